@@ -33,8 +33,8 @@ build_matrixmath_project() {
   # Project Settings.
   local project_path="$1"; # Root path of the project.
   local base_name='libmatrixmath';   # Base name for the project.
-  local test_dependencies='-lm'; # Dependencies for tests (add as needed).
-  local library_dependencies='-lm'; # Dependencies for library (add as needed).
+  local test_dependencies='-lm -lpthread'; # Dependencies for tests (add as needed).
+  local library_dependencies='-lm -lpthread'; # Dependencies for library (add as needed).
   local namespace=''; # The project namespace.
 
   # Build the project.
@@ -1,6 +1,14 @@
 #ifndef VECTOR_H
 #define VECTOR_H
 
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The reference counted storage of values shared by several objects.
+ */
+struct matrixmath_shared;
+
 /**
  * The data struct definition for an individual vector object.
  *
@@ -9,48 +17,87 @@
 struct vector {
 
   /**
-   * Pointer to the vectors items in the chain.
+   * Pointer to the contiguous buffer with the vector values.
+   *
+   * The values are stored one after the other, so the whole vector can be
+   * processed by tight loops over a single block of memory.
+   *
+   * @var long double *data.
+   */
+  long double *data;
+
+  /**
+   * The number of elements of the vector.
+   *
+   * @var int64_t capacity.
+   */
+  int64_t capacity;
+
+  /**
+   * The number of elements the buffer can hold, at least the capacity.
+   *
+   * The vector grows in place while its capacity stays below it.
+   *
+   * @var int64_t allocated.
+   */
+  int64_t allocated;
+
+  /**
+   * The callback releasing the values when the object is destroyed.
    *
-   * Allow you to walk array/object chains.
+   * NULL when the values are borrowed: the caller keeps ownership of them
+   * and they must outlive the object.
+   *
+   * @var void (*release)(void *context, long double *data).
+   */
+  void (*release)(void *context, long double *data);
+
+  /**
+   * The context given to the release callback.
    *
-   * @var void **items.
+   * @var void *release_context.
    */
-  void **items;
+  void *release_context;
 
   /**
-   * The maximum amount elements that the vector instance can contain.
+   * The reference counted storage, once the values are shared by clones.
    *
-   * @var int capacity.
+   * NULL while the object is the only one using its values. Shared values
+   * are copied on the first write, and released by the last object using
+   * them; the release fields above are moved to the storage when it is
+   * created.
+   *
+   * @var struct matrixmath_shared *shared.
    */
-  int capacity;
+  struct matrixmath_shared *shared;
 };
 
 /**
- * Create a new vector object instance.
+ * Create a new vector object instance with all its elements set to zero.
  *
- * @param const int capacity
+ * @param const int64_t capacity
  *   The max size of the vector.
  *
  * @return struct vector*
  *   The pointer to the vector instance, otherwise NULL.
  */
-struct vector *vector_create(const int capacity);
+struct vector *vector_create(const int64_t capacity);
 
 /**
  * Create a new vector filled with zeros.
  *
- * @param const int capacity
+ * @param const int64_t capacity
  *   The max size of the vector.
  *
  * @return struct vector*
  *   The pointer to the zero-filled vector instance, otherwise NULL.
  */
-struct vector *vector_create_zeros(const int capacity);
+struct vector *vector_create_zeros(const int64_t capacity);
 
 /**
  * Create a new vector filled with a given default value.
  *
- * @param const int capacity
+ * @param const int64_t capacity
  *   The max size of the vector.
  * @param long double default_value
  *   The value to initialize each element with.
@@ -58,12 +105,12 @@ struct vector *vector_create_zeros(const int capacity);
  * @return struct vector*
  *   The pointer to the value-filled vector instance, otherwise NULL.
  */
-struct vector *vector_create_with_value(const int capacity, long double default_value);
+struct vector *vector_create_with_value(const int64_t capacity, long double default_value);
 
 /**
  * Create a new vector object instance with random values between a specified range.
  *
- * @param const int capacity
+ * @param const int64_t capacity
  *   The maximum size of the vector.
  * @param const long double min
  *   The minimum value for random initialization.
@@ -73,18 +120,40 @@ struct vector *vector_create_with_value(const int capacity, long double default_
  * @return struct vector*
  *   The pointer to the vector instance, otherwise NULL.
  */
-struct vector *vector_create_random(const int capacity, const long double min, const long double max);
+struct vector *vector_create_random(const int64_t capacity, const long double min, const long double max);
+
+/**
+ * Create a vector object instance around an existing buffer, without copying.
+ *
+ * With a release callback the vector takes ownership of the buffer and calls
+ * release(context, data) when destroyed, matrixmath_release_free() adopts a
+ * buffer from malloc(); without one the buffer is only borrowed. On failure
+ * the ownership stays with the caller.
+ *
+ * @param long double* data
+ *   The values, aligned for long double.
+ * @param const int64_t capacity
+ *   The number of values.
+ * @param void (*release)(void *context, long double *data)
+ *   The callback releasing the buffer, or NULL to borrow it.
+ * @param void* context
+ *   The context given to the release callback.
+ *
+ * @return struct vector*
+ *   The pointer to the vector instance, otherwise NULL.
+ */
+struct vector *vector_wrap(long double *data, const int64_t capacity, void (*release)(void *context, long double *data), void *context);
 
 /**
  * Creates multiple vectors.
  *
- * @param int size
+ * @param int64_t size
  *   This represents the number of vectors to allocate space for.
  *
  * @return struct vector**
  *   The list of vector items.
  */
-struct vector **vector_create_multiple(int size);
+struct vector **vector_create_multiple(int64_t size);
 
 /**
  * Free the memory associted to a vector object.
@@ -99,17 +168,17 @@ void vector_destroy(struct vector *object);
  *
  * @param struct vector **items
  *   The list of vectors to destroy.
- * @param int size
+ * @param int64_t size
  *   The number of vectors to destroy.
  */
-void vector_destroy_multiple(struct vector **items, int size);
+void vector_destroy_multiple(struct vector **items, int64_t size);
 
 /**
  * Sets the long double value at the specified index in the given vector.
  *
  * @param struct vector* object
  *   The vector object.
- * @param int index
+ * @param int64_t index
  *   The position to store the given value.
  * @param long double value
  *   The value to store.
@@ -117,21 +186,37 @@ void vector_destroy_multiple(struct vector **items, int size);
  * @return long double*
  *   The pointer to the long double value stored at the given position; otherwise NULL.
  */
-long double *vector_setl(struct vector *object, int index, long double value);
+long double *vector_setl(struct vector *object, int64_t index, long double value);
 
 /**
  * Gets the long double value stored at the given index in the given vector.
  *
+ * The values are detached first, so the value can be written through the
+ * pointer without changing the vectors sharing them.
+ *
  * @param struct vector* object
  *   The vector object.
- * @param int index
+ * @param int64_t index
  *   The position to store the given value.
  * @param long double value
  *
  * @return long double*
  *   The pointer to the long double value stored at the given position; otherwise NULL.
  */
-long double *vector_getl(struct vector *object, int index);
+long double *vector_getl(struct vector *object, int64_t index);
+
+/**
+ * Get the contiguous buffer with the values of the given vector.
+ *
+ * The values are detached first, so the buffer can be written.
+ *
+ * @param struct vector* object
+ *   The vector object.
+ *
+ * @return long double*
+ *   The pointer to the first value, otherwise NULL.
+ */
+long double *vector_data(struct vector *object);
 
 /**
  * Concatenate two given vectors.
@@ -149,9 +234,87 @@ long double *vector_getl(struct vector *object, int index);
  */
 struct vector *vector_concatenate(struct vector *a, struct vector *b);
 
+/**
+ * Make room for a number of elements in the buffer of the given vector.
+ *
+ * The capacity of the vector is left unchanged, later pushes, resizes and
+ * appends up to the reserved size do not reallocate.
+ *
+ * @param struct vector* object
+ *   The vector object.
+ * @param int64_t count
+ *   The number of elements to make room for.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int vector_reserve(struct vector *object, int64_t count);
+
+/**
+ * Change the number of elements of the given vector.
+ *
+ * The new elements are set to zero. The buffer grows geometrically, so a
+ * sequence of resizes costs amortized constant time per element.
+ *
+ * @param struct vector* object
+ *   The vector object.
+ * @param int64_t capacity
+ *   The new number of elements, zero included.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int vector_resize(struct vector *object, int64_t capacity);
+
+/**
+ * Add a value at the end of the given vector.
+ *
+ * The buffer doubles when it is full, so pushes take amortized constant time.
+ *
+ * @param struct vector* object
+ *   The vector object.
+ * @param long double value
+ *   The value to add.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int vector_push(struct vector *object, long double value);
+
+/**
+ * Add the values of a vector at the end of another one, in place.
+ *
+ * Unlike vector_concatenate() no vector is created, and the buffer of a is
+ * only reallocated when it has no room left.
+ *
+ * @param struct vector* a
+ *   The vector to extend.
+ * @param struct vector* b
+ *   The vector with the values to add, a itself included.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int vector_append(struct vector *a, struct vector *b);
+
+/**
+ * Release the room of the buffer not used by the elements of the vector.
+ *
+ * @param struct vector* object
+ *   The vector object.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int vector_shrink_to_fit(struct vector *object);
+
 /**
  * Creating a copy of the given vector.
  *
+ * The copy shares the values of the vector until one of them is written, so
+ * cloning takes constant time and the values are only duplicated on the first
+ * write; the vector can keep being read while shared.
+ *
  * @param struct vector *a
  *   The vector to copy.
  *
@@ -160,6 +323,20 @@ struct vector *vector_concatenate(struct vector *a, struct vector *b);
  */
 struct vector *vector_clone(struct vector *a);
 
+/**
+ * Give the vector its own copy of its values if they are shared.
+ *
+ * Every library function writing to a vector calls it first, vector_getl()
+ * and vector_data() included.
+ *
+ * @param struct vector* object
+ *   The vector object.
+ *
+ * @return int
+ *   Returns 0 when the values can be written, otherwise 1.
+ */
+int vector_detach(struct vector *object);
+
 /**
  * Apply a user supplied function to every member of an vector.
  *
@@ -186,6 +363,9 @@ void vector_fill(struct vector *object, const long double value);
 /**
  * Fill the given vector with random values between a specified range.
  *
+ * The values are drawn from the library default generator, see
+ * matrixmath_random_seed() and vector_fill_uniform().
+ *
  * @param struct vector *object
  *   The vector object to fill.
  * @param const long double min
@@ -343,9 +523,98 @@ struct vector *vector_scalar_sub(long double scalar, struct vector *a);
 
 #endif
 
+#ifndef VECTOR_FUSED_OPERATIONS_H
+#define VECTOR_FUSED_OPERATIONS_H
+
+/**
+ * Fused in-place scaled addition: y = y + alpha * x.
+ *
+ * @param long double alpha
+ *   The scalar that multiplies x.
+ * @param struct vector* x
+ *   The vector to be added.
+ * @param struct vector* y
+ *   The vector updated in place.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int vector_axpy(long double alpha, struct vector *x, struct vector *y);
+
+/**
+ * Fused in-place linear combination: y = alpha * x + beta * y.
+ *
+ * When beta is zero the previous values of y are not read.
+ *
+ * @param long double alpha
+ *   The scalar that multiplies x.
+ * @param struct vector* x
+ *   The vector to be added.
+ * @param long double beta
+ *   The scalar that multiplies y.
+ * @param struct vector* y
+ *   The vector updated in place.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int vector_axpby(long double alpha, struct vector *x, long double beta, struct vector *y);
+
+/**
+ * In-place vector multiplication by a scalar: x = alpha * x.
+ *
+ * @param long double alpha
+ *   The scalar to be multiplied.
+ * @param struct vector* x
+ *   The vector updated in place.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int vector_scale_inplace(long double alpha, struct vector *x);
+
+/**
+ * In-place vector addition: a = a + b.
+ *
+ * @param struct vector* a
+ *   The vector updated in place.
+ * @param struct vector* b
+ *   The vector to be added.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int vector_add_inplace(struct vector *a, struct vector *b);
+
+/**
+ * Compute the dot product and the Euclidean norms of two vectors in a single pass.
+ *
+ * Large vectors are split across threads, the library reduction mode decides
+ * whether the result depends on the number of threads.
+ *
+ * @param struct vector* a
+ *   The first vector.
+ * @param struct vector* b
+ *   The second vector.
+ * @param long double* dot
+ *   The destination for the dot product, it can be NULL.
+ * @param long double* norm_a
+ *   The destination for the norm of a, it can be NULL.
+ * @param long double* norm_b
+ *   The destination for the norm of b, it can be NULL.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int vector_dot_norms(struct vector *a, struct vector *b, long double *dot, long double *norm_a, long double *norm_b);
+
+#endif
+
 #ifndef VECTOR_PRINT_H
 #define VECTOR_PRINT_H
 
+#include <stdio.h>
+
 /**
  * Prints a vector object.
  *
@@ -362,6 +631,50 @@ void vector_print(struct vector *object);
  */
 void vector_println(struct vector *object);
 
+/**
+ * Prints a vector object to a stream.
+ *
+ * The text is formatted into large chunks before it is written, with a fast
+ * fixed-point formatter.
+ *
+ * @param FILE* stream
+ *   The stream.
+ * @param struct vector* object
+ *   The vector object to be printed.
+ * @param int precision
+ *   The number of decimals of each value.
+ * @param int64_t edge
+ *   The number of leading and trailing values printed for larger vectors, the
+ *   others are summarized by "..."; 0 prints every value.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int vector_fprint(FILE *stream, struct vector *object, int precision, int64_t edge);
+
+/**
+ * Prints a vector object to a buffer, as vector_fprint() does to a stream.
+ *
+ * At most size - 1 characters are written, followed by a null character; a
+ * NULL buffer with size 0 only measures the text.
+ *
+ * @param char* buffer
+ *   The buffer.
+ * @param size_t size
+ *   The size of the buffer.
+ * @param struct vector* object
+ *   The vector object to be printed.
+ * @param int precision
+ *   The number of decimals of each value.
+ * @param int64_t edge
+ *   The number of leading and trailing values printed, 0 for all.
+ *
+ * @return int64_t
+ *   The length of the whole text, which was truncated when it is not below
+ *   size; -1 on error.
+ */
+int64_t vector_sprint(char *buffer, size_t size, struct vector *object, int precision, int64_t edge);
+
 #endif
 
 #ifndef MATRIX_H
@@ -377,51 +690,78 @@ void vector_println(struct vector *object);
 struct matrix {
 
   /**
-   * Pointer to the row vectors in the chain.
+   * Pointer to the contiguous buffer with the matrix values.
    *
-   * Allow you to walk array/object chains. this pointer points to an
-   * array of row vectors, where each row vector contains the elements
-   * of the matrix in row-major order. The type of the elements is
-   * determined by the context in which this struct is used.
+   * The rows are stored one after the other in row-major order, so the
+   * element in the row j and the column k is at data[j * columns + k].
    *
-   * @var void **items.
+   * @var long double *data.
    */
-  void **items;
+  long double *data;
 
   /**
    * The number of rows in the matrix.
    *
-   * @var int rows.
+   * @var int64_t rows.
    */
-  int rows;
+  int64_t rows;
 
   /**
    * The number of columns in the matrix.
    *
-   * @var int columns.
+   * @var int64_t columns.
+   */
+  int64_t columns;
+
+  /**
+   * The callback releasing the values when the object is destroyed.
+   *
+   * NULL when the values are borrowed: the caller keeps ownership of them
+   * and they must outlive the object.
+   *
+   * @var void (*release)(void *context, long double *data).
+   */
+  void (*release)(void *context, long double *data);
+
+  /**
+   * The context given to the release callback.
+   *
+   * @var void *release_context.
+   */
+  void *release_context;
+
+  /**
+   * The reference counted storage, once the values are shared by clones.
+   *
+   * NULL while the object is the only one using its values. Shared values
+   * are copied on the first write, and released by the last object using
+   * them; the release fields above are moved to the storage when it is
+   * created.
+   *
+   * @var struct matrixmath_shared *shared.
    */
-  int columns;
+  struct matrixmath_shared *shared;
 };
 
 /*
- * Create a new matrix object instance.
+ * Create a new matrix object instance with all its elements set to zero.
  *
- * @param const int rows
+ * @param const int64_t rows
  *   The numer of rows in the matrix.
- * @param const int columns
+ * @param const int64_t columns
  *   The numer of columns in the matrix.
  *
  * @return struct matrix*
  *   The pointer to the matrix instance, otherwise NULL.
  */
-struct matrix *matrix_create(const int rows, const int columns);
+struct matrix *matrix_create(const int64_t rows, const int64_t columns);
 
 /*
  * Create a new matrix object instance with random values between a given range.
  *
- * @param const int rows
+ * @param const int64_t rows
  *   The number of rows in the matrix.
- * @param const int columns
+ * @param const int64_t columns
  *   The number of columns in the matrix.
  * @param const long double min
  *   The minimum value for random initialization.
@@ -431,7 +771,30 @@ struct matrix *matrix_create(const int rows, const int columns);
  * @return struct matrix*
  *   The pointer to the matrix instance, otherwise NULL.
  */
-struct matrix *matrix_create_random(const int rows, const int columns, const long double min, const long double max);
+struct matrix *matrix_create_random(const int64_t rows, const int64_t columns, const long double min, const long double max);
+
+/**
+ * Create a matrix object instance around an existing buffer, without copying.
+ *
+ * The buffer holds rows * columns values in row-major order. With a release
+ * callback the matrix takes ownership of the buffer, without one it is only
+ * borrowed; see vector_wrap().
+ *
+ * @param long double* data
+ *   The values, aligned for long double.
+ * @param const int64_t rows
+ *   The number of rows in the matrix.
+ * @param const int64_t columns
+ *   The number of columns in the matrix.
+ * @param void (*release)(void *context, long double *data)
+ *   The callback releasing the buffer, or NULL to borrow it.
+ * @param void* context
+ *   The context given to the release callback.
+ *
+ * @return struct matrix*
+ *   The pointer to the matrix instance, otherwise NULL.
+ */
+struct matrix *matrix_wrap(long double *data, const int64_t rows, const int64_t columns, void (*release)(void *context, long double *data), void *context);
 
 /**
  * Free the memory associted to a matrix object.
@@ -446,9 +809,9 @@ void matrix_destroy(struct matrix *object);
  *
  * @param struct matrix* object
  *   The matrix object.
- * @param int j
+ * @param int64_t j
  *   The j position to check.
- * @param int k
+ * @param int64_t k
  *   The k position to check.
  * @param long double value
  *   The value to store.
@@ -456,16 +819,16 @@ void matrix_destroy(struct matrix *object);
  * @return int
  *   Returns 1 if the given positions j and K are valid, otherwise 0.
  */
-int matrix_check_boundaries(struct matrix *object, int j, int k);
+int matrix_check_boundaries(struct matrix *object, int64_t j, int64_t k);
 
 /**
  * Sets the long double value at the specified index in the given matrix.
  *
  * @param struct matrix* object
  *   The matrix object.
- * @param int j
+ * @param int64_t j
  *   The j position to store the given value.
- * @param int k
+ * @param int64_t k
  *   The k position to store the given value.
  * @param long double value
  *   The value to store.
@@ -473,23 +836,39 @@ int matrix_check_boundaries(struct matrix *object, int j, int k);
  * @return long double*
  *   The pointer to the long double value stored at the given position; otherwise NULL.
  */
-long double *matrix_setl(struct matrix *object, int j, int k, long double value);
+long double *matrix_setl(struct matrix *object, int64_t j, int64_t k, long double value);
 
 /**
  * Gets the long double value stored at the given index in the given matrix.
  *
+ * The values are detached first, so the value can be written through the
+ * pointer without changing the matrices sharing them.
+ *
  * @param struct matrix* object
  *   The matrix object.
- * @param int j
+ * @param int64_t j
  *   The x position to store the given value.
- * @param int k
+ * @param int64_t k
  *   The y position to store the given value.
  * @param long double value
  *
  * @return long double*
  *   The pointer to the long double value stored at the given position; otherwise NULL.
  */
-long double *matrix_getl(struct matrix *object, int j, int k);
+long double *matrix_getl(struct matrix *object, int64_t j, int64_t k);
+
+/**
+ * Get the contiguous row-major buffer with the values of the given matrix.
+ *
+ * The values are detached first, so the buffer can be written.
+ *
+ * @param struct matrix* object
+ *   The matrix object.
+ *
+ * @return long double*
+ *   The pointer to the first value, otherwise NULL.
+ */
+long double *matrix_data(struct matrix *object);
 
 /*
  * Create a new matrix object instance from the given array values.
@@ -497,15 +876,30 @@ long double *matrix_getl(struct matrix *object, int j, int k);
  *
  * @param long double *array
  *   The pointer to the tip(first) value on the array.
- * @param const int rows
+ * @param const int64_t rows
  *   The numer of rows in the matrix.
- * @param const int columns
+ * @param const int64_t columns
  *   The numer of columns in the matrix.
  *
  * @return struct matrix*
  *   The pointer to the matrix instance, otherwise NULL.
  */
-struct matrix *matrix_from_array(long double *array, const int rows, const int columns);
+struct matrix *matrix_from_array(long double *array, const int64_t rows, const int64_t columns);
+
+/**
+ * Apply a user supplied function to every element of a matrix.
+ *
+ * See matrix_walk_batch() for a form that receives contiguous chunks.
+ *
+ * @param struct matrix *a
+ *   The matrix to run through the callback function.
+ * @param long double (*callback)(long double)
+ *   A callable to run for each element.
+ *
+ * @return int
+ *   Returns 1 if the walk operation succeeded, otherwise 0.
+ */
+int matrix_walk(struct matrix *a, long double (*callback)(long double));
 
 /**
  * Set the given value in all elements of the given matrix.
@@ -520,6 +914,9 @@ void matrix_fill(struct matrix *object, const long double value);
 /**
  * Fill the given matrix with random values between a specified range.
  *
+ * The values are drawn from the library default generator, see
+ * matrixmath_random_seed() and matrix_fill_uniform().
+ *
  * @param struct matrix *object
  *   The matrix object to fill.
  * @param const long double min
@@ -536,15 +933,15 @@ void matrix_fill_random(struct matrix *object, const long double min, const long
  *   The pointer to the tip(first) value on the array.
  * @param struct matrix* object
  *   The matrix object.
- * @param const int rows
+ * @param const int64_t rows
  *   The numer of rows in the matrix.
- * @param const int columns
+ * @param const int64_t columns
  *   The numer of columns in the matrix.
  *
  * @return int
  *   Returns 1 if the given positions j and K are valid, otherwise 0.
  */
-void matrix_fill_from_array(long double *array, struct matrix *object, const int rows, const int columns);
+void matrix_fill_from_array(long double *array, struct matrix *object, const int64_t rows, const int64_t columns);
 
 /**
  * Copies the contents of one matrix to another.
@@ -561,6 +958,34 @@ void matrix_fill_from_array(long double *array, struct matrix *object, const int
  */
 int matrix_copy(struct matrix *src, struct matrix *dest);
 
+/**
+ * Create a copy of the given matrix.
+ *
+ * The copy shares the values of the matrix until one of them is written, see
+ * vector_clone().
+ *
+ * @param struct matrix* a
+ *   The matrix to copy.
+ *
+ * @return struct matrix*
+ *   The pointer to the copy of the matrix, otherwise NULL.
+ */
+struct matrix *matrix_clone(struct matrix *a);
+
+/**
+ * Give the matrix its own copy of its values if they are shared.
+ *
+ * Every library function writing to a matrix calls it first, matrix_getl()
+ * and matrix_data() included.
+ *
+ * @param struct matrix* object
+ *   The matrix object.
+ *
+ * @return int
+ *   Returns 0 when the values can be written, otherwise 1.
+ */
+int matrix_detach(struct matrix *object);
+
 #endif
 
 #ifndef MATRIX_ALGEBRAIC_OPERATIONS_H
@@ -635,6 +1060,61 @@ int matrix_sub_dest(struct matrix *a, struct matrix *b, struct matrix *dest);
  */
 struct matrix *matrix_mul(struct matrix *a, struct matrix *b);
 
+/**
+ * General matrix product c = alpha * a * b + beta * c (GEMM), in parallel.
+ *
+ * When beta is 0, c is not read.
+ *
+ * @param long double alpha
+ *   The scale factor of the product.
+ * @param struct matrix* a
+ *   The m x k matrix.
+ * @param struct matrix* b
+ *   The k x n matrix.
+ * @param long double beta
+ *   The scale factor of c.
+ * @param struct matrix* c
+ *   The m x n destination matrix, it cannot be a or b.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_gemm(long double alpha, struct matrix *a, struct matrix *b, long double beta, struct matrix *c);
+
+/**
+ * General matrix product on row-major buffers with leading dimensions.
+ *
+ * Computes c = alpha * a * b + beta * c where element (i, j) of a is
+ * a[i * lda + j], so the operands can be blocks of larger matrices.
+ *
+ * @param int64_t m
+ *   The number of rows of a and c.
+ * @param int64_t n
+ *   The number of columns of b and c.
+ * @param int64_t k
+ *   The number of columns of a and rows of b.
+ * @param long double alpha
+ *   The scale factor of the product.
+ * @param const long double* a
+ *   The first matrix values.
+ * @param int64_t lda
+ *   The distance between two rows of a, at least k.
+ * @param const long double* b
+ *   The second matrix values.
+ * @param int64_t ldb
+ *   The distance between two rows of b, at least n.
+ * @param long double beta
+ *   The scale factor of c.
+ * @param long double* c
+ *   The destination matrix values, they must not overlap a or b.
+ * @param int64_t ldc
+ *   The distance between two rows of c, at least n.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_gemm_strided(int64_t m, int64_t n, int64_t k, long double alpha, const long double *a, int64_t lda, const long double *b, int64_t ldb, long double beta, long double *c, int64_t ldc);
+
 /**
  * Matrix multiplication by a scalar.
  *
@@ -674,6 +1154,22 @@ int matrix_scalar_mul_dest(long double scalar, struct matrix *a, struct matrix *
  */
 struct vector *matrix_mul_vector(struct matrix *a, struct vector *b);
 
+/**
+ * Matrix by vector multiplication with destination.
+ *
+ * @param struct matrix* a
+ *   The matrix object to be multiplied.
+ * @param struct vector* b
+ *   The vector object to be multiplied.
+ * @param struct vector* dest
+ *   The destination vector where the results of the operation will be stored,
+ *   distinct from b.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_mul_vector_dest(struct matrix *a, struct vector *b, struct vector *dest);
+
 /**
  * Transpose the given matrix.
  *
@@ -687,6 +1183,69 @@ struct matrix *matrix_transpose(struct matrix *a);
 
 #endif
 
+#ifndef MATRIX_BATCHED_OPERATIONS_H
+#define MATRIX_BATCHED_OPERATIONS_H
+
+/**
+ * Batched multiplication of matrices stored with a constant stride in buffers.
+ *
+ * Computes C_i = A_i * B_i for i in [0, count), where the row-major values of
+ * A_i start at a + i * stride_a, and so on. The products run in parallel across
+ * the batch, and square 2, 3, 4, 8 and 16 sized products use unrolled kernels.
+ * A stride of 0 reuses the same matrix for every product.
+ *
+ * @param int64_t m
+ *   The number of rows of each A_i and C_i.
+ * @param int64_t n
+ *   The number of columns of each B_i and C_i.
+ * @param int64_t k
+ *   The number of columns of each A_i and rows of each B_i.
+ * @param const long double* a
+ *   The buffer with the first matrices.
+ * @param int64_t stride_a
+ *   The number of elements between consecutive first matrices.
+ * @param const long double* b
+ *   The buffer with the second matrices.
+ * @param int64_t stride_b
+ *   The number of elements between consecutive second matrices.
+ * @param long double* c
+ *   The destination buffer, it must not overlap a or b.
+ * @param int64_t stride_c
+ *   The number of elements between consecutive destination matrices, at least m * n.
+ * @param int64_t count
+ *   The number of products.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_mul_strided_batched(int64_t m, int64_t n, int64_t k, const long double *a, int64_t stride_a, const long double *b, int64_t stride_b, long double *c, int64_t stride_c, int64_t count);
+
+/**
+ * Batched multiplication of arrays of matrices: c[i] = a[i] * b[i].
+ *
+ * The destination matrices must be already created with the dimensions of the
+ * products. The products run in parallel in any order, so the storage of a
+ * destination must not overlap the storage of another destination or of any
+ * operand of the batch, whatever its index: chaining products with
+ * c[i] == a[i + 1] is rejected. The whole batch is validated before any
+ * product is computed.
+ *
+ * @param struct matrix** a
+ *   The first matrices.
+ * @param struct matrix** b
+ *   The second matrices.
+ * @param struct matrix** c
+ *   The destination matrices.
+ * @param int64_t count
+ *   The number of products.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_mul_batched(struct matrix **a, struct matrix **b, struct matrix **c, int64_t count);
+
+#endif
+
 #ifndef MATRIX_PRINT_H
 #define MATRIX_PRINT_H
 
@@ -698,6 +1257,50 @@ struct matrix *matrix_transpose(struct matrix *a);
  */
 void matrix_print(struct matrix *object);
 
+/**
+ * Prints a matrix object to a stream, one row per line.
+ *
+ * The text is formatted into large chunks before it is written, with a fast
+ * fixed-point formatter.
+ *
+ * @param FILE* stream
+ *   The stream.
+ * @param struct matrix* object
+ *   The matrix object to be printed.
+ * @param int precision
+ *   The number of decimals of each value.
+ * @param int64_t edge
+ *   The number of leading and trailing rows and columns printed for larger
+ *   matrices, the others are summarized by "..."; 0 prints every value.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_fprint(FILE *stream, struct matrix *object, int precision, int64_t edge);
+
+/**
+ * Prints a matrix object to a buffer, as matrix_fprint() does to a stream.
+ *
+ * At most size - 1 characters are written, followed by a null character; a
+ * NULL buffer with size 0 only measures the text.
+ *
+ * @param char* buffer
+ *   The buffer.
+ * @param size_t size
+ *   The size of the buffer.
+ * @param struct matrix* object
+ *   The matrix object to be printed.
+ * @param int precision
+ *   The number of decimals of each value.
+ * @param int64_t edge
+ *   The number of leading and trailing rows and columns printed, 0 for all.
+ *
+ * @return int64_t
+ *   The length of the whole text, which was truncated when it is not below
+ *   size; -1 on error.
+ */
+int64_t matrix_sprint(char *buffer, size_t size, struct matrix *object, int precision, int64_t edge);
+
 #endif
 
 #ifndef MATRIX_CASTING_H
@@ -726,3 +1329,3627 @@ struct vector *matrix_to_vector(struct matrix *m);
 struct matrix *vector_to_matrix(struct vector *a);
 
 #endif
+
+#ifndef PRECONDITIONER_H
+#define PRECONDITIONER_H
+
+/**
+ * The data struct definition for a preconditioner object.
+ *
+ * A preconditioner approximates the inverse of a linear system matrix, it is
+ * applied by the iterative solvers as z = M^-1 * r.
+ */
+struct preconditioner {
+
+  /**
+   * The callback that applies the preconditioner: z = M^-1 * r.
+   *
+   * The callback must return 0 when the operation succeeded, otherwise 1.
+   *
+   * @var int (*apply)(void *context, struct vector *r, struct vector *z).
+   */
+  int (*apply)(void *context, struct vector *r, struct vector *z);
+
+  /**
+   * The callback that frees the preconditioner context, it can be NULL.
+   *
+   * @var void (*destroy)(void *context).
+   */
+  void (*destroy)(void *context);
+
+  /**
+   * The data used by the apply callback.
+   *
+   * @var void *context.
+   */
+  void *context;
+};
+
+/**
+ * Create a Jacobi (diagonal) preconditioner for the given square matrix.
+ *
+ * @param struct matrix* a
+ *   The system matrix, all the elements on its diagonal must be nonzero.
+ *
+ * @return struct preconditioner*
+ *   The pointer to the preconditioner instance, otherwise NULL.
+ */
+struct preconditioner *preconditioner_jacobi_create(struct matrix *a);
+
+/**
+ * Create an incomplete LU factorization with zero fill-in, ILU(0), preconditioner.
+ *
+ * The factors keep the sparsity pattern of the given matrix: only the elements
+ * that are nonzero in the given matrix are stored and updated, the same as
+ * preconditioner_ilu0_create_sparse on its nonzero elements.
+ *
+ * @param struct matrix* a
+ *   The square system matrix.
+ *
+ * @return struct preconditioner*
+ *   The pointer to the preconditioner instance, otherwise NULL.
+ */
+struct preconditioner *preconditioner_ilu0_create(struct matrix *a);
+
+/**
+ * Free the memory associated to a preconditioner object.
+ *
+ * @param struct preconditioner* object
+ *   The preconditioner object to be clean.
+ */
+void preconditioner_destroy(struct preconditioner *object);
+
+/**
+ * Apply the given preconditioner: z = M^-1 * r.
+ *
+ * When no preconditioner is given, the values of r are copied into z.
+ *
+ * @param struct preconditioner* object
+ *   The preconditioner object, or NULL for the identity.
+ * @param struct vector* r
+ *   The vector to precondition.
+ * @param struct vector* z
+ *   The destination vector where the results of the operation will be stored.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int preconditioner_apply(struct preconditioner *object, struct vector *r, struct vector *z);
+
+#endif
+
+#ifndef KRYLOV_H
+#define KRYLOV_H
+
+/**
+ * The data struct definition for a linear operator object.
+ *
+ * The Krylov solvers never access the system matrix directly, they only need
+ * the product y = A * x, which allows solving systems that are never assembled.
+ */
+struct linear_operator {
+
+  /**
+   * The callback that applies the operator: y = A * x.
+   *
+   * The callback must return 0 when the operation succeeded, otherwise 1.
+   *
+   * @var int (*apply)(void *context, struct vector *x, struct vector *y).
+   */
+  int (*apply)(void *context, struct vector *x, struct vector *y);
+
+  /**
+   * The data used by the apply callback.
+   *
+   * @var void *context.
+   */
+  void *context;
+};
+
+/**
+ * The data struct definition for a Krylov solver object.
+ *
+ * The solver object owns all the scratch memory used by the iterations, so it
+ * can be created once and reused to solve many systems of the same size.
+ */
+struct krylov_solver {
+
+  /**
+   * The size of the linear systems to solve.
+   *
+   * @var int64_t size.
+   */
+  int64_t size;
+
+  /**
+   * The number of iterations between restarts of GMRES.
+   *
+   * @var int restart.
+   */
+  int restart;
+
+  /**
+   * The maximum number of iterations allowed, 1000 by default.
+   *
+   * @var int max_iterations.
+   */
+  int max_iterations;
+
+  /**
+   * The relative residual tolerance ||b - A * x|| / ||b||, 1e-10 by default.
+   *
+   * @var long double tolerance.
+   */
+  long double tolerance;
+
+  /**
+   * The number of iterations performed by the last solve.
+   *
+   * @var int iterations.
+   */
+  int iterations;
+
+  /**
+   * The relative residual norm reached by the last solve.
+   *
+   * @var long double residual.
+   */
+  long double residual;
+
+  /**
+   * The preallocated scratch vectors.
+   *
+   * @var struct vector **work.
+   */
+  struct vector **work;
+
+  /**
+   * The number of preallocated scratch vectors.
+   *
+   * @var int work_size.
+   */
+  int work_size;
+
+  /**
+   * The GMRES Hessenberg matrix, stored by columns.
+   *
+   * @var long double *hessenberg.
+   */
+  long double *hessenberg;
+
+  /**
+   * The GMRES Givens rotations, stored as (cos, sin) pairs.
+   *
+   * @var long double *givens.
+   */
+  long double *givens;
+
+  /**
+   * The GMRES least squares right hand side.
+   *
+   * @var long double *rhs.
+   */
+  long double *rhs;
+
+  /**
+   * The GMRES Gram-Schmidt projections scratch space.
+   *
+   * @var long double *projections.
+   */
+  long double *projections;
+};
+
+/**
+ * Create a new Krylov solver object instance.
+ *
+ * @param const int64_t size
+ *   The size of the linear systems to solve.
+ * @param const int restart
+ *   The number of iterations between restarts of GMRES.
+ *
+ * @return struct krylov_solver*
+ *   The pointer to the solver instance, otherwise NULL.
+ */
+struct krylov_solver *krylov_solver_create(const int64_t size, const int restart);
+
+/**
+ * Free the memory associated to a Krylov solver object.
+ *
+ * @param struct krylov_solver* object
+ *   The solver object to be clean.
+ */
+void krylov_solver_destroy(struct krylov_solver *object);
+
+/**
+ * Linear operator callback that multiplies by a dense matrix.
+ *
+ * @param void* context
+ *   The struct matrix object to multiply by.
+ * @param struct vector* x
+ *   The vector to be multiplied.
+ * @param struct vector* y
+ *   The destination vector where the results of the operation will be stored.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_operator_apply(void *context, struct vector *x, struct vector *y);
+
+/**
+ * Solve A * x = b with the preconditioned Conjugate Gradient method.
+ *
+ * The operator and the preconditioner must be symmetric positive definite. It
+ * uses the Chronopoulos-Gear formulation, which computes both inner products of
+ * an iteration in a single pass, so each iteration makes two passes over the
+ * vectors besides the operator and preconditioner applications.
+ *
+ * @param struct krylov_solver* solver
+ *   The solver object.
+ * @param struct linear_operator* op
+ *   The linear operator A.
+ * @param struct preconditioner* pc
+ *   The preconditioner, or NULL for none.
+ * @param struct vector* b
+ *   The right hand side vector.
+ * @param struct vector* x
+ *   The initial guess, overwritten with the solution.
+ *
+ * @return int
+ *   Returns 0 when the method converged, otherwise 1.
+ */
+int krylov_cg(struct krylov_solver *solver, struct linear_operator *op, struct preconditioner *pc, struct vector *b, struct vector *x);
+
+/**
+ * Solve A * x = b with the right preconditioned BiCGSTAB method.
+ *
+ * @param struct krylov_solver* solver
+ *   The solver object.
+ * @param struct linear_operator* op
+ *   The linear operator A.
+ * @param struct preconditioner* pc
+ *   The preconditioner, or NULL for none.
+ * @param struct vector* b
+ *   The right hand side vector.
+ * @param struct vector* x
+ *   The initial guess, overwritten with the solution.
+ *
+ * @return int
+ *   Returns 0 when the method converged, otherwise 1.
+ */
+int krylov_bicgstab(struct krylov_solver *solver, struct linear_operator *op, struct preconditioner *pc, struct vector *b, struct vector *x);
+
+/**
+ * Solve A * x = b with the right preconditioned, restarted GMRES method.
+ *
+ * The basis is orthogonalized with classical Gram-Schmidt, which computes all
+ * the projections in a single pass, and it is repeated once when cancellation
+ * is detected.
+ *
+ * @param struct krylov_solver* solver
+ *   The solver object.
+ * @param struct linear_operator* op
+ *   The linear operator A.
+ * @param struct preconditioner* pc
+ *   The preconditioner, or NULL for none.
+ * @param struct vector* b
+ *   The right hand side vector.
+ * @param struct vector* x
+ *   The initial guess, overwritten with the solution.
+ *
+ * @return int
+ *   Returns 0 when the method converged, otherwise 1.
+ */
+int krylov_gmres(struct krylov_solver *solver, struct linear_operator *op, struct preconditioner *pc, struct vector *b, struct vector *x);
+
+#endif
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+/**
+ * Set the number of threads used by the library.
+ *
+ * By default the library uses the value of the MATRIXMATH_NUM_THREADS
+ * environment variable, or the number of online processors. It must not be
+ * called while library operations are running in other threads.
+ *
+ * @param int count
+ *   The number of threads, including the calling thread; 0 restores the default.
+ */
+void matrixmath_set_num_threads(int count);
+
+/**
+ * Get the number of threads used by the library.
+ *
+ * @return int
+ *   The number of threads, including the calling thread.
+ */
+int matrixmath_get_num_threads();
+
+/**
+ * Get the number of chunks a parallel loop is split into.
+ *
+ * @param int64_t count
+ *   The number of iterations of the loop.
+ * @param int64_t grain
+ *   The minimum number of iterations per chunk.
+ *
+ * @return int
+ *   The number of chunks.
+ */
+int matrixmath_parallel_chunks(int64_t count, int64_t grain);
+
+/**
+ * Run a loop in parallel on the library thread pool.
+ *
+ * The iterations are split in contiguous chunks of at least grain iterations,
+ * at most one per thread. The partition only depends on the count and the
+ * number of chunks, and the calling thread always runs the first chunk.
+ *
+ * @param int64_t count
+ *   The number of iterations of the loop.
+ * @param int64_t grain
+ *   The minimum number of iterations per chunk.
+ * @param void (*callback)(void *context, int64_t start, int64_t end)
+ *   The loop body, called for each chunk with the range [start, end).
+ * @param void* context
+ *   The data given to the loop body.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrixmath_parallel_for(int64_t count, int64_t grain, void (*callback)(void *context, int64_t start, int64_t end), void *context);
+
+/**
+ * Run a function on a worker of the library thread pool, without waiting.
+ *
+ * The function may itself run parallel loops. With a single thread there is no
+ * worker, and the function runs in the calling thread before this returns.
+ *
+ * @param void (*run)(void *argument)
+ *   The function.
+ * @param void* argument
+ *   The argument given to the function.
+ *
+ * @return int
+ *   Returns 0 when the function was queued or run, otherwise 1.
+ */
+int matrixmath_parallel_spawn(void (*run)(void *argument), void *argument);
+
+/**
+ * The ways the partial results of a parallel reduction are combined.
+ *
+ * - PARALLEL_REDUCTION_FAST: one segment per thread, so the last bits of the
+ *   sums depend on the number of threads.
+ * - PARALLEL_REDUCTION_REPRODUCIBLE: a fixed number of segments, whatever the
+ *   number of threads, summed along a fixed binary tree. The results are bit
+ *   identical for every thread count and on every machine with the same long
+ *   double format. The cost is a parallelism limited to 64 threads and the
+ *   loss of the load balance when the thread count does not divide 64, the
+ *   extra combining work being negligible.
+ * - PARALLEL_REDUCTION_DEFAULT: the mode set by matrixmath_set_reduction_mode().
+ *
+ * Only the sums are affected: the minimum, the maximum and their indexes, the
+ * row and column reductions and the matrix products never split the
+ * accumulation of one result across threads, so they are always reproducible.
+ */
+enum parallel_reduction_mode {
+  PARALLEL_REDUCTION_DEFAULT,
+  PARALLEL_REDUCTION_FAST,
+  PARALLEL_REDUCTION_REPRODUCIBLE,
+};
+
+/**
+ * Set the reduction mode used by the library when none is given.
+ *
+ * By default the library is in PARALLEL_REDUCTION_FAST mode, unless the
+ * MATRIXMATH_REPRODUCIBLE environment variable is set to 1.
+ *
+ * @param enum parallel_reduction_mode mode
+ *   The mode; PARALLEL_REDUCTION_DEFAULT restores the default.
+ */
+void matrixmath_set_reduction_mode(enum parallel_reduction_mode mode);
+
+/**
+ * Get the reduction mode used by the library when none is given.
+ *
+ * @return enum parallel_reduction_mode
+ *   PARALLEL_REDUCTION_FAST or PARALLEL_REDUCTION_REPRODUCIBLE.
+ */
+enum parallel_reduction_mode matrixmath_get_reduction_mode();
+
+/**
+ * Compute sums over the iterations of a loop, in parallel.
+ *
+ * The iterations are split into contiguous segments, the callback computes the
+ * width sums of a segment into partial (initialized to 0) and the partials are
+ * summed along a balanced binary tree.
+ *
+ * @param int64_t count
+ *   The number of iterations of the loop.
+ * @param int64_t grain
+ *   The minimum number of iterations per segment.
+ * @param enum parallel_reduction_mode mode
+ *   The reduction mode.
+ * @param int width
+ *   The number of sums computed at once, at most 4.
+ * @param void (*callback)(void *context, int64_t start, int64_t end, long double *partial)
+ *   The loop body, called for the segments [start, end).
+ * @param void* context
+ *   The data given to the loop body.
+ * @param long double* result
+ *   The destination of the width sums.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrixmath_parallel_reduce(int64_t count, int64_t grain, enum parallel_reduction_mode mode, int width, void (*callback)(void *context, int64_t start, int64_t end, long double *partial), void *context, long double *result);
+
+#endif
+
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+/**
+ * The maximum number of intermediate results alive while evaluating an expression.
+ */
+#define EXPRESSION_MAX_DEPTH 8
+
+/**
+ * The operations of an expression node.
+ */
+enum expression_operation {
+  EXPRESSION_OPERAND,
+  EXPRESSION_SCALAR,
+  EXPRESSION_ADD,
+  EXPRESSION_SUB,
+  EXPRESSION_MUL,
+  EXPRESSION_DIV,
+  EXPRESSION_SCALE
+};
+
+/**
+ * The data struct definition for a lazy elementwise expression node.
+ *
+ * Expression nodes are small values meant to live on the stack: building a tree
+ * does not allocate memory nor compute anything, the whole tree is computed by a
+ * single pass over the operands when it is evaluated into a destination.
+ */
+struct expression {
+
+  /**
+   * The operation of the node.
+   *
+   * @var enum expression_operation operation.
+   */
+  enum expression_operation operation;
+
+  /**
+   * The first operand of the operation.
+   *
+   * @var const struct expression *left.
+   */
+  const struct expression *left;
+
+  /**
+   * The second operand of binary operations.
+   *
+   * @var const struct expression *right.
+   */
+  const struct expression *right;
+
+  /**
+   * The values of an operand node.
+   *
+   * @var const long double *data.
+   */
+  const long double *data;
+
+  /**
+   * The value of a scalar node, or the factor of a scale node.
+   *
+   * @var long double scalar.
+   */
+  long double scalar;
+
+  /**
+   * The number of rows of the result; 0 for scalars and -1 for invalid expressions.
+   *
+   * @var int64_t rows.
+   */
+  int64_t rows;
+
+  /**
+   * The number of columns of the result.
+   *
+   * @var int64_t columns.
+   */
+  int64_t columns;
+};
+
+/**
+ * Create an expression node that reads the values of a matrix.
+ *
+ * @param struct matrix* a
+ *   The matrix object.
+ *
+ * @return struct expression
+ *   The expression node.
+ */
+struct expression expression_matrix(struct matrix *a);
+
+/**
+ * Create an expression node that reads the values of a vector.
+ *
+ * A vector has the shape of a one column matrix.
+ *
+ * @param struct vector* a
+ *   The vector object.
+ *
+ * @return struct expression
+ *   The expression node.
+ */
+struct expression expression_vector(struct vector *a);
+
+/**
+ * Create a scalar expression node, it is broadcast to the shape of the other operand.
+ *
+ * @param long double value
+ *   The scalar value.
+ *
+ * @return struct expression
+ *   The expression node.
+ */
+struct expression expression_scalar(long double value);
+
+/**
+ * Create the elementwise addition node a + b.
+ *
+ * @param const struct expression* a
+ *   The first operand.
+ * @param const struct expression* b
+ *   The second operand.
+ *
+ * @return struct expression
+ *   The expression node.
+ */
+struct expression expression_add(const struct expression *a, const struct expression *b);
+
+/**
+ * Create the elementwise subtraction node a - b.
+ *
+ * @param const struct expression* a
+ *   The first operand.
+ * @param const struct expression* b
+ *   The second operand.
+ *
+ * @return struct expression
+ *   The expression node.
+ */
+struct expression expression_sub(const struct expression *a, const struct expression *b);
+
+/**
+ * Create the elementwise (Hadamard) product node a * b.
+ *
+ * @param const struct expression* a
+ *   The first operand.
+ * @param const struct expression* b
+ *   The second operand.
+ *
+ * @return struct expression
+ *   The expression node.
+ */
+struct expression expression_mul(const struct expression *a, const struct expression *b);
+
+/**
+ * Create the elementwise division node a / b.
+ *
+ * @param const struct expression* a
+ *   The first operand.
+ * @param const struct expression* b
+ *   The second operand.
+ *
+ * @return struct expression
+ *   The expression node.
+ */
+struct expression expression_div(const struct expression *a, const struct expression *b);
+
+/**
+ * Create the multiplication by a scalar node scalar * a.
+ *
+ * @param long double scalar
+ *   The scalar factor.
+ * @param const struct expression* a
+ *   The operand.
+ *
+ * @return struct expression
+ *   The expression node.
+ */
+struct expression expression_scale(long double scalar, const struct expression *a);
+
+/**
+ * Create the negation node -a.
+ *
+ * @param const struct expression* a
+ *   The operand.
+ *
+ * @return struct expression
+ *   The expression node.
+ */
+struct expression expression_neg(const struct expression *a);
+
+/**
+ * Evaluate an expression into a matrix in a single fused pass.
+ *
+ * The destination can be one of the operands of the expression.
+ *
+ * @param const struct expression* e
+ *   The expression to evaluate.
+ * @param struct matrix* dest
+ *   The destination matrix, it must have the shape of the expression.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int expression_eval_matrix(const struct expression *e, struct matrix *dest);
+
+/**
+ * Evaluate an expression into a vector in a single fused pass.
+ *
+ * The destination can be one of the operands of the expression.
+ *
+ * @param const struct expression* e
+ *   The expression to evaluate.
+ * @param struct vector* dest
+ *   The destination vector, it must have the shape of the expression.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int expression_eval_vector(const struct expression *e, struct vector *dest);
+
+#endif
+
+#ifndef FIXED_VECTOR_H
+#define FIXED_VECTOR_H
+
+#include <math.h>
+
+/**
+ * The data struct definitions for the fixed size vectors.
+ *
+ * They are plain values: they live on the stack, are copied by assignment and
+ * never need to be created or destroyed.
+ */
+struct vec2 {
+
+  /**
+   * The values of the vector.
+   *
+   * @var long double v.
+   */
+  long double v[2];
+};
+
+struct vec3 {
+
+  /**
+   * The values of the vector.
+   *
+   * @var long double v.
+   */
+  long double v[3];
+};
+
+struct vec4 {
+
+  /**
+   * The values of the vector.
+   *
+   * @var long double v.
+   */
+  long double v[4];
+};
+
+/**
+ * Define the operations of the fixed size vector type vecN, N being 2, 3 or 4.
+ *
+ * They are static inline so the callers can inline them: the loops have a trip
+ * count known at compile time, the compiler unrolls them completely and the
+ * values stay in registers instead of being copied to a call frame.
+ *
+ * - vecN_add(a, b), vecN_sub(a, b): the sum and the difference a +- b.
+ * - vecN_scale(scalar, a): the product scalar * a.
+ * - vecN_dot(a, b): the dot product of a and b.
+ * - vecN_norm(a): the euclidean norm of a.
+ */
+#define FIXED_VECTOR_DEFINITIONS(N) \
+  static inline struct vec##N vec##N##_add(struct vec##N a, struct vec##N b) { \
+    struct vec##N result; \
+    for (int i = 0; i < N; i++) { \
+      result.v[i] = a.v[i] + b.v[i]; \
+    } \
+    return result; \
+  } \
+\
+  static inline struct vec##N vec##N##_sub(struct vec##N a, struct vec##N b) { \
+    struct vec##N result; \
+    for (int i = 0; i < N; i++) { \
+      result.v[i] = a.v[i] - b.v[i]; \
+    } \
+    return result; \
+  } \
+\
+  static inline struct vec##N vec##N##_scale(long double scalar, struct vec##N a) { \
+    struct vec##N result; \
+    for (int i = 0; i < N; i++) { \
+      result.v[i] = scalar * a.v[i]; \
+    } \
+    return result; \
+  } \
+\
+  static inline long double vec##N##_dot(struct vec##N a, struct vec##N b) { \
+    long double result = 0; \
+    for (int i = 0; i < N; i++) { \
+      result += a.v[i] * b.v[i]; \
+    } \
+    return result; \
+  } \
+\
+  static inline long double vec##N##_norm(struct vec##N a) { \
+    return sqrtl(vec##N##_dot(a, a)); \
+  }
+
+FIXED_VECTOR_DEFINITIONS(2)
+FIXED_VECTOR_DEFINITIONS(3)
+FIXED_VECTOR_DEFINITIONS(4)
+
+/**
+ * Declare the conversions of the fixed size vector type vecN, N being 2, 3 or 4.
+ *
+ * - vecN_from_vector(a, dest): copy a vector of size N to dest, returns 0
+ *   when the operation succeeded, otherwise 1.
+ * - vecN_to_vector(a): create a new vector with the values of a, otherwise NULL.
+ */
+#define FIXED_VECTOR_DECLARATIONS(N) \
+  int vec##N##_from_vector(struct vector *a, struct vec##N *dest); \
+  struct vector *vec##N##_to_vector(struct vec##N a);
+
+FIXED_VECTOR_DECLARATIONS(2)
+FIXED_VECTOR_DECLARATIONS(3)
+FIXED_VECTOR_DECLARATIONS(4)
+
+/**
+ * Compute the cross product of two 3 dimensional vectors.
+ *
+ * @param struct vec3 a
+ *   The first vector.
+ * @param struct vec3 b
+ *   The second vector.
+ *
+ * @return struct vec3
+ *   The cross product a x b.
+ */
+static inline struct vec3 vec3_cross(struct vec3 a, struct vec3 b) {
+  struct vec3 result = {{
+      a.v[1] * b.v[2] - a.v[2] * b.v[1],
+      a.v[2] * b.v[0] - a.v[0] * b.v[2],
+      a.v[0] * b.v[1] - a.v[1] * b.v[0],
+  }};
+  return result;
+}
+
+#endif
+
+#ifndef FIXED_MATRIX_H
+#define FIXED_MATRIX_H
+
+/**
+ * The data struct definitions for the fixed size square matrices.
+ *
+ * They are plain values stored row-major: m[i][j] is the element at row i and
+ * column j.
+ */
+struct mat2 {
+
+  /**
+   * The values of the matrix.
+   *
+   * @var long double m.
+   */
+  long double m[2][2];
+};
+
+struct mat3 {
+
+  /**
+   * The values of the matrix.
+   *
+   * @var long double m.
+   */
+  long double m[3][3];
+};
+
+struct mat4 {
+
+  /**
+   * The values of the matrix.
+   *
+   * @var long double m.
+   */
+  long double m[4][4];
+};
+
+/**
+ * Define the operations of the fixed size matrix type matN, N being 2, 3 or 4.
+ *
+ * They are static inline for the same reason as the vector ones, see
+ * FIXED_VECTOR_DEFINITIONS.
+ *
+ * - matN_identity(): the identity matrix.
+ * - matN_mul(a, b): the matrix product a * b.
+ * - matN_mul_vec(a, b): the matrix vector product a * b.
+ * - matN_transpose(a): the transpose of a.
+ */
+#define FIXED_MATRIX_DEFINITIONS(N) \
+  static inline struct mat##N mat##N##_identity() { \
+    struct mat##N result; \
+    for (int i = 0; i < N; i++) { \
+      for (int j = 0; j < N; j++) { \
+        result.m[i][j] = i == j ? 1 : 0; \
+      } \
+    } \
+    return result; \
+  } \
+\
+  static inline struct mat##N mat##N##_mul(struct mat##N a, struct mat##N b) { \
+    struct mat##N result; \
+    long double sum; \
+    for (int i = 0; i < N; i++) { \
+      for (int j = 0; j < N; j++) { \
+        sum = 0; \
+        for (int l = 0; l < N; l++) { \
+          sum += a.m[i][l] * b.m[l][j]; \
+        } \
+        result.m[i][j] = sum; \
+      } \
+    } \
+    return result; \
+  } \
+\
+  static inline struct vec##N mat##N##_mul_vec(struct mat##N a, struct vec##N b) { \
+    struct vec##N result; \
+    long double sum; \
+    for (int i = 0; i < N; i++) { \
+      sum = 0; \
+      for (int j = 0; j < N; j++) { \
+        sum += a.m[i][j] * b.v[j]; \
+      } \
+      result.v[i] = sum; \
+    } \
+    return result; \
+  } \
+\
+  static inline struct mat##N mat##N##_transpose(struct mat##N a) { \
+    struct mat##N result; \
+    for (int i = 0; i < N; i++) { \
+      for (int j = 0; j < N; j++) { \
+        result.m[i][j] = a.m[j][i]; \
+      } \
+    } \
+    return result; \
+  }
+
+FIXED_MATRIX_DEFINITIONS(2)
+FIXED_MATRIX_DEFINITIONS(3)
+FIXED_MATRIX_DEFINITIONS(4)
+
+/**
+ * Declare the conversions of the fixed size matrix type matN, N being 2, 3 or 4.
+ *
+ * - matN_from_matrix(a, dest): copy a NxN matrix to dest, returns 0 when the
+ *   operation succeeded, otherwise 1.
+ * - matN_to_matrix(a): create a new matrix with the values of a, otherwise NULL.
+ */
+#define FIXED_MATRIX_DECLARATIONS(N) \
+  int mat##N##_from_matrix(struct matrix *a, struct mat##N *dest); \
+  struct matrix *mat##N##_to_matrix(struct mat##N a);
+
+FIXED_MATRIX_DECLARATIONS(2)
+FIXED_MATRIX_DECLARATIONS(3)
+FIXED_MATRIX_DECLARATIONS(4)
+
+/**
+ * Compute the determinant of a 2x2 matrix.
+ *
+ * @param struct mat2 a
+ *   The matrix.
+ *
+ * @return long double
+ *   The determinant.
+ */
+static inline long double mat2_determinant(struct mat2 a) {
+  return a.m[0][0] * a.m[1][1] - a.m[0][1] * a.m[1][0];
+}
+
+/**
+ * Compute the inverse of a 2x2 matrix.
+ *
+ * @param struct mat2 a
+ *   The matrix.
+ * @param struct mat2* dest
+ *   The destination where the inverse will be stored.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1 (singular matrix).
+ */
+static inline int mat2_inverse(struct mat2 a, struct mat2 *dest) {
+  long double determinant = mat2_determinant(a);
+  if (dest == NULL || determinant == 0) {
+    return 1;
+  }
+  long double inverse = 1 / determinant;
+  dest->m[0][0] = a.m[1][1] * inverse;
+  dest->m[0][1] = -a.m[0][1] * inverse;
+  dest->m[1][0] = -a.m[1][0] * inverse;
+  dest->m[1][1] = a.m[0][0] * inverse;
+  return 0;
+}
+
+/**
+ * Compute the determinant of a 3x3 matrix.
+ *
+ * @param struct mat3 a
+ *   The matrix.
+ *
+ * @return long double
+ *   The determinant.
+ */
+static inline long double mat3_determinant(struct mat3 a) {
+  return a.m[0][0] * (a.m[1][1] * a.m[2][2] - a.m[1][2] * a.m[2][1]) -
+         a.m[0][1] * (a.m[1][0] * a.m[2][2] - a.m[1][2] * a.m[2][0]) +
+         a.m[0][2] * (a.m[1][0] * a.m[2][1] - a.m[1][1] * a.m[2][0]);
+}
+
+/**
+ * Compute the inverse of a 3x3 matrix with the adjugate formula.
+ *
+ * @param struct mat3 a
+ *   The matrix.
+ * @param struct mat3* dest
+ *   The destination where the inverse will be stored.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1 (singular matrix).
+ */
+static inline int mat3_inverse(struct mat3 a, struct mat3 *dest) {
+  // Cofactors of the first row, reused by the determinant.
+  long double c00 = a.m[1][1] * a.m[2][2] - a.m[1][2] * a.m[2][1];
+  long double c01 = a.m[1][2] * a.m[2][0] - a.m[1][0] * a.m[2][2];
+  long double c02 = a.m[1][0] * a.m[2][1] - a.m[1][1] * a.m[2][0];
+  long double determinant = a.m[0][0] * c00 + a.m[0][1] * c01 + a.m[0][2] * c02;
+  if (dest == NULL || determinant == 0) {
+    return 1;
+  }
+  long double inverse = 1 / determinant;
+  // The inverse is the transposed cofactor matrix divided by the determinant.
+  dest->m[0][0] = c00 * inverse;
+  dest->m[1][0] = c01 * inverse;
+  dest->m[2][0] = c02 * inverse;
+  dest->m[0][1] = (a.m[0][2] * a.m[2][1] - a.m[0][1] * a.m[2][2]) * inverse;
+  dest->m[1][1] = (a.m[0][0] * a.m[2][2] - a.m[0][2] * a.m[2][0]) * inverse;
+  dest->m[2][1] = (a.m[0][1] * a.m[2][0] - a.m[0][0] * a.m[2][1]) * inverse;
+  dest->m[0][2] = (a.m[0][1] * a.m[1][2] - a.m[0][2] * a.m[1][1]) * inverse;
+  dest->m[1][2] = (a.m[0][2] * a.m[1][0] - a.m[0][0] * a.m[1][2]) * inverse;
+  dest->m[2][2] = (a.m[0][0] * a.m[1][1] - a.m[0][1] * a.m[1][0]) * inverse;
+  return 0;
+}
+
+/**
+ * Compute the 2x2 minors of a 4x4 matrix used by its determinant and inverse.
+ *
+ * s holds the minors of the two top rows and c the ones of the two bottom rows.
+ *
+ * @param struct mat4 a
+ *   The matrix.
+ * @param long double* s
+ *   The destination for the six top minors.
+ * @param long double* c
+ *   The destination for the six bottom minors.
+ */
+static inline void mat4_minors(struct mat4 a, long double *s, long double *c) {
+  s[0] = a.m[0][0] * a.m[1][1] - a.m[1][0] * a.m[0][1];
+  s[1] = a.m[0][0] * a.m[1][2] - a.m[1][0] * a.m[0][2];
+  s[2] = a.m[0][0] * a.m[1][3] - a.m[1][0] * a.m[0][3];
+  s[3] = a.m[0][1] * a.m[1][2] - a.m[1][1] * a.m[0][2];
+  s[4] = a.m[0][1] * a.m[1][3] - a.m[1][1] * a.m[0][3];
+  s[5] = a.m[0][2] * a.m[1][3] - a.m[1][2] * a.m[0][3];
+  c[5] = a.m[2][2] * a.m[3][3] - a.m[3][2] * a.m[2][3];
+  c[4] = a.m[2][1] * a.m[3][3] - a.m[3][1] * a.m[2][3];
+  c[3] = a.m[2][1] * a.m[3][2] - a.m[3][1] * a.m[2][2];
+  c[2] = a.m[2][0] * a.m[3][3] - a.m[3][0] * a.m[2][3];
+  c[1] = a.m[2][0] * a.m[3][2] - a.m[3][0] * a.m[2][2];
+  c[0] = a.m[2][0] * a.m[3][1] - a.m[3][0] * a.m[2][1];
+}
+
+/**
+ * Compute the determinant of a 4x4 matrix.
+ *
+ * @param struct mat4 a
+ *   The matrix.
+ *
+ * @return long double
+ *   The determinant.
+ */
+static inline long double mat4_determinant(struct mat4 a) {
+  long double s[6];
+  long double c[6];
+  mat4_minors(a, s, c);
+  return s[0] * c[5] - s[1] * c[4] + s[2] * c[3] + s[3] * c[2] - s[4] * c[1] + s[5] * c[0];
+}
+
+/**
+ * Compute the inverse of a 4x4 matrix with the adjugate formula.
+ *
+ * @param struct mat4 a
+ *   The matrix.
+ * @param struct mat4* dest
+ *   The destination where the inverse will be stored.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1 (singular matrix).
+ */
+static inline int mat4_inverse(struct mat4 a, struct mat4 *dest) {
+  long double s[6];
+  long double c[6];
+  mat4_minors(a, s, c);
+  long double determinant = s[0] * c[5] - s[1] * c[4] + s[2] * c[3] + s[3] * c[2] - s[4] * c[1] + s[5] * c[0];
+  if (dest == NULL || determinant == 0) {
+    return 1;
+  }
+  long double inverse = 1 / determinant;
+  dest->m[0][0] = (a.m[1][1] * c[5] - a.m[1][2] * c[4] + a.m[1][3] * c[3]) * inverse;
+  dest->m[0][1] = (-a.m[0][1] * c[5] + a.m[0][2] * c[4] - a.m[0][3] * c[3]) * inverse;
+  dest->m[0][2] = (a.m[3][1] * s[5] - a.m[3][2] * s[4] + a.m[3][3] * s[3]) * inverse;
+  dest->m[0][3] = (-a.m[2][1] * s[5] + a.m[2][2] * s[4] - a.m[2][3] * s[3]) * inverse;
+  dest->m[1][0] = (-a.m[1][0] * c[5] + a.m[1][2] * c[2] - a.m[1][3] * c[1]) * inverse;
+  dest->m[1][1] = (a.m[0][0] * c[5] - a.m[0][2] * c[2] + a.m[0][3] * c[1]) * inverse;
+  dest->m[1][2] = (-a.m[3][0] * s[5] + a.m[3][2] * s[2] - a.m[3][3] * s[1]) * inverse;
+  dest->m[1][3] = (a.m[2][0] * s[5] - a.m[2][2] * s[2] + a.m[2][3] * s[1]) * inverse;
+  dest->m[2][0] = (a.m[1][0] * c[4] - a.m[1][1] * c[2] + a.m[1][3] * c[0]) * inverse;
+  dest->m[2][1] = (-a.m[0][0] * c[4] + a.m[0][1] * c[2] - a.m[0][3] * c[0]) * inverse;
+  dest->m[2][2] = (a.m[3][0] * s[4] - a.m[3][1] * s[2] + a.m[3][3] * s[0]) * inverse;
+  dest->m[2][3] = (-a.m[2][0] * s[4] + a.m[2][1] * s[2] - a.m[2][3] * s[0]) * inverse;
+  dest->m[3][0] = (-a.m[1][0] * c[3] + a.m[1][1] * c[1] - a.m[1][2] * c[0]) * inverse;
+  dest->m[3][1] = (a.m[0][0] * c[3] - a.m[0][1] * c[1] + a.m[0][2] * c[0]) * inverse;
+  dest->m[3][2] = (-a.m[3][0] * s[3] + a.m[3][1] * s[1] - a.m[3][2] * s[0]) * inverse;
+  dest->m[3][3] = (a.m[2][0] * s[3] - a.m[2][1] * s[1] + a.m[2][2] * s[0]) * inverse;
+  return 0;
+}
+
+#endif
+
+#ifndef RANDOM_H
+#define RANDOM_H
+
+/**
+ * The data struct definition for a counter-based random number generator.
+ *
+ * The value at each position of a stream is a hash of the key, the stream and
+ * the position, so any range of values can be generated independently: the
+ * parallel fills give the same values whatever the number of threads used.
+ * A generator is a plain value, it is not thread-safe itself, but each thread
+ * can use its own stream of the same seed.
+ */
+struct random_generator {
+
+  /**
+   * The key derived from the seed.
+   *
+   * @var uint64_t key.
+   */
+  uint64_t key;
+
+  /**
+   * The key derived from the stream number.
+   *
+   * @var uint64_t stream.
+   */
+  uint64_t stream;
+
+  /**
+   * The position of the next value in the stream.
+   *
+   * @var uint64_t counter.
+   */
+  uint64_t counter;
+};
+
+/**
+ * Create a generator from a seed, positioned at the start of its stream 0.
+ *
+ * @param uint64_t seed
+ *   The seed.
+ *
+ * @return struct random_generator
+ *   The generator.
+ */
+struct random_generator random_generator_seed(uint64_t seed);
+
+/**
+ * Create a generator for an independent stream of the same seed.
+ *
+ * @param const struct random_generator* generator
+ *   The generator created from the seed.
+ * @param uint64_t stream
+ *   The stream number.
+ *
+ * @return struct random_generator
+ *   The generator, positioned at the start of the stream.
+ */
+struct random_generator random_generator_stream(const struct random_generator *generator, uint64_t stream);
+
+/**
+ * Reseed the library default generator, used when the generator is NULL.
+ *
+ * The default generator is shared by all the threads: each call reserves its
+ * values under a mutex.
+ *
+ * @param uint64_t seed
+ *   The seed.
+ */
+void matrixmath_random_seed(uint64_t seed);
+
+/**
+ * Draw the next 64 random bits of a generator.
+ *
+ * @param struct random_generator* generator
+ *   The generator, NULL for the library default generator.
+ *
+ * @return uint64_t
+ *   The random value.
+ */
+uint64_t random_next(struct random_generator *generator);
+
+/**
+ * Draw a value uniformly distributed in [min, max).
+ *
+ * @param struct random_generator* generator
+ *   The generator, NULL for the library default generator.
+ * @param long double min
+ *   The minimum value.
+ * @param long double max
+ *   The maximum value.
+ *
+ * @return long double
+ *   The random value.
+ */
+long double random_uniform(struct random_generator *generator, long double min, long double max);
+
+/**
+ * Draw a normally distributed value.
+ *
+ * @param struct random_generator* generator
+ *   The generator, NULL for the library default generator.
+ * @param long double mean
+ *   The mean of the distribution.
+ * @param long double deviation
+ *   The standard deviation of the distribution.
+ *
+ * @return long double
+ *   The random value.
+ */
+long double random_gaussian(struct random_generator *generator, long double mean, long double deviation);
+
+/**
+ * Fill a buffer with values uniformly distributed in [min, max), in parallel.
+ *
+ * @param struct random_generator* generator
+ *   The generator, NULL for the library default generator.
+ * @param long double* data
+ *   The buffer.
+ * @param size_t size
+ *   The number of values.
+ * @param long double min
+ *   The minimum value.
+ * @param long double max
+ *   The maximum value.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int random_fill_uniform(struct random_generator *generator, long double *data, size_t size, long double min, long double max);
+
+/**
+ * Fill a buffer with normally distributed values, in parallel.
+ *
+ * @param struct random_generator* generator
+ *   The generator, NULL for the library default generator.
+ * @param long double* data
+ *   The buffer.
+ * @param size_t size
+ *   The number of values.
+ * @param long double mean
+ *   The mean of the distribution.
+ * @param long double deviation
+ *   The standard deviation of the distribution.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int random_fill_gaussian(struct random_generator *generator, long double *data, size_t size, long double mean, long double deviation);
+
+/**
+ * Fill a vector with values uniformly distributed in [min, max).
+ *
+ * @param struct vector* object
+ *   The vector.
+ * @param struct random_generator* generator
+ *   The generator, NULL for the library default generator.
+ * @param long double min
+ *   The minimum value.
+ * @param long double max
+ *   The maximum value.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int vector_fill_uniform(struct vector *object, struct random_generator *generator, long double min, long double max);
+
+/**
+ * Fill a vector with normally distributed values.
+ *
+ * @param struct vector* object
+ *   The vector.
+ * @param struct random_generator* generator
+ *   The generator, NULL for the library default generator.
+ * @param long double mean
+ *   The mean of the distribution.
+ * @param long double deviation
+ *   The standard deviation of the distribution.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int vector_fill_gaussian(struct vector *object, struct random_generator *generator, long double mean, long double deviation);
+
+/**
+ * Fill a matrix with values uniformly distributed in [min, max).
+ *
+ * @param struct matrix* object
+ *   The matrix.
+ * @param struct random_generator* generator
+ *   The generator, NULL for the library default generator.
+ * @param long double min
+ *   The minimum value.
+ * @param long double max
+ *   The maximum value.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_fill_uniform(struct matrix *object, struct random_generator *generator, long double min, long double max);
+
+/**
+ * Fill a matrix with normally distributed values.
+ *
+ * @param struct matrix* object
+ *   The matrix.
+ * @param struct random_generator* generator
+ *   The generator, NULL for the library default generator.
+ * @param long double mean
+ *   The mean of the distribution.
+ * @param long double deviation
+ *   The standard deviation of the distribution.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_fill_gaussian(struct matrix *object, struct random_generator *generator, long double mean, long double deviation);
+
+#endif
+
+#ifndef REDUCTION_H
+#define REDUCTION_H
+
+/**
+ * The reductions of a set of elements to a single value.
+ *
+ * The sums are pairwise, the matrix column sums compensated, so their error
+ * grows with the logarithm of the number of elements instead of linearly.
+ * The matrix norms are entrywise: the L2 norm is the Frobenius norm.
+ * The functions without a mode use the library reduction mode, see
+ * matrixmath_set_reduction_mode().
+ */
+enum reduction_operation {
+  REDUCTION_SUM,
+  REDUCTION_MEAN,
+  REDUCTION_MIN,
+  REDUCTION_MAX,
+  REDUCTION_ARGMIN,
+  REDUCTION_ARGMAX,
+  REDUCTION_NORM_L1,
+  REDUCTION_NORM_L2,
+  REDUCTION_NORM_INF,
+};
+
+/**
+ * Reduce all the elements of a vector, in parallel.
+ *
+ * @param struct vector* a
+ *   The vector.
+ * @param enum reduction_operation operation
+ *   The reduction.
+ *
+ * @return long double
+ *   The value of the reduction; the index of the first extreme element for
+ *   REDUCTION_ARGMIN and REDUCTION_ARGMAX (-1 for an empty vector); NAN when
+ *   the vector is NULL, or empty for the mean, the minimum and the maximum.
+ */
+long double vector_reduce(struct vector *a, enum reduction_operation operation);
+
+/**
+ * Reduce all the elements of a matrix, in parallel.
+ *
+ * The indexes returned by REDUCTION_ARGMIN and REDUCTION_ARGMAX are the
+ * row-major positions of the elements: row * columns + column.
+ *
+ * @param struct matrix* a
+ *   The matrix.
+ * @param enum reduction_operation operation
+ *   The reduction.
+ *
+ * @return long double
+ *   The value of the reduction, see vector_reduce().
+ */
+long double matrix_reduce(struct matrix *a, enum reduction_operation operation);
+
+/**
+ * Reduce all the elements of a vector with the given reduction mode.
+ *
+ * @param struct vector* a
+ *   The vector.
+ * @param enum reduction_operation operation
+ *   The reduction.
+ * @param enum parallel_reduction_mode mode
+ *   The way the partial sums of the threads are combined.
+ *
+ * @return long double
+ *   The value of the reduction, see vector_reduce().
+ */
+long double vector_reduce_mode(struct vector *a, enum reduction_operation operation, enum parallel_reduction_mode mode);
+
+/**
+ * Reduce all the elements of a matrix with the given reduction mode.
+ *
+ * @param struct matrix* a
+ *   The matrix.
+ * @param enum reduction_operation operation
+ *   The reduction.
+ * @param enum parallel_reduction_mode mode
+ *   The way the partial sums of the threads are combined.
+ *
+ * @return long double
+ *   The value of the reduction, see vector_reduce().
+ */
+long double matrix_reduce_mode(struct matrix *a, enum reduction_operation operation, enum parallel_reduction_mode mode);
+
+/**
+ * Compute the dot product and the norms of two vectors with the given reduction mode.
+ *
+ * @param struct vector* a
+ *   The first vector.
+ * @param struct vector* b
+ *   The second vector.
+ * @param enum parallel_reduction_mode mode
+ *   The way the partial sums of the threads are combined.
+ * @param long double* dot
+ *   The destination for the dot product, it can be NULL.
+ * @param long double* norm_a
+ *   The destination for the norm of a, it can be NULL.
+ * @param long double* norm_b
+ *   The destination for the norm of b, it can be NULL.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int vector_dot_norms_mode(struct vector *a, struct vector *b, enum parallel_reduction_mode mode, long double *dot, long double *norm_a, long double *norm_b);
+
+/**
+ * Reduce each row of a matrix, in parallel.
+ *
+ * @param struct matrix* a
+ *   The matrix.
+ * @param enum reduction_operation operation
+ *   The reduction, the indexes are column numbers.
+ * @param struct vector* dest
+ *   The destination vector, with one element per row.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_reduce_rows(struct matrix *a, enum reduction_operation operation, struct vector *dest);
+
+/**
+ * Reduce each column of a matrix, in parallel.
+ *
+ * @param struct matrix* a
+ *   The matrix.
+ * @param enum reduction_operation operation
+ *   The reduction, the indexes are row numbers.
+ * @param struct vector* dest
+ *   The destination vector, with one element per column.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_reduce_columns(struct matrix *a, enum reduction_operation operation, struct vector *dest);
+
+/**
+ * Compute the sum of the elements of a vector.
+ *
+ * @param struct vector* a
+ *   The vector.
+ *
+ * @return long double
+ *   The sum.
+ */
+long double vector_sum(struct vector *a);
+
+/**
+ * Compute the mean of the elements of a vector.
+ *
+ * @param struct vector* a
+ *   The vector.
+ *
+ * @return long double
+ *   The mean, NAN for an empty vector.
+ */
+long double vector_mean(struct vector *a);
+
+/**
+ * Get the smallest element of a vector.
+ *
+ * @param struct vector* a
+ *   The vector.
+ *
+ * @return long double
+ *   The smallest element, NAN for an empty vector.
+ */
+long double vector_min(struct vector *a);
+
+/**
+ * Get the largest element of a vector.
+ *
+ * @param struct vector* a
+ *   The vector.
+ *
+ * @return long double
+ *   The largest element, NAN for an empty vector.
+ */
+long double vector_max(struct vector *a);
+
+/**
+ * Get the index of the first smallest element of a vector.
+ *
+ * @param struct vector* a
+ *   The vector.
+ *
+ * @return int64_t
+ *   The index, -1 for an empty vector.
+ */
+int64_t vector_argmin(struct vector *a);
+
+/**
+ * Get the index of the first largest element of a vector.
+ *
+ * @param struct vector* a
+ *   The vector.
+ *
+ * @return int64_t
+ *   The index, -1 for an empty vector.
+ */
+int64_t vector_argmax(struct vector *a);
+
+/**
+ * Compute the L1 norm of a vector: the sum of the absolute values.
+ *
+ * @param struct vector* a
+ *   The vector.
+ *
+ * @return long double
+ *   The norm.
+ */
+long double vector_norm_l1(struct vector *a);
+
+/**
+ * Compute the L2 (euclidean) norm of a vector.
+ *
+ * @param struct vector* a
+ *   The vector.
+ *
+ * @return long double
+ *   The norm.
+ */
+long double vector_norm_l2(struct vector *a);
+
+/**
+ * Compute the infinity norm of a vector: the largest absolute value.
+ *
+ * @param struct vector* a
+ *   The vector.
+ *
+ * @return long double
+ *   The norm.
+ */
+long double vector_norm_inf(struct vector *a);
+
+#endif
+
+#ifndef ELEMENTWISE_H
+#define ELEMENTWISE_H
+
+/**
+ * The built-in elementwise functions.
+ *
+ * - ELEMENTWISE_EXP, ELEMENTWISE_LOG, ELEMENTWISE_TANH, ELEMENTWISE_SQRT: the
+ *   functions of the C library.
+ * - ELEMENTWISE_SIGMOID: 1 / (1 + exp(-x)).
+ * - ELEMENTWISE_RELU: max(x, 0).
+ * - ELEMENTWISE_POW: x raised to the power p.
+ * - ELEMENTWISE_CLAMP: x limited to the range [p, q].
+ */
+enum elementwise_operation {
+  ELEMENTWISE_EXP,
+  ELEMENTWISE_LOG,
+  ELEMENTWISE_TANH,
+  ELEMENTWISE_SIGMOID,
+  ELEMENTWISE_RELU,
+  ELEMENTWISE_SQRT,
+  ELEMENTWISE_POW,
+  ELEMENTWISE_CLAMP,
+};
+
+/**
+ * Apply a built-in function to every element of a vector, in parallel.
+ *
+ * @param struct vector* a
+ *   The source vector.
+ * @param enum elementwise_operation operation
+ *   The function.
+ * @param long double p
+ *   The exponent of ELEMENTWISE_POW, the minimum of ELEMENTWISE_CLAMP.
+ * @param long double q
+ *   The maximum of ELEMENTWISE_CLAMP.
+ * @param struct vector* dest
+ *   The destination vector, it can be a.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int vector_map(struct vector *a, enum elementwise_operation operation, long double p, long double q, struct vector *dest);
+
+/**
+ * Apply a built-in function to every element of a matrix, in parallel.
+ *
+ * @param struct matrix* a
+ *   The source matrix.
+ * @param enum elementwise_operation operation
+ *   The function.
+ * @param long double p
+ *   The exponent of ELEMENTWISE_POW, the minimum of ELEMENTWISE_CLAMP.
+ * @param long double q
+ *   The maximum of ELEMENTWISE_CLAMP.
+ * @param struct matrix* dest
+ *   The destination matrix, it can be a.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_map(struct matrix *a, enum elementwise_operation operation, long double p, long double q, struct matrix *dest);
+
+/**
+ * Apply a user supplied function to contiguous chunks of a vector.
+ *
+ * The chunks are disjoint and may be given to the callback concurrently from
+ * several threads.
+ *
+ * @param struct vector* a
+ *   The vector to run through the callback function.
+ * @param void (*callback)(void *context, long double *values, int count)
+ *   A callable to run for each chunk of count values, it updates them in place.
+ * @param void* context
+ *   The data given to the callback.
+ *
+ * @return int
+ *   Returns 1 if the walk operation succeeded, otherwise 0.
+ */
+int vector_walk_batch(struct vector *a, void (*callback)(void *context, long double *values, int count), void *context);
+
+/**
+ * Apply a user supplied function to contiguous chunks of a matrix.
+ *
+ * The chunks follow the row-major order of the values, they are disjoint and
+ * may be given to the callback concurrently from several threads.
+ *
+ * @param struct matrix* a
+ *   The matrix to run through the callback function.
+ * @param void (*callback)(void *context, long double *values, int count)
+ *   A callable to run for each chunk of count values, it updates them in place.
+ * @param void* context
+ *   The data given to the callback.
+ *
+ * @return int
+ *   Returns 1 if the walk operation succeeded, otherwise 0.
+ */
+int matrix_walk_batch(struct matrix *a, void (*callback)(void *context, long double *values, int count), void *context);
+
+#endif
+
+#ifndef MATRIX_BROADCAST_OPERATIONS_H
+#define MATRIX_BROADCAST_OPERATIONS_H
+
+/**
+ * The operations between the elements of a matrix and of a broadcast vector.
+ */
+enum broadcast_operation {
+  BROADCAST_ADD,
+  BROADCAST_SUB,
+  BROADCAST_MUL,
+  BROADCAST_DIV,
+};
+
+/**
+ * Combine every row of a matrix with a vector: dest[i][j] = a[i][j] op v[j].
+ *
+ * Adds a bias to every row, or scales every column, in a single pass.
+ *
+ * @param struct matrix* a
+ *   The matrix.
+ * @param struct vector* v
+ *   The vector, with one element per column.
+ * @param enum broadcast_operation operation
+ *   The operation.
+ * @param struct matrix* dest
+ *   The destination matrix, it can be a.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_broadcast_row_dest(struct matrix *a, struct vector *v, enum broadcast_operation operation, struct matrix *dest);
+
+/**
+ * Combine every column of a matrix with a vector: dest[i][j] = a[i][j] op v[i].
+ *
+ * Scales every row, or subtracts a value per row, in a single pass.
+ *
+ * @param struct matrix* a
+ *   The matrix.
+ * @param struct vector* v
+ *   The vector, with one element per row.
+ * @param enum broadcast_operation operation
+ *   The operation.
+ * @param struct matrix* dest
+ *   The destination matrix, it can be a.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_broadcast_column_dest(struct matrix *a, struct vector *v, enum broadcast_operation operation, struct matrix *dest);
+
+/**
+ * Combine every row of a matrix with a vector into a new matrix.
+ *
+ * @param struct matrix* a
+ *   The matrix.
+ * @param struct vector* v
+ *   The vector, with one element per column.
+ * @param enum broadcast_operation operation
+ *   The operation.
+ *
+ * @return struct matrix*
+ *   The pointer to the result matrix, otherwise NULL.
+ */
+struct matrix *matrix_broadcast_row(struct matrix *a, struct vector *v, enum broadcast_operation operation);
+
+/**
+ * Combine every column of a matrix with a vector into a new matrix.
+ *
+ * @param struct matrix* a
+ *   The matrix.
+ * @param struct vector* v
+ *   The vector, with one element per row.
+ * @param enum broadcast_operation operation
+ *   The operation.
+ *
+ * @return struct matrix*
+ *   The pointer to the result matrix, otherwise NULL.
+ */
+struct matrix *matrix_broadcast_column(struct matrix *a, struct vector *v, enum broadcast_operation operation);
+
+/**
+ * Combine every row of a matrix with a vector, in place.
+ *
+ * @param struct matrix* a
+ *   The matrix, updated with the result.
+ * @param struct vector* v
+ *   The vector, with one element per column.
+ * @param enum broadcast_operation operation
+ *   The operation.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_broadcast_row_inplace(struct matrix *a, struct vector *v, enum broadcast_operation operation);
+
+/**
+ * Combine every column of a matrix with a vector, in place.
+ *
+ * @param struct matrix* a
+ *   The matrix, updated with the result.
+ * @param struct vector* v
+ *   The vector, with one element per row.
+ * @param enum broadcast_operation operation
+ *   The operation.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_broadcast_column_inplace(struct matrix *a, struct vector *v, enum broadcast_operation operation);
+
+/**
+ * Apply an affine map to every column: dest[i][j] = a[i][j] * scale[j] + shift[j].
+ *
+ * Standardizes the columns in a single pass, with scale = 1 / deviation and
+ * shift = -mean / deviation.
+ *
+ * @param struct matrix* a
+ *   The matrix.
+ * @param struct vector* scale
+ *   The factors, one per column.
+ * @param struct vector* shift
+ *   The offsets, one per column.
+ * @param struct matrix* dest
+ *   The destination matrix, it can be a.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_broadcast_affine_dest(struct matrix *a, struct vector *scale, struct vector *shift, struct matrix *dest);
+
+#endif
+
+#ifndef MATRIX_RANK_UPDATE_OPERATIONS_H
+#define MATRIX_RANK_UPDATE_OPERATIONS_H
+
+/**
+ * The triangles of a square matrix, the diagonal being part of both.
+ */
+enum matrix_triangle {
+  MATRIX_LOWER,
+  MATRIX_UPPER,
+};
+
+/**
+ * Compute the outer product x * y^T of two vectors.
+ *
+ * @param struct vector* x
+ *   The first vector.
+ * @param struct vector* y
+ *   The second vector.
+ *
+ * @return struct matrix*
+ *   The pointer to the x->capacity x y->capacity result matrix, otherwise NULL.
+ */
+struct matrix *vector_outer_product(struct vector *x, struct vector *y);
+
+/**
+ * Compute the outer product x * y^T of two vectors into a destination matrix.
+ *
+ * @param struct vector* x
+ *   The first vector, with one element per row of dest.
+ * @param struct vector* y
+ *   The second vector, with one element per column of dest.
+ * @param struct matrix* dest
+ *   The destination matrix.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int vector_outer_product_dest(struct vector *x, struct vector *y, struct matrix *dest);
+
+/**
+ * Apply the rank-1 update a = a + alpha * x * y^T (GER), in place and in parallel.
+ *
+ * @param long double alpha
+ *   The scale factor.
+ * @param struct vector* x
+ *   The first vector, with one element per row of a.
+ * @param struct vector* y
+ *   The second vector, with one element per column of a.
+ * @param struct matrix* a
+ *   The matrix to update.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_ger(long double alpha, struct vector *x, struct vector *y, struct matrix *a);
+
+/**
+ * Apply the rank-k update c = alpha * a * a^T + beta * c (SYRK), in parallel.
+ *
+ * Only the requested triangle of c is computed and written, the other one is
+ * left untouched. When beta is 0, c is not read.
+ *
+ * @param long double alpha
+ *   The scale factor of the product.
+ * @param struct matrix* a
+ *   The n x k matrix.
+ * @param long double beta
+ *   The scale factor of c.
+ * @param struct matrix* c
+ *   The n x n symmetric matrix to update.
+ * @param enum matrix_triangle triangle
+ *   The triangle of c to compute.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_syrk(long double alpha, struct matrix *a, long double beta, struct matrix *c, enum matrix_triangle triangle);
+
+#endif
+
+#ifndef MATRIX_TRIANGULAR_OPERATIONS_H
+#define MATRIX_TRIANGULAR_OPERATIONS_H
+
+/**
+ * Triangular matrix product b = alpha * a * b (TRMM), in place.
+ *
+ * Only the given triangle of a is read. The product is blocked: the diagonal
+ * blocks are multiplied by a triangular kernel and the rest of the work goes
+ * through matrix_gemm_strided(); every step is split across threads.
+ *
+ * @param enum matrix_triangle triangle
+ *   The triangle of a.
+ * @param int unit
+ *   Whether the diagonal of a is made of ones, it is not read then.
+ * @param long double alpha
+ *   The scale factor.
+ * @param struct matrix* a
+ *   The n x n triangular matrix.
+ * @param struct matrix* b
+ *   The n x m right-hand sides, updated with the product.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_trmm(enum matrix_triangle triangle, int unit, long double alpha, struct matrix *a, struct matrix *b);
+
+/**
+ * Solve the triangular system a * x = alpha * b for many right-hand sides (TRSM).
+ *
+ * Only the given triangle of a is read. The solve is blocked: the diagonal
+ * blocks are solved by substitution and the updates of the remaining rows go
+ * through matrix_gemm_strided(); every step is split across threads.
+ *
+ * @param enum matrix_triangle triangle
+ *   The triangle of a.
+ * @param int unit
+ *   Whether the diagonal of a is made of ones, it is not read then.
+ * @param long double alpha
+ *   The scale factor of the right-hand sides.
+ * @param struct matrix* a
+ *   The n x n triangular matrix.
+ * @param struct matrix* b
+ *   The n x m right-hand sides, overwritten with the solutions.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_trsm(enum matrix_triangle triangle, int unit, long double alpha, struct matrix *a, struct matrix *b);
+
+#endif
+
+#ifndef PACKED_MATRIX_H
+#define PACKED_MATRIX_H
+
+/**
+ * The data struct definition for a packed triangular or symmetric matrix.
+ *
+ * Only one triangle is stored, row by row: n * (n + 1) / 2 values instead of
+ * n * n. Row i of a lower triangle holds the columns 0 to i, row i of an upper
+ * triangle the columns i to n - 1.
+ */
+struct packed_matrix {
+
+  /**
+   * Pointer to the contiguous buffer with the values of the triangle.
+   *
+   * @var long double *data.
+   */
+  long double *data;
+
+  /**
+   * The number of rows and columns.
+   *
+   * @var int64_t size.
+   */
+  int64_t size;
+
+  /**
+   * The stored triangle.
+   *
+   * @var enum matrix_triangle triangle.
+   */
+  enum matrix_triangle triangle;
+
+  /**
+   * Whether the other triangle mirrors the stored one, otherwise it is zero.
+   *
+   * @var int symmetric.
+   */
+  int symmetric;
+};
+
+/**
+ * Create a new packed matrix with all its elements set to zero.
+ *
+ * @param const int64_t size
+ *   The number of rows and columns.
+ * @param enum matrix_triangle triangle
+ *   The stored triangle.
+ * @param int symmetric
+ *   Whether the matrix is symmetric, otherwise it is triangular.
+ *
+ * @return struct packed_matrix*
+ *   The pointer to the packed matrix instance, otherwise NULL.
+ */
+struct packed_matrix *packed_matrix_create(const int64_t size, enum matrix_triangle triangle, int symmetric);
+
+/**
+ * Free the memory used by a packed matrix.
+ *
+ * @param struct packed_matrix* object
+ *   The packed matrix.
+ */
+void packed_matrix_destroy(struct packed_matrix *object);
+
+/**
+ * Get the pointer of an element of a packed matrix.
+ *
+ * @param struct packed_matrix* object
+ *   The packed matrix.
+ * @param int64_t row
+ *   The row.
+ * @param int64_t column
+ *   The column.
+ *
+ * @return long double*
+ *   The pointer to the element, the mirrored one for symmetric matrices;
+ *   NULL when it is out of range or outside the triangle.
+ */
+long double *packed_matrix_getl(struct packed_matrix *object, int64_t row, int64_t column);
+
+/**
+ * Pack one triangle of a square matrix.
+ *
+ * @param struct matrix* a
+ *   The square matrix.
+ * @param enum matrix_triangle triangle
+ *   The triangle to keep.
+ * @param int symmetric
+ *   Whether the matrix is symmetric, otherwise it is triangular.
+ *
+ * @return struct packed_matrix*
+ *   The pointer to the packed matrix instance, otherwise NULL.
+ */
+struct packed_matrix *packed_matrix_from_matrix(struct matrix *a, enum matrix_triangle triangle, int symmetric);
+
+/**
+ * Unpack a packed matrix to a dense matrix.
+ *
+ * @param struct packed_matrix* object
+ *   The packed matrix.
+ *
+ * @return struct matrix*
+ *   The pointer to the dense matrix instance, otherwise NULL.
+ */
+struct matrix *packed_matrix_to_matrix(struct packed_matrix *object);
+
+/**
+ * Multiply a packed matrix by a vector (TPMV, or SPMV when symmetric).
+ *
+ * @param struct packed_matrix* object
+ *   The packed matrix.
+ * @param struct vector* x
+ *   The vector.
+ * @param struct vector* dest
+ *   The destination vector, it cannot be x.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int packed_matrix_mul_vector_dest(struct packed_matrix *object, struct vector *x, struct vector *dest);
+
+/**
+ * Solve the triangular system a * x = b for a packed triangular matrix (TPSV).
+ *
+ * @param struct packed_matrix* object
+ *   The packed triangular matrix.
+ * @param struct vector* b
+ *   The right-hand side, overwritten with the solution.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1 (symmetric or
+ *   singular matrix).
+ */
+int packed_matrix_solve_vector(struct packed_matrix *object, struct vector *b);
+
+#endif
+
+#ifndef BANDED_MATRIX_H
+#define BANDED_MATRIX_H
+
+/**
+ * The data struct definition for a banded matrix.
+ *
+ * Only the diagonals from -lower to +upper are stored, row by row: the element
+ * (i, j) is at data[i * width + j - i + lower]. Memory and the cost of every
+ * operation grow with size * width instead of size^2.
+ */
+struct banded_matrix {
+
+  /**
+   * Pointer to the contiguous buffer with the rows of the band.
+   *
+   * @var long double *data.
+   */
+  long double *data;
+
+  /**
+   * The number of rows and columns.
+   *
+   * @var int64_t size.
+   */
+  int64_t size;
+
+  /**
+   * The number of diagonals below the main one.
+   *
+   * @var int64_t lower.
+   */
+  int64_t lower;
+
+  /**
+   * The number of diagonals above the main one.
+   *
+   * @var int64_t upper.
+   */
+  int64_t upper;
+
+  /**
+   * The number of values stored per row, lower + upper + 1.
+   *
+   * @var int64_t width.
+   */
+  int64_t width;
+};
+
+/**
+ * The data struct definition for the LU factorization of a banded matrix.
+ *
+ * The factorization uses partial pivoting, so U has up to lower + upper
+ * diagonals above the main one; each row stores the columns i - lower to
+ * i + lower + upper, the multipliers of L in place of the eliminated values.
+ */
+struct banded_lu {
+
+  /**
+   * Pointer to the contiguous buffer with the rows of both factors.
+   *
+   * @var long double *data.
+   */
+  long double *data;
+
+  /**
+   * The row interchanged with row k at step k of the factorization.
+   *
+   * @var int64_t *pivots.
+   */
+  int64_t *pivots;
+
+  /**
+   * The number of rows and columns.
+   *
+   * @var int64_t size.
+   */
+  int64_t size;
+
+  /**
+   * The number of diagonals below the main one of the factorized matrix.
+   *
+   * @var int64_t lower.
+   */
+  int64_t lower;
+
+  /**
+   * The number of diagonals above the main one of the factorized matrix.
+   *
+   * @var int64_t upper.
+   */
+  int64_t upper;
+
+  /**
+   * The number of values stored per row, 2 * lower + upper + 1.
+   *
+   * @var int64_t width.
+   */
+  int64_t width;
+};
+
+/**
+ * Create a new banded matrix with all its elements set to zero.
+ *
+ * @param const int64_t size
+ *   The number of rows and columns.
+ * @param const int64_t lower
+ *   The number of diagonals below the main one.
+ * @param const int64_t upper
+ *   The number of diagonals above the main one.
+ *
+ * @return struct banded_matrix*
+ *   The pointer to the banded matrix instance, otherwise NULL.
+ */
+struct banded_matrix *banded_matrix_create(const int64_t size, const int64_t lower, const int64_t upper);
+
+/**
+ * Free the memory used by a banded matrix.
+ *
+ * @param struct banded_matrix* object
+ *   The banded matrix.
+ */
+void banded_matrix_destroy(struct banded_matrix *object);
+
+/**
+ * Get the pointer of an element of a banded matrix.
+ *
+ * @param struct banded_matrix* object
+ *   The banded matrix.
+ * @param int64_t row
+ *   The row.
+ * @param int64_t column
+ *   The column.
+ *
+ * @return long double*
+ *   The pointer to the element, NULL when it is out of range or outside the band.
+ */
+long double *banded_matrix_getl(struct banded_matrix *object, int64_t row, int64_t column);
+
+/**
+ * Copy the band of a square matrix, the elements outside of it are ignored.
+ *
+ * @param struct matrix* a
+ *   The square matrix.
+ * @param const int64_t lower
+ *   The number of diagonals below the main one.
+ * @param const int64_t upper
+ *   The number of diagonals above the main one.
+ *
+ * @return struct banded_matrix*
+ *   The pointer to the banded matrix instance, otherwise NULL.
+ */
+struct banded_matrix *banded_matrix_from_matrix(struct matrix *a, const int64_t lower, const int64_t upper);
+
+/**
+ * Expand a banded matrix to a dense matrix.
+ *
+ * @param struct banded_matrix* object
+ *   The banded matrix.
+ *
+ * @return struct matrix*
+ *   The pointer to the dense matrix instance, otherwise NULL.
+ */
+struct matrix *banded_matrix_to_matrix(struct banded_matrix *object);
+
+/**
+ * Multiply a banded matrix by a vector (GBMV), split across threads by rows.
+ *
+ * @param struct banded_matrix* object
+ *   The banded matrix.
+ * @param struct vector* x
+ *   The vector.
+ * @param struct vector* dest
+ *   The destination vector, it cannot be x.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int banded_matrix_mul_vector_dest(struct banded_matrix *object, struct vector *x, struct vector *dest);
+
+/**
+ * Linear operator callback that multiplies by a banded matrix.
+ *
+ * @param void* context
+ *   The struct banded_matrix object to multiply by.
+ * @param struct vector* x
+ *   The vector to be multiplied.
+ * @param struct vector* y
+ *   The destination vector where the results of the operation will be stored.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int banded_operator_apply(void *context, struct vector *x, struct vector *y);
+
+/**
+ * Solve a tridiagonal system with the Thomas algorithm, in O(n).
+ *
+ * There is no pivoting: the system must be diagonally dominant or symmetric
+ * positive definite, as the spline and finite difference systems are.
+ *
+ * @param struct vector* sub
+ *   The subdiagonal, n - 1 values.
+ * @param struct vector* diagonal
+ *   The diagonal, n values.
+ * @param struct vector* super
+ *   The superdiagonal, n - 1 values.
+ * @param struct vector* b
+ *   The right-hand side, overwritten with the solution.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int vector_solve_tridiagonal(struct vector *sub, struct vector *diagonal, struct vector *super, struct vector *b);
+
+/**
+ * Solve a system with a banded matrix of one diagonal on each side with the
+ * Thomas algorithm, in O(n).
+ *
+ * @param struct banded_matrix* object
+ *   The tridiagonal matrix, lower and upper must be 1.
+ * @param struct vector* b
+ *   The right-hand side, overwritten with the solution.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int banded_matrix_solve_tridiagonal(struct banded_matrix *object, struct vector *b);
+
+/**
+ * Compute the LU factorization with partial pivoting of a banded matrix (GBTRF).
+ *
+ * It costs O(size * lower * (lower + upper)) operations.
+ *
+ * @param struct banded_matrix* a
+ *   The banded matrix, it is not modified.
+ *
+ * @return struct banded_lu*
+ *   The pointer to the factorization instance, NULL when the matrix is
+ *   singular or the memory could not be allocated.
+ */
+struct banded_lu *banded_matrix_lu(struct banded_matrix *a);
+
+/**
+ * Free the memory used by a banded LU factorization.
+ *
+ * @param struct banded_lu* object
+ *   The factorization.
+ */
+void banded_lu_destroy(struct banded_lu *object);
+
+/**
+ * Solve a system with a factorized banded matrix (GBTRS).
+ *
+ * @param struct banded_lu* object
+ *   The factorization.
+ * @param struct vector* b
+ *   The right-hand side, overwritten with the solution.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int banded_lu_solve(struct banded_lu *object, struct vector *b);
+
+/**
+ * Solve a system with a banded matrix, factorizing it first.
+ *
+ * @param struct banded_matrix* object
+ *   The banded matrix, it is not modified.
+ * @param struct vector* b
+ *   The right-hand side, overwritten with the solution.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int banded_matrix_solve(struct banded_matrix *object, struct vector *b);
+
+#endif
+
+#ifndef MEMORY_H
+#define MEMORY_H
+
+/**
+ * Multiply two sizes, checking for overflow.
+ *
+ * @param size_t a
+ *   The first factor.
+ * @param size_t b
+ *   The second factor.
+ * @param size_t* result
+ *   The destination of the product, left untouched on overflow.
+ *
+ * @return int
+ *   Returns 0 when the product fits in a size_t, otherwise 1.
+ */
+int matrixmath_size_mul(size_t a, size_t b, size_t *result);
+
+/**
+ * Compute the number of bytes of an array, checking for overflow.
+ *
+ * Every allocation sized from dimensions goes through it, so a dimension
+ * product that does not fit in memory fails cleanly instead of wrapping
+ * around to a small buffer.
+ *
+ * @param int64_t count
+ *   The number of elements.
+ * @param size_t element
+ *   The size of an element in bytes.
+ * @param size_t* bytes
+ *   The destination of the number of bytes, left untouched on overflow.
+ *
+ * @return int
+ *   Returns 0 when the size is valid, otherwise 1 (negative count or overflow).
+ */
+int matrixmath_array_size(int64_t count, size_t element, size_t *bytes);
+
+/**
+ * Release callback of the buffers allocated with malloc().
+ *
+ * It can be given to vector_wrap() or matrix_wrap() to hand them a buffer
+ * from malloc(). The objects created by the library release their values
+ * with matrixmath_release_allocated() instead; only the matrices read by
+ * matrix_csv_read() and the converted NumPy arrays use this one.
+ *
+ * @param void* context
+ *   Unused.
+ * @param long double* data
+ *   The buffer to free.
+ */
+void matrixmath_release_free(void *context, long double *data);
+
+/**
+ * The alignment in bytes of the values of the matrices and vectors created by
+ * the library, a cache line.
+ */
+#define MATRIXMATH_ALIGNMENT 64
+
+/**
+ * The data struct definition for an allocator given to the library.
+ *
+ * It allocates the values of the matrices and vectors the library creates, a
+ * jemalloc arena for example. The buffers are released through the allocator
+ * they come from, it must stay valid until they are all released.
+ */
+struct matrixmath_allocator {
+
+  /**
+   * Allocate a buffer, aligned on alignment bytes.
+   *
+   * @var void *(*allocate)(void *context, size_t bytes, size_t alignment).
+   */
+  void *(*allocate)(void *context, size_t bytes, size_t alignment);
+
+  /**
+   * Release a buffer allocated by allocate().
+   *
+   * @var void (*release)(void *context, void *data).
+   */
+  void (*release)(void *context, void *data);
+
+  /**
+   * The data given to the callbacks.
+   *
+   * @var void *context.
+   */
+  void *context;
+};
+
+/**
+ * The huge page policies of the built-in allocator.
+ *
+ * - HUGE_PAGES_NONE: the buffers are aligned on MATRIXMATH_ALIGNMENT bytes.
+ * - HUGE_PAGES_TRANSPARENT: the buffers of 2 MiB and more are mapped on a
+ *   2 MiB boundary and marked for transparent huge pages; the values start
+ *   after a MATRIXMATH_ALIGNMENT bytes header, so they stay 64-byte aligned.
+ * - HUGE_PAGES_EXPLICIT: the buffers of 2 MiB and more are mapped from the
+ *   reserved huge pages, the transparent ones are used when none are left.
+ * - HUGE_PAGES_DEFAULT: the policy set by matrixmath_set_huge_pages().
+ */
+enum huge_pages_policy {
+  HUGE_PAGES_DEFAULT,
+  HUGE_PAGES_NONE,
+  HUGE_PAGES_TRANSPARENT,
+  HUGE_PAGES_EXPLICIT,
+};
+
+/**
+ * Set the allocator of the values of the matrices and vectors created from now on.
+ *
+ * @param struct matrixmath_allocator* allocator
+ *   The allocator, NULL for the built-in one.
+ */
+void matrixmath_set_allocator(struct matrixmath_allocator *allocator);
+
+/**
+ * Get the allocator of the values of the matrices and vectors.
+ *
+ * @return struct matrixmath_allocator*
+ *   The allocator, NULL for the built-in one.
+ */
+struct matrixmath_allocator *matrixmath_get_allocator();
+
+/**
+ * Set the huge page policy of the built-in allocator.
+ *
+ * By default no huge pages are used, unless the MATRIXMATH_HUGE_PAGES
+ * environment variable is set to "transparent" or "explicit".
+ *
+ * @param enum huge_pages_policy policy
+ *   The policy; HUGE_PAGES_DEFAULT restores the default.
+ */
+void matrixmath_set_huge_pages(enum huge_pages_policy policy);
+
+/**
+ * Get the huge page policy of the built-in allocator.
+ *
+ * @return enum huge_pages_policy
+ *   HUGE_PAGES_NONE, HUGE_PAGES_TRANSPARENT or HUGE_PAGES_EXPLICIT.
+ */
+enum huge_pages_policy matrixmath_get_huge_pages();
+
+/**
+ * Allocate a buffer of values with the current allocator, not initialized.
+ *
+ * @param size_t bytes
+ *   The number of bytes.
+ * @param struct matrixmath_allocator** allocator
+ *   The destination of the allocator used, the context to give to
+ *   matrixmath_release_allocated(); it can be NULL.
+ *
+ * @return long double*
+ *   The buffer, aligned on MATRIXMATH_ALIGNMENT bytes, otherwise NULL.
+ */
+long double *matrixmath_allocate_values(size_t bytes, struct matrixmath_allocator **allocator);
+
+/**
+ * Release callback of the buffers from matrixmath_allocate_values().
+ *
+ * @param void* context
+ *   The allocator of the buffer.
+ * @param long double* data
+ *   The buffer to release.
+ */
+void matrixmath_release_allocated(void *context, long double *data);
+
+/**
+ * Get the shared storage of an object, creating it on first use.
+ *
+ * The storage is created with a single reference, the one of the object, and
+ * takes over its release callback; it is installed atomically so an object
+ * can be cloned from several threads at once.
+ *
+ * @param struct matrixmath_shared** slot
+ *   The shared field of the object.
+ * @param long double* data
+ *   The values of the object.
+ * @param void (*release)(void *context, long double *data)
+ *   The release callback of the object.
+ * @param void* context
+ *   The context of the release callback.
+ *
+ * @return struct matrixmath_shared*
+ *   The shared storage, otherwise NULL.
+ */
+struct matrixmath_shared *matrixmath_shared_get(struct matrixmath_shared **slot, long double *data, void (*release)(void *context, long double *data), void *context);
+
+/**
+ * Add a reference to a shared storage, atomically.
+ *
+ * @param struct matrixmath_shared* shared
+ *   The shared storage.
+ */
+void matrixmath_shared_retain(struct matrixmath_shared *shared);
+
+/**
+ * Check whether a shared storage has a single reference left.
+ *
+ * @param struct matrixmath_shared* shared
+ *   The shared storage.
+ *
+ * @return int
+ *   Returns 1 when the storage is only used by its caller, otherwise 0.
+ */
+int matrixmath_shared_unique(struct matrixmath_shared *shared);
+
+/**
+ * Drop a reference to a shared storage, atomically.
+ *
+ * The last reference releases the values and the storage.
+ *
+ * @param struct matrixmath_shared* shared
+ *   The shared storage.
+ */
+void matrixmath_shared_release(struct matrixmath_shared *shared);
+
+#endif
+
+#ifndef SPARSE_MATRIX_H
+#define SPARSE_MATRIX_H
+
+/**
+ * The data struct definition for a sparse matrix in compressed sparse row form.
+ *
+ * The non-zero elements are stored row by row: the elements of the row i are
+ * at the positions offsets[i] to offsets[i + 1] - 1 of values, with their
+ * columns at the same positions of indices.
+ */
+struct sparse_matrix {
+
+  /**
+   * Pointer to the buffer with the non-zero values.
+   *
+   * @var long double *values.
+   */
+  long double *values;
+
+  /**
+   * Pointer to the buffer with the column of every non-zero value.
+   *
+   * @var int64_t *indices.
+   */
+  int64_t *indices;
+
+  /**
+   * Pointer to the buffer with the position of the first value of every row,
+   * rows + 1 positions.
+   *
+   * @var int64_t *offsets.
+   */
+  int64_t *offsets;
+
+  /**
+   * The number of rows in the matrix.
+   *
+   * @var int64_t rows.
+   */
+  int64_t rows;
+
+  /**
+   * The number of columns in the matrix.
+   *
+   * @var int64_t columns.
+   */
+  int64_t columns;
+
+  /**
+   * The number of stored values.
+   *
+   * @var int64_t nonzeros.
+   */
+  int64_t nonzeros;
+};
+
+/**
+ * Create a new sparse matrix with room for a number of values.
+ *
+ * All the rows are empty, offsets is zero initialized.
+ *
+ * @param const int64_t rows
+ *   The number of rows in the matrix.
+ * @param const int64_t columns
+ *   The number of columns in the matrix.
+ * @param const int64_t nonzeros
+ *   The number of values to store.
+ *
+ * @return struct sparse_matrix*
+ *   The pointer to the sparse matrix instance, otherwise NULL.
+ */
+struct sparse_matrix *sparse_matrix_create(const int64_t rows, const int64_t columns, const int64_t nonzeros);
+
+/**
+ * Free the memory associated to a sparse matrix.
+ *
+ * @param struct sparse_matrix* object
+ *   The sparse matrix to be cleaned.
+ */
+void sparse_matrix_destroy(struct sparse_matrix *object);
+
+/**
+ * Copy the non-zero elements of a dense matrix.
+ *
+ * @param struct matrix* a
+ *   The dense matrix.
+ *
+ * @return struct sparse_matrix*
+ *   The pointer to the sparse matrix instance, otherwise NULL.
+ */
+struct sparse_matrix *sparse_matrix_from_matrix(struct matrix *a);
+
+/**
+ * Expand a sparse matrix into a dense one.
+ *
+ * @param struct sparse_matrix* object
+ *   The sparse matrix.
+ *
+ * @return struct matrix*
+ *   The pointer to the dense matrix instance, otherwise NULL.
+ */
+struct matrix *sparse_matrix_to_matrix(struct sparse_matrix *object);
+
+/**
+ * Multiply a sparse matrix by a vector (SpMV), split across threads by rows.
+ *
+ * @param struct sparse_matrix* object
+ *   The sparse matrix.
+ * @param struct vector* x
+ *   The vector, one element per column.
+ * @param struct vector* dest
+ *   The destination vector, one element per row; it cannot be x.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int sparse_matrix_mul_vector_dest(struct sparse_matrix *object, struct vector *x, struct vector *dest);
+
+/**
+ * Linear operator callback that multiplies by a sparse matrix.
+ *
+ * @param void* context
+ *   The struct sparse_matrix object to multiply by.
+ * @param struct vector* x
+ *   The vector to be multiplied.
+ * @param struct vector* y
+ *   The destination vector where the results of the operation will be stored.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int sparse_operator_apply(void *context, struct vector *x, struct vector *y);
+
+/**
+ * Create a Jacobi (diagonal) preconditioner for the given square sparse matrix.
+ *
+ * @param struct sparse_matrix* a
+ *   The system matrix, all the elements on its diagonal must be nonzero.
+ *
+ * @return struct preconditioner*
+ *   The pointer to the preconditioner instance, otherwise NULL.
+ */
+struct preconditioner *preconditioner_jacobi_create_sparse(struct sparse_matrix *a);
+
+/**
+ * Create an ILU(0) preconditioner for the given square sparse matrix.
+ *
+ * The factors are stored with the sparsity pattern of the matrix, so building
+ * and applying them costs in the order of its stored values. The columns of a
+ * row may come in any order, repeated ones add up.
+ *
+ * @param struct sparse_matrix* a
+ *   The system matrix, every diagonal element must be stored.
+ *
+ * @return struct preconditioner*
+ *   The pointer to the preconditioner instance, otherwise NULL.
+ */
+struct preconditioner *preconditioner_ilu0_create_sparse(struct sparse_matrix *a);
+
+#endif
+
+#ifndef WRITER_H
+#define WRITER_H
+
+#include <stdio.h>
+
+/**
+ * The data struct definition for text written by chunks to a stream, or into
+ * a caller buffer.
+ *
+ * A stream is written one fwrite per full buffer. A caller buffer is filled up
+ * to its size, keeping room for a null character, while the total length
+ * keeps being counted.
+ */
+struct matrixmath_writer {
+
+  /**
+   * The stream, NULL to fill the buffer only.
+   *
+   * @var FILE *stream.
+   */
+  FILE *stream;
+
+  /**
+   * The buffer.
+   *
+   * @var char *buffer.
+   */
+  char *buffer;
+
+  /**
+   * The size of the buffer.
+   *
+   * @var size_t size.
+   */
+  size_t size;
+
+  /**
+   * The number of bytes used in the buffer.
+   *
+   * @var size_t position.
+   */
+  size_t position;
+
+  /**
+   * The length of all the text written.
+   *
+   * @var int64_t total.
+   */
+  int64_t total;
+
+  /**
+   * Non-zero once an operation failed.
+   *
+   * @var int error.
+   */
+  int error;
+};
+
+/**
+ * Prepare a writer.
+ *
+ * @param struct matrixmath_writer* writer
+ *   The writer.
+ * @param FILE* stream
+ *   The stream, or NULL to write into the buffer only.
+ * @param char* buffer
+ *   The buffer, it cannot be NULL for a stream.
+ * @param size_t size
+ *   The size of the buffer.
+ */
+void matrixmath_writer_init(struct matrixmath_writer *writer, FILE *stream, char *buffer, size_t size);
+
+/**
+ * Write the buffered text to the stream, nothing is done without a stream.
+ *
+ * @param struct matrixmath_writer* writer
+ *   The writer.
+ */
+void matrixmath_writer_flush(struct matrixmath_writer *writer);
+
+/**
+ * Finish the writing: the buffered text is written to the stream, or the
+ * caller buffer is null terminated.
+ *
+ * @param struct matrixmath_writer* writer
+ *   The writer.
+ *
+ * @return int
+ *   Returns 0 when everything was written, otherwise 1.
+ */
+int matrixmath_writer_finish(struct matrixmath_writer *writer);
+
+/**
+ * Write text.
+ *
+ * @param struct matrixmath_writer* writer
+ *   The writer.
+ * @param const char* text
+ *   The text.
+ * @param size_t length
+ *   The length of the text.
+ */
+void matrixmath_writer_put(struct matrixmath_writer *writer, const char *text, size_t length);
+
+/**
+ * Write a character.
+ *
+ * @param struct matrixmath_writer* writer
+ *   The writer.
+ * @param char c
+ *   The character.
+ */
+void matrixmath_writer_put_char(struct matrixmath_writer *writer, char c);
+
+/**
+ * Write an integer.
+ *
+ * @param struct matrixmath_writer* writer
+ *   The writer.
+ * @param int64_t value
+ *   The integer.
+ */
+void matrixmath_writer_put_index(struct matrixmath_writer *writer, int64_t value);
+
+/**
+ * Write a value with a fixed number of decimals, as printf("%.*Lf").
+ *
+ * Values whose scaled magnitude fits 53 bits are formatted with integer
+ * arithmetic, the others with snprintf.
+ *
+ * @param struct matrixmath_writer* writer
+ *   The writer.
+ * @param long double value
+ *   The value.
+ * @param int precision
+ *   The number of decimals.
+ */
+void matrixmath_writer_put_fixed(struct matrixmath_writer *writer, long double value, int precision);
+
+/**
+ * Write a value with the 21 significant digits that read it back exactly, as
+ * printf("%.21Lg").
+ *
+ * Values from about 1e-6 up to 2^128 are formatted with integer arithmetic,
+ * the others with snprintf; the text is the same.
+ *
+ * @param struct matrixmath_writer* writer
+ *   The writer.
+ * @param long double value
+ *   The value.
+ */
+void matrixmath_writer_put_value(struct matrixmath_writer *writer, long double value);
+
+#endif
+
+#ifndef MATRIX_IO_H
+#define MATRIX_IO_H
+
+#include <stdio.h>
+
+/**
+ * Read a dense matrix from a Matrix Market stream.
+ *
+ * Both the array and the coordinate formats are accepted, with real, integer
+ * or pattern values and general, symmetric or skew-symmetric layouts. The
+ * stream is parsed by chunks straight into the matrix, without intermediate
+ * arrays.
+ *
+ * @param FILE* stream
+ *   The stream, positioned at the MatrixMarket banner.
+ *
+ * @return struct matrix*
+ *   The pointer to the matrix instance, otherwise NULL (invalid or
+ *   unsupported content).
+ */
+struct matrix *matrix_market_read(FILE *stream);
+
+/**
+ * Read a sparse matrix from a Matrix Market stream.
+ *
+ * The entries are parsed by chunks into the final value and column buffers,
+ * and sorted into rows in place. Symmetric layouts are expanded.
+ *
+ * @param FILE* stream
+ *   The stream, positioned at the MatrixMarket banner.
+ *
+ * @return struct sparse_matrix*
+ *   The pointer to the sparse matrix instance, otherwise NULL.
+ */
+struct sparse_matrix *matrix_market_read_sparse(FILE *stream);
+
+/**
+ * Write a dense matrix to a stream in the Matrix Market array format.
+ *
+ * The values are written with enough digits to be read back exactly.
+ *
+ * @param FILE* stream
+ *   The stream.
+ * @param struct matrix* object
+ *   The matrix.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_market_write(FILE *stream, struct matrix *object);
+
+/**
+ * Write a sparse matrix to a stream in the Matrix Market coordinate format.
+ *
+ * @param FILE* stream
+ *   The stream.
+ * @param struct sparse_matrix* object
+ *   The sparse matrix.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_market_write_sparse(FILE *stream, struct sparse_matrix *object);
+
+/**
+ * Read a dense matrix from a CSV stream, one row per line.
+ *
+ * The number of columns is taken from the first row and every row must match
+ * it; the rows are parsed by chunks straight into a geometrically growing
+ * buffer.
+ *
+ * @param FILE* stream
+ *   The stream.
+ * @param char delimiter
+ *   The field separator, usually ','.
+ * @param int header
+ *   Whether the first line holds column names to skip.
+ *
+ * @return struct matrix*
+ *   The pointer to the matrix instance, otherwise NULL.
+ */
+struct matrix *matrix_csv_read(FILE *stream, char delimiter, int header);
+
+/**
+ * Write a dense matrix to a CSV stream, one row per line.
+ *
+ * @param FILE* stream
+ *   The stream.
+ * @param struct matrix* object
+ *   The matrix.
+ * @param char delimiter
+ *   The field separator, usually ','.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_csv_write(FILE *stream, struct matrix *object, char delimiter);
+
+#endif
+
+#ifndef MATRIX_NPY_H
+#define MATRIX_NPY_H
+
+/**
+ * The types of the values of a NumPy array.
+ */
+enum matrix_npy_type {
+  MATRIX_NPY_FLOAT32,
+  MATRIX_NPY_FLOAT64,
+  MATRIX_NPY_LONGDOUBLE
+};
+
+/**
+ * Load a matrix from a NumPy .npy file holding a two-dimensional array.
+ *
+ * The file is mapped privately into memory. Native long double arrays in C
+ * order are used in place, without parsing or copy, and the mapping is
+ * released with the matrix; float32, float64, big-endian and Fortran order
+ * arrays are converted. Writing to the matrix never changes the file.
+ *
+ * @param const char* path
+ *   The path of the file.
+ *
+ * @return struct matrix*
+ *   The pointer to the matrix instance, otherwise NULL (invalid, empty or
+ *   unsupported array).
+ */
+struct matrix *matrix_load_npy(const char *path);
+
+/**
+ * Load a vector from a NumPy .npy file holding a one-dimensional array.
+ *
+ * The values are used in place or converted as by matrix_load_npy().
+ *
+ * @param const char* path
+ *   The path of the file.
+ *
+ * @return struct vector*
+ *   The pointer to the vector instance, otherwise NULL.
+ */
+struct vector *vector_load_npy(const char *path);
+
+/**
+ * Save a matrix to a NumPy .npy file as a two-dimensional array.
+ *
+ * The values are rounded when saved as float32 or float64.
+ *
+ * @param const char* path
+ *   The path of the file, overwritten.
+ * @param struct matrix* object
+ *   The matrix.
+ * @param enum matrix_npy_type type
+ *   The type of the values in the file.
+ * @param int fortran_order
+ *   Whether the values are saved column after column.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_save_npy(const char *path, struct matrix *object, enum matrix_npy_type type, int fortran_order);
+
+/**
+ * Save a vector to a NumPy .npy file as a one-dimensional array.
+ *
+ * @param const char* path
+ *   The path of the file, overwritten.
+ * @param struct vector* object
+ *   The vector.
+ * @param enum matrix_npy_type type
+ *   The type of the values in the file.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int vector_save_npy(const char *path, struct vector *object, enum matrix_npy_type type);
+
+/**
+ * Load a matrix from a member of a NumPy .npz archive.
+ *
+ * Members stored without compression, as written by numpy.savez(), are used
+ * in place like a .npy file; deflated members, as written by
+ * numpy.savez_compressed(), are inflated once into the matrix storage.
+ *
+ * @param const char* path
+ *   The path of the archive.
+ * @param const char* name
+ *   The name of the array, with or without the .npy extension.
+ *
+ * @return struct matrix*
+ *   The pointer to the matrix instance, otherwise NULL (missing member,
+ *   invalid or unsupported array).
+ */
+struct matrix *matrix_load_npz(const char *path, const char *name);
+
+/**
+ * Load a vector from a member of a NumPy .npz archive.
+ *
+ * @param const char* path
+ *   The path of the archive.
+ * @param const char* name
+ *   The name of the array, with or without the .npy extension.
+ *
+ * @return struct vector*
+ *   The pointer to the vector instance, otherwise NULL.
+ */
+struct vector *vector_load_npz(const char *path, const char *name);
+
+/**
+ * List the arrays of a NumPy .npz archive.
+ *
+ * @param const char* path
+ *   The path of the archive.
+ * @param void (*callback)(void *context, const char *name)
+ *   Called with the name of each array, without the .npy extension; the name
+ *   is only valid during the call.
+ * @param void* context
+ *   The context given to the callback.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_npz_members(const char *path, void (*callback)(void *context, const char *name), void *context);
+
+#endif
+
+#ifndef ASYNC_H
+#define ASYNC_H
+
+/**
+ * A queue of operations run in submission order, one at a time, on the
+ * library thread pool. Operations of different queues run concurrently.
+ */
+struct matrixmath_queue;
+
+/**
+ * The handle of a queued operation.
+ */
+struct matrixmath_future;
+
+/**
+ * Create an operation queue.
+ *
+ * @return struct matrixmath_queue*
+ *   The pointer to the queue, otherwise NULL.
+ */
+struct matrixmath_queue *matrixmath_queue_create();
+
+/**
+ * Destroy an operation queue, once its operations are done.
+ *
+ * @param struct matrixmath_queue* queue
+ *   The queue.
+ */
+void matrixmath_queue_destroy(struct matrixmath_queue *queue);
+
+/**
+ * Queue an operation.
+ *
+ * The operation runs on a worker of the library thread pool, after the ones
+ * queued before it, and may itself run parallel library operations. The
+ * objects it uses must not be changed or destroyed before it is done. With a
+ * single thread there is no worker, and it runs before this returns.
+ *
+ * @param struct matrixmath_queue* queue
+ *   The queue.
+ * @param int (*run)(void *context)
+ *   The operation, returning 0 when it succeeded.
+ * @param void* context
+ *   The data given to the operation.
+ *
+ * @return struct matrixmath_future*
+ *   The handle of the operation, to be destroyed with
+ *   matrixmath_future_destroy(), otherwise NULL.
+ */
+struct matrixmath_future *matrixmath_queue_submit(struct matrixmath_queue *queue, int (*run)(void *context), void *context);
+
+/**
+ * Queue a general matrix product, c = alpha * a * b + beta * c.
+ *
+ * @param struct matrixmath_queue* queue
+ *   The queue.
+ * @param long double alpha
+ *   The scale of the product.
+ * @param struct matrix* a
+ *   The left matrix.
+ * @param struct matrix* b
+ *   The right matrix.
+ * @param long double beta
+ *   The scale of c.
+ * @param struct matrix* c
+ *   The destination matrix.
+ *
+ * @return struct matrixmath_future*
+ *   The handle of the operation, its result is the one of matrix_gemm();
+ *   otherwise NULL.
+ */
+struct matrixmath_future *matrixmath_queue_gemm(struct matrixmath_queue *queue, long double alpha, struct matrix *a, struct matrix *b, long double beta, struct matrix *c);
+
+/**
+ * Wait for every operation queued so far.
+ *
+ * @param struct matrixmath_queue* queue
+ *   The queue.
+ *
+ * @return int
+ *   Returns 0 when every operation done since the last wait succeeded,
+ *   otherwise 1.
+ */
+int matrixmath_queue_wait(struct matrixmath_queue *queue);
+
+/**
+ * Tell whether an operation is done, without waiting.
+ *
+ * @param struct matrixmath_future* future
+ *   The handle of the operation.
+ *
+ * @return int
+ *   1 when the operation and its completion callback are done, otherwise 0.
+ */
+int matrixmath_future_poll(struct matrixmath_future *future);
+
+/**
+ * Wait for an operation.
+ *
+ * Operations and callbacks must not wait for operations queued after them,
+ * which may need the worker they hold.
+ *
+ * @param struct matrixmath_future* future
+ *   The handle of the operation.
+ *
+ * @return int
+ *   The value returned by the operation.
+ */
+int matrixmath_future_wait(struct matrixmath_future *future);
+
+/**
+ * Register the completion callback of an operation.
+ *
+ * The callback runs on the worker once the operation is done and before
+ * its waiters are released, or right away in the calling thread when the
+ * operation is already done.
+ *
+ * @param struct matrixmath_future* future
+ *   The handle of the operation.
+ * @param void (*callback)(void *context, int result)
+ *   The callback, given the value returned by the operation.
+ * @param void* context
+ *   The data given to the callback.
+ *
+ * @return int
+ *   Returns 0 when the callback was registered, otherwise 1 (a callback is
+ *   already registered).
+ */
+int matrixmath_future_then(struct matrixmath_future *future, void (*callback)(void *context, int result), void *context);
+
+/**
+ * Destroy the handle of an operation; the operation itself still runs.
+ *
+ * @param struct matrixmath_future* future
+ *   The handle of the operation.
+ */
+void matrixmath_future_destroy(struct matrixmath_future *future);
+
+#endif
+
+#ifndef GRAPH_H
+#define GRAPH_H
+
+/**
+ * The ways a task accesses a tile.
+ */
+enum matrixmath_access {
+  MATRIXMATH_READ = 1,
+  MATRIXMATH_WRITE = 2,
+  MATRIXMATH_READ_WRITE = 3,
+};
+
+/**
+ * The data struct definition for the access of a task to a tile.
+ *
+ * A tile is identified by an address, usually its first element as given by
+ * matrixmath_graph_tile().
+ */
+struct matrixmath_tile_access {
+  const void *tile;
+  enum matrixmath_access mode;
+};
+
+/**
+ * A graph of tasks over matrix tiles, run by a work-stealing scheduler.
+ *
+ * The dependencies are inferred from the order the tasks are added in and
+ * their tile accesses: a read waits for the last write of the tile, a write
+ * for the last write and every read since. Independent tasks run
+ * concurrently as soon as their predecessors are done, so consecutive tiled
+ * operations overlap instead of synchronizing between each other.
+ */
+struct matrixmath_graph;
+
+/**
+ * Create a task graph.
+ *
+ * @param int64_t tile
+ *   The number of rows and columns of the square tiles used by the tiled
+ *   operations; a matrix shared by several operations is always split the
+ *   same way.
+ *
+ * @return struct matrixmath_graph*
+ *   The pointer to the graph, otherwise NULL.
+ */
+struct matrixmath_graph *matrixmath_graph_create(int64_t tile);
+
+/**
+ * Destroy a task graph and the tasks not run.
+ *
+ * @param struct matrixmath_graph* graph
+ *   The graph.
+ */
+void matrixmath_graph_destroy(struct matrixmath_graph *graph);
+
+/**
+ * Add a task to a graph.
+ *
+ * @param struct matrixmath_graph* graph
+ *   The graph.
+ * @param int (*run)(void *context)
+ *   The operation, returning 0 when it succeeded.
+ * @param void* context
+ *   The data given to the operation.
+ * @param const struct matrixmath_tile_access* accesses
+ *   The tiles accessed by the operation.
+ * @param int count
+ *   The number of accesses.
+ *
+ * @return int64_t
+ *   The identifier of the task, otherwise -1.
+ */
+int64_t matrixmath_graph_add(struct matrixmath_graph *graph, int (*run)(void *context), void *context, const struct matrixmath_tile_access *accesses, int count);
+
+/**
+ * Make a task wait for an earlier one, beyond their tile accesses.
+ *
+ * @param struct matrixmath_graph* graph
+ *   The graph.
+ * @param int64_t task
+ *   The identifier of the task.
+ * @param int64_t predecessor
+ *   The identifier of a task added before it.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrixmath_graph_depend(struct matrixmath_graph *graph, int64_t task, int64_t predecessor);
+
+/**
+ * Get the identifier of a tile of a matrix: its first element.
+ *
+ * @param struct matrixmath_graph* graph
+ *   The graph, giving the size of the tiles.
+ * @param struct matrix* object
+ *   The matrix.
+ * @param int64_t row
+ *   The row of the tile.
+ * @param int64_t column
+ *   The column of the tile.
+ *
+ * @return long double*
+ *   The first element of the tile, otherwise NULL.
+ */
+long double *matrixmath_graph_tile(struct matrixmath_graph *graph, struct matrix *object, int64_t row, int64_t column);
+
+/**
+ * Add a tiled general matrix product, c = alpha * a * b + beta * c, to a
+ * graph.
+ *
+ * One task is added per tile of c and tile of the inner dimension. The
+ * matrices must not be changed or destroyed until the graph has run. When the
+ * product is only partly added, the next matrixmath_graph_run() discards the
+ * graph and fails.
+ *
+ * @param struct matrixmath_graph* graph
+ *   The graph.
+ * @param long double alpha
+ *   The scale of the product.
+ * @param struct matrix* a
+ *   The left matrix.
+ * @param struct matrix* b
+ *   The right matrix.
+ * @param long double beta
+ *   The scale of c.
+ * @param struct matrix* c
+ *   The destination matrix.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrixmath_graph_gemm(struct matrixmath_graph *graph, long double alpha, struct matrix *a, struct matrix *b, long double beta, struct matrix *c);
+
+/**
+ * Run the tasks of a graph and wait for them.
+ *
+ * Each thread of the library pool takes the ready tasks it enabled first and
+ * steals the oldest ones of the other threads when it has none. A task whose
+ * predecessor failed is skipped. The graph is empty afterwards and can be
+ * filled again.
+ *
+ * @param struct matrixmath_graph* graph
+ *   The graph.
+ *
+ * @return int
+ *   Returns 0 when every task succeeded, otherwise 1.
+ */
+int matrixmath_graph_run(struct matrixmath_graph *graph);
+
+#endif
+
+#ifndef NUMA_H
+#define NUMA_H
+
+/**
+ * The policies placing the pages of the matrices and vectors on memory nodes.
+ *
+ * - NUMA_POLICY_FIRST_TOUCH: the values of a new or detached object are
+ *   initialized in parallel, each thread touching the rows the kernels give it,
+ *   so the pages land on the node of the thread computing them.
+ * - NUMA_POLICY_INTERLEAVE: the pages are spread round robin over the memory
+ *   nodes, for data read by every thread.
+ * - NUMA_POLICY_NONE: the values are initialized by the calling thread, every
+ *   page landing on its node.
+ * - NUMA_POLICY_DEFAULT: the policy set by matrixmath_set_numa_policy().
+ *
+ * Only the buffers of 1 MiB and more are placed, the smaller ones stay in the
+ * caches. On a machine with a single memory node every policy is equivalent.
+ */
+enum numa_policy {
+  NUMA_POLICY_DEFAULT,
+  NUMA_POLICY_FIRST_TOUCH,
+  NUMA_POLICY_INTERLEAVE,
+  NUMA_POLICY_NONE,
+};
+
+/**
+ * Set the page placement policy used by the library when none is given.
+ *
+ * By default the library is in NUMA_POLICY_FIRST_TOUCH mode, unless the
+ * MATRIXMATH_NUMA environment variable is set to "interleave" or "none".
+ *
+ * @param enum numa_policy policy
+ *   The policy; NUMA_POLICY_DEFAULT restores the default.
+ */
+void matrixmath_set_numa_policy(enum numa_policy policy);
+
+/**
+ * Get the page placement policy used by the library when none is given.
+ *
+ * @return enum numa_policy
+ *   NUMA_POLICY_FIRST_TOUCH, NUMA_POLICY_INTERLEAVE or NUMA_POLICY_NONE.
+ */
+enum numa_policy matrixmath_get_numa_policy();
+
+/**
+ * Allocate the values of a matrix, placed following the page placement policy.
+ *
+ * The buffer comes from matrixmath_allocate_values() and is released with
+ * matrixmath_release_allocated().
+ *
+ * @param int64_t rows
+ *   The number of rows, the unit of work of the threads.
+ * @param int64_t columns
+ *   The number of columns, 1 for a vector.
+ * @param const long double* source
+ *   The values copied into the buffer, NULL for zeros.
+ * @param struct matrixmath_allocator** allocator
+ *   The destination of the allocator used; it can be NULL.
+ *
+ * @return long double*
+ *   The buffer, otherwise NULL.
+ */
+long double *matrixmath_allocate(int64_t rows, int64_t columns, const long double *source, struct matrixmath_allocator **allocator);
+
+/**
+ * Set every value of a matrix, in parallel over its rows.
+ *
+ * @param long double* data
+ *   The values.
+ * @param int64_t rows
+ *   The number of rows.
+ * @param int64_t columns
+ *   The number of columns, 1 for a vector.
+ * @param long double value
+ *   The value.
+ */
+void matrixmath_fill(long double *data, int64_t rows, int64_t columns, long double value);
+
+#endif
+
+#ifndef MIXED_PRECISION_H
+#define MIXED_PRECISION_H
+
+/**
+ * The precisions of the mixed precision products and factorizations.
+ *
+ * - MATRIX_PRECISION_FLOAT: the values are rounded to float, their products
+ *   are summed in double precision.
+ * - MATRIX_PRECISION_DOUBLE: the values are rounded to double, their products
+ *   are summed in double precision by blocks, the blocks in long double.
+ * - MATRIX_PRECISION_LONG_DOUBLE: the long double path of the library.
+ */
+enum matrix_precision {
+  MATRIX_PRECISION_FLOAT,
+  MATRIX_PRECISION_DOUBLE,
+  MATRIX_PRECISION_LONG_DOUBLE,
+};
+
+/**
+ * The data struct definition for the LU factorization of a square matrix.
+ *
+ * The factorization uses partial pivoting; the rows of U and of the
+ * multipliers of L share a row-major buffer of values of the precision.
+ */
+struct matrix_lu {
+
+  /**
+   * Pointer to the buffer with the rows of both factors, float, double or
+   * long double values depending on the precision.
+   *
+   * @var void *data.
+   */
+  void *data;
+
+  /**
+   * The row interchanged with row k at step k of the factorization.
+   *
+   * @var int64_t *pivots.
+   */
+  int64_t *pivots;
+
+  /**
+   * The number of rows and columns.
+   *
+   * @var int64_t size.
+   */
+  int64_t size;
+
+  /**
+   * The precision of the factors.
+   *
+   * @var enum matrix_precision precision.
+   */
+  enum matrix_precision precision;
+};
+
+/**
+ * General matrix product c = alpha * a * b + beta * c, in a lower precision.
+ *
+ * The products are computed in the given precision and accumulated into c in
+ * long double precision, in parallel. When beta is 0, c is not read.
+ *
+ * @param enum matrix_precision precision
+ *   The precision of the products.
+ * @param long double alpha
+ *   The scale of the product.
+ * @param struct matrix* a
+ *   The left matrix.
+ * @param struct matrix* b
+ *   The right matrix.
+ * @param long double beta
+ *   The scale of c.
+ * @param struct matrix* c
+ *   The destination matrix, distinct from a and b.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_gemm_mixed(enum matrix_precision precision, long double alpha, struct matrix *a, struct matrix *b, long double beta, struct matrix *c);
+
+/**
+ * Matrix multiplication in a lower precision.
+ *
+ * @param enum matrix_precision precision
+ *   The precision of the products.
+ * @param struct matrix* a
+ *   The left matrix.
+ * @param struct matrix* b
+ *   The right matrix.
+ *
+ * @return struct matrix*
+ *   The product, otherwise NULL.
+ */
+struct matrix *matrix_mul_mixed(enum matrix_precision precision, struct matrix *a, struct matrix *b);
+
+/**
+ * Compute the LU factorization with partial pivoting of a square matrix (GETRF).
+ *
+ * The matrix is factorized by panels in the given precision, the updates of
+ * the trailing rows in parallel.
+ *
+ * @param struct matrix* a
+ *   The square matrix, it is not modified.
+ * @param enum matrix_precision precision
+ *   The precision of the factors.
+ *
+ * @return struct matrix_lu*
+ *   The pointer to the factorization instance, NULL when the matrix is
+ *   singular in the precision or the memory could not be allocated.
+ */
+struct matrix_lu *matrix_lu(struct matrix *a, enum matrix_precision precision);
+
+/**
+ * Free the memory used by an LU factorization.
+ *
+ * @param struct matrix_lu* object
+ *   The factorization.
+ */
+void matrix_lu_destroy(struct matrix_lu *object);
+
+/**
+ * Solve a system with a factorized matrix (GETRS).
+ *
+ * The substitutions are computed in long double precision, the solution is as
+ * accurate as the factors.
+ *
+ * @param struct matrix_lu* object
+ *   The factorization.
+ * @param struct vector* b
+ *   The right-hand side, overwritten with the solution.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_lu_solve(struct matrix_lu *object, struct vector *b);
+
+/**
+ * Solve a system with a square matrix by iterative refinement.
+ *
+ * The matrix is factorized in the given precision, then the solution is
+ * corrected with the residuals computed in long double precision until the
+ * residual is at the level of a long double backward error. When the matrix is
+ * too ill-conditioned for the precision, the refinement restarts from a long
+ * double factorization, so the accuracy is the one of the long double path.
+ *
+ * @param struct matrix* a
+ *   The square matrix, it is not modified.
+ * @param struct vector* b
+ *   The right-hand side, overwritten with the solution.
+ * @param enum matrix_precision precision
+ *   The precision of the factorization.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+int matrix_solve_mixed(struct matrix *a, struct vector *b, enum matrix_precision precision);
+
+#endif
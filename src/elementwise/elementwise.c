@@ -0,0 +1,241 @@
+#include <math.h>
+#include "../../include/matrixmath.h"
+
+/**
+ * The number of elements given at once to the kernels and the batch callbacks.
+ */
+#define ELEMENTWISE_BLOCK_SIZE 1024
+
+/**
+ * The number of elements below which a map is not split across threads.
+ *
+ * The transcendental functions cost tens of cycles per element, so the
+ * threshold is lower than the one of the arithmetic kernels.
+ */
+#define ELEMENTWISE_PARALLEL_GRAIN 4096
+
+/**
+ * Apply an elementwise function to a block of values.
+ *
+ * The switch is taken once per block, so each loop only calls the function it
+ * is about and can be unrolled by the compiler.
+ *
+ * @param enum elementwise_operation operation
+ *   The function.
+ * @param const long double* x
+ *   The source values.
+ * @param long double* y
+ *   The destination values, it can be x.
+ * @param size_t n
+ *   The number of values.
+ * @param long double p
+ *   The exponent of ELEMENTWISE_POW, the minimum of ELEMENTWISE_CLAMP.
+ * @param long double q
+ *   The maximum of ELEMENTWISE_CLAMP.
+ */
+static void elementwise_kernel(enum elementwise_operation operation, const long double *x, long double *y, size_t n, long double p, long double q) {
+  long double e;
+  switch (operation) {
+    case ELEMENTWISE_EXP:
+      for (size_t i = 0; i < n; i++) {
+        y[i] = expl(x[i]);
+      }
+      break;
+
+    case ELEMENTWISE_LOG:
+      for (size_t i = 0; i < n; i++) {
+        y[i] = logl(x[i]);
+      }
+      break;
+
+    case ELEMENTWISE_TANH:
+      for (size_t i = 0; i < n; i++) {
+        y[i] = tanhl(x[i]);
+      }
+      break;
+
+    case ELEMENTWISE_SIGMOID:
+      // exp(-|x|) never overflows, which keeps both tails accurate.
+      for (size_t i = 0; i < n; i++) {
+        e = expl(-fabsl(x[i]));
+        y[i] = x[i] >= 0 ? 1 / (1 + e) : e / (1 + e);
+      }
+      break;
+
+    case ELEMENTWISE_RELU:
+      for (size_t i = 0; i < n; i++) {
+        y[i] = x[i] > 0 ? x[i] : 0;
+      }
+      break;
+
+    case ELEMENTWISE_SQRT:
+      for (size_t i = 0; i < n; i++) {
+        y[i] = sqrtl(x[i]);
+      }
+      break;
+
+    case ELEMENTWISE_POW:
+      if (p == 2) {
+        for (size_t i = 0; i < n; i++) {
+          y[i] = x[i] * x[i];
+        }
+        break;
+      }
+      for (size_t i = 0; i < n; i++) {
+        y[i] = powl(x[i], p);
+      }
+      break;
+
+    case ELEMENTWISE_CLAMP:
+      for (size_t i = 0; i < n; i++) {
+        y[i] = x[i] < p ? p : (x[i] > q ? q : x[i]);
+      }
+      break;
+  }
+}
+
+/**
+ * The data struct definition for a map in progress.
+ */
+struct elementwise_map {
+  enum elementwise_operation operation;
+  const long double *x;
+  long double *y;
+  size_t size;
+  long double p;
+  long double q;
+};
+
+/**
+ * Parallel loop body of the maps, the loop runs over blocks.
+ *
+ * @param void* context
+ *   The elementwise_map object.
+ * @param int64_t start
+ *   The first block to map.
+ * @param int64_t end
+ *   The block after the last one to map.
+ */
+static void elementwise_map_blocks(void *context, int64_t start, int64_t end) {
+  struct elementwise_map *map = (struct elementwise_map *)context;
+  size_t first = (size_t)start * ELEMENTWISE_BLOCK_SIZE;
+  size_t last = (size_t)end * ELEMENTWISE_BLOCK_SIZE < map->size ? (size_t)end * ELEMENTWISE_BLOCK_SIZE : map->size;
+  elementwise_kernel(map->operation, map->x + first, map->y + first, last - first, map->p, map->q);
+}
+
+/**
+ * Apply an elementwise function to a buffer, in parallel.
+ *
+ * @param enum elementwise_operation operation
+ *   The function.
+ * @param const long double* x
+ *   The source values.
+ * @param long double* y
+ *   The destination values, it can be x.
+ * @param size_t size
+ *   The number of values.
+ * @param long double p
+ *   The first parameter of the function.
+ * @param long double q
+ *   The second parameter of the function.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+static int elementwise_map_buffer(enum elementwise_operation operation, const long double *x, long double *y, size_t size, long double p, long double q) {
+  struct elementwise_map map = {operation, x, y, size, p, q};
+  int64_t blocks = (int64_t)((size + ELEMENTWISE_BLOCK_SIZE - 1) / ELEMENTWISE_BLOCK_SIZE);
+  return matrixmath_parallel_for(blocks, ELEMENTWISE_PARALLEL_GRAIN / ELEMENTWISE_BLOCK_SIZE, elementwise_map_blocks, &map);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int vector_map(struct vector *a, enum elementwise_operation operation, long double p, long double q, struct vector *dest) {
+  if (a == NULL || dest == NULL || a->capacity != dest->capacity || vector_detach(dest) != 0) {
+    return 1;
+  }
+  return elementwise_map_buffer(operation, a->data, dest->data, a->capacity, p, q);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_map(struct matrix *a, enum elementwise_operation operation, long double p, long double q, struct matrix *dest) {
+  if (a == NULL || dest == NULL || a->rows != dest->rows || a->columns != dest->columns || matrix_detach(dest) != 0) {
+    return 1;
+  }
+  return elementwise_map_buffer(operation, a->data, dest->data, (size_t)a->rows * a->columns, p, q);
+}
+
+/**
+ * The data struct definition for a batch walk in progress.
+ */
+struct elementwise_walk {
+  void (*callback)(void *context, long double *values, int count);
+  void *context;
+  long double *data;
+  size_t size;
+};
+
+/**
+ * Parallel loop body of the batch walks, the loop runs over blocks.
+ *
+ * @param void* context
+ *   The elementwise_walk object.
+ * @param int64_t start
+ *   The first block to walk.
+ * @param int64_t end
+ *   The block after the last one to walk.
+ */
+static void elementwise_walk_blocks(void *context, int64_t start, int64_t end) {
+  struct elementwise_walk *walk = (struct elementwise_walk *)context;
+  size_t first;
+  size_t last;
+  for (int64_t i = start; i < end; i++) {
+    first = (size_t)i * ELEMENTWISE_BLOCK_SIZE;
+    last = first + ELEMENTWISE_BLOCK_SIZE < walk->size ? first + ELEMENTWISE_BLOCK_SIZE : walk->size;
+    walk->callback(walk->context, walk->data + first, (int)(last - first));
+  }
+}
+
+/**
+ * Walk a buffer by chunks, in parallel.
+ *
+ * @param long double* data
+ *   The values.
+ * @param size_t size
+ *   The number of values.
+ * @param void (*callback)(void *context, long double *values, int count)
+ *   The function called for each chunk.
+ * @param void* context
+ *   The data given to the callback.
+ *
+ * @return int
+ *   Returns 1 if the walk operation succeeded, otherwise 0.
+ */
+static int elementwise_walk_buffer(long double *data, size_t size, void (*callback)(void *context, long double *values, int count), void *context) {
+  struct elementwise_walk walk = {callback, context, data, size};
+  int64_t blocks = (int64_t)((size + ELEMENTWISE_BLOCK_SIZE - 1) / ELEMENTWISE_BLOCK_SIZE);
+  return matrixmath_parallel_for(blocks, ELEMENTWISE_PARALLEL_GRAIN / ELEMENTWISE_BLOCK_SIZE, elementwise_walk_blocks, &walk) == 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int vector_walk_batch(struct vector *a, void (*callback)(void *context, long double *values, int count), void *context) {
+  if (a == NULL || callback == NULL || vector_detach(a) != 0) {
+    return 0;
+  }
+  return elementwise_walk_buffer(a->data, a->capacity, callback, context);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_walk_batch(struct matrix *a, void (*callback)(void *context, long double *values, int count), void *context) {
+  if (a == NULL || callback == NULL || matrix_detach(a) != 0) {
+    return 0;
+  }
+  return elementwise_walk_buffer(a->data, (size_t)a->rows * a->columns, callback, context);
+}
@@ -0,0 +1,357 @@
+#include <string.h>
+#include "../../include/matrixmath.h"
+
+/**
+ * The number of elements evaluated at once.
+ *
+ * The intermediate results of a block stay in the cache while the whole tree
+ * is evaluated, so each operand is streamed from memory only once.
+ */
+#define EXPRESSION_BLOCK_SIZE 256
+
+/**
+ * The number of elements below which the evaluation is not split across threads.
+ */
+#define EXPRESSION_PARALLEL_GRAIN 16384
+
+/**
+ * Build a leaf expression node.
+ *
+ * @param long double* data
+ *   The values of the operand.
+ * @param int64_t rows
+ *   The number of rows of the operand.
+ * @param int64_t columns
+ *   The number of columns of the operand.
+ *
+ * @return struct expression
+ *   The expression node.
+ */
+static struct expression expression_leaf(const long double *data, int64_t rows, int64_t columns) {
+  struct expression node = {EXPRESSION_OPERAND, NULL, NULL, data, 0, rows, columns};
+  return node;
+}
+
+/**
+ * Build an operation expression node.
+ *
+ * The shape of the node is the shape of its non scalar operands, which must
+ * match; otherwise the node is marked as invalid with -1 rows.
+ *
+ * @param enum expression_operation operation
+ *   The operation.
+ * @param const struct expression* left
+ *   The first operand.
+ * @param const struct expression* right
+ *   The second operand, NULL for unary operations.
+ * @param long double scalar
+ *   The scalar used by the operation, if any.
+ *
+ * @return struct expression
+ *   The expression node.
+ */
+static struct expression expression_node(enum expression_operation operation, const struct expression *left, const struct expression *right, long double scalar) {
+  struct expression node = {operation, left, right, NULL, scalar, -1, -1};
+  if (left == NULL || left->rows < 0 || (right != NULL && right->rows < 0)) {
+    return node;
+  }
+  // Scalars take the shape of the other operand.
+  if (right == NULL || right->rows == 0) {
+    node.rows = left->rows;
+    node.columns = left->columns;
+  }
+  else if (left->rows == 0) {
+    node.rows = right->rows;
+    node.columns = right->columns;
+  }
+  else if (left->rows == right->rows && left->columns == right->columns) {
+    node.rows = left->rows;
+    node.columns = left->columns;
+  }
+  return node;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct expression expression_matrix(struct matrix *a) {
+  if (a == NULL) {
+    return expression_leaf(NULL, -1, -1);
+  }
+  return expression_leaf(a->data, a->rows, a->columns);
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct expression expression_vector(struct vector *a) {
+  if (a == NULL) {
+    return expression_leaf(NULL, -1, -1);
+  }
+  return expression_leaf(a->data, a->capacity, 1);
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct expression expression_scalar(long double value) {
+  struct expression node = {EXPRESSION_SCALAR, NULL, NULL, NULL, value, 0, 0};
+  return node;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct expression expression_add(const struct expression *a, const struct expression *b) {
+  return expression_node(EXPRESSION_ADD, a, b, 0);
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct expression expression_sub(const struct expression *a, const struct expression *b) {
+  return expression_node(EXPRESSION_SUB, a, b, 0);
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct expression expression_mul(const struct expression *a, const struct expression *b) {
+  return expression_node(EXPRESSION_MUL, a, b, 0);
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct expression expression_div(const struct expression *a, const struct expression *b) {
+  return expression_node(EXPRESSION_DIV, a, b, 0);
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct expression expression_scale(long double scalar, const struct expression *a) {
+  return expression_node(EXPRESSION_SCALE, a, NULL, scalar);
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct expression expression_neg(const struct expression *a) {
+  return expression_node(EXPRESSION_SCALE, a, NULL, -1);
+}
+
+/**
+ * Compute the number of block buffers needed to evaluate the given expression.
+ *
+ * @param const struct expression* e
+ *   The expression.
+ *
+ * @return int
+ *   The number of buffers, or -1 when the expression is malformed.
+ */
+static int expression_buffers(const struct expression *e) {
+  int left;
+  int right;
+  switch (e->operation) {
+    case EXPRESSION_OPERAND:
+    case EXPRESSION_SCALAR:
+      return 1;
+
+    case EXPRESSION_SCALE:
+      return e->left == NULL ? -1 : expression_buffers(e->left);
+
+    case EXPRESSION_ADD:
+    case EXPRESSION_SUB:
+    case EXPRESSION_MUL:
+    case EXPRESSION_DIV:
+      if (e->left == NULL || e->right == NULL) {
+        return -1;
+      }
+      // The result of the left operand is kept while the right one is evaluated.
+      left = expression_buffers(e->left);
+      right = expression_buffers(e->right);
+      if (left < 0 || right < 0) {
+        return -1;
+      }
+      return left > right + 1 ? left : right + 1;
+  }
+  return -1;
+}
+
+/**
+ * Evaluate a block of the given expression.
+ *
+ * The result is written to buffers[0], the deeper buffers are used for the
+ * intermediate results of the operands. Operands are returned in place.
+ *
+ * @param const struct expression* e
+ *   The expression.
+ * @param size_t offset
+ *   The index of the first element of the block.
+ * @param int length
+ *   The number of elements of the block.
+ * @param long double (*buffers)[EXPRESSION_BLOCK_SIZE]
+ *   The block buffers available to this node.
+ *
+ * @return const long double*
+ *   The pointer to the values of the block.
+ */
+static const long double *expression_block(const struct expression *e, size_t offset, int length, long double (*buffers)[EXPRESSION_BLOCK_SIZE]) {
+  long double *out = buffers[0];
+  const long double *x;
+  const long double *y;
+  switch (e->operation) {
+    case EXPRESSION_OPERAND:
+      return e->data + offset;
+
+    case EXPRESSION_SCALAR:
+      for (int64_t i = 0; i < length; i++) {
+        out[i] = e->scalar;
+      }
+      return out;
+
+    case EXPRESSION_SCALE:
+      x = expression_block(e->left, offset, length, buffers);
+      for (int64_t i = 0; i < length; i++) {
+        out[i] = e->scalar * x[i];
+      }
+      return out;
+
+    default:
+      break;
+  }
+  x = expression_block(e->left, offset, length, buffers);
+  y = expression_block(e->right, offset, length, buffers + 1);
+  switch (e->operation) {
+    case EXPRESSION_ADD:
+      for (int64_t i = 0; i < length; i++) {
+        out[i] = x[i] + y[i];
+      }
+      break;
+
+    case EXPRESSION_SUB:
+      for (int64_t i = 0; i < length; i++) {
+        out[i] = x[i] - y[i];
+      }
+      break;
+
+    case EXPRESSION_MUL:
+      for (int64_t i = 0; i < length; i++) {
+        out[i] = x[i] * y[i];
+      }
+      break;
+
+    case EXPRESSION_DIV:
+      for (int64_t i = 0; i < length; i++) {
+        out[i] = x[i] / y[i];
+      }
+      break;
+
+    default:
+      break;
+  }
+  return out;
+}
+
+/**
+ * The data struct definition for an evaluation in progress.
+ */
+struct expression_evaluation {
+
+  /**
+   * The expression to evaluate.
+   *
+   * @var const struct expression *root.
+   */
+  const struct expression *root;
+
+  /**
+   * The destination buffer.
+   *
+   * @var long double *dest.
+   */
+  long double *dest;
+};
+
+/**
+ * Evaluate a range of elements of an expression, block by block.
+ *
+ * @param struct expression_evaluation* evaluation
+ *   The evaluation object.
+ * @param size_t start
+ *   The first element to evaluate.
+ * @param size_t end
+ *   The element after the last one to evaluate.
+ */
+static void expression_evaluate_range(struct expression_evaluation *evaluation, size_t start, size_t end) {
+  long double buffers[EXPRESSION_MAX_DEPTH][EXPRESSION_BLOCK_SIZE];
+  const long double *values;
+  int length;
+  for (size_t offset = start; offset < end; offset += EXPRESSION_BLOCK_SIZE) {
+    length = end - offset < EXPRESSION_BLOCK_SIZE ? (int)(end - offset) : EXPRESSION_BLOCK_SIZE;
+    values = expression_block(evaluation->root, offset, length, buffers);
+    // Every element only depends on the operands at the same position, so the
+    // destination can also be one of the operands.
+    memmove(evaluation->dest + offset, values, sizeof(long double) * length);
+  }
+}
+
+/**
+ * Parallel loop body of the evaluation, the loop runs over blocks.
+ *
+ * @param void* context
+ *   The expression_evaluation object.
+ * @param int64_t start
+ *   The first block to evaluate.
+ * @param int64_t end
+ *   The block after the last one to evaluate.
+ */
+static void expression_evaluate_blocks(void *context, int64_t start, int64_t end) {
+  struct expression_evaluation *evaluation = (struct expression_evaluation *)context;
+  size_t size = (size_t)evaluation->root->rows * evaluation->root->columns;
+  size_t last = (size_t)end * EXPRESSION_BLOCK_SIZE;
+  expression_evaluate_range(evaluation, (size_t)start * EXPRESSION_BLOCK_SIZE, last < size ? last : size);
+}
+
+/**
+ * Evaluate the given expression into a destination buffer.
+ *
+ * @param const struct expression* e
+ *   The expression.
+ * @param long double* dest
+ *   The destination buffer.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+static int expression_evaluate(const struct expression *e, long double *dest) {
+  int buffers = expression_buffers(e);
+  if (buffers < 0 || buffers > EXPRESSION_MAX_DEPTH) {
+    return 1;
+  }
+  struct expression_evaluation evaluation = {e, dest};
+  size_t size = (size_t)e->rows * e->columns;
+  int64_t blocks = (int64_t)((size + EXPRESSION_BLOCK_SIZE - 1) / EXPRESSION_BLOCK_SIZE);
+  return matrixmath_parallel_for(blocks, EXPRESSION_PARALLEL_GRAIN / EXPRESSION_BLOCK_SIZE, expression_evaluate_blocks, &evaluation);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int expression_eval_matrix(const struct expression *e, struct matrix *dest) {
+  if (e == NULL || dest == NULL || e->rows != dest->rows || e->columns != dest->columns || matrix_detach(dest) != 0) {
+    return 1;
+  }
+  return expression_evaluate(e, dest->data);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int expression_eval_vector(const struct expression *e, struct vector *dest) {
+  if (e == NULL || dest == NULL || e->rows != dest->capacity || e->columns != 1 || vector_detach(dest) != 0) {
+    return 1;
+  }
+  return expression_evaluate(e, dest->data);
+}
@@ -0,0 +1,35 @@
+#include <stdlib.h>
+#include "../../include/matrixmath.h"
+
+/**
+ * Define the conversions of a fixed size square matrix type.
+ */
+#define FIXED_MATRIX_CONVERSIONS(N) \
+  int mat##N##_from_matrix(struct matrix *a, struct mat##N *dest) { \
+    if (a == NULL || dest == NULL || a->rows != N || a->columns != N) { \
+      return 1; \
+    } \
+    for (int i = 0; i < N; i++) { \
+      for (int j = 0; j < N; j++) { \
+        dest->m[i][j] = a->data[i * N + j]; \
+      } \
+    } \
+    return 0; \
+  } \
+\
+  struct matrix *mat##N##_to_matrix(struct mat##N a) { \
+    struct matrix *result = matrix_create(N, N); \
+    if (result == NULL) { \
+      return NULL; \
+    } \
+    for (int i = 0; i < N; i++) { \
+      for (int j = 0; j < N; j++) { \
+        result->data[i * N + j] = a.m[i][j]; \
+      } \
+    } \
+    return result; \
+  }
+
+FIXED_MATRIX_CONVERSIONS(2)
+FIXED_MATRIX_CONVERSIONS(3)
+FIXED_MATRIX_CONVERSIONS(4)
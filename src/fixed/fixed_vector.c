@@ -0,0 +1,31 @@
+#include <stdlib.h>
+#include "../../include/matrixmath.h"
+
+/**
+ * Define the conversions of a fixed size vector type.
+ */
+#define FIXED_VECTOR_CONVERSIONS(N) \
+  int vec##N##_from_vector(struct vector *a, struct vec##N *dest) { \
+    if (a == NULL || dest == NULL || a->capacity != N) { \
+      return 1; \
+    } \
+    for (int i = 0; i < N; i++) { \
+      dest->v[i] = a->data[i]; \
+    } \
+    return 0; \
+  } \
+\
+  struct vector *vec##N##_to_vector(struct vec##N a) { \
+    struct vector *result = vector_create(N); \
+    if (result == NULL) { \
+      return NULL; \
+    } \
+    for (int i = 0; i < N; i++) { \
+      result->data[i] = a.v[i]; \
+    } \
+    return result; \
+  }
+
+FIXED_VECTOR_CONVERSIONS(2)
+FIXED_VECTOR_CONVERSIONS(3)
+FIXED_VECTOR_CONVERSIONS(4)
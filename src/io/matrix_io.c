@@ -0,0 +1,827 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../include/matrixmath.h"
+
+/**
+ * The number of bytes read from or written to a stream at once.
+ */
+#define MATRIX_IO_CHUNK 1048576
+
+/**
+ * The largest number of decimal digits held exactly by the fast parser.
+ *
+ * Up to 19 digits fit in a 64-bit integer, which the 64-bit mantissa of a long
+ * double holds exactly.
+ */
+#define MATRIX_IO_MANTISSA_DIGITS 19
+
+/**
+ * The largest power of ten held exactly by a long double.
+ */
+#define MATRIX_IO_EXACT_POWER 27
+
+/**
+ * The powers of ten held exactly by a long double.
+ */
+static const long double matrix_io_powers[MATRIX_IO_EXACT_POWER + 1] = {
+  1e0L, 1e1L, 1e2L, 1e3L, 1e4L, 1e5L, 1e6L, 1e7L, 1e8L, 1e9L,
+  1e10L, 1e11L, 1e12L, 1e13L, 1e14L, 1e15L, 1e16L, 1e17L, 1e18L, 1e19L,
+  1e20L, 1e21L, 1e22L, 1e23L, 1e24L, 1e25L, 1e26L, 1e27L};
+
+/**
+ * The data struct definition for a stream read by chunks.
+ *
+ * The bytes between start and end are read but not parsed yet; the buffer
+ * keeps one more byte so the last line can always be terminated.
+ */
+struct matrix_io_reader {
+  FILE *stream;
+  char *buffer;
+  size_t size;
+  size_t start;
+  size_t end;
+  int eof;
+};
+
+/**
+ * The data struct definition for the header of a Matrix Market stream.
+ */
+struct matrix_market_header {
+  int coordinate;
+  int pattern;
+  int symmetric;
+  int skew;
+  int64_t rows;
+  int64_t columns;
+  int64_t entries;
+};
+
+/**
+ * Prepare the reading of a stream.
+ *
+ * @param struct matrix_io_reader* reader
+ *   The reader.
+ * @param FILE* stream
+ *   The stream.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+static int matrix_io_reader_init(struct matrix_io_reader *reader, FILE *stream) {
+  reader->stream = stream;
+  reader->size = MATRIX_IO_CHUNK + 1;
+  reader->buffer = malloc(reader->size);
+  reader->start = 0;
+  reader->end = 0;
+  reader->eof = 0;
+  return stream == NULL || reader->buffer == NULL;
+}
+
+/**
+ * Get the next line of a stream, without its end of line.
+ *
+ * The line stays valid until the next call.
+ *
+ * @param struct matrix_io_reader* reader
+ *   The reader.
+ *
+ * @return char*
+ *   The line, NULL at the end of the stream or on a read error.
+ */
+static char *matrix_io_line(struct matrix_io_reader *reader) {
+  char *line;
+  char *newline;
+  size_t length;
+  size_t count;
+  while (1) {
+    newline = memchr(reader->buffer + reader->start, '\n', reader->end - reader->start);
+    if (newline != NULL || (reader->eof && reader->start < reader->end)) {
+      line = reader->buffer + reader->start;
+      if (newline == NULL) {
+        newline = reader->buffer + reader->end;
+      }
+      *newline = '\0';
+      length = (size_t)(newline - line);
+      reader->start = reader->start + length + 1 < reader->end ? reader->start + length + 1 : reader->end;
+      if (length > 0 && line[length - 1] == '\r') {
+        line[length - 1] = '\0';
+      }
+      return line;
+    }
+    if (reader->eof) {
+      return NULL;
+    }
+    // Keep the partial line, growing the buffer when it fills all of it.
+    length = reader->end - reader->start;
+    memmove(reader->buffer, reader->buffer + reader->start, length);
+    reader->start = 0;
+    reader->end = length;
+    if (reader->end == reader->size - 1) {
+      char *buffer = realloc(reader->buffer, reader->size * 2);
+      if (buffer == NULL) {
+        return NULL;
+      }
+      reader->buffer = buffer;
+      reader->size *= 2;
+    }
+    count = fread(reader->buffer + reader->end, 1, reader->size - 1 - reader->end, reader->stream);
+    reader->end += count;
+    if (count == 0) {
+      if (ferror(reader->stream)) {
+        return NULL;
+      }
+      reader->eof = 1;
+    }
+  }
+}
+
+/**
+ * Skip the spaces and tabs of a line.
+ *
+ * @param const char* cursor
+ *   The position in the line.
+ *
+ * @return const char*
+ *   The first position that is not blank.
+ */
+static const char *matrix_io_skip(const char *cursor) {
+  while (*cursor == ' ' || *cursor == '\t') {
+    cursor++;
+  }
+  return cursor;
+}
+
+/**
+ * Parse a decimal number.
+ *
+ * Numbers with at most 19 significant digits and a power of ten held exactly
+ * by a long double are converted with a single rounded multiplication or
+ * division, which is correctly rounded; the others, infinities and NaNs go
+ * through strtold().
+ *
+ * @param const char* cursor
+ *   The first character of the number.
+ * @param long double* value
+ *   The destination of the number.
+ *
+ * @return const char*
+ *   The position after the number, otherwise NULL.
+ */
+static const char *matrix_io_number(const char *cursor, long double *value) {
+  const char *start = cursor;
+  uint64_t mantissa = 0;
+  int64_t exponent = 0;
+  int64_t power = 0;
+  int digits = 0;
+  int any = 0;
+  int exact = 1;
+  int negative = 0;
+  if (*cursor == '+' || *cursor == '-') {
+    negative = *cursor == '-';
+    cursor++;
+  }
+  while (*cursor >= '0' && *cursor <= '9') {
+    if (digits < MATRIX_IO_MANTISSA_DIGITS) {
+      mantissa = mantissa * 10 + (uint64_t)(*cursor - '0');
+      digits += mantissa != 0;
+    }
+    else {
+      exact = 0;
+    }
+    cursor++;
+    any = 1;
+  }
+  if (*cursor == '.') {
+    cursor++;
+    while (*cursor >= '0' && *cursor <= '9') {
+      if (digits < MATRIX_IO_MANTISSA_DIGITS) {
+        mantissa = mantissa * 10 + (uint64_t)(*cursor - '0');
+        digits += mantissa != 0;
+        exponent--;
+      }
+      else {
+        exact = 0;
+      }
+      cursor++;
+      any = 1;
+    }
+  }
+  if (any && (*cursor == 'e' || *cursor == 'E')) {
+    const char *mark = cursor;
+    int sign = 1;
+    cursor++;
+    if (*cursor == '+' || *cursor == '-') {
+      sign = *cursor == '-' ? -1 : 1;
+      cursor++;
+    }
+    if (*cursor < '0' || *cursor > '9') {
+      // Not an exponent, the number ends before the mark.
+      cursor = mark;
+    }
+    while (*cursor >= '0' && *cursor <= '9') {
+      power = power < 100000 ? power * 10 + (*cursor - '0') : power;
+      cursor++;
+    }
+    exponent += sign * power;
+  }
+  if (any && exact && exponent >= -MATRIX_IO_EXACT_POWER && exponent <= MATRIX_IO_EXACT_POWER) {
+    *value = exponent >= 0 ? (long double)mantissa * matrix_io_powers[exponent] : (long double)mantissa / matrix_io_powers[-exponent];
+    *value = negative ? -*value : *value;
+    return cursor;
+  }
+  // Slow path, also taken for inf and nan.
+  char *end;
+  *value = strtold(start, &end);
+  return end == start ? NULL : end;
+}
+
+/**
+ * Parse a non-negative decimal integer.
+ *
+ * @param const char* cursor
+ *   The first character of the integer.
+ * @param int64_t* value
+ *   The destination of the integer.
+ *
+ * @return const char*
+ *   The position after the integer, otherwise NULL (no digit or overflow).
+ */
+static const char *matrix_io_index(const char *cursor, int64_t *value) {
+  int64_t result = 0;
+  if (*cursor < '0' || *cursor > '9') {
+    return NULL;
+  }
+  while (*cursor >= '0' && *cursor <= '9') {
+    if (result > (INT64_MAX - (*cursor - '0')) / 10) {
+      return NULL;
+    }
+    result = result * 10 + (*cursor - '0');
+    cursor++;
+  }
+  *value = result;
+  return cursor;
+}
+
+/**
+ * Get the next token of a stream, across lines.
+ *
+ * @param struct matrix_io_reader* reader
+ *   The reader.
+ * @param const char** cursor
+ *   The position in the current line, NULL before the first one.
+ *
+ * @return const char*
+ *   The first character of the token, otherwise NULL at the end of the stream.
+ */
+static const char *matrix_io_token(struct matrix_io_reader *reader, const char **cursor) {
+  while (1) {
+    if (*cursor != NULL) {
+      *cursor = matrix_io_skip(*cursor);
+      if (**cursor != '\0') {
+        return *cursor;
+      }
+    }
+    *cursor = matrix_io_line(reader);
+    if (*cursor == NULL) {
+      return NULL;
+    }
+  }
+}
+
+/**
+ * Compare a word of a line with a keyword, ignoring the case.
+ *
+ * @param const char** cursor
+ *   The position of the word, moved after it when it matches.
+ * @param const char* keyword
+ *   The lowercase keyword.
+ *
+ * @return int
+ *   Returns 1 when the word is the keyword, otherwise 0.
+ */
+static int matrix_io_keyword(const char **cursor, const char *keyword) {
+  const char *word = matrix_io_skip(*cursor);
+  size_t i = 0;
+  for (; keyword[i] != '\0'; i++) {
+    if ((word[i] | 0x20) != keyword[i]) {
+      return 0;
+    }
+  }
+  if (word[i] != '\0' && word[i] != ' ' && word[i] != '\t') {
+    return 0;
+  }
+  *cursor = word + i;
+  return 1;
+}
+
+/**
+ * Read the banner and the size line of a Matrix Market stream.
+ *
+ * @param struct matrix_io_reader* reader
+ *   The reader.
+ * @param struct matrix_market_header* header
+ *   The destination of the header.
+ *
+ * @return int
+ *   Returns 0 when the header is valid and supported, otherwise 1.
+ */
+static int matrix_market_header_read(struct matrix_io_reader *reader, struct matrix_market_header *header) {
+  const char *cursor = matrix_io_line(reader);
+  if (cursor == NULL || strncmp(cursor, "%%MatrixMarket", 14) != 0) {
+    return 1;
+  }
+  cursor += 14;
+  memset(header, 0, sizeof(struct matrix_market_header));
+  if (!matrix_io_keyword(&cursor, "matrix")) {
+    return 1;
+  }
+  if (matrix_io_keyword(&cursor, "coordinate")) {
+    header->coordinate = 1;
+  }
+  else if (!matrix_io_keyword(&cursor, "array")) {
+    return 1;
+  }
+  if (matrix_io_keyword(&cursor, "pattern")) {
+    header->pattern = 1;
+  }
+  else if (!matrix_io_keyword(&cursor, "real") && !matrix_io_keyword(&cursor, "double") && !matrix_io_keyword(&cursor, "integer")) {
+    // Complex values are not supported.
+    return 1;
+  }
+  // Hermitian real matrices are symmetric.
+  if (matrix_io_keyword(&cursor, "symmetric") || matrix_io_keyword(&cursor, "hermitian")) {
+    header->symmetric = 1;
+  }
+  else if (matrix_io_keyword(&cursor, "skew-symmetric")) {
+    header->symmetric = 1;
+    header->skew = 1;
+  }
+  else if (!matrix_io_keyword(&cursor, "general")) {
+    return 1;
+  }
+  if (header->pattern && !header->coordinate) {
+    return 1;
+  }
+  // Skip the comments up to the size line.
+  do {
+    cursor = matrix_io_line(reader);
+    if (cursor == NULL) {
+      return 1;
+    }
+    cursor = matrix_io_skip(cursor);
+  } while (*cursor == '%' || *cursor == '\0');
+  cursor = matrix_io_index(cursor, &header->rows);
+  cursor = cursor == NULL ? NULL : matrix_io_index(matrix_io_skip(cursor), &header->columns);
+  if (cursor != NULL && header->coordinate) {
+    cursor = matrix_io_index(matrix_io_skip(cursor), &header->entries);
+  }
+  if (cursor == NULL || header->rows == 0 || header->columns == 0) {
+    return 1;
+  }
+  return header->symmetric && header->rows != header->columns;
+}
+
+/**
+ * Read the next coordinate entry of a Matrix Market stream.
+ *
+ * @param struct matrix_io_reader* reader
+ *   The reader.
+ * @param const char** cursor
+ *   The position in the current line.
+ * @param struct matrix_market_header* header
+ *   The header of the stream.
+ * @param int64_t* row
+ *   The destination of the row, from 0.
+ * @param int64_t* column
+ *   The destination of the column, from 0.
+ * @param long double* value
+ *   The destination of the value, 1 for patterns.
+ *
+ * @return int
+ *   Returns 0 when the entry is valid, otherwise 1.
+ */
+static int matrix_market_entry(struct matrix_io_reader *reader, const char **cursor, struct matrix_market_header *header, int64_t *row, int64_t *column, long double *value) {
+  const char *token = matrix_io_token(reader, cursor);
+  if (token == NULL || (*cursor = matrix_io_index(token, row)) == NULL) {
+    return 1;
+  }
+  token = matrix_io_token(reader, cursor);
+  if (token == NULL || (*cursor = matrix_io_index(token, column)) == NULL) {
+    return 1;
+  }
+  if (*row < 1 || *row > header->rows || *column < 1 || *column > header->columns) {
+    return 1;
+  }
+  (*row)--;
+  (*column)--;
+  *value = 1;
+  if (header->pattern) {
+    return 0;
+  }
+  token = matrix_io_token(reader, cursor);
+  return token == NULL || (*cursor = matrix_io_number(token, value)) == NULL;
+}
+
+/**
+ * Read the values of a Matrix Market stream into a dense matrix.
+ *
+ * @param struct matrix_io_reader* reader
+ *   The reader, after the header.
+ * @param struct matrix_market_header* header
+ *   The header of the stream.
+ *
+ * @return struct matrix*
+ *   The pointer to the matrix instance, otherwise NULL.
+ */
+static struct matrix *matrix_market_read_dense(struct matrix_io_reader *reader, struct matrix_market_header *header) {
+  struct matrix *result = matrix_create(header->rows, header->columns);
+  if (result == NULL) {
+    return NULL;
+  }
+  long double *data = result->data;
+  int64_t n = header->columns;
+  const char *cursor = NULL;
+  const char *token;
+  int64_t i;
+  int64_t j;
+  long double value;
+  if (header->coordinate) {
+    for (int64_t e = 0; e < header->entries; e++) {
+      if (matrix_market_entry(reader, &cursor, header, &i, &j, &value) != 0) {
+        matrix_destroy(result);
+        return NULL;
+      }
+      data[(size_t)i * n + j] = value;
+      if (header->symmetric && i != j) {
+        data[(size_t)j * n + i] = header->skew ? -value : value;
+      }
+    }
+    return result;
+  }
+  // The array format lists the columns one after the other, only the lower
+  // triangle for symmetric matrices and without the diagonal for skew ones.
+  for (j = 0; j < n; j++) {
+    for (i = header->symmetric ? j + header->skew : 0; i < header->rows; i++) {
+      token = matrix_io_token(reader, &cursor);
+      if (token == NULL || (cursor = matrix_io_number(token, &value)) == NULL) {
+        matrix_destroy(result);
+        return NULL;
+      }
+      data[(size_t)i * n + j] = value;
+      if (header->symmetric) {
+        data[(size_t)j * n + i] = header->skew ? -value : value;
+      }
+    }
+  }
+  return result;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct matrix *matrix_market_read(FILE *stream) {
+  struct matrix_io_reader reader;
+  struct matrix_market_header header;
+  struct matrix *result = NULL;
+  if (matrix_io_reader_init(&reader, stream) == 0 && matrix_market_header_read(&reader, &header) == 0) {
+    result = matrix_market_read_dense(&reader, &header);
+  }
+  free(reader.buffer);
+  return result;
+}
+
+/**
+ * Sort the values of a sparse matrix into their rows, in place.
+ *
+ * The offsets hold the number of values of every row on entry. Every swap
+ * moves a value to its final position, so the sort takes linear time.
+ *
+ * @param struct sparse_matrix* object
+ *   The sparse matrix, values in any order.
+ * @param int64_t* rows
+ *   The row of every value, sorted along.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+static int sparse_matrix_sort_rows(struct sparse_matrix *object, int64_t *rows) {
+  int64_t *next = malloc(((size_t)object->rows + 1) * sizeof(int64_t));
+  if (next == NULL) {
+    return 1;
+  }
+  // Turn the counts into the positions of the rows.
+  int64_t position = 0;
+  int64_t count;
+  for (int64_t i = 0; i <= object->rows; i++) {
+    count = object->offsets[i];
+    object->offsets[i] = position;
+    next[i] = position;
+    position += count;
+  }
+  int64_t e;
+  int64_t target;
+  int64_t index;
+  long double value;
+  for (int64_t i = 0; i < object->rows; i++) {
+    while (next[i] < object->offsets[i + 1]) {
+      e = next[i];
+      target = rows[e];
+      if (target == i) {
+        next[i]++;
+        continue;
+      }
+      // Swap the value with the first free position of its row.
+      index = next[target]++;
+      rows[e] = rows[index];
+      rows[index] = target;
+      value = object->values[e];
+      object->values[e] = object->values[index];
+      object->values[index] = value;
+      count = object->indices[e];
+      object->indices[e] = object->indices[index];
+      object->indices[index] = count;
+    }
+  }
+  free(next);
+  return 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct sparse_matrix *matrix_market_read_sparse(FILE *stream) {
+  struct matrix_io_reader reader;
+  struct matrix_market_header header;
+  struct sparse_matrix *result = NULL;
+  if (matrix_io_reader_init(&reader, stream) != 0 || matrix_market_header_read(&reader, &header) != 0) {
+    free(reader.buffer);
+    return NULL;
+  }
+  if (!header.coordinate) {
+    // Dense content, the zeros are dropped once the matrix is read.
+    struct matrix *dense = matrix_market_read_dense(&reader, &header);
+    free(reader.buffer);
+    result = sparse_matrix_from_matrix(dense);
+    matrix_destroy(dense);
+    return result;
+  }
+  // Room for the mirrored entries of symmetric matrices.
+  int64_t room = header.entries;
+  if (header.symmetric) {
+    room = header.entries < INT64_MAX / 2 ? header.entries * 2 : -1;
+  }
+  result = sparse_matrix_create(header.rows, header.columns, room);
+  int64_t *rows = result == NULL ? NULL : malloc(((size_t)room + 1) * sizeof(int64_t));
+  if (rows == NULL) {
+    sparse_matrix_destroy(result);
+    free(reader.buffer);
+    return NULL;
+  }
+  const char *cursor = NULL;
+  int64_t i;
+  int64_t j;
+  long double value;
+  int64_t count = 0;
+  int status = 0;
+  for (int64_t e = 0; e < header.entries; e++) {
+    if (matrix_market_entry(&reader, &cursor, &header, &i, &j, &value) != 0) {
+      status = 1;
+      break;
+    }
+    // The offsets count the values of every row until they are sorted.
+    rows[count] = i;
+    result->indices[count] = j;
+    result->values[count++] = value;
+    result->offsets[i]++;
+    if (header.symmetric && i != j) {
+      rows[count] = j;
+      result->indices[count] = i;
+      result->values[count++] = header.skew ? -value : value;
+      result->offsets[j]++;
+    }
+  }
+  free(reader.buffer);
+  if (status == 0) {
+    result->nonzeros = count;
+    status = sparse_matrix_sort_rows(result, rows);
+  }
+  free(rows);
+  if (status != 0) {
+    sparse_matrix_destroy(result);
+    return NULL;
+  }
+  return result;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct matrix *matrix_csv_read(FILE *stream, char delimiter, int header) {
+  struct matrix_io_reader reader;
+  if (matrix_io_reader_init(&reader, stream) != 0) {
+    free(reader.buffer);
+    return NULL;
+  }
+  if (header) {
+    matrix_io_line(&reader);
+  }
+  long double *data = NULL;
+  size_t allocated = 0;
+  size_t count = 0;
+  int64_t rows = 0;
+  int64_t columns = 0;
+  int64_t fields;
+  int blank = delimiter == ' ' || delimiter == '\t';
+  int status = 0;
+  const char *cursor;
+  while (status == 0 && (cursor = matrix_io_line(&reader)) != NULL) {
+    cursor = matrix_io_skip(cursor);
+    if (*cursor == '\0') {
+      continue;
+    }
+    fields = 0;
+    while (1) {
+      // Grow the values geometrically, the rows are parsed in place.
+      if (count == allocated) {
+        size_t size = allocated > 0 ? allocated * 2 : MATRIX_IO_CHUNK / sizeof(long double);
+        long double *grown = size < SIZE_MAX / sizeof(long double) ? realloc(data, size * sizeof(long double)) : NULL;
+        if (grown == NULL) {
+          status = 1;
+          break;
+        }
+        data = grown;
+        allocated = size;
+      }
+      cursor = matrix_io_number(matrix_io_skip(cursor), data + count);
+      if (cursor == NULL) {
+        status = 1;
+        break;
+      }
+      count++;
+      fields++;
+      cursor = matrix_io_skip(cursor);
+      if (*cursor == '\0') {
+        break;
+      }
+      if (!blank && *cursor++ != delimiter) {
+        status = 1;
+        break;
+      }
+    }
+    // Every row has the number of fields of the first one.
+    if (status == 0 && rows > 0 && fields != columns) {
+      status = 1;
+    }
+    columns = fields;
+    rows++;
+  }
+  free(reader.buffer);
+  struct matrix *result = NULL;
+  if (status == 0 && rows > 0) {
+    long double *shrunk = realloc(data, count * sizeof(long double));
+    data = shrunk != NULL ? shrunk : data;
+    result = matrix_wrap(data, rows, columns, matrixmath_release_free, NULL);
+  }
+  if (result == NULL) {
+    free(data);
+  }
+  return result;
+}
+
+/**
+ * Prepare the writing of a stream.
+ *
+ * @param struct matrixmath_writer* writer
+ *   The writer.
+ * @param FILE* stream
+ *   The stream.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+static int matrix_io_writer_init(struct matrixmath_writer *writer, FILE *stream) {
+  char *buffer = stream != NULL ? malloc(MATRIX_IO_CHUNK) : NULL;
+  matrixmath_writer_init(writer, stream, buffer, MATRIX_IO_CHUNK);
+  if (buffer == NULL) {
+    writer->error = 1;
+  }
+  return writer->error;
+}
+
+/**
+ * Finish the writing of a stream.
+ *
+ * @param struct matrixmath_writer* writer
+ *   The writer.
+ *
+ * @return int
+ *   Returns 0 when everything was written, otherwise 1.
+ */
+static int matrix_io_writer_finish(struct matrixmath_writer *writer) {
+  if (writer->buffer != NULL && matrixmath_writer_finish(writer) == 0 && fflush(writer->stream) != 0) {
+    writer->error = 1;
+  }
+  free(writer->buffer);
+  return writer->error;
+}
+
+/**
+ * Write a Matrix Market banner and size line.
+ *
+ * @param struct matrixmath_writer* writer
+ *   The writer.
+ * @param const char* format
+ *   The format, "array" or "coordinate".
+ * @param int64_t rows
+ *   The number of rows.
+ * @param int64_t columns
+ *   The number of columns.
+ * @param int64_t entries
+ *   The number of entries, negative to leave it out.
+ */
+static void matrix_market_put_header(struct matrixmath_writer *writer, const char *format, int64_t rows, int64_t columns, int64_t entries) {
+  matrixmath_writer_put(writer, "%%MatrixMarket matrix ", 22);
+  matrixmath_writer_put(writer, format, strlen(format));
+  matrixmath_writer_put(writer, " real general\n", 14);
+  matrixmath_writer_put_index(writer, rows);
+  matrixmath_writer_put_char(writer, ' ');
+  matrixmath_writer_put_index(writer, columns);
+  if (entries >= 0) {
+    matrixmath_writer_put_char(writer, ' ');
+    matrixmath_writer_put_index(writer, entries);
+  }
+  matrixmath_writer_put_char(writer, '\n');
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_market_write(FILE *stream, struct matrix *object) {
+  struct matrixmath_writer writer;
+  if (object == NULL) {
+    return 1;
+  }
+  if (matrix_io_writer_init(&writer, stream) != 0) {
+    return 1;
+  }
+  matrix_market_put_header(&writer, "array", object->rows, object->columns, -1);
+  // The array format lists the columns one after the other.
+  for (int64_t j = 0; j < object->columns; j++) {
+    for (int64_t i = 0; i < object->rows; i++) {
+      matrixmath_writer_put_value(&writer, object->data[(size_t)i * object->columns + j]);
+      matrixmath_writer_put_char(&writer, '\n');
+    }
+  }
+  return matrix_io_writer_finish(&writer);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_market_write_sparse(FILE *stream, struct sparse_matrix *object) {
+  struct matrixmath_writer writer;
+  if (object == NULL) {
+    return 1;
+  }
+  if (matrix_io_writer_init(&writer, stream) != 0) {
+    return 1;
+  }
+  matrix_market_put_header(&writer, "coordinate", object->rows, object->columns, object->nonzeros);
+  for (int64_t i = 0; i < object->rows; i++) {
+    for (int64_t p = object->offsets[i]; p < object->offsets[i + 1]; p++) {
+      matrixmath_writer_put_index(&writer, i + 1);
+      matrixmath_writer_put_char(&writer, ' ');
+      matrixmath_writer_put_index(&writer, object->indices[p] + 1);
+      matrixmath_writer_put_char(&writer, ' ');
+      matrixmath_writer_put_value(&writer, object->values[p]);
+      matrixmath_writer_put_char(&writer, '\n');
+    }
+  }
+  return matrix_io_writer_finish(&writer);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_csv_write(FILE *stream, struct matrix *object, char delimiter) {
+  struct matrixmath_writer writer;
+  if (object == NULL) {
+    return 1;
+  }
+  if (matrix_io_writer_init(&writer, stream) != 0) {
+    return 1;
+  }
+  const long double *row;
+  for (int64_t i = 0; i < object->rows; i++) {
+    row = object->data + (size_t)i * object->columns;
+    for (int64_t j = 0; j < object->columns; j++) {
+      if (j > 0) {
+        matrixmath_writer_put_char(&writer, delimiter);
+      }
+      matrixmath_writer_put_value(&writer, row[j]);
+    }
+    matrixmath_writer_put_char(&writer, '\n');
+  }
+  return matrix_io_writer_finish(&writer);
+}
@@ -0,0 +1,1221 @@
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../../include/matrixmath.h"
+
+/**
+ * The number of bytes converted and written to a file at once.
+ */
+#define MATRIX_NPY_CHUNK 1048576
+
+/**
+ * The alignment of the array data after a NumPy header.
+ */
+#define MATRIX_NPY_ALIGNMENT 64
+
+/**
+ * The number of bytes of the magic string and the version of a NumPy file.
+ */
+#define MATRIX_NPY_PREAMBLE 8
+
+/**
+ * The largest length of the header of a NumPy file written by this library.
+ */
+#define MATRIX_NPY_HEADER 256
+
+/**
+ * The byte order character of the NumPy types native to this host.
+ */
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define MATRIX_NPY_ORDER '<'
+#else
+#define MATRIX_NPY_ORDER '>'
+#endif
+
+/**
+ * The largest number of bytes searched for the end of a zip archive: the
+ * record itself followed by the longest comment.
+ */
+#define MATRIX_NPZ_END_SEARCH (22 + 65535)
+
+/**
+ * The data struct definition for the bytes an array is loaded from.
+ *
+ * The bytes are either a private mapping of a file or a heap buffer; values
+ * loaded without a copy keep them alive until the matrix or vector goes away.
+ */
+struct matrix_npy_source {
+  unsigned char *base;
+  size_t length;
+  int mapped;
+};
+
+/**
+ * The data struct definition for the header of a NumPy array.
+ */
+struct matrix_npy_header {
+  enum matrix_npy_type type;
+  size_t size;
+  int swap;
+  int fortran_order;
+  int dimensions;
+  int64_t shape[2];
+  size_t offset;
+};
+
+/**
+ * The data struct definition for a member of a zip archive.
+ */
+struct matrix_npz_member {
+  const unsigned char *name;
+  size_t name_length;
+  int method;
+  uint64_t compressed;
+  uint64_t uncompressed;
+  uint64_t offset;
+};
+
+/**
+ * The data struct definition for a deflate stream being inflated.
+ */
+struct matrix_npz_inflate {
+  const unsigned char *in;
+  size_t in_length;
+  size_t in_position;
+  uint32_t bits;
+  int count;
+  unsigned char *out;
+  size_t out_length;
+  size_t out_position;
+  int error;
+};
+
+/**
+ * The data struct definition for a canonical Huffman code.
+ */
+struct matrix_npz_huffman {
+  int16_t count[16];
+  int16_t symbol[288];
+};
+
+/**
+ * The base lengths and extra bits of the deflate length symbols 257 to 285.
+ */
+static const int16_t matrix_npz_length_base[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const int16_t matrix_npz_length_extra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+
+/**
+ * The base distances and extra bits of the deflate distance symbols.
+ */
+static const int32_t matrix_npz_distance_base[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const int16_t matrix_npz_distance_extra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+/**
+ * Release the bytes an array was loaded from.
+ *
+ * @param void* context
+ *   The matrix_npy_source object.
+ * @param long double* data
+ *   The values, unused: they point inside the source.
+ */
+static void matrix_npy_release(void *context, long double *data) {
+  struct matrix_npy_source *source = (struct matrix_npy_source *)context;
+  if (source == NULL) {
+    return;
+  }
+  if (source->mapped) {
+    munmap(source->base, source->length);
+  }
+  else {
+    free(source->base);
+  }
+  free(source);
+}
+
+/**
+ * Map a whole file privately into memory.
+ *
+ * The mapping is writable, the changes made to it never reach the file.
+ *
+ * @param const char* path
+ *   The path of the file.
+ *
+ * @return struct matrix_npy_source*
+ *   The mapped source, otherwise NULL.
+ */
+static struct matrix_npy_source *matrix_npy_map(const char *path) {
+  struct stat status;
+  if (path == NULL) {
+    return NULL;
+  }
+  int descriptor = open(path, O_RDONLY);
+  if (descriptor < 0) {
+    return NULL;
+  }
+  if (fstat(descriptor, &status) != 0 || status.st_size <= 0 || (uint64_t)status.st_size > SIZE_MAX) {
+    close(descriptor);
+    return NULL;
+  }
+  struct matrix_npy_source *source = malloc(sizeof(struct matrix_npy_source));
+  if (source == NULL) {
+    close(descriptor);
+    return NULL;
+  }
+  source->length = (size_t)status.st_size;
+  source->base = mmap(NULL, source->length, PROT_READ | PROT_WRITE, MAP_PRIVATE, descriptor, 0);
+  source->mapped = 1;
+  // The mapping stays valid once the descriptor is closed.
+  close(descriptor);
+  if (source->base == MAP_FAILED) {
+    free(source);
+    return NULL;
+  }
+  return source;
+}
+
+/**
+ * Read a little-endian unsigned integer.
+ *
+ * @param const unsigned char* bytes
+ *   The first byte.
+ * @param int size
+ *   The number of bytes, up to 8.
+ *
+ * @return uint64_t
+ *   The integer.
+ */
+static uint64_t matrix_npy_le(const unsigned char *bytes, int size) {
+  uint64_t value = 0;
+  for (int i = size - 1; i >= 0; i--) {
+    value = value << 8 | bytes[i];
+  }
+  return value;
+}
+
+/**
+ * Parse a non-negative decimal integer of a NumPy header.
+ *
+ * @param const char* cursor
+ *   The first digit.
+ * @param const char* end
+ *   The end of the header.
+ * @param int64_t* value
+ *   The integer to set.
+ *
+ * @return const char*
+ *   The character after the integer, otherwise NULL.
+ */
+static const char *matrix_npy_integer(const char *cursor, const char *end, int64_t *value) {
+  if (cursor == end || *cursor < '0' || *cursor > '9') {
+    return NULL;
+  }
+  *value = 0;
+  while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+    if (*value > (INT64_MAX - 9) / 10) {
+      return NULL;
+    }
+    *value = *value * 10 + (*cursor++ - '0');
+  }
+  return cursor;
+}
+
+/**
+ * Find the value of a key in the dictionary of a NumPy header.
+ *
+ * @param const char* text
+ *   The dictionary, not terminated.
+ * @param size_t length
+ *   The length of the dictionary.
+ * @param const char* key
+ *   The key, without quotes.
+ *
+ * @return const char*
+ *   The first character of the value, otherwise NULL.
+ */
+static const char *matrix_npy_find(const char *text, size_t length, const char *key) {
+  size_t size = strlen(key);
+  const char *end = text + length;
+  for (const char *cursor = text; cursor + size + 2 <= end; cursor++) {
+    if ((*cursor == '\'' || *cursor == '"') && memcmp(cursor + 1, key, size) == 0 && cursor[size + 1] == *cursor) {
+      cursor += size + 2;
+      while (cursor < end && (*cursor == ' ' || *cursor == ':')) {
+        cursor++;
+      }
+      return cursor < end ? cursor : NULL;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Parse the header of a NumPy array.
+ *
+ * Versions 1.0 to 3.0 are accepted with little or big-endian float32,
+ * float64 and long double values, in C or Fortran order, with up to two
+ * dimensions.
+ *
+ * @param const unsigned char* bytes
+ *   The array, starting at the magic string.
+ * @param size_t length
+ *   The number of bytes of the array.
+ * @param struct matrix_npy_header* header
+ *   The header to set.
+ *
+ * @return int
+ *   Returns 0 when the header is valid and supported, otherwise 1.
+ */
+static int matrix_npy_header_parse(const unsigned char *bytes, size_t length, struct matrix_npy_header *header) {
+  if (length < MATRIX_NPY_PREAMBLE + 2 || memcmp(bytes, "\x93NUMPY", 6) != 0) {
+    return 1;
+  }
+  // Version 1.0 stores the header length on 2 bytes, later versions on 4.
+  int width = bytes[6] == 1 ? 2 : 4;
+  if (bytes[6] < 1 || bytes[6] > 3 || length < MATRIX_NPY_PREAMBLE + width) {
+    return 1;
+  }
+  size_t size = matrix_npy_le(bytes + MATRIX_NPY_PREAMBLE, width);
+  const char *text = (const char *)bytes + MATRIX_NPY_PREAMBLE + width;
+  if (size > length - MATRIX_NPY_PREAMBLE - width) {
+    return 1;
+  }
+  header->offset = MATRIX_NPY_PREAMBLE + width + size;
+  const char *end = text + size;
+  int64_t value;
+  // The type: a byte order, a kind and a size in bytes.
+  const char *cursor = matrix_npy_find(text, size, "descr");
+  if (cursor == NULL || end - cursor < 5 || (*cursor != '\'' && *cursor != '"') || cursor[2] != 'f') {
+    return 1;
+  }
+  char order = cursor[1];
+  const char *next = matrix_npy_integer(cursor + 3, end, &value);
+  if (next == NULL || next == end || *next != *cursor || (order != '<' && order != '>' && order != '=')) {
+    return 1;
+  }
+  header->size = value;
+  header->swap = order != '=' && order != MATRIX_NPY_ORDER;
+  if (header->size == sizeof(float)) {
+    header->type = MATRIX_NPY_FLOAT32;
+  }
+  else if (header->size == sizeof(double)) {
+    header->type = MATRIX_NPY_FLOAT64;
+  }
+  else if (header->size == sizeof(long double) && !header->swap) {
+    header->type = MATRIX_NPY_LONGDOUBLE;
+  }
+  else {
+    return 1;
+  }
+  cursor = matrix_npy_find(text, size, "fortran_order");
+  if (cursor == NULL) {
+    return 1;
+  }
+  header->fortran_order = *cursor == 'T';
+  // The shape: a tuple of up to two non-negative dimensions.
+  cursor = matrix_npy_find(text, size, "shape");
+  if (cursor == NULL || *cursor != '(') {
+    return 1;
+  }
+  cursor++;
+  header->dimensions = 0;
+  for (;;) {
+    while (cursor < end && (*cursor == ' ' || *cursor == ',')) {
+      cursor++;
+    }
+    if (cursor < end && *cursor == ')') {
+      break;
+    }
+    if (header->dimensions == 2) {
+      return 1;
+    }
+    cursor = matrix_npy_integer(cursor, end, &header->shape[header->dimensions++]);
+    if (cursor == NULL) {
+      return 1;
+    }
+  }
+  // The values must be within the bytes.
+  size_t count = 1;
+  size_t bytes_count;
+  for (int i = 0; i < header->dimensions; i++) {
+    if (matrixmath_size_mul(count, header->shape[i], &count) != 0) {
+      return 1;
+    }
+  }
+  if (matrixmath_size_mul(count, header->size, &bytes_count) != 0 || bytes_count > length - header->offset) {
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * Convert the values of a NumPy array into a new buffer, in row-major order.
+ *
+ * @param const unsigned char* data
+ *   The first value of the array.
+ * @param const struct matrix_npy_header* header
+ *   The header of the array.
+ * @param int64_t rows
+ *   The number of rows.
+ * @param int64_t columns
+ *   The number of columns.
+ *
+ * @return long double*
+ *   The converted values, otherwise NULL.
+ */
+static long double *matrix_npy_convert(const unsigned char *data, const struct matrix_npy_header *header, int64_t rows, int64_t columns) {
+  size_t count = (size_t)rows * columns;
+  size_t bytes;
+  if (matrixmath_array_size(count, sizeof(long double), &bytes) != 0) {
+    return NULL;
+  }
+  long double *values = malloc(bytes);
+  if (values == NULL) {
+    return NULL;
+  }
+  size_t position;
+  float single;
+  double twice;
+  uint32_t word;
+  uint64_t quad;
+  for (size_t k = 0; k < count; k++) {
+    // Fortran order stores the columns one after another.
+    position = header->fortran_order ? (k % columns) * rows + k / columns : k;
+    if (header->type == MATRIX_NPY_FLOAT32) {
+      memcpy(&word, data + position * sizeof(float), sizeof(float));
+      word = header->swap ? __builtin_bswap32(word) : word;
+      memcpy(&single, &word, sizeof(float));
+      values[k] = single;
+    }
+    else if (header->type == MATRIX_NPY_FLOAT64) {
+      memcpy(&quad, data + position * sizeof(double), sizeof(double));
+      quad = header->swap ? __builtin_bswap64(quad) : quad;
+      memcpy(&twice, &quad, sizeof(double));
+      values[k] = twice;
+    }
+    else {
+      memcpy(values + k, data + position * sizeof(long double), sizeof(long double));
+    }
+  }
+  return values;
+}
+
+/**
+ * Get the values of a NumPy array held by a source.
+ *
+ * Native long double values stored contiguously in row-major order and
+ * suitably aligned are used in place; any other array is converted into a
+ * new buffer.
+ *
+ * @param struct matrix_npy_source* source
+ *   The source holding the array.
+ * @param size_t start
+ *   The position of the array in the source.
+ * @param size_t length
+ *   The number of bytes of the array.
+ * @param int dimensions
+ *   The number of dimensions expected.
+ * @param int64_t* shape
+ *   The two dimensions to set; a vector has one row.
+ * @param int* borrowed
+ *   Set to 1 when the values point inside the source, to 0 when they were
+ *   allocated.
+ *
+ * @return long double*
+ *   The values, otherwise NULL.
+ */
+static long double *matrix_npy_values(struct matrix_npy_source *source, size_t start, size_t length, int dimensions, int64_t *shape, int *borrowed) {
+  struct matrix_npy_header header;
+  if (matrix_npy_header_parse(source->base + start, length, &header) != 0 || header.dimensions != dimensions) {
+    return NULL;
+  }
+  shape[0] = dimensions == 2 ? header.shape[0] : 1;
+  shape[1] = dimensions == 2 ? header.shape[1] : header.shape[0];
+  if (shape[0] <= 0 || shape[1] <= 0) {
+    return NULL;
+  }
+  // Both orders are the same for a single row or column.
+  if (shape[0] == 1 || shape[1] == 1) {
+    header.fortran_order = 0;
+  }
+  unsigned char *data = source->base + start + header.offset;
+  *borrowed = header.type == MATRIX_NPY_LONGDOUBLE && !header.fortran_order && (uintptr_t)data % _Alignof(long double) == 0;
+  if (*borrowed) {
+    return (long double *)data;
+  }
+  return matrix_npy_convert(data, &header, shape[0], shape[1]);
+}
+
+/**
+ * Create a matrix or a vector over the NumPy array held by a source.
+ *
+ * The source is released, right away when the values were converted,
+ * otherwise when the matrix or vector is destroyed.
+ *
+ * @param struct matrix_npy_source* source
+ *   The source holding the array.
+ * @param size_t start
+ *   The position of the array in the source.
+ * @param size_t length
+ *   The number of bytes of the array.
+ * @param int dimensions
+ *   2 for a matrix, 1 for a vector.
+ *
+ * @return void*
+ *   The struct matrix* or struct vector* instance, otherwise NULL.
+ */
+static void *matrix_npy_object(struct matrix_npy_source *source, size_t start, size_t length, int dimensions) {
+  int64_t shape[2];
+  int borrowed = 0;
+  void *object = NULL;
+  long double *values = matrix_npy_values(source, start, length, dimensions, shape, &borrowed);
+  if (values != NULL) {
+    void (*release)(void *context, long double *data) = borrowed ? matrix_npy_release : matrixmath_release_free;
+    void *context = borrowed ? source : NULL;
+    if (dimensions == 2) {
+      object = matrix_wrap(values, shape[0], shape[1], release, context);
+    }
+    else {
+      object = vector_wrap(values, shape[1], release, context);
+    }
+    if (object == NULL && !borrowed) {
+      free(values);
+    }
+  }
+  if (object == NULL || !borrowed) {
+    matrix_npy_release(source, NULL);
+  }
+  return object;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct matrix *matrix_load_npy(const char *path) {
+  struct matrix_npy_source *source = matrix_npy_map(path);
+  if (source == NULL) {
+    return NULL;
+  }
+  return matrix_npy_object(source, 0, source->length, 2);
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct vector *vector_load_npy(const char *path) {
+  struct matrix_npy_source *source = matrix_npy_map(path);
+  if (source == NULL) {
+    return NULL;
+  }
+  return matrix_npy_object(source, 0, source->length, 1);
+}
+
+/**
+ * Write a NumPy array to a file.
+ *
+ * @param const char* path
+ *   The path of the file.
+ * @param const long double* values
+ *   The values, in row-major order.
+ * @param int64_t rows
+ *   The number of rows.
+ * @param int64_t columns
+ *   The number of columns.
+ * @param int dimensions
+ *   2 for a matrix, 1 for a vector.
+ * @param enum matrix_npy_type type
+ *   The type of the values in the file.
+ * @param int fortran_order
+ *   Whether the values are written column after column.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+static int matrix_npy_save(const char *path, const long double *values, int64_t rows, int64_t columns, int dimensions, enum matrix_npy_type type, int fortran_order) {
+  char header[MATRIX_NPY_HEADER];
+  char shape[64];
+  size_t size = type == MATRIX_NPY_FLOAT32 ? sizeof(float) : type == MATRIX_NPY_FLOAT64 ? sizeof(double) : sizeof(long double);
+  if (path == NULL || values == NULL || (type != MATRIX_NPY_FLOAT32 && type != MATRIX_NPY_FLOAT64 && type != MATRIX_NPY_LONGDOUBLE)) {
+    return 1;
+  }
+  if (dimensions == 2) {
+    snprintf(shape, sizeof(shape), "(%lld, %lld)", (long long)rows, (long long)columns);
+  }
+  else {
+    snprintf(shape, sizeof(shape), "(%lld,)", (long long)columns);
+  }
+  // Version 1.0: magic, version and a 2-byte length, then the dictionary
+  // padded with spaces so the values start aligned.
+  int text = snprintf(header + MATRIX_NPY_PREAMBLE + 2, sizeof(header) - MATRIX_NPY_PREAMBLE - 2, "{'descr': '%cf%zu', 'fortran_order': %s, 'shape': %s, }", MATRIX_NPY_ORDER, size, fortran_order ? "True" : "False", shape);
+  size_t total = (MATRIX_NPY_PREAMBLE + 2 + text + 1 + MATRIX_NPY_ALIGNMENT - 1) / MATRIX_NPY_ALIGNMENT * MATRIX_NPY_ALIGNMENT;
+  if (text < 0 || total > sizeof(header)) {
+    return 1;
+  }
+  memcpy(header, "\x93NUMPY\x01\x00", MATRIX_NPY_PREAMBLE);
+  header[MATRIX_NPY_PREAMBLE] = (char)((total - MATRIX_NPY_PREAMBLE - 2) & 0xff);
+  header[MATRIX_NPY_PREAMBLE + 1] = (char)((total - MATRIX_NPY_PREAMBLE - 2) >> 8);
+  memset(header + MATRIX_NPY_PREAMBLE + 2 + text, ' ', total - MATRIX_NPY_PREAMBLE - 2 - text);
+  header[total - 1] = '\n';
+  FILE *stream = fopen(path, "wb");
+  if (stream == NULL) {
+    return 1;
+  }
+  int error = fwrite(header, 1, total, stream) != total;
+  size_t count = (size_t)rows * columns;
+  if (!error && type == MATRIX_NPY_LONGDOUBLE && (!fortran_order || rows == 1 || columns == 1)) {
+    // The values are already laid out as in the file.
+    error = fwrite(values, sizeof(long double), count, stream) != count;
+  }
+  else if (!error) {
+    // Convert by chunks, reading the columns one after another for Fortran
+    // order.
+    unsigned char *buffer = malloc(MATRIX_NPY_CHUNK);
+    size_t used = 0;
+    long double value;
+    float single;
+    double twice;
+    error = buffer == NULL;
+    for (size_t k = 0; k < count && !error; k++) {
+      value = fortran_order ? values[(k % rows) * columns + k / rows] : values[k];
+      if (type == MATRIX_NPY_FLOAT32) {
+        single = (float)value;
+        memcpy(buffer + used, &single, size);
+      }
+      else if (type == MATRIX_NPY_FLOAT64) {
+        twice = (double)value;
+        memcpy(buffer + used, &twice, size);
+      }
+      else {
+        memcpy(buffer + used, &value, size);
+      }
+      used += size;
+      if (used + size > MATRIX_NPY_CHUNK || k + 1 == count) {
+        error = fwrite(buffer, 1, used, stream) != used;
+        used = 0;
+      }
+    }
+    free(buffer);
+  }
+  error |= fclose(stream) != 0;
+  return error;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_save_npy(const char *path, struct matrix *object, enum matrix_npy_type type, int fortran_order) {
+  if (object == NULL) {
+    return 1;
+  }
+  return matrix_npy_save(path, object->data, object->rows, object->columns, 2, type, fortran_order);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int vector_save_npy(const char *path, struct vector *object, enum matrix_npy_type type) {
+  if (object == NULL) {
+    return 1;
+  }
+  return matrix_npy_save(path, object->data, 1, object->capacity, 1, type, 0);
+}
+
+/**
+ * Read bits from a deflate stream, least significant first.
+ *
+ * @param struct matrix_npz_inflate* state
+ *   The stream.
+ * @param int need
+ *   The number of bits, up to 16.
+ *
+ * @return int
+ *   The bits; 0 with the error flag set once the input is exhausted.
+ */
+static int matrix_npz_bits(struct matrix_npz_inflate *state, int need) {
+  uint32_t value = state->bits;
+  while (state->count < need) {
+    if (state->in_position == state->in_length) {
+      state->error = 1;
+      return 0;
+    }
+    value |= (uint32_t)state->in[state->in_position++] << state->count;
+    state->count += 8;
+  }
+  state->bits = value >> need;
+  state->count -= need;
+  return (int)(value & ((1u << need) - 1));
+}
+
+/**
+ * Decode a symbol from a deflate stream.
+ *
+ * @param struct matrix_npz_inflate* state
+ *   The stream.
+ * @param const struct matrix_npz_huffman* huffman
+ *   The code.
+ *
+ * @return int
+ *   The symbol, otherwise -1.
+ */
+static int matrix_npz_decode(struct matrix_npz_inflate *state, const struct matrix_npz_huffman *huffman) {
+  int code = 0;
+  int first = 0;
+  int index = 0;
+  int count;
+  // Codes of the same length are consecutive integers, the first code of
+  // each length follows the last one of the previous length.
+  for (int length = 1; length < 16; length++) {
+    code |= matrix_npz_bits(state, 1);
+    count = huffman->count[length];
+    if (code - count < first) {
+      return huffman->symbol[index + (code - first)];
+    }
+    index += count;
+    first = (first + count) << 1;
+    code <<= 1;
+  }
+  return -1;
+}
+
+/**
+ * Build a canonical Huffman code from code lengths.
+ *
+ * @param struct matrix_npz_huffman* huffman
+ *   The code to set.
+ * @param const int16_t* lengths
+ *   The code length of each symbol, 0 for unused symbols.
+ * @param int n
+ *   The number of symbols.
+ *
+ * @return int
+ *   0 for a complete code, a positive number for an incomplete one, a
+ *   negative one for an over-subscribed one.
+ */
+static int matrix_npz_construct(struct matrix_npz_huffman *huffman, const int16_t *lengths, int n) {
+  int16_t offsets[16];
+  int left = 1;
+  memset(huffman->count, 0, sizeof(huffman->count));
+  for (int symbol = 0; symbol < n; symbol++) {
+    huffman->count[lengths[symbol]]++;
+  }
+  if (huffman->count[0] == n) {
+    return 0;
+  }
+  for (int length = 1; length < 16; length++) {
+    left = (left << 1) - huffman->count[length];
+    if (left < 0) {
+      return left;
+    }
+  }
+  offsets[1] = 0;
+  for (int length = 1; length < 15; length++) {
+    offsets[length + 1] = offsets[length] + huffman->count[length];
+  }
+  for (int symbol = 0; symbol < n; symbol++) {
+    if (lengths[symbol] != 0) {
+      huffman->symbol[offsets[lengths[symbol]]++] = symbol;
+    }
+  }
+  return left;
+}
+
+/**
+ * Inflate the literals and matches of a compressed block.
+ *
+ * @param struct matrix_npz_inflate* state
+ *   The stream.
+ * @param const struct matrix_npz_huffman* lengths
+ *   The literal and length code.
+ * @param const struct matrix_npz_huffman* distances
+ *   The distance code.
+ *
+ * @return int
+ *   Returns 0 when the block was inflated, otherwise 1.
+ */
+static int matrix_npz_codes(struct matrix_npz_inflate *state, const struct matrix_npz_huffman *lengths, const struct matrix_npz_huffman *distances) {
+  int symbol;
+  size_t length;
+  size_t distance;
+  for (;;) {
+    symbol = matrix_npz_decode(state, lengths);
+    if (symbol < 0 || state->error) {
+      return 1;
+    }
+    if (symbol == 256) {
+      return 0;
+    }
+    if (symbol < 256) {
+      if (state->out_position == state->out_length) {
+        return 1;
+      }
+      state->out[state->out_position++] = (unsigned char)symbol;
+      continue;
+    }
+    symbol -= 257;
+    if (symbol >= 29) {
+      return 1;
+    }
+    length = matrix_npz_length_base[symbol] + matrix_npz_bits(state, matrix_npz_length_extra[symbol]);
+    symbol = matrix_npz_decode(state, distances);
+    if (symbol < 0 || symbol >= 30) {
+      return 1;
+    }
+    distance = matrix_npz_distance_base[symbol] + matrix_npz_bits(state, matrix_npz_distance_extra[symbol]);
+    if (state->error || distance > state->out_position || length > state->out_length - state->out_position) {
+      return 1;
+    }
+    // The match may overlap the bytes it produces.
+    for (size_t i = 0; i < length; i++) {
+      state->out[state->out_position] = state->out[state->out_position - distance];
+      state->out_position++;
+    }
+  }
+}
+
+/**
+ * Inflate a block stored without compression.
+ *
+ * @param struct matrix_npz_inflate* state
+ *   The stream.
+ *
+ * @return int
+ *   Returns 0 when the block was copied, otherwise 1.
+ */
+static int matrix_npz_stored(struct matrix_npz_inflate *state) {
+  // The block starts on the next byte.
+  state->bits = 0;
+  state->count = 0;
+  if (state->in_length - state->in_position < 4) {
+    return 1;
+  }
+  size_t length = matrix_npy_le(state->in + state->in_position, 2);
+  if ((length ^ 0xffff) != matrix_npy_le(state->in + state->in_position + 2, 2)) {
+    return 1;
+  }
+  state->in_position += 4;
+  if (length > state->in_length - state->in_position || length > state->out_length - state->out_position) {
+    return 1;
+  }
+  memcpy(state->out + state->out_position, state->in + state->in_position, length);
+  state->in_position += length;
+  state->out_position += length;
+  return 0;
+}
+
+/**
+ * Inflate a block compressed with the fixed codes.
+ *
+ * @param struct matrix_npz_inflate* state
+ *   The stream.
+ *
+ * @return int
+ *   Returns 0 when the block was inflated, otherwise 1.
+ */
+static int matrix_npz_fixed(struct matrix_npz_inflate *state) {
+  struct matrix_npz_huffman lengths;
+  struct matrix_npz_huffman distances;
+  int16_t sizes[288];
+  for (int symbol = 0; symbol < 288; symbol++) {
+    sizes[symbol] = symbol < 144 ? 8 : symbol < 256 ? 9 : symbol < 280 ? 7 : 8;
+  }
+  matrix_npz_construct(&lengths, sizes, 288);
+  for (int symbol = 0; symbol < 30; symbol++) {
+    sizes[symbol] = 5;
+  }
+  matrix_npz_construct(&distances, sizes, 30);
+  return matrix_npz_codes(state, &lengths, &distances);
+}
+
+/**
+ * Inflate a block compressed with codes described in the block.
+ *
+ * @param struct matrix_npz_inflate* state
+ *   The stream.
+ *
+ * @return int
+ *   Returns 0 when the block was inflated, otherwise 1.
+ */
+static int matrix_npz_dynamic(struct matrix_npz_inflate *state) {
+  static const int order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+  struct matrix_npz_huffman lengths;
+  struct matrix_npz_huffman distances;
+  int16_t sizes[320];
+  int nlength = matrix_npz_bits(state, 5) + 257;
+  int ndistance = matrix_npz_bits(state, 5) + 1;
+  int ncode = matrix_npz_bits(state, 4) + 4;
+  if (state->error || nlength > 286 || ndistance > 30) {
+    return 1;
+  }
+  // The code lengths are themselves Huffman coded.
+  for (int index = 0; index < 19; index++) {
+    sizes[order[index]] = index < ncode ? matrix_npz_bits(state, 3) : 0;
+  }
+  if (state->error || matrix_npz_construct(&lengths, sizes, 19) != 0) {
+    return 1;
+  }
+  int symbol;
+  int repeat;
+  int16_t size;
+  for (int index = 0; index < nlength + ndistance;) {
+    symbol = matrix_npz_decode(state, &lengths);
+    if (symbol < 0 || state->error) {
+      return 1;
+    }
+    if (symbol < 16) {
+      sizes[index++] = symbol;
+      continue;
+    }
+    // 16 repeats the previous length, 17 and 18 repeat zero.
+    size = 0;
+    if (symbol == 16) {
+      if (index == 0) {
+        return 1;
+      }
+      size = sizes[index - 1];
+      repeat = 3 + matrix_npz_bits(state, 2);
+    }
+    else if (symbol == 17) {
+      repeat = 3 + matrix_npz_bits(state, 3);
+    }
+    else {
+      repeat = 11 + matrix_npz_bits(state, 7);
+    }
+    if (state->error || index + repeat > nlength + ndistance) {
+      return 1;
+    }
+    while (repeat--) {
+      sizes[index++] = size;
+    }
+  }
+  // The end of block symbol must have a code; incomplete codes are only
+  // allowed for a single symbol.
+  if (sizes[256] == 0) {
+    return 1;
+  }
+  int left = matrix_npz_construct(&lengths, sizes, nlength);
+  if (left < 0 || (left > 0 && nlength - lengths.count[0] != 1)) {
+    return 1;
+  }
+  left = matrix_npz_construct(&distances, sizes + nlength, ndistance);
+  if (left < 0 || (left > 0 && ndistance - distances.count[0] != 1)) {
+    return 1;
+  }
+  return matrix_npz_codes(state, &lengths, &distances);
+}
+
+/**
+ * Inflate a raw deflate stream into a buffer of known size.
+ *
+ * @param const unsigned char* in
+ *   The compressed bytes.
+ * @param size_t in_length
+ *   The number of compressed bytes.
+ * @param unsigned char* out
+ *   The buffer.
+ * @param size_t out_length
+ *   The number of bytes the stream inflates to.
+ *
+ * @return int
+ *   Returns 0 when the stream filled the buffer exactly, otherwise 1.
+ */
+static int matrix_npz_inflate(const unsigned char *in, size_t in_length, unsigned char *out, size_t out_length) {
+  struct matrix_npz_inflate state = {in, in_length, 0, 0, 0, out, out_length, 0, 0};
+  int last;
+  int type;
+  int error;
+  do {
+    last = matrix_npz_bits(&state, 1);
+    type = matrix_npz_bits(&state, 2);
+    if (state.error) {
+      return 1;
+    }
+    if (type == 0) {
+      error = matrix_npz_stored(&state);
+    }
+    else if (type == 1) {
+      error = matrix_npz_fixed(&state);
+    }
+    else if (type == 2) {
+      error = matrix_npz_dynamic(&state);
+    }
+    else {
+      error = 1;
+    }
+    if (error) {
+      return 1;
+    }
+  } while (!last);
+  return state.out_position != out_length;
+}
+
+/**
+ * Read the 64-bit values of a zip64 extra field that replace the saturated
+ * 32-bit ones of a central directory entry.
+ *
+ * @param const unsigned char* extra
+ *   The extra fields.
+ * @param size_t length
+ *   The length of the extra fields.
+ * @param struct matrix_npz_member* member
+ *   The member to update.
+ *
+ * @return int
+ *   Returns 0 when every saturated value was found, otherwise 1.
+ */
+static int matrix_npz_zip64(const unsigned char *extra, size_t length, struct matrix_npz_member *member) {
+  uint64_t *values[3] = {&member->uncompressed, &member->compressed, &member->offset};
+  for (size_t position = 0; position + 4 <= length;) {
+    size_t id = matrix_npy_le(extra + position, 2);
+    size_t size = matrix_npy_le(extra + position + 2, 2);
+    position += 4;
+    if (size > length - position) {
+      return 1;
+    }
+    if (id == 1) {
+      // Only the saturated values are present, in this order.
+      size_t used = 0;
+      for (int i = 0; i < 3; i++) {
+        if (*values[i] == 0xffffffff) {
+          if (used + 8 > size) {
+            return 1;
+          }
+          *values[i] = matrix_npy_le(extra + position + used, 8);
+          used += 8;
+        }
+      }
+      return 0;
+    }
+    position += size;
+  }
+  return member->uncompressed == 0xffffffff || member->compressed == 0xffffffff || member->offset == 0xffffffff;
+}
+
+/**
+ * Walk the central directory of a zip archive.
+ *
+ * @param const struct matrix_npy_source* source
+ *   The mapped archive.
+ * @param int (*callback)(void *context, const struct matrix_npz_member *member)
+ *   Called for each member until it returns a non-zero value.
+ * @param void* context
+ *   The context given to the callback.
+ *
+ * @return int
+ *   The value returned by the callback that stopped the walk, 0 once every
+ *   member was visited, otherwise -1 (invalid archive).
+ */
+static int matrix_npz_walk(const struct matrix_npy_source *source, int (*callback)(void *context, const struct matrix_npz_member *member), void *context) {
+  const unsigned char *base = source->base;
+  size_t length = source->length;
+  if (length < 22) {
+    return -1;
+  }
+  // The end of central directory record is followed by a comment only.
+  size_t end = length - 22;
+  size_t stop = length > MATRIX_NPZ_END_SEARCH ? length - MATRIX_NPZ_END_SEARCH : 0;
+  while (matrix_npy_le(base + end, 4) != 0x06054b50) {
+    if (end == stop) {
+      return -1;
+    }
+    end--;
+  }
+  uint64_t entries = matrix_npy_le(base + end + 10, 2);
+  uint64_t directory = matrix_npy_le(base + end + 16, 4);
+  // Archives with many members or above 4 GiB keep the values in a zip64
+  // record, found through a locator just before the end record.
+  if ((entries == 0xffff || directory == 0xffffffff) && end >= 20 && matrix_npy_le(base + end - 20, 4) == 0x07064b50) {
+    uint64_t record = matrix_npy_le(base + end - 12, 8);
+    if (length < 56 || record > length - 56 || matrix_npy_le(base + record, 4) != 0x06064b50) {
+      return -1;
+    }
+    entries = matrix_npy_le(base + record + 32, 8);
+    directory = matrix_npy_le(base + record + 48, 8);
+  }
+  struct matrix_npz_member member;
+  size_t position = directory;
+  size_t extra;
+  int result;
+  for (uint64_t i = 0; i < entries; i++) {
+    if (length < 46 || position > length - 46 || matrix_npy_le(base + position, 4) != 0x02014b50) {
+      return -1;
+    }
+    member.method = (int)matrix_npy_le(base + position + 10, 2);
+    member.compressed = matrix_npy_le(base + position + 20, 4);
+    member.uncompressed = matrix_npy_le(base + position + 24, 4);
+    member.name_length = matrix_npy_le(base + position + 28, 2);
+    extra = matrix_npy_le(base + position + 30, 2);
+    member.offset = matrix_npy_le(base + position + 42, 4);
+    member.name = base + position + 46;
+    if (member.name_length + extra > length - position - 46 || matrix_npz_zip64(member.name + member.name_length, extra, &member) != 0) {
+      return -1;
+    }
+    result = callback(context, &member);
+    if (result != 0) {
+      return result;
+    }
+    position += 46 + member.name_length + extra + matrix_npy_le(base + position + 32, 2);
+  }
+  return 0;
+}
+
+/**
+ * The data struct definition for a member being searched.
+ */
+struct matrix_npz_search {
+  const char *name;
+  struct matrix_npz_member member;
+};
+
+/**
+ * Match a member of an archive against a name, with or without the .npy
+ * extension NumPy adds to the array names.
+ *
+ * @param void* context
+ *   The matrix_npz_search object.
+ * @param const struct matrix_npz_member* member
+ *   The member.
+ *
+ * @return int
+ *   1 when the member matches, otherwise 0.
+ */
+static int matrix_npz_match(void *context, const struct matrix_npz_member *member) {
+  struct matrix_npz_search *search = (struct matrix_npz_search *)context;
+  size_t size = strlen(search->name);
+  size_t length = member->name_length;
+  if (length == size + 4 && memcmp(member->name + size, ".npy", 4) == 0) {
+    length = size;
+  }
+  if (length != size || memcmp(member->name, search->name, size) != 0) {
+    return 0;
+  }
+  search->member = *member;
+  return 1;
+}
+
+/**
+ * Load a member of a NumPy archive.
+ *
+ * Stored members are used in place like a .npy file; compressed members are
+ * inflated into a buffer which then holds the values.
+ *
+ * @param const char* path
+ *   The path of the archive.
+ * @param const char* name
+ *   The name of the member.
+ * @param int dimensions
+ *   2 for a matrix, 1 for a vector.
+ *
+ * @return void*
+ *   The struct matrix* or struct vector* instance, otherwise NULL.
+ */
+static void *matrix_npz_load(const char *path, const char *name, int dimensions) {
+  if (name == NULL) {
+    return NULL;
+  }
+  struct matrix_npy_source *source = matrix_npy_map(path);
+  if (source == NULL) {
+    return NULL;
+  }
+  struct matrix_npz_search search = {name};
+  uint64_t start = 0;
+  // The data follows the local header, whose name and extra field lengths
+  // may differ from the central directory ones.
+  if (matrix_npz_walk(source, matrix_npz_match, &search) == 1 && source->length >= 30 && search.member.offset <= source->length - 30 && matrix_npy_le(source->base + search.member.offset, 4) == 0x04034b50) {
+    start = search.member.offset + 30 + matrix_npy_le(source->base + search.member.offset + 26, 2) + matrix_npy_le(source->base + search.member.offset + 28, 2);
+    if (start > source->length || search.member.compressed > source->length - start) {
+      start = 0;
+    }
+  }
+  if (start != 0 && search.member.method == 0 && search.member.compressed == search.member.uncompressed) {
+    return matrix_npy_object(source, start, search.member.uncompressed, dimensions);
+  }
+  if (start == 0 || search.member.method != 8 || search.member.uncompressed == 0 || search.member.uncompressed > SIZE_MAX) {
+    matrix_npy_release(source, NULL);
+    return NULL;
+  }
+  struct matrix_npy_source *inflated = malloc(sizeof(struct matrix_npy_source));
+  unsigned char *buffer = malloc(search.member.uncompressed);
+  int error = inflated == NULL || buffer == NULL || matrix_npz_inflate(source->base + start, search.member.compressed, buffer, search.member.uncompressed) != 0;
+  matrix_npy_release(source, NULL);
+  if (error) {
+    free(inflated);
+    free(buffer);
+    return NULL;
+  }
+  inflated->base = buffer;
+  inflated->length = search.member.uncompressed;
+  inflated->mapped = 0;
+  return matrix_npy_object(inflated, 0, inflated->length, dimensions);
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct matrix *matrix_load_npz(const char *path, const char *name) {
+  return matrix_npz_load(path, name, 2);
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct vector *vector_load_npz(const char *path, const char *name) {
+  return matrix_npz_load(path, name, 1);
+}
+
+/**
+ * The data struct definition for the members being listed.
+ */
+struct matrix_npz_listing {
+  void (*callback)(void *context, const char *name);
+  void *context;
+  int error;
+};
+
+/**
+ * Report the name of a member of an archive, without the .npy extension.
+ *
+ * @param void* context
+ *   The matrix_npz_listing object.
+ * @param const struct matrix_npz_member* member
+ *   The member.
+ *
+ * @return int
+ *   0 to go on with the next member, 1 when out of memory.
+ */
+static int matrix_npz_list(void *context, const struct matrix_npz_member *member) {
+  struct matrix_npz_listing *listing = (struct matrix_npz_listing *)context;
+  size_t length = member->name_length;
+  if (length > 4 && memcmp(member->name + length - 4, ".npy", 4) == 0) {
+    length -= 4;
+  }
+  char *name = malloc(length + 1);
+  if (name == NULL) {
+    listing->error = 1;
+    return 1;
+  }
+  memcpy(name, member->name, length);
+  name[length] = '\0';
+  listing->callback(listing->context, name);
+  free(name);
+  return 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_npz_members(const char *path, void (*callback)(void *context, const char *name), void *context) {
+  if (callback == NULL) {
+    return 1;
+  }
+  struct matrix_npy_source *source = matrix_npy_map(path);
+  if (source == NULL) {
+    return 1;
+  }
+  struct matrix_npz_listing listing = {callback, context, 0};
+  int result = matrix_npz_walk(source, matrix_npz_list, &listing);
+  matrix_npy_release(source, NULL);
+  return result != 0 || listing.error;
+}
@@ -0,0 +1,147 @@
+#include <stdint.h>
+#include <stdio.h>
+#include "../../include/matrixmath.h"
+
+/**
+ * The number of bytes buffered before they are written to a stream.
+ */
+#define PRINT_CHUNK 65536
+
+/**
+ * Get the next position shown in a summarized dimension.
+ *
+ * @param int64_t index
+ *   The position.
+ * @param int64_t count
+ *   The size of the dimension.
+ * @param int64_t edge
+ *   The number of leading and trailing positions shown, 0 for all.
+ *
+ * @return int64_t
+ *   The first trailing position when the skipped middle starts at index,
+ *   otherwise index.
+ */
+static int64_t print_skip(int64_t index, int64_t count, int64_t edge) {
+  if (edge > 0 && count - edge > edge && index == edge) {
+    return count - edge;
+  }
+  return index;
+}
+
+/**
+ * Write a vector.
+ *
+ * @param struct matrixmath_writer* writer
+ *   The writer.
+ * @param struct vector* object
+ *   The vector.
+ * @param int precision
+ *   The number of decimals.
+ * @param int64_t edge
+ *   The number of leading and trailing values shown, 0 for all.
+ */
+static void print_vector(struct matrixmath_writer *writer, struct vector *object, int precision, int64_t edge) {
+  matrixmath_writer_put(writer, "[", 1);
+  for (int64_t i = 0; i < object->capacity; i++) {
+    // Separate values after the first one.
+    if (i != 0) {
+      matrixmath_writer_put(writer, ", ", 2);
+    }
+    if (print_skip(i, object->capacity, edge) != i) {
+      matrixmath_writer_put(writer, "..., ", 5);
+      i = print_skip(i, object->capacity, edge);
+    }
+    matrixmath_writer_put_fixed(writer, object->data[i], precision);
+  }
+  matrixmath_writer_put(writer, "]", 1);
+}
+
+/**
+ * Write a matrix, one row per line.
+ *
+ * @param struct matrixmath_writer* writer
+ *   The writer.
+ * @param struct matrix* object
+ *   The matrix.
+ * @param int precision
+ *   The number of decimals.
+ * @param int64_t edge
+ *   The number of leading and trailing rows and columns shown, 0 for all.
+ */
+static void print_matrix(struct matrixmath_writer *writer, struct matrix *object, int precision, int64_t edge) {
+  const long double *row;
+  matrixmath_writer_put(writer, "[\n", 2);
+  for (int64_t i = 0; i < object->rows; i++) {
+    if (print_skip(i, object->rows, edge) != i) {
+      matrixmath_writer_put(writer, " ...\n", 5);
+      i = print_skip(i, object->rows, edge);
+    }
+    matrixmath_writer_put(writer, " [", 2);
+    row = object->data + (size_t)i * object->columns;
+    for (int64_t j = 0; j < object->columns; j++) {
+      if (print_skip(j, object->columns, edge) != j) {
+        matrixmath_writer_put(writer, " ... ", 5);
+        j = print_skip(j, object->columns, edge);
+      }
+      matrixmath_writer_put(writer, " ", 1);
+      matrixmath_writer_put_fixed(writer, row[j], precision);
+      matrixmath_writer_put(writer, " ", 1);
+    }
+    matrixmath_writer_put(writer, "]\n", 2);
+  }
+  matrixmath_writer_put(writer, "]\n", 2);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int vector_fprint(FILE *stream, struct vector *object, int precision, int64_t edge) {
+  char buffer[PRINT_CHUNK];
+  if (stream == NULL || object == NULL || precision < 0 || edge < 0) {
+    return 1;
+  }
+  struct matrixmath_writer writer;
+  matrixmath_writer_init(&writer, stream, buffer, sizeof(buffer));
+  print_vector(&writer, object, precision, edge);
+  return matrixmath_writer_finish(&writer);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int64_t vector_sprint(char *buffer, size_t size, struct vector *object, int precision, int64_t edge) {
+  if ((buffer == NULL && size > 0) || object == NULL || precision < 0 || edge < 0) {
+    return -1;
+  }
+  struct matrixmath_writer writer;
+  matrixmath_writer_init(&writer, NULL, buffer, size);
+  print_vector(&writer, object, precision, edge);
+  return matrixmath_writer_finish(&writer) ? -1 : writer.total;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_fprint(FILE *stream, struct matrix *object, int precision, int64_t edge) {
+  char buffer[PRINT_CHUNK];
+  if (stream == NULL || object == NULL || precision < 0 || edge < 0) {
+    return 1;
+  }
+  struct matrixmath_writer writer;
+  matrixmath_writer_init(&writer, stream, buffer, sizeof(buffer));
+  print_matrix(&writer, object, precision, edge);
+  return matrixmath_writer_finish(&writer);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int64_t matrix_sprint(char *buffer, size_t size, struct matrix *object, int precision, int64_t edge) {
+  if ((buffer == NULL && size > 0) || object == NULL || precision < 0 || edge < 0) {
+    return -1;
+  }
+  struct matrixmath_writer writer;
+  matrixmath_writer_init(&writer, NULL, buffer, size);
+  print_matrix(&writer, object, precision, edge);
+  return matrixmath_writer_finish(&writer) ? -1 : writer.total;
+}
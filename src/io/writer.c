@@ -0,0 +1,497 @@
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../include/matrixmath.h"
+
+/**
+ * The room kept for a value formatted on a fast path.
+ */
+#define WRITER_FIELD 64
+
+/**
+ * The largest precision formatted on the fixed-point fast path.
+ */
+#define WRITER_FIXED_PRECISION 17
+
+/**
+ * The largest scaled value formatted on the fixed-point fast path, 2^53: its
+ * fraction is still known to 2^-11, enough to round it like printf.
+ */
+#define WRITER_FIXED_LIMIT 9007199254740992.0L
+
+/**
+ * The number of significant digits that round-trip a long double.
+ */
+#define WRITER_DIGITS 21
+
+/**
+ * The largest power of five multiplied by a mantissa on the round-trip fast
+ * path, 5^27 fits 63 bits.
+ */
+#define WRITER_MAX_POWER 27
+
+/**
+ * The number of 32-bit limbs of the integers used on the round-trip fast path.
+ */
+#define WRITER_LIMBS 4
+
+/**
+ * The powers of ten used by the fixed-point fast path, all exact.
+ */
+static const uint64_t writer_powers[WRITER_FIXED_PRECISION + 1] = {
+  1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+  10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+  1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL};
+
+/**
+ * {@inheritdoc}
+ */
+void matrixmath_writer_init(struct matrixmath_writer *writer, FILE *stream, char *buffer, size_t size) {
+  writer->stream = stream;
+  writer->buffer = buffer;
+  writer->size = size;
+  writer->position = 0;
+  writer->total = 0;
+  writer->error = stream != NULL && (buffer == NULL || size == 0);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void matrixmath_writer_flush(struct matrixmath_writer *writer) {
+  if (writer->stream == NULL) {
+    return;
+  }
+  if (writer->error == 0 && writer->position > 0 && fwrite(writer->buffer, 1, writer->position, writer->stream) != writer->position) {
+    writer->error = 1;
+  }
+  writer->position = 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrixmath_writer_finish(struct matrixmath_writer *writer) {
+  if (writer->stream != NULL) {
+    matrixmath_writer_flush(writer);
+  }
+  else if (writer->size > 0) {
+    writer->buffer[writer->position] = '\0';
+  }
+  return writer->error;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void matrixmath_writer_put(struct matrixmath_writer *writer, const char *text, size_t length) {
+  writer->total += length;
+  if (writer->error != 0) {
+    return;
+  }
+  if (writer->stream != NULL) {
+    if (writer->position + length > writer->size) {
+      matrixmath_writer_flush(writer);
+    }
+    if (length > writer->size) {
+      writer->error |= fwrite(text, 1, length, writer->stream) != length;
+      return;
+    }
+  }
+  else {
+    // A caller buffer keeps room for the terminating null character, the
+    // text past it is only counted.
+    size_t room = writer->size > 0 ? writer->size - 1 - writer->position : 0;
+    length = length < room ? length : room;
+  }
+  memcpy(writer->buffer + writer->position, text, length);
+  writer->position += length;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void matrixmath_writer_put_char(struct matrixmath_writer *writer, char c) {
+  if (writer->stream != NULL && writer->error == 0 && writer->position < writer->size) {
+    writer->buffer[writer->position++] = c;
+    writer->total++;
+    return;
+  }
+  matrixmath_writer_put(writer, &c, 1);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void matrixmath_writer_put_index(struct matrixmath_writer *writer, int64_t value) {
+  char reversed[24];
+  char field[24];
+  int count = 0;
+  int length = 0;
+  uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+  do {
+    reversed[count++] = (char)('0' + magnitude % 10);
+    magnitude /= 10;
+  } while (magnitude > 0);
+  if (value < 0) {
+    field[length++] = '-';
+  }
+  while (count > 0) {
+    field[length++] = reversed[--count];
+  }
+  matrixmath_writer_put(writer, field, (size_t)length);
+}
+
+/**
+ * Format a value with a fixed number of decimals, as printf("%.*Lf").
+ *
+ * Values whose scaled magnitude fits 53 bits are rounded with integer
+ * arithmetic; the others, and the ones too close to a rounding tie to decide
+ * it from the scaled value, need snprintf.
+ *
+ * @param char* out
+ *   The field, WRITER_FIELD bytes.
+ * @param long double value
+ *   The value.
+ * @param int precision
+ *   The number of decimals.
+ *
+ * @return int
+ *   The length of the text, negative when it needs the slow path.
+ */
+static int writer_format_fixed(char *out, long double value, int precision) {
+  if (precision > WRITER_FIXED_PRECISION || !isfinite(value)) {
+    return -1;
+  }
+  long double scaled = fabsl(value) * writer_powers[precision];
+  if (scaled >= WRITER_FIXED_LIMIT) {
+    return -1;
+  }
+  long double whole = floorl(scaled);
+  long double fraction = scaled - whole;
+  // The scaled value is off by half an ulp at most, 2^-12 here.
+  if (fabsl(fraction - 0.5L) <= 0x1p-10L) {
+    return -1;
+  }
+  uint64_t digits = (uint64_t)whole + (fraction > 0.5L);
+  uint64_t integer = digits / writer_powers[precision];
+  uint64_t decimals = digits % writer_powers[precision];
+  char reversed[24];
+  int length = 0;
+  int count = 0;
+  if (signbit(value)) {
+    out[length++] = '-';
+  }
+  do {
+    reversed[count++] = (char)('0' + integer % 10);
+    integer /= 10;
+  } while (integer > 0);
+  while (count > 0) {
+    out[length++] = reversed[--count];
+  }
+  if (precision > 0) {
+    out[length++] = '.';
+    for (int i = precision - 1; i >= 0; i--) {
+      out[length + i] = (char)('0' + decimals % 10);
+      decimals /= 10;
+    }
+    length += precision;
+  }
+  return length;
+}
+
+/**
+ * Write a value formatted by snprintf, whatever its length.
+ *
+ * @param struct matrixmath_writer* writer
+ *   The writer.
+ * @param const char* format
+ *   The format, with a precision and a long double argument.
+ * @param int precision
+ *   The precision.
+ * @param long double value
+ *   The value.
+ */
+static void writer_put_printf(struct matrixmath_writer *writer, const char *format, int precision, long double value) {
+  char field[WRITER_FIELD];
+  int length = snprintf(field, sizeof(field), format, precision, value);
+  if (length < 0) {
+    writer->error = 1;
+    return;
+  }
+  if ((size_t)length < sizeof(field)) {
+    matrixmath_writer_put(writer, field, (size_t)length);
+    return;
+  }
+  // Huge values take up to thousands of digits.
+  char *text = malloc((size_t)length + 1);
+  if (text == NULL) {
+    writer->error = 1;
+    return;
+  }
+  snprintf(text, (size_t)length + 1, format, precision, value);
+  matrixmath_writer_put(writer, text, (size_t)length);
+  free(text);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void matrixmath_writer_put_fixed(struct matrixmath_writer *writer, long double value, int precision) {
+  char field[WRITER_FIELD];
+  int length = writer_format_fixed(field, value, precision);
+  if (length >= 0) {
+    matrixmath_writer_put(writer, field, (size_t)length);
+    return;
+  }
+  writer_put_printf(writer, "%.*Lf", precision, value);
+}
+
+/**
+ * Check whether any of the lowest bits of an integer is set.
+ *
+ * @param const uint32_t* limbs
+ *   The integer, WRITER_LIMBS limbs from the least significant one.
+ * @param int count
+ *   The number of bits, below 32 * WRITER_LIMBS.
+ *
+ * @return int
+ *   1 when one of the bits is set, otherwise 0.
+ */
+static int writer_any_below(const uint32_t *limbs, int count) {
+  int i = 0;
+  for (; i < count / 32; i++) {
+    if (limbs[i] != 0) {
+      return 1;
+    }
+  }
+  return count % 32 != 0 && (limbs[i] & ((1U << (count % 32)) - 1)) != 0;
+}
+
+/**
+ * Shift an integer by a number of bits.
+ *
+ * @param uint32_t* limbs
+ *   The integer, WRITER_LIMBS limbs from the least significant one.
+ * @param int count
+ *   The number of bits, to the left when positive, otherwise to the right.
+ *
+ * @return int
+ *   Returns 0 when no set bit was shifted out to the left, otherwise 1.
+ */
+static int writer_shift(uint32_t *limbs, int count) {
+  uint32_t result[WRITER_LIMBS] = {0};
+  int words = (count < 0 ? -count : count) / 32;
+  int bits = (count < 0 ? -count : count) % 32;
+  int source;
+  uint64_t value;
+  for (int i = 0; i < WRITER_LIMBS; i++) {
+    if (count >= 0) {
+      source = i - words;
+      value = source >= 0 ? (uint64_t)limbs[source] << bits : 0;
+      value |= source >= 1 && bits > 0 ? limbs[source - 1] >> (32 - bits) : 0;
+    }
+    else {
+      source = i + words;
+      value = source < WRITER_LIMBS ? limbs[source] >> bits : 0;
+      value |= source + 1 < WRITER_LIMBS && bits > 0 ? (uint64_t)limbs[source + 1] << (32 - bits) : 0;
+    }
+    result[i] = (uint32_t)value;
+  }
+  if (count > 0) {
+    // The bits shifted out are the ones the left shift back cannot restore.
+    for (int i = WRITER_LIMBS - words; i < WRITER_LIMBS; i++) {
+      if (limbs[i] != 0) {
+        return 1;
+      }
+    }
+    if (bits > 0 && (limbs[WRITER_LIMBS - 1 - words] >> (32 - bits)) != 0) {
+      return 1;
+    }
+  }
+  memcpy(limbs, result, sizeof(result));
+  return 0;
+}
+
+/**
+ * Format a value with WRITER_DIGITS significant digits, as printf("%.21Lg").
+ *
+ * The value m * 2^e is scaled by 10^q with exact integer arithmetic: the
+ * mantissa times 5^q fits 128 bits, the power of two is a shift. The decimal
+ * digits of the result are then rounded half to even on the exact remainder,
+ * so the text is the one printf writes. Very small values and mantissas wider
+ * than 64 bits need snprintf.
+ *
+ * @param char* out
+ *   The field, WRITER_FIELD bytes.
+ * @param long double value
+ *   The value.
+ *
+ * @return int
+ *   The length of the text, negative when it needs the slow path.
+ */
+static int writer_format_round_trip(char *out, long double value) {
+  int length = 0;
+  if (LDBL_MANT_DIG > 64 || !isfinite(value)) {
+    return -1;
+  }
+  if (signbit(value)) {
+    out[length++] = '-';
+  }
+  if (value == 0) {
+    out[length++] = '0';
+    return length;
+  }
+  int exponent;
+  long double fraction = frexpl(fabsl(value), &exponent);
+  uint64_t mantissa = (uint64_t)ldexpl(fraction, 64);
+  // The decimal exponent of the value is k or k + 1.
+  int k = (int)floorl((exponent - 1) * 0.30102999566398119521L);
+  int q = k < WRITER_DIGITS ? WRITER_DIGITS - k : 0;
+  if (q > WRITER_MAX_POWER) {
+    return -1;
+  }
+  uint64_t power = 1;
+  for (int i = 0; i < q; i++) {
+    power *= 5;
+  }
+  // The scaled value is mantissa * 5^q * 2^(exponent - 64 + q).
+  uint64_t a0 = mantissa & 0xffffffffULL;
+  uint64_t a1 = mantissa >> 32;
+  uint64_t b0 = power & 0xffffffffULL;
+  uint64_t b1 = power >> 32;
+  uint64_t middle = a0 * b1;
+  uint64_t cross = a1 * b0;
+  uint64_t carry = a0 * b0;
+  uint32_t limbs[WRITER_LIMBS];
+  limbs[0] = (uint32_t)carry;
+  carry = (carry >> 32) + (middle & 0xffffffffULL) + (cross & 0xffffffffULL);
+  limbs[1] = (uint32_t)carry;
+  carry = (carry >> 32) + (middle >> 32) + (cross >> 32) + ((a1 * b1) & 0xffffffffULL);
+  limbs[2] = (uint32_t)carry;
+  limbs[3] = (uint32_t)((carry >> 32) + ((a1 * b1) >> 32));
+  int shift = exponent - 64 + q;
+  if (shift >= 32 * WRITER_LIMBS) {
+    return -1;
+  }
+  int half = 0;
+  int below = 0;
+  if (shift < 0) {
+    if (-shift >= 32 * WRITER_LIMBS) {
+      return -1;
+    }
+    half = (limbs[(-shift - 1) / 32] >> ((-shift - 1) % 32)) & 1;
+    below = writer_any_below(limbs, -shift - 1);
+  }
+  if (writer_shift(limbs, shift) != 0) {
+    return -1;
+  }
+  // Extract the decimal digits by chunks of nine.
+  char digits[48];
+  int count = 0;
+  uint64_t remainder;
+  int empty = 0;
+  while (!empty) {
+    remainder = 0;
+    empty = 1;
+    for (int i = WRITER_LIMBS - 1; i >= 0; i--) {
+      remainder = (remainder << 32) | limbs[i];
+      limbs[i] = (uint32_t)(remainder / 1000000000ULL);
+      remainder %= 1000000000ULL;
+      empty &= limbs[i] == 0;
+    }
+    for (int i = 0; i < 9; i++) {
+      digits[count++] = (char)('0' + remainder % 10);
+      remainder /= 10;
+    }
+  }
+  while (count > 1 && digits[count - 1] == '0') {
+    count--;
+  }
+  // Most significant digit first.
+  for (int i = 0; i < count / 2; i++) {
+    char swap = digits[i];
+    digits[i] = digits[count - 1 - i];
+    digits[count - 1 - i] = swap;
+  }
+  int decimal = count - 1 - q;
+  int up;
+  if (count > WRITER_DIGITS) {
+    int rest = half || below;
+    for (int i = WRITER_DIGITS + 1; i < count && !rest; i++) {
+      rest = digits[i] != '0';
+    }
+    up = digits[WRITER_DIGITS] > '5' || (digits[WRITER_DIGITS] == '5' && (rest || (digits[WRITER_DIGITS - 1] - '0') % 2 == 1));
+    count = WRITER_DIGITS;
+  }
+  else {
+    up = half && (below || (digits[count - 1] - '0') % 2 == 1);
+  }
+  if (up) {
+    int i = count - 1;
+    while (i >= 0 && digits[i] == '9') {
+      digits[i--] = '0';
+    }
+    if (i < 0) {
+      digits[0] = '1';
+      decimal++;
+    }
+    else {
+      digits[i]++;
+    }
+  }
+  while (count > 1 && digits[count - 1] == '0') {
+    count--;
+  }
+  if (decimal < -4 || decimal >= WRITER_DIGITS) {
+    out[length++] = digits[0];
+    if (count > 1) {
+      out[length++] = '.';
+      memcpy(out + length, digits + 1, (size_t)count - 1);
+      length += count - 1;
+    }
+    out[length++] = 'e';
+    out[length++] = decimal < 0 ? '-' : '+';
+    decimal = decimal < 0 ? -decimal : decimal;
+    if (decimal >= 100) {
+      out[length++] = (char)('0' + decimal / 100);
+    }
+    out[length++] = (char)('0' + decimal / 10 % 10);
+    out[length++] = (char)('0' + decimal % 10);
+    return length;
+  }
+  if (decimal < 0) {
+    out[length++] = '0';
+    out[length++] = '.';
+    for (int i = 0; i < -decimal - 1; i++) {
+      out[length++] = '0';
+    }
+    memcpy(out + length, digits, (size_t)count);
+    return length + count;
+  }
+  for (int i = 0; i <= decimal; i++) {
+    out[length++] = i < count ? digits[i] : '0';
+  }
+  if (count > decimal + 1) {
+    out[length++] = '.';
+    memcpy(out + length, digits + decimal + 1, (size_t)(count - decimal - 1));
+    length += count - decimal - 1;
+  }
+  return length;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void matrixmath_writer_put_value(struct matrixmath_writer *writer, long double value) {
+  char field[WRITER_FIELD];
+  int length = writer_format_round_trip(field, value);
+  if (length >= 0) {
+    matrixmath_writer_put(writer, field, (size_t)length);
+    return;
+  }
+  writer_put_printf(writer, "%.*Lg", WRITER_DIGITS, value);
+}
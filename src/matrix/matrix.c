@@ -1,14 +1,21 @@
 #include <stdlib.h>
+#include <string.h>
 #include "../../include/matrixmath.h"
 
 /**
  * {@inheritdoc}
  */
-struct matrix *matrix_create(const int rows, const int columns) {
+struct matrix *matrix_create(const int64_t rows, const int64_t columns) {
+  size_t count;
+  size_t bytes;
   if (rows <= 0 || columns <= 0) {
     // Matrix with no capacity not allowed.
     return NULL;
   }
+  // Neither the number of elements nor the number of bytes may wrap around.
+  if (matrixmath_size_mul((size_t)rows, (size_t)columns, &count) != 0 || matrixmath_size_mul(count, sizeof(long double), &bytes) != 0) {
+    return NULL;
+  }
   // Allocate memory for the matrix structure.
   size_t size = sizeof(struct matrix);
   struct matrix *object = malloc(size);
@@ -18,21 +25,18 @@ struct matrix *matrix_create(const int rows, const int columns) {
   // Init matrix object properties.
   object->rows = rows;
   object->columns = columns;
-  // Try to set the requested matrix capacity.
-  size_t matrix_size = sizeof(struct vector *) * object->rows;
-  object->items = malloc(matrix_size);
-  if (object->items == NULL) {
+  object->release = matrixmath_release_allocated;
+  object->release_context = NULL;
+  object->shared = NULL;
+  // Try to set the requested matrix capacity, zero initialized by the threads
+  // computing the rows.
+  struct matrixmath_allocator *allocator;
+  object->data = matrixmath_allocate(rows, columns, NULL, &allocator);
+  if (object->data == NULL) {
     matrix_destroy(object);
     return NULL;
   }
-  // Initialize the mtrix row/columns elements.
-  for (int i = 0; i < object->rows; i++) {
-    object->items[i] = vector_create(object->columns);
-    if (object->items[i] == NULL) {
-      matrix_destroy(object);
-      return NULL;
-    }
-  }
+  object->release_context = allocator;
   // Return the matrix object.
   return object;
 }
@@ -40,7 +44,7 @@ struct matrix *matrix_create(const int rows, const int columns) {
 /**
  * {@inheritdoc}
  */
-struct matrix *matrix_create_random(const int rows, const int columns, const long double min, const long double max) {
+struct matrix *matrix_create_random(const int64_t rows, const int64_t columns, const long double min, const long double max) {
   // Create a new matrix object instance.
   struct matrix *object = matrix_create(rows, columns);
   if (object == NULL) {
@@ -52,6 +56,35 @@ struct matrix *matrix_create_random(const int rows, const int columns, const lon
   return object;
 }
 
+/**
+ * {@inheritdoc}
+ */
+struct matrix *matrix_wrap(long double *data, const int64_t rows, const int64_t columns, void (*release)(void *context, long double *data), void *context) {
+  size_t count;
+  size_t bytes;
+  if (data == NULL || rows <= 0 || columns <= 0) {
+    return NULL;
+  }
+  if (matrixmath_size_mul((size_t)rows, (size_t)columns, &count) != 0 || matrixmath_size_mul(count, sizeof(long double), &bytes) != 0) {
+    return NULL;
+  }
+  // The kernels address the values as long double, the buffer must allow it.
+  if ((uintptr_t)data % _Alignof(long double) != 0) {
+    return NULL;
+  }
+  struct matrix *object = malloc(sizeof(struct matrix));
+  if (object == NULL) {
+    return NULL;
+  }
+  object->data = data;
+  object->rows = rows;
+  object->columns = columns;
+  object->release = release;
+  object->release_context = context;
+  object->shared = NULL;
+  return object;
+}
+
 /**
  * {@inheritdoc}
  */
@@ -59,14 +92,15 @@ void matrix_destroy(struct matrix *object) {
   if (object == NULL) {
     return;
   }
-  // Free the object items.
-  for (int i = 0; i < object->rows; i++) {
-    if (object->items[i] != NULL) {
-      vector_destroy(object->items[i]);
-    }
+  // Release the object values, unless they are borrowed; shared values are
+  // released by the last object using them.
+  if (object->shared != NULL) {
+    matrixmath_shared_release(object->shared);
   }
-  free(object->items);
-  object->items = NULL;
+  else if (object->release != NULL && object->data != NULL) {
+    object->release(object->release_context, object->data);
+  }
+  object->data = NULL;
   // Free the matrix structure itself.
   free(object);
 }
@@ -74,7 +108,7 @@ void matrix_destroy(struct matrix *object) {
 /**
  * {@inheritdoc}
  */
-int matrix_check_boundaries(struct matrix *object, int j, int k) {
+int matrix_check_boundaries(struct matrix *object, int64_t j, int64_t k) {
   if (object == NULL || j < 0 || j >= object->rows || k < 0 || k >= object->columns) {
     return 0;
   }
@@ -84,41 +118,43 @@ int matrix_check_boundaries(struct matrix *object, int j, int k) {
 /**
  * {@inheritdoc}
  */
-long double *matrix_setl(struct matrix *object, int j, int k, long double value) {
+long double *matrix_setl(struct matrix *object, int64_t j, int64_t k, long double value) {
   // Check if the requested positions are valid.
-  if (matrix_check_boundaries(object, j, k) == 0) {
+  if (matrix_check_boundaries(object, j, k) == 0 || matrix_detach(object) != 0) {
     return NULL;
   }
-  // Get the vector in the position j.
-  struct vector *vector_object = object->items[j];
-  if (vector_object == NULL) {
-    return NULL;
-  }
-  // Store the value in the vector in the k position.
-  return vector_setl(vector_object, k, value);
+  // Store the value in place.
+  long double *item = object->data + (size_t)j * object->columns + k;
+  *item = value;
+  return item;
 }
 
 /**
  * {@inheritdoc}
  */
-long double *matrix_getl(struct matrix *object, int j, int k) {
+long double *matrix_getl(struct matrix *object, int64_t j, int64_t k) {
   // Check if the requested positions are valid.
-  if (matrix_check_boundaries(object, j, k) == 0) {
+  if (matrix_check_boundaries(object, j, k) == 0 || matrix_detach(object) != 0) {
     return NULL;
   }
-  // Get the vector in the position j.
-  struct vector *vector_object = object->items[j];
-  if (vector_object == NULL) {
+  // Get the value in the j row and the k column.
+  return object->data + (size_t)j * object->columns + k;
+}
+
+/**
+ * {@inheritdoc}
+ */
+long double *matrix_data(struct matrix *object) {
+  if (object == NULL || matrix_detach(object) != 0) {
     return NULL;
   }
-  // Get the value from the vector in the k position.
-  return vector_getl(vector_object, k);
+  return object->data;
 }
 
 /**
  * {@inheritdoc}
  */
-struct matrix *matrix_from_array(long double *array, const int rows, const int columns) {
+struct matrix *matrix_from_array(long double *array, const int64_t rows, const int64_t columns) {
   struct matrix *object = matrix_create(rows, columns);
   if (object == NULL) {
     return NULL;
@@ -130,28 +166,47 @@ struct matrix *matrix_from_array(long double *array, const int rows, const int c
 /**
  * {@inheritdoc}
  */
-void matrix_fill_from_array(long double *array, struct matrix *object, const int rows, const int columns) {
-  if (object == NULL || array == NULL || rows <= 0 || columns <= 0) {
+void matrix_fill_from_array(long double *array, struct matrix *object, const int64_t rows, const int64_t columns) {
+  if (object == NULL || array == NULL || rows <= 0 || columns <= 0 || matrix_detach(object) != 0) {
+    return;
+  }
+  // Same layout: copy the whole block at once.
+  if (rows == object->rows && columns == object->columns) {
+    memcpy(object->data, array, sizeof(long double) * rows * columns);
     return;
   }
-  long double *value;
-  for (int j = 0; j < rows; j++) {
-    for (int k = 0; k < columns; k++) {
-      value = (array + j * columns) + k;
-      matrix_setl(object, j, k, *value);
-    }
+  // Different layouts: copy the overlapping part row by row.
+  int64_t copy_rows = rows < object->rows ? rows : object->rows;
+  int64_t copy_columns = columns < object->columns ? columns : object->columns;
+  for (int64_t j = 0; j < copy_rows; j++) {
+    memcpy(object->data + (size_t)j * object->columns, array + (size_t)j * columns, sizeof(long double) * copy_columns);
+  }
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_walk(struct matrix *a, long double (*callback)(long double)) {
+  // Check for NULL pointers.
+  if (a == NULL || callback == NULL || matrix_detach(a) != 0) {
+    return 0;
+  }
+  long double *data = a->data;
+  size_t size = (size_t)a->rows * a->columns;
+  for (size_t i = 0; i < size; i++) {
+    data[i] = callback(data[i]);
   }
+  return 1;
 }
 
 /**
  * {@inheritdoc}
  */
 void matrix_fill(struct matrix *object, const long double value) {
-  for (size_t j = 0; j < object->rows; j++) {
-    for (size_t k = 0; k < object->columns; k++) {
-      matrix_setl(object, j, k, value);
-    }
+  if (object == NULL || matrix_detach(object) != 0) {
+    return;
   }
+  matrixmath_fill(object->data, object->rows, object->columns, value);
 }
 
 /**
@@ -159,15 +214,11 @@ void matrix_fill(struct matrix *object, const long double value) {
  */
 void matrix_fill_random(struct matrix *object, const long double min, const long double max) {
   // Handle NULL matrix object.
-  if (object == NULL) {
+  if (object == NULL || matrix_detach(object) != 0) {
     return;
   }
-  // Assign a random value to each element in the matrix.
-  for (size_t j = 0; j < object->rows; j++) {
-    if (object->items[j] != NULL) {
-      vector_fill_random(object->items[j], min, max);
-    }
-  }
+  // Draw the values from the library default generator.
+  random_fill_uniform(NULL, object->data, (size_t)object->rows * object->columns, min, max);
 }
 
 /**
@@ -177,14 +228,62 @@ int matrix_copy(struct matrix *src, struct matrix *dest) {
   if (src == NULL || dest == NULL || src->rows != dest->rows || src->columns != dest->columns) {
     return 1;
   }
-  long double *value;
-  for (int i = 0; i < src->rows; i++) {
-    for (int j = 0; j < src->columns; j++) {
-      value = matrix_getl(src, i, j);
-      if (value != NULL) {
-        matrix_setl(dest, i, j, *value);
-      }
-    }
+  if (matrix_detach(dest) != 0) {
+    return 1;
+  }
+  // Copying a matrix into itself is a no-op.
+  if (src != dest) {
+    memcpy(dest->data, src->data, sizeof(long double) * src->rows * src->columns);
+  }
+  return 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct matrix *matrix_clone(struct matrix *a) {
+  if (a == NULL) {
+    return NULL;
+  }
+  // Share the values, they are copied by the first write to either matrix.
+  struct matrixmath_shared *shared = matrixmath_shared_get(&a->shared, a->data, a->release, a->release_context);
+  if (shared == NULL) {
+    return NULL;
+  }
+  struct matrix *result = malloc(sizeof(struct matrix));
+  if (result == NULL) {
+    return NULL;
+  }
+  matrixmath_shared_retain(shared);
+  result->data = a->data;
+  result->rows = a->rows;
+  result->columns = a->columns;
+  result->release = NULL;
+  result->release_context = NULL;
+  result->shared = shared;
+  return result;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_detach(struct matrix *object) {
+  if (object == NULL) {
+    return 1;
+  }
+  if (object->shared == NULL || matrixmath_shared_unique(object->shared)) {
+    return 0;
+  }
+  struct matrixmath_allocator *allocator;
+  long double *data = matrixmath_allocate(object->rows, object->columns, object->data, &allocator);
+  if (data == NULL) {
+    return 1;
   }
+  // Drop the reference only once the values are copied.
+  matrixmath_shared_release(object->shared);
+  object->data = data;
+  object->release = matrixmath_release_allocated;
+  object->release_context = allocator;
+  object->shared = NULL;
   return 0;
 }
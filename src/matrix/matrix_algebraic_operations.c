@@ -2,6 +2,123 @@
 #include <error.h>
 #include "../../include/matrixmath.h"
 
+/**
+ * The number of multiply-add operations below which a product is not split
+ * across threads.
+ */
+#define MATRIX_GEMM_PARALLEL_GRAIN 32768
+
+/**
+ * The number of rows of b, and columns of a, walked at once by the product.
+ */
+#define MATRIX_GEMM_DEPTH 128
+
+/**
+ * The number of columns of b and c walked at once by the product.
+ *
+ * A panel of b, 128 x 256 long doubles, fits in the L2 cache and is reused by
+ * all the rows of a chunk.
+ */
+#define MATRIX_GEMM_WIDTH 256
+
+/**
+ * The data struct definition for a matrix product in progress.
+ */
+struct matrix_gemm {
+  int64_t n;
+  int64_t k;
+  long double alpha;
+  const long double *a;
+  int64_t lda;
+  const long double *b;
+  int64_t ldb;
+  long double beta;
+  long double *c;
+  int64_t ldc;
+};
+
+/**
+ * Parallel loop body of the matrix product, the loop runs over rows of c.
+ *
+ * Each element of c accumulates its products in the order of k, whatever the
+ * split across threads, so the result does not depend on the thread count.
+ *
+ * @param void* context
+ *   The matrix_gemm object.
+ * @param int64_t start
+ *   The first row.
+ * @param int64_t end
+ *   The row after the last one.
+ */
+static void matrix_gemm_rows(void *context, int64_t start, int64_t end) {
+  struct matrix_gemm *gemm = (struct matrix_gemm *)context;
+  const long double *restrict row_b;
+  long double *restrict row_c;
+  long double val;
+  int64_t last_l;
+  int64_t last_j;
+  // Scale c first, without reading it when beta is 0.
+  for (int64_t i = start; i < end; i++) {
+    row_c = gemm->c + (size_t)i * gemm->ldc;
+    for (int64_t j = 0; j < gemm->n; j++) {
+      row_c[j] = gemm->beta == 0 ? 0 : gemm->beta * row_c[j];
+    }
+  }
+  for (int64_t j0 = 0; j0 < gemm->n; j0 += MATRIX_GEMM_WIDTH) {
+    last_j = j0 + MATRIX_GEMM_WIDTH < gemm->n ? j0 + MATRIX_GEMM_WIDTH : gemm->n;
+    for (int64_t l0 = 0; l0 < gemm->k; l0 += MATRIX_GEMM_DEPTH) {
+      last_l = l0 + MATRIX_GEMM_DEPTH < gemm->k ? l0 + MATRIX_GEMM_DEPTH : gemm->k;
+      for (int64_t i = start; i < end; i++) {
+        row_c = gemm->c + (size_t)i * gemm->ldc;
+        for (int64_t l = l0; l < last_l; l++) {
+          val = gemm->alpha * gemm->a[(size_t)i * gemm->lda + l];
+          row_b = gemm->b + (size_t)l * gemm->ldb;
+          for (int64_t j = j0; j < last_j; j++) {
+            row_c[j] += val * row_b[j];
+          }
+        }
+      }
+    }
+  }
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_gemm_strided(int64_t m, int64_t n, int64_t k, long double alpha, const long double *a, int64_t lda, const long double *b, int64_t ldb, long double beta, long double *c, int64_t ldc) {
+  if (m < 0 || n < 0 || k < 0 || (m > 0 && n > 0 && (a == NULL || b == NULL || c == NULL))) {
+    return 1;
+  }
+  if (lda < k || ldb < n || ldc < n) {
+    return 1;
+  }
+  // An empty product has nothing to write.
+  if (m == 0 || n == 0) {
+    return 0;
+  }
+  struct matrix_gemm gemm = {n, k, alpha, a, lda, b, ldb, beta, c, ldc};
+  int64_t work = (int64_t)n * (k > 0 ? k : 1);
+  int64_t grain = work >= MATRIX_GEMM_PARALLEL_GRAIN ? 1 : MATRIX_GEMM_PARALLEL_GRAIN / work;
+  return matrixmath_parallel_for(m, grain, matrix_gemm_rows, &gemm);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_gemm(long double alpha, struct matrix *a, struct matrix *b, long double beta, struct matrix *c) {
+  if (a == NULL || b == NULL || c == NULL || a->columns != b->rows) {
+    return 1;
+  }
+  if (c->rows != a->rows || c->columns != b->columns || matrix_detach(c) != 0) {
+    return 1;
+  }
+  // The rows of c are written while a and b are still read.
+  if (c->data == a->data || c->data == b->data) {
+    return 1;
+  }
+  return matrix_gemm_strided(a->rows, b->columns, a->columns, alpha, a->data, a->columns, b->data, b->columns, beta, c->data, c->columns);
+}
+
 /**
  * {@inheritdoc}
  */
@@ -16,21 +133,7 @@ struct matrix *matrix_add(struct matrix *a, struct matrix *b) {
     return NULL;
   }
   // Sum the values.
-  long double *val1;
-  long double *val2;
-  long double sum = 0;
-  for (int j = 0; j < a->rows; j++) {
-    for (int k = 0; k < a->columns; k++) {
-      val1 = matrix_getl(a, j, k);
-      val2 = matrix_getl(b, j, k);
-      if (val1 == NULL || val2 == NULL) {
-        free(result);
-        return NULL;
-      }
-      sum = *val1 + *val2;
-      matrix_setl(result, j, k, sum);
-    }
-  }
+  matrix_add_dest(a, b, result);
   // Return the result of the operation.
   return result;
 }
@@ -43,24 +146,18 @@ int matrix_add_dest(struct matrix *a, struct matrix *b, struct matrix *dest) {
   if (a->rows != b->rows || a->columns != b->columns) {
     return 1;
   }
-  // Check if the destination matrix matches the expected dimensions.
-  if (dest->rows != a->rows || dest->columns != a->columns) {
+  // Check if the destination matrix matches the expected dimensions, and that
+  // its values are its own.
+  if (dest->rows != a->rows || dest->columns != a->columns || matrix_detach(dest) != 0) {
     return 1;
   }
   // Sum the values.
-  long double *val1;
-  long double *val2;
-  long double sum = 0;
-  for (int j = 0; j < a->rows; j++) {
-    for (int k = 0; k < a->columns; k++) {
-      val1 = matrix_getl(a, j, k);
-      val2 = matrix_getl(b, j, k);
-      if (val1 == NULL || val2 == NULL) {
-        return 1;
-      }
-      sum = *val1 + *val2;
-      matrix_setl(dest, j, k, sum);
-    }
+  long double *val1 = a->data;
+  long double *val2 = b->data;
+  long double *sum = dest->data;
+  size_t size = (size_t)a->rows * a->columns;
+  for (size_t i = 0; i < size; i++) {
+    sum[i] = val1[i] + val2[i];
   }
   // Return the result of the operation.
   return 0;
@@ -80,21 +177,7 @@ struct matrix *matrix_sub(struct matrix *a, struct matrix *b) {
     return NULL;
   }
   // Subtract the values.
-  long double *val1;
-  long double *val2;
-  long double sub = 0;
-  for (int j = 0; j < a->rows; j++) {
-    for (int k = 0; k < a->columns; k++) {
-      val1 = matrix_getl(a, j, k);
-      val2 = matrix_getl(b, j, k);
-      if (val1 == NULL || val2 == NULL) {
-        free(result);
-        return NULL;
-      }
-      sub = *val1 - *val2;
-      matrix_setl(result, j, k, sub);
-    }
-  }
+  matrix_sub_dest(a, b, result);
   // Return the result of the operation.
   return result;
 }
@@ -107,24 +190,18 @@ int matrix_sub_dest(struct matrix *a, struct matrix *b, struct matrix *dest) {
   if (a->rows != b->rows || a->columns != b->columns) {
     return 1;
   }
-  // Check if the destination matrix matches the expected dimensions.
-  if (dest->rows != a->rows || dest->columns != a->columns) {
+  // Check if the destination matrix matches the expected dimensions, and that
+  // its values are its own.
+  if (dest->rows != a->rows || dest->columns != a->columns || matrix_detach(dest) != 0) {
     return 1;
   }
   // Subtract the values.
-  long double *val1;
-  long double *val2;
-  long double sub = 0;
-  for (int j = 0; j < a->rows; j++) {
-    for (int k = 0; k < a->columns; k++) {
-      val1 = matrix_getl(a, j, k);
-      val2 = matrix_getl(b, j, k);
-      if (val1 == NULL || val2 == NULL) {
-        return 1;
-      }
-      sub = *val1 - *val2;
-      matrix_setl(dest, j, k, sub);
-    }
+  long double *val1 = a->data;
+  long double *val2 = b->data;
+  long double *sub = dest->data;
+  size_t size = (size_t)a->rows * a->columns;
+  for (size_t i = 0; i < size; i++) {
+    sub[i] = val1[i] - val2[i];
   }
   // Return the result of the operation.
   return 0;
@@ -148,22 +225,8 @@ struct matrix *matrix_mul(struct matrix *a, struct matrix *b) {
   if (c == NULL) {
     return NULL;
   }
-  // Mul the values.
-  long double *val1;
-  long double *val2;
-  long double result = 0;
-  for (int j = 0; j < a->rows; j++) {
-    for (int k = 0; k < b->columns; k++) {
-      result = 0;
-
-      for (int l = 0; l < b->rows; l++) {
-        val1 = matrix_getl(a, j, l);
-        val2 = matrix_getl(b, l, k);
-        result += (*val1) * (*val2);
-      }
-      matrix_setl(c, j, k, result);
-    }
-  }
+  // Mul the values, blocked and split across threads.
+  matrix_gemm(1, a, b, 0, c);
   // Return the result of the operation.
   return c;
 }
@@ -175,7 +238,7 @@ struct vector *matrix_mul_vector(struct matrix *a, struct vector *b) {
   // To perform multiplication between a matrix and a vector, we must
   // make sure that the number of columns in the matrix is equal
   // to the rows in the vector.
-  if (a->columns != b->capacity) {
+  if (a == NULL || b == NULL || a->columns != b->capacity) {
     return NULL;
   }
   // Create the new Vector to store the result of the operation.
@@ -184,20 +247,42 @@ struct vector *matrix_mul_vector(struct matrix *a, struct vector *b) {
     return NULL;
   }
   // Mul the values.
-  long double *val1;
-  long double *val2;
+  matrix_mul_vector_dest(a, b, c);
+  // Return the result of the operation.
+  return c;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_mul_vector_dest(struct matrix *a, struct vector *b, struct vector *dest) {
+  // The number of columns in the matrix must match the size of the vector.
+  if (a == NULL || b == NULL || dest == NULL || a->columns != b->capacity) {
+    return 1;
+  }
+  // Check if the destination vector matches the expected size, and that its
+  // values are its own.
+  if (dest->capacity != a->rows || vector_detach(dest) != 0) {
+    return 1;
+  }
+  // Every row reads all of b, it cannot be overwritten.
+  if (b->data == dest->data) {
+    return 1;
+  }
+  // Mul the values.
+  long double *row;
+  long double *val2 = b->data;
   long double result = 0;
-  for (int j = 0; j < a->rows; j++) {
+  for (int64_t j = 0; j < a->rows; j++) {
+    row = a->data + (size_t)j * a->columns;
     result = 0;
-    for (int k = 0; k < a->columns; k++) {
-      val1 = matrix_getl(a, j, k);
-      val2 = vector_getl(b, k);
-      result += (*val1) * (*val2);
+    for (int64_t k = 0; k < a->columns; k++) {
+      result += row[k] * val2[k];
     }
-    vector_setl(c, j, result);
+    dest->data[j] = result;
   }
   // Return the result of the operation.
-  return c;
+  return 0;
 }
 
 /**
@@ -210,38 +295,26 @@ struct matrix *matrix_scalar_mul(long double scalar, struct matrix *a) {
     return NULL;
   }
   // Mul the values.
-  long double *val;
-  long double mul;
-  for (int j = 0; j < a->rows; j++) {
-    for (int k = 0; k < a->columns; k++) {
-      val = matrix_getl(a, j, k);
-      if (val == NULL) {
-        return NULL;
-      }
-      mul = scalar * (*val);
-      matrix_setl(result, j, k, mul);
-    }
-  }
+  matrix_scalar_mul_dest(scalar, a, result);
   // Return the result of the operation.
-  return NULL;
+  return result;
 }
 
 /**
  * {@inheritdoc}
  */
 int matrix_scalar_mul_dest(long double scalar, struct matrix *a, struct matrix *dest) {
+  // Check if the destination matrix matches the expected dimensions, and that
+  // its values are its own.
+  if (dest->rows != a->rows || dest->columns != a->columns || matrix_detach(dest) != 0) {
+    return 1;
+  }
   // Mul the values.
-  long double *val;
-  long double mul;
-  for (int j = 0; j < a->rows; j++) {
-    for (int k = 0; k < a->columns; k++) {
-      val = matrix_getl(a, j, k);
-      if (val == NULL) {
-        return 1;
-      }
-      mul = scalar * (*val);
-      matrix_setl(dest, j, k, mul);
-    }
+  long double *val = a->data;
+  long double *mul = dest->data;
+  size_t size = (size_t)a->rows * a->columns;
+  for (size_t i = 0; i < size; i++) {
+    mul[i] = scalar * val[i];
   }
   // Return the result of the operation.
   return 0;
@@ -261,11 +334,9 @@ struct matrix *matrix_transpose(struct matrix *a) {
     return NULL;
   }
   // Fill the transposed matrix.
-  long double *value;
-  for (int i = 0; i < a->rows; ++i) {
-    for (int j = 0; j < a->columns; ++j) {
-      value = matrix_getl(a, i, j);
-      matrix_setl(transposed, j, i, *value);
+  for (int64_t i = 0; i < a->rows; ++i) {
+    for (int64_t j = 0; j < a->columns; ++j) {
+      transposed->data[(size_t)j * a->rows + i] = a->data[(size_t)i * a->columns + j];
     }
   }
   return transposed;
@@ -0,0 +1,434 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../../include/matrixmath.h"
+
+/**
+ * The number of stored elements below which a banded product is not split
+ * across threads.
+ */
+#define BANDED_MATRIX_PARALLEL_GRAIN 16384
+
+/**
+ * {@inheritdoc}
+ */
+struct banded_matrix *banded_matrix_create(const int64_t size, const int64_t lower, const int64_t upper) {
+  size_t count;
+  if (size < 0 || lower < 0 || upper < 0) {
+    return NULL;
+  }
+  // The number of stored values must not wrap around.
+  if (matrixmath_size_mul((size_t)size, (size_t)(lower + upper + 1), &count) != 0 || count == SIZE_MAX) {
+    return NULL;
+  }
+  // Allocate the banded matrix memory space.
+  struct banded_matrix *object = malloc(sizeof(struct banded_matrix));
+  if (object == NULL) {
+    return NULL;
+  }
+  // Every row stores lower + upper + 1 values, zero initialized; the corners
+  // outside the matrix are kept and stay zero.
+  object->width = lower + upper + 1;
+  object->data = calloc(count + 1, sizeof(long double));
+  if (object->data == NULL) {
+    free(object);
+    return NULL;
+  }
+  object->size = size;
+  object->lower = lower;
+  object->upper = upper;
+  return object;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void banded_matrix_destroy(struct banded_matrix *object) {
+  if (object == NULL) {
+    return;
+  }
+  free(object->data);
+  object->data = NULL;
+  object->size = 0;
+  free(object);
+}
+
+/**
+ * {@inheritdoc}
+ */
+long double *banded_matrix_getl(struct banded_matrix *object, int64_t row, int64_t column) {
+  if (object == NULL || row < 0 || column < 0 || row >= object->size || column >= object->size) {
+    return NULL;
+  }
+  if (column < row - object->lower || column > row + object->upper) {
+    return NULL;
+  }
+  return object->data + (size_t)row * object->width + (column - row + object->lower);
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct banded_matrix *banded_matrix_from_matrix(struct matrix *a, const int64_t lower, const int64_t upper) {
+  if (a == NULL || a->rows != a->columns) {
+    return NULL;
+  }
+  struct banded_matrix *object = banded_matrix_create(a->rows, lower, upper);
+  if (object == NULL) {
+    return NULL;
+  }
+  int64_t n = a->rows;
+  int64_t first;
+  int64_t last;
+  for (int64_t i = 0; i < n; i++) {
+    first = i - lower > 0 ? i - lower : 0;
+    last = i + upper < n - 1 ? i + upper : n - 1;
+    for (int64_t j = first; j <= last; j++) {
+      object->data[(size_t)i * object->width + (j - i + lower)] = a->data[(size_t)i * n + j];
+    }
+  }
+  return object;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct matrix *banded_matrix_to_matrix(struct banded_matrix *object) {
+  if (object == NULL) {
+    return NULL;
+  }
+  int64_t n = object->size;
+  struct matrix *result = matrix_create(n, n);
+  if (result == NULL) {
+    return NULL;
+  }
+  matrix_fill(result, 0);
+  int64_t first;
+  int64_t last;
+  for (int64_t i = 0; i < n; i++) {
+    first = i - object->lower > 0 ? i - object->lower : 0;
+    last = i + object->upper < n - 1 ? i + object->upper : n - 1;
+    for (int64_t j = first; j <= last; j++) {
+      result->data[(size_t)i * n + j] = object->data[(size_t)i * object->width + (j - i + object->lower)];
+    }
+  }
+  return result;
+}
+
+/**
+ * The data struct definition for a banded product in progress.
+ */
+struct banded_matrix_product {
+  const struct banded_matrix *a;
+  const long double *x;
+  long double *y;
+};
+
+/**
+ * Parallel loop body of the banded product, the loop runs over rows.
+ *
+ * Row i only meets the elements of x between i - lower and i + upper, so every
+ * row is a short contiguous inner product.
+ *
+ * @param void* context
+ *   The banded_matrix_product object.
+ * @param int64_t start
+ *   The first row.
+ * @param int64_t end
+ *   The row after the last one.
+ */
+static void banded_matrix_product_rows(void *context, int64_t start, int64_t end) {
+  struct banded_matrix_product *product = (struct banded_matrix_product *)context;
+  const struct banded_matrix *a = product->a;
+  const long double *restrict row;
+  const long double *restrict x;
+  long double sum;
+  int64_t first;
+  int64_t last;
+  for (int64_t i = start; i < end; i++) {
+    first = i - a->lower > 0 ? i - a->lower : 0;
+    last = i + a->upper < a->size - 1 ? i + a->upper : a->size - 1;
+    row = a->data + (size_t)i * a->width + (first - i + a->lower);
+    x = product->x + first;
+    sum = 0;
+    for (int64_t j = 0; j <= last - first; j++) {
+      sum += row[j] * x[j];
+    }
+    product->y[i] = sum;
+  }
+}
+
+/**
+ * {@inheritdoc}
+ */
+int banded_matrix_mul_vector_dest(struct banded_matrix *object, struct vector *x, struct vector *dest) {
+  if (object == NULL || x == NULL || dest == NULL || x->capacity != object->size || dest->capacity != object->size || vector_detach(dest) != 0) {
+    return 1;
+  }
+  // Every row reads several elements of x, it cannot be overwritten.
+  if (x->data == dest->data) {
+    return 1;
+  }
+  struct banded_matrix_product product = {object, x->data, dest->data};
+  int64_t grain = BANDED_MATRIX_PARALLEL_GRAIN / object->width;
+  return matrixmath_parallel_for(object->size, grain > 0 ? grain : 1, banded_matrix_product_rows, &product);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int banded_operator_apply(void *context, struct vector *x, struct vector *y) {
+  return banded_matrix_mul_vector_dest((struct banded_matrix *)context, x, y);
+}
+
+/**
+ * Solve a tridiagonal system with the Thomas algorithm, in place.
+ *
+ * The elements of the row i are sub[(i - 1) * stride], diagonal[i * stride]
+ * and super[i * stride], which covers both three separate arrays (stride 1)
+ * and the rows of a banded matrix with one diagonal on each side (stride 3).
+ *
+ * @param const long double* sub
+ *   The subdiagonal, n - 1 values.
+ * @param const long double* diagonal
+ *   The diagonal, n values.
+ * @param const long double* super
+ *   The superdiagonal, n - 1 values.
+ * @param size_t stride
+ *   The distance between two consecutive values of a diagonal.
+ * @param long double* b
+ *   The right-hand side, overwritten with the solution.
+ * @param long double* scratch
+ *   The space for the n - 1 modified superdiagonal values.
+ * @param int64_t n
+ *   The size of the system.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1 (zero pivot).
+ */
+static int banded_thomas(const long double *sub, const long double *diagonal, const long double *super, size_t stride, long double *b, long double *scratch, int64_t n) {
+  long double pivot;
+  if (n == 0) {
+    return 0;
+  }
+  pivot = diagonal[0];
+  if (pivot == 0) {
+    return 1;
+  }
+  b[0] /= pivot;
+  // Forward elimination of the subdiagonal.
+  for (int64_t i = 1; i < n; i++) {
+    scratch[i - 1] = super[(size_t)(i - 1) * stride] / pivot;
+    pivot = diagonal[(size_t)i * stride] - sub[(size_t)(i - 1) * stride] * scratch[i - 1];
+    if (pivot == 0) {
+      return 1;
+    }
+    b[i] = (b[i] - sub[(size_t)(i - 1) * stride] * b[i - 1]) / pivot;
+  }
+  // Back substitution of the modified superdiagonal.
+  for (int64_t i = n - 2; i >= 0; i--) {
+    b[i] -= scratch[i] * b[i + 1];
+  }
+  return 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int vector_solve_tridiagonal(struct vector *sub, struct vector *diagonal, struct vector *super, struct vector *b) {
+  if (sub == NULL || diagonal == NULL || super == NULL || b == NULL || b->capacity != diagonal->capacity || vector_detach(b) != 0) {
+    return 1;
+  }
+  int64_t n = diagonal->capacity;
+  int64_t off = n > 0 ? n - 1 : 0;
+  if (sub->capacity != off || super->capacity != off) {
+    return 1;
+  }
+  long double *scratch = malloc(((size_t)off + 1) * sizeof(long double));
+  if (scratch == NULL) {
+    return 1;
+  }
+  int status = banded_thomas(sub->data, diagonal->data, super->data, 1, b->data, scratch, n);
+  free(scratch);
+  return status;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int banded_matrix_solve_tridiagonal(struct banded_matrix *object, struct vector *b) {
+  if (object == NULL || b == NULL || b->capacity != object->size || object->lower != 1 || object->upper != 1 || vector_detach(b) != 0) {
+    return 1;
+  }
+  int64_t n = object->size;
+  long double *scratch = malloc(((size_t)n + 1) * sizeof(long double));
+  if (scratch == NULL) {
+    return 1;
+  }
+  // Row i is (sub, diagonal, super), the subdiagonal of row i is read through
+  // the row before it so that both forms share the same indexing.
+  const long double *data = object->data;
+  int status = banded_thomas(data + 3, data + 1, data + 2, 3, b->data, scratch, n);
+  free(scratch);
+  return status;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct banded_lu *banded_matrix_lu(struct banded_matrix *a) {
+  if (a == NULL) {
+    return NULL;
+  }
+  int64_t n = a->size;
+  int64_t kl = a->lower;
+  int64_t ku = a->upper;
+  // Row interchanges can move up to kl more superdiagonals into U, so every
+  // row covers the columns i - kl to i + kl + ku.
+  int64_t width = 2 * kl + ku + 1;
+  size_t count;
+  if (matrixmath_size_mul((size_t)n, (size_t)width, &count) != 0 || count == SIZE_MAX) {
+    return NULL;
+  }
+  // Allocate the factorization memory space.
+  struct banded_lu *object = malloc(sizeof(struct banded_lu));
+  if (object == NULL) {
+    return NULL;
+  }
+  object->data = calloc(count + 1, sizeof(long double));
+  object->pivots = malloc(((size_t)n + 1) * sizeof(int64_t));
+  if (object->data == NULL || object->pivots == NULL) {
+    banded_lu_destroy(object);
+    return NULL;
+  }
+  object->size = n;
+  object->lower = kl;
+  object->upper = ku;
+  object->width = width;
+  for (int64_t i = 0; i < n; i++) {
+    memcpy(object->data + (size_t)i * width, a->data + (size_t)i * a->width, (size_t)a->width * sizeof(long double));
+  }
+  // Element (i, j) lives at data[i * width + j - i + kl].
+  long double *lu = object->data;
+  long double *rk;
+  long double *ri;
+  long double swap;
+  long double best;
+  long double factor;
+  int64_t last_row;
+  int64_t last_column;
+  int64_t p;
+  for (int64_t k = 0; k < n; k++) {
+    last_row = k + kl < n - 1 ? k + kl : n - 1;
+    last_column = k + kl + ku < n - 1 ? k + kl + ku : n - 1;
+    // Partial pivoting among the kl rows below the diagonal.
+    p = k;
+    best = fabsl(lu[(size_t)k * width + kl]);
+    for (int64_t i = k + 1; i <= last_row; i++) {
+      if (fabsl(lu[(size_t)i * width + (k - i + kl)]) > best) {
+        best = fabsl(lu[(size_t)i * width + (k - i + kl)]);
+        p = i;
+      }
+    }
+    object->pivots[k] = p;
+    if (best == 0) {
+      banded_lu_destroy(object);
+      return NULL;
+    }
+    rk = lu + (size_t)k * width + (kl - k);
+    if (p != k) {
+      // Only the columns from k on are exchanged: the multipliers of the
+      // earlier steps stay with the row position they were computed for.
+      ri = lu + (size_t)p * width + (kl - p);
+      for (int64_t j = k; j <= last_column; j++) {
+        swap = rk[j];
+        rk[j] = ri[j];
+        ri[j] = swap;
+      }
+    }
+    for (int64_t i = k + 1; i <= last_row; i++) {
+      ri = lu + (size_t)i * width + (kl - i);
+      factor = ri[k] / rk[k];
+      ri[k] = factor;
+      if (factor == 0) {
+        continue;
+      }
+      for (int64_t j = k + 1; j <= last_column; j++) {
+        ri[j] -= factor * rk[j];
+      }
+    }
+  }
+  return object;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void banded_lu_destroy(struct banded_lu *object) {
+  if (object == NULL) {
+    return;
+  }
+  free(object->data);
+  free(object->pivots);
+  object->data = NULL;
+  object->pivots = NULL;
+  object->size = 0;
+  free(object);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int banded_lu_solve(struct banded_lu *object, struct vector *b) {
+  if (object == NULL || b == NULL || b->capacity != object->size || vector_detach(b) != 0) {
+    return 1;
+  }
+  int64_t n = object->size;
+  int64_t kl = object->lower;
+  int64_t width = object->width;
+  long double *x = b->data;
+  const long double *row;
+  long double swap;
+  long double sum;
+  int64_t last;
+  // Apply the interchanges and the multipliers in the order of the
+  // factorization: L^-1 * P * b.
+  for (int64_t k = 0; k < n; k++) {
+    if (object->pivots[k] != k) {
+      swap = x[k];
+      x[k] = x[object->pivots[k]];
+      x[object->pivots[k]] = swap;
+    }
+    last = k + kl < n - 1 ? k + kl : n - 1;
+    for (int64_t i = k + 1; i <= last; i++) {
+      x[i] -= object->data[(size_t)i * width + (k - i + kl)] * x[k];
+    }
+  }
+  // Back substitution with U, kl + ku diagonals above the main one.
+  for (int64_t i = n - 1; i >= 0; i--) {
+    row = object->data + (size_t)i * width + (kl - i);
+    last = i + width - 1 - kl < n - 1 ? i + width - 1 - kl : n - 1;
+    sum = x[i];
+    for (int64_t j = i + 1; j <= last; j++) {
+      sum -= row[j] * x[j];
+    }
+    x[i] = sum / row[i];
+  }
+  return 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int banded_matrix_solve(struct banded_matrix *object, struct vector *b) {
+  if (object == NULL || b == NULL || b->capacity != object->size) {
+    return 1;
+  }
+  struct banded_lu *lu = banded_matrix_lu(object);
+  if (lu == NULL) {
+    return 1;
+  }
+  int status = banded_lu_solve(lu, b);
+  banded_lu_destroy(lu);
+  return status;
+}
@@ -0,0 +1,338 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include "../../include/matrixmath.h"
+
+/**
+ * The number of multiply-add operations below which a batch is not split across threads.
+ */
+#define MATRIX_BATCHED_PARALLEL_GRAIN 32768
+
+/**
+ * The signature of the batched multiplication kernels: c = a * b, row-major.
+ */
+typedef void (*matrix_mul_kernel)(int64_t m, int64_t n, int64_t k, const long double *restrict a, const long double *restrict b, long double *restrict c);
+
+/**
+ * Define a kernel for square matrices of a size known at compile time.
+ *
+ * With constant trip counts the compiler fully unrolls the small sizes and keeps
+ * the running sums in registers.
+ */
+#define MATRIX_MUL_FIXED_KERNEL(N) \
+  static void matrix_mul_kernel_##N(int64_t m, int64_t n, int64_t k, const long double *restrict a, const long double *restrict b, long double *restrict c) { \
+    long double sum; \
+    (void)m; \
+    (void)n; \
+    (void)k; \
+    for (int i = 0; i < N; i++) { \
+      for (int j = 0; j < N; j++) { \
+        sum = 0; \
+        for (int l = 0; l < N; l++) { \
+          sum += a[i * N + l] * b[l * N + j]; \
+        } \
+        c[i * N + j] = sum; \
+      } \
+    } \
+  }
+
+MATRIX_MUL_FIXED_KERNEL(2)
+MATRIX_MUL_FIXED_KERNEL(3)
+MATRIX_MUL_FIXED_KERNEL(4)
+MATRIX_MUL_FIXED_KERNEL(8)
+MATRIX_MUL_FIXED_KERNEL(16)
+
+/**
+ * Kernel for matrices of any size.
+ *
+ * @param int64_t m
+ *   The number of rows of a and c.
+ * @param int64_t n
+ *   The number of columns of b and c.
+ * @param int64_t k
+ *   The number of columns of a and rows of b.
+ * @param const long double* a
+ *   The first matrix values.
+ * @param const long double* b
+ *   The second matrix values.
+ * @param long double* c
+ *   The destination matrix values.
+ */
+static void matrix_mul_kernel_generic(int64_t m, int64_t n, int64_t k, const long double *restrict a, const long double *restrict b, long double *restrict c) {
+  long double *row_c;
+  const long double *row_b;
+  long double val;
+  for (int64_t i = 0; i < m; i++) {
+    row_c = c + i * n;
+    for (int64_t j = 0; j < n; j++) {
+      row_c[j] = 0;
+    }
+    for (int64_t l = 0; l < k; l++) {
+      val = a[i * k + l];
+      row_b = b + l * n;
+      for (int64_t j = 0; j < n; j++) {
+        row_c[j] += val * row_b[j];
+      }
+    }
+  }
+}
+
+/**
+ * Select the kernel for the given dimensions.
+ *
+ * @param int64_t m
+ *   The number of rows of a and c.
+ * @param int64_t n
+ *   The number of columns of b and c.
+ * @param int64_t k
+ *   The number of columns of a and rows of b.
+ *
+ * @return matrix_mul_kernel
+ *   The kernel.
+ */
+static matrix_mul_kernel matrix_mul_select_kernel(int64_t m, int64_t n, int64_t k) {
+  if (m != n || n != k) {
+    return matrix_mul_kernel_generic;
+  }
+  switch (m) {
+    case 2:
+      return matrix_mul_kernel_2;
+
+    case 3:
+      return matrix_mul_kernel_3;
+
+    case 4:
+      return matrix_mul_kernel_4;
+
+    case 8:
+      return matrix_mul_kernel_8;
+
+    case 16:
+      return matrix_mul_kernel_16;
+  }
+  return matrix_mul_kernel_generic;
+}
+
+/**
+ * Get the minimum number of products per thread for the given dimensions.
+ *
+ * @param int64_t m
+ *   The number of rows of a and c.
+ * @param int64_t n
+ *   The number of columns of b and c.
+ * @param int64_t k
+ *   The number of columns of a and rows of b.
+ *
+ * @return int
+ *   The grain of the parallel loop over the batch.
+ */
+static int64_t matrix_mul_batched_grain(int64_t m, int64_t n, int64_t k) {
+  int64_t work = (int64_t)m * n * k;
+  return work >= MATRIX_BATCHED_PARALLEL_GRAIN ? 1 : MATRIX_BATCHED_PARALLEL_GRAIN / work;
+}
+
+/**
+ * The data struct definition for a strided batch in progress.
+ */
+struct matrix_strided_batch {
+  matrix_mul_kernel kernel;
+  int64_t m;
+  int64_t n;
+  int64_t k;
+  const long double *a;
+  size_t stride_a;
+  const long double *b;
+  size_t stride_b;
+  long double *c;
+  size_t stride_c;
+};
+
+/**
+ * Parallel loop body of the strided batched multiplication.
+ *
+ * @param void* context
+ *   The matrix_strided_batch object.
+ * @param int64_t start
+ *   The first product of the chunk.
+ * @param int64_t end
+ *   The product after the last one of the chunk.
+ */
+static void matrix_mul_strided_batched_range(void *context, int64_t start, int64_t end) {
+  struct matrix_strided_batch *batch = (struct matrix_strided_batch *)context;
+  for (int64_t i = start; i < end; i++) {
+    batch->kernel(batch->m, batch->n, batch->k, batch->a + i * batch->stride_a, batch->b + i * batch->stride_b, batch->c + i * batch->stride_c);
+  }
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_mul_strided_batched(int64_t m, int64_t n, int64_t k, const long double *a, int64_t stride_a, const long double *b, int64_t stride_b, long double *c, int64_t stride_c, int64_t count) {
+  if (a == NULL || b == NULL || c == NULL || m <= 0 || n <= 0 || k <= 0 || count < 0) {
+    return 1;
+  }
+  // Consecutive products must not overlap their destinations.
+  if (stride_a < 0 || stride_b < 0 || stride_c < m * n) {
+    return 1;
+  }
+  struct matrix_strided_batch batch = {matrix_mul_select_kernel(m, n, k), m, n, k, a, stride_a, b, stride_b, c, stride_c};
+  return matrixmath_parallel_for(count, matrix_mul_batched_grain(m, n, k), matrix_mul_strided_batched_range, &batch);
+}
+
+/**
+ * The data struct definition for a pointer array batch in progress.
+ */
+struct matrix_pointer_batch {
+  struct matrix **a;
+  struct matrix **b;
+  struct matrix **c;
+};
+
+/**
+ * Parallel loop body of the pointer array batched multiplication.
+ *
+ * @param void* context
+ *   The matrix_pointer_batch object.
+ * @param int64_t start
+ *   The first product of the chunk.
+ * @param int64_t end
+ *   The product after the last one of the chunk.
+ */
+static void matrix_mul_batched_range(void *context, int64_t start, int64_t end) {
+  struct matrix_pointer_batch *batch = (struct matrix_pointer_batch *)context;
+  struct matrix *a;
+  for (int64_t i = start; i < end; i++) {
+    a = batch->a[i];
+    matrix_mul_select_kernel(a->rows, batch->b[i]->columns, a->columns)(a->rows, batch->b[i]->columns, a->columns, a->data, batch->b[i]->data, batch->c[i]->data);
+  }
+}
+
+/**
+ * The data struct definition for the storage range of a destination matrix.
+ */
+struct matrix_batch_range {
+  uintptr_t start;
+  uintptr_t end;
+};
+
+/**
+ * Order storage ranges by their start, for qsort().
+ *
+ * @param const void* left
+ *   The first matrix_batch_range object.
+ * @param const void* right
+ *   The second matrix_batch_range object.
+ *
+ * @return int
+ *   A negative value, 0 or a positive value.
+ */
+static int matrix_batch_range_compare(const void *left, const void *right) {
+  uintptr_t a = ((const struct matrix_batch_range *)left)->start;
+  uintptr_t b = ((const struct matrix_batch_range *)right)->start;
+  return (a > b) - (a < b);
+}
+
+/**
+ * Check whether a matrix shares storage with one of the destination ranges.
+ *
+ * @param const struct matrix_batch_range* ranges
+ *   The destination ranges, sorted and disjoint.
+ * @param int64_t count
+ *   The number of ranges.
+ * @param struct matrix* object
+ *   The matrix.
+ *
+ * @return int
+ *   Returns 1 when the storage overlaps a destination, otherwise 0.
+ */
+static int matrix_batch_overlaps(const struct matrix_batch_range *ranges, int64_t count, struct matrix *object) {
+  uintptr_t start = (uintptr_t)object->data;
+  uintptr_t end = (uintptr_t)(object->data + (size_t)object->rows * object->columns);
+  // Find the last destination starting before the end of the matrix, the
+  // ones before it end before it starts.
+  int64_t low = 0;
+  int64_t high = count;
+  int64_t middle;
+  while (low < high) {
+    middle = low + (high - low) / 2;
+    if (ranges[middle].start < end) {
+      low = middle + 1;
+    }
+    else {
+      high = middle;
+    }
+  }
+  return low > 0 && ranges[low - 1].end > start;
+}
+
+/**
+ * Check that no destination of a batch shares storage with another
+ * destination or with any operand of the batch.
+ *
+ * @param struct matrix** a
+ *   The first matrices.
+ * @param struct matrix** b
+ *   The second matrices.
+ * @param struct matrix** c
+ *   The destination matrices, detached.
+ * @param int64_t count
+ *   The number of products, at least 1.
+ *
+ * @return int
+ *   Returns 0 when the batch can run in parallel, otherwise 1.
+ */
+static int matrix_mul_batched_check_storage(struct matrix **a, struct matrix **b, struct matrix **c, int64_t count) {
+  struct matrix_batch_range *ranges = malloc((size_t)count * sizeof(struct matrix_batch_range));
+  if (ranges == NULL) {
+    return 1;
+  }
+  for (int64_t i = 0; i < count; i++) {
+    ranges[i].start = (uintptr_t)c[i]->data;
+    ranges[i].end = (uintptr_t)(c[i]->data + (size_t)c[i]->rows * c[i]->columns);
+  }
+  qsort(ranges, (size_t)count, sizeof(struct matrix_batch_range), matrix_batch_range_compare);
+  int status = 0;
+  for (int64_t i = 1; i < count && status == 0; i++) {
+    status = ranges[i].start < ranges[i - 1].end;
+  }
+  for (int64_t i = 0; i < count && status == 0; i++) {
+    status = matrix_batch_overlaps(ranges, count, a[i]) || matrix_batch_overlaps(ranges, count, b[i]);
+  }
+  free(ranges);
+  return status;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_mul_batched(struct matrix **a, struct matrix **b, struct matrix **c, int64_t count) {
+  if (a == NULL || b == NULL || c == NULL || count < 0) {
+    return 1;
+  }
+  // Validate the whole batch before computing anything.
+  int64_t work = 0;
+  for (int64_t i = 0; i < count; i++) {
+    if (a[i] == NULL || b[i] == NULL || c[i] == NULL) {
+      return 1;
+    }
+    if (a[i]->columns != b[i]->rows || c[i]->rows != a[i]->rows || c[i]->columns != b[i]->columns) {
+      return 1;
+    }
+    if (matrix_detach(c[i]) != 0) {
+      return 1;
+    }
+    work += (int64_t)a[i]->rows * b[i]->columns * a[i]->columns;
+  }
+  if (count == 0) {
+    return 0;
+  }
+  // The products run in any order, so no destination may be read or written
+  // by another product.
+  if (matrix_mul_batched_check_storage(a, b, c, count) != 0) {
+    return 1;
+  }
+  // Split the batch by the average size of its products.
+  int64_t average = work / count > 0 ? work / count : 1;
+  int64_t grain = average >= MATRIX_BATCHED_PARALLEL_GRAIN ? 1 : MATRIX_BATCHED_PARALLEL_GRAIN / average;
+  struct matrix_pointer_batch batch = {a, b, c};
+  return matrixmath_parallel_for(count, grain, matrix_mul_batched_range, &batch);
+}
@@ -0,0 +1,267 @@
+#include <stdlib.h>
+#include "../../include/matrixmath.h"
+
+/**
+ * The number of elements below which a broadcast is not split across threads.
+ */
+#define MATRIX_BROADCAST_PARALLEL_GRAIN 16384
+
+/**
+ * The data struct definition for a broadcast in progress.
+ */
+struct matrix_broadcast {
+  enum broadcast_operation operation;
+  const long double *a;
+  const long double *v;
+  const long double *w;
+  long double *dest;
+  int64_t columns;
+  int along_rows;
+};
+
+/**
+ * Combine a row of a matrix with a vector, element by element.
+ *
+ * The destination can be the row itself: every element only depends on the
+ * element at the same position.
+ *
+ * @param enum broadcast_operation operation
+ *   The operation.
+ * @param const long double* a
+ *   The row.
+ * @param const long double* v
+ *   The vector values, one per element of the row.
+ * @param long double* dest
+ *   The destination row.
+ * @param int64_t n
+ *   The number of elements.
+ */
+static void matrix_broadcast_row_kernel(enum broadcast_operation operation, const long double *a, const long double *v, long double *dest, int64_t n) {
+  switch (operation) {
+    case BROADCAST_ADD:
+      for (int64_t j = 0; j < n; j++) {
+        dest[j] = a[j] + v[j];
+      }
+      break;
+
+    case BROADCAST_SUB:
+      for (int64_t j = 0; j < n; j++) {
+        dest[j] = a[j] - v[j];
+      }
+      break;
+
+    case BROADCAST_MUL:
+      for (int64_t j = 0; j < n; j++) {
+        dest[j] = a[j] * v[j];
+      }
+      break;
+
+    case BROADCAST_DIV:
+      for (int64_t j = 0; j < n; j++) {
+        dest[j] = a[j] / v[j];
+      }
+      break;
+  }
+}
+
+/**
+ * Combine a row of a matrix with a scalar, element by element.
+ *
+ * @param enum broadcast_operation operation
+ *   The operation.
+ * @param const long double* a
+ *   The row.
+ * @param long double value
+ *   The scalar.
+ * @param long double* dest
+ *   The destination row.
+ * @param int64_t n
+ *   The number of elements.
+ */
+static void matrix_broadcast_scalar_kernel(enum broadcast_operation operation, const long double *a, long double value, long double *dest, int64_t n) {
+  switch (operation) {
+    case BROADCAST_ADD:
+      for (int64_t j = 0; j < n; j++) {
+        dest[j] = a[j] + value;
+      }
+      break;
+
+    case BROADCAST_SUB:
+      for (int64_t j = 0; j < n; j++) {
+        dest[j] = a[j] - value;
+      }
+      break;
+
+    case BROADCAST_MUL:
+      for (int64_t j = 0; j < n; j++) {
+        dest[j] = a[j] * value;
+      }
+      break;
+
+    case BROADCAST_DIV:
+      for (int64_t j = 0; j < n; j++) {
+        dest[j] = a[j] / value;
+      }
+      break;
+  }
+}
+
+/**
+ * Parallel loop body of the broadcasts, the loop runs over rows.
+ *
+ * @param void* context
+ *   The matrix_broadcast object.
+ * @param int64_t start
+ *   The first row.
+ * @param int64_t end
+ *   The row after the last one.
+ */
+static void matrix_broadcast_rows(void *context, int64_t start, int64_t end) {
+  struct matrix_broadcast *broadcast = (struct matrix_broadcast *)context;
+  size_t offset;
+  for (int64_t i = start; i < end; i++) {
+    offset = (size_t)i * broadcast->columns;
+    if (broadcast->along_rows) {
+      matrix_broadcast_row_kernel(broadcast->operation, broadcast->a + offset, broadcast->v, broadcast->dest + offset, broadcast->columns);
+    }
+    else {
+      matrix_broadcast_scalar_kernel(broadcast->operation, broadcast->a + offset, broadcast->v[i], broadcast->dest + offset, broadcast->columns);
+    }
+  }
+}
+
+/**
+ * Parallel loop body of the affine broadcasts, the loop runs over rows.
+ *
+ * @param void* context
+ *   The matrix_broadcast object, v being the scales and w the shifts.
+ * @param int64_t start
+ *   The first row.
+ * @param int64_t end
+ *   The row after the last one.
+ */
+static void matrix_broadcast_affine_rows(void *context, int64_t start, int64_t end) {
+  struct matrix_broadcast *broadcast = (struct matrix_broadcast *)context;
+  const long double *scale = broadcast->v;
+  const long double *shift = broadcast->w;
+  const long double *a;
+  long double *dest;
+  for (int64_t i = start; i < end; i++) {
+    a = broadcast->a + (size_t)i * broadcast->columns;
+    dest = broadcast->dest + (size_t)i * broadcast->columns;
+    for (int64_t j = 0; j < broadcast->columns; j++) {
+      dest[j] = a[j] * scale[j] + shift[j];
+    }
+  }
+}
+
+/**
+ * Run a broadcast over all the rows of a matrix.
+ *
+ * @param struct matrix_broadcast* broadcast
+ *   The broadcast.
+ * @param int64_t rows
+ *   The number of rows.
+ * @param void (*callback)(void *context, int64_t start, int64_t end)
+ *   The loop body.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+static int matrix_broadcast_run(struct matrix_broadcast *broadcast, int64_t rows, void (*callback)(void *context, int64_t start, int64_t end)) {
+  int64_t grain = broadcast->columns > 0 ? MATRIX_BROADCAST_PARALLEL_GRAIN / broadcast->columns : rows;
+  return matrixmath_parallel_for(rows, grain > 0 ? grain : 1, callback, broadcast);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_broadcast_row_dest(struct matrix *a, struct vector *v, enum broadcast_operation operation, struct matrix *dest) {
+  // The vector has one element per column.
+  if (a == NULL || v == NULL || dest == NULL || v->capacity != a->columns) {
+    return 1;
+  }
+  if (dest->rows != a->rows || dest->columns != a->columns || matrix_detach(dest) != 0) {
+    return 1;
+  }
+  struct matrix_broadcast broadcast = {operation, a->data, v->data, NULL, dest->data, a->columns, 1};
+  return matrix_broadcast_run(&broadcast, a->rows, matrix_broadcast_rows);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_broadcast_column_dest(struct matrix *a, struct vector *v, enum broadcast_operation operation, struct matrix *dest) {
+  // The vector has one element per row.
+  if (a == NULL || v == NULL || dest == NULL || v->capacity != a->rows) {
+    return 1;
+  }
+  if (dest->rows != a->rows || dest->columns != a->columns || matrix_detach(dest) != 0) {
+    return 1;
+  }
+  struct matrix_broadcast broadcast = {operation, a->data, v->data, NULL, dest->data, a->columns, 0};
+  return matrix_broadcast_run(&broadcast, a->rows, matrix_broadcast_rows);
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct matrix *matrix_broadcast_row(struct matrix *a, struct vector *v, enum broadcast_operation operation) {
+  if (a == NULL || v == NULL || v->capacity != a->columns) {
+    return NULL;
+  }
+  // Create the new Matrix to store the result of the operation.
+  struct matrix *result = matrix_create(a->rows, a->columns);
+  if (result == NULL) {
+    return NULL;
+  }
+  matrix_broadcast_row_dest(a, v, operation, result);
+  return result;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct matrix *matrix_broadcast_column(struct matrix *a, struct vector *v, enum broadcast_operation operation) {
+  if (a == NULL || v == NULL || v->capacity != a->rows) {
+    return NULL;
+  }
+  // Create the new Matrix to store the result of the operation.
+  struct matrix *result = matrix_create(a->rows, a->columns);
+  if (result == NULL) {
+    return NULL;
+  }
+  matrix_broadcast_column_dest(a, v, operation, result);
+  return result;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_broadcast_row_inplace(struct matrix *a, struct vector *v, enum broadcast_operation operation) {
+  return matrix_broadcast_row_dest(a, v, operation, a);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_broadcast_column_inplace(struct matrix *a, struct vector *v, enum broadcast_operation operation) {
+  return matrix_broadcast_column_dest(a, v, operation, a);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_broadcast_affine_dest(struct matrix *a, struct vector *scale, struct vector *shift, struct matrix *dest) {
+  if (a == NULL || scale == NULL || shift == NULL || dest == NULL) {
+    return 1;
+  }
+  if (scale->capacity != a->columns || shift->capacity != a->columns) {
+    return 1;
+  }
+  if (dest->rows != a->rows || dest->columns != a->columns || matrix_detach(dest) != 0) {
+    return 1;
+  }
+  struct matrix_broadcast broadcast = {BROADCAST_MUL, a->data, scale->data, shift->data, dest->data, a->columns, 1};
+  return matrix_broadcast_run(&broadcast, a->rows, matrix_broadcast_affine_rows);
+}
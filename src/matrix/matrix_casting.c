@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <string.h>
 #include "../../include/matrixmath.h"
 
 /**
@@ -10,21 +11,8 @@ struct matrix *vector_to_matrix(struct vector *a) {
   if (object == NULL) {
     return NULL;
   }
-  // Set the matrix row/columns elements.
-  long double *set_val;
-  long double *get_val;
-  for (int i = 0; i < a->capacity; i++) {
-    set_val = vector_getl(a, i);
-    if (set_val == NULL) {
-      matrix_destroy(object);
-      return NULL;
-    }
-    get_val = matrix_setl(object, i, 0, (*set_val));
-    if (get_val == NULL) {
-      matrix_destroy(object);
-      return NULL;
-    }
-  }
+  // A one column matrix has the same layout as the vector.
+  memcpy(object->data, a->data, sizeof(long double) * a->capacity);
   // Return the matrix object.
   return object;
 }
@@ -33,29 +21,22 @@ struct matrix *vector_to_matrix(struct vector *a) {
  * {@inheritdoc}
  */
 struct vector *matrix_to_vector(struct matrix *m) {
-  // Verify if it is a matrix with a single row and multiple columns.
-  if (m->rows == 1) {
-    // Create the new Vector to store the result of the operation.
-    struct vector *v = vector_create(m->columns);
-    if (v == NULL) {
-      return NULL;
-    }
-    long double *val;
-    for (int i = 0; i < m->columns; i++) {
-      val = matrix_getl(m, 0, i);
-      vector_setl(v, i, *val);
-    }
-    return v;
-  }
-  // Otherwise, assume it is a matrix with a single column and multiple rows.
-  struct vector *v = vector_create(m->rows);
+  // Verify if it is a matrix with a single row and multiple columns,
+  // otherwise, assume it is a matrix with a single column and multiple rows.
+  int64_t capacity = m->rows == 1 ? m->columns : m->rows;
+  // Create the new Vector to store the result of the operation.
+  struct vector *v = vector_create(capacity);
   if (v == NULL) {
     return NULL;
   }
-  long double *val;
-  for (int i = 0; i < m->rows; i++) {
-    val = matrix_getl(m, i, 0);
-    vector_setl(v, i, *val);
+  // A single row or a single column is contiguous in the matrix.
+  if (m->rows == 1 || m->columns == 1) {
+    memcpy(v->data, m->data, sizeof(long double) * capacity);
+    return v;
+  }
+  // Otherwise take the first column.
+  for (int64_t i = 0; i < m->rows; i++) {
+    v->data[i] = m->data[(size_t)i * m->columns];
   }
   return v;
 }
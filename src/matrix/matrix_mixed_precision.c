@@ -0,0 +1,657 @@
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../include/matrixmath.h"
+
+/**
+ * The number of multiply-add operations below which a product or an update is
+ * not split across threads.
+ */
+#define MATRIX_MIXED_PARALLEL_GRAIN 32768
+
+/**
+ * The number of rows of b whose products are summed in double precision before
+ * being added to c in long double precision.
+ */
+#define MATRIX_MIXED_DEPTH 128
+
+/**
+ * The number of columns walked at once by the product and the factorization.
+ */
+#define MATRIX_MIXED_WIDTH 256
+
+/**
+ * The number of columns of a panel of the blocked factorization.
+ */
+#define MATRIX_LU_BLOCK 64
+
+/**
+ * The maximum number of refinement steps with one factorization.
+ */
+#define MATRIX_REFINE_ITERATIONS 30
+
+/**
+ * The data struct definition for the kernels of a precision.
+ *
+ * Only the operations on whole rows, where the time goes, are specialized; the
+ * rest of the algorithms reads and writes single values through get and set.
+ */
+struct matrix_mixed_type {
+
+  /**
+   * The size of a value in bytes.
+   *
+   * @var size_t size.
+   */
+  size_t size;
+
+  /**
+   * Round count long double values to the precision.
+   *
+   * @var void (*convert)(int64_t count, const long double *from, void *to).
+   */
+  void (*convert)(int64_t count, const long double *from, void *to);
+
+  /**
+   * Compute y -= scale * x on count values.
+   *
+   * @var void (*axpy)(int64_t count, long double scale, const void *x, void *y).
+   */
+  void (*axpy)(int64_t count, long double scale, const void *x, void *y);
+
+  /**
+   * Compute sum += scale * x on count values, the sums in double precision.
+   *
+   * @var void (*accumulate)(int64_t count, long double scale, const void *x, double *sum).
+   */
+  void (*accumulate)(int64_t count, long double scale, const void *x, double *sum);
+
+  /**
+   * Compute the dot product of count values with long double ones, in long
+   * double precision.
+   *
+   * @var long double (*dot)(int64_t count, const void *x, const long double *y).
+   */
+  long double (*dot)(int64_t count, const void *x, const long double *y);
+
+  /**
+   * Read a value.
+   *
+   * @var long double (*get)(const void *data, size_t index).
+   */
+  long double (*get)(const void *data, size_t index);
+
+  /**
+   * Write a value, rounded to the precision.
+   *
+   * @var void (*set)(void *data, size_t index, long double value).
+   */
+  void (*set)(void *data, size_t index, long double value);
+};
+
+/**
+ * Define the kernels of a precision.
+ *
+ * The products of two float values are exact in double precision, so the
+ * float products lose nothing before being summed.
+ */
+#define MATRIX_MIXED_KERNELS(T, NAME) \
+  static void matrix_mixed_convert_##NAME(int64_t count, const long double *from, void *to) { \
+    T *restrict values = (T *)to; \
+    for (int64_t j = 0; j < count; j++) { \
+      values[j] = (T)from[j]; \
+    } \
+  } \
+  static void matrix_mixed_axpy_##NAME(int64_t count, long double scale, const void *x, void *y) { \
+    const T *restrict from = (const T *)x; \
+    T *restrict to = (T *)y; \
+    T factor = (T)scale; \
+    for (int64_t j = 0; j < count; j++) { \
+      to[j] -= factor * from[j]; \
+    } \
+  } \
+  static void matrix_mixed_accumulate_##NAME(int64_t count, long double scale, const void *x, double *restrict sum) { \
+    const T *restrict from = (const T *)x; \
+    double factor = (double)(T)scale; \
+    for (int64_t j = 0; j < count; j++) { \
+      sum[j] += factor * (double)from[j]; \
+    } \
+  } \
+  static long double matrix_mixed_dot_##NAME(int64_t count, const void *x, const long double *y) { \
+    const T *restrict from = (const T *)x; \
+    long double sum = 0; \
+    for (int64_t j = 0; j < count; j++) { \
+      sum += (long double)from[j] * y[j]; \
+    } \
+    return sum; \
+  } \
+  static long double matrix_mixed_get_##NAME(const void *data, size_t index) { \
+    return ((const T *)data)[index]; \
+  } \
+  static void matrix_mixed_set_##NAME(void *data, size_t index, long double value) { \
+    ((T *)data)[index] = (T)value; \
+  }
+
+MATRIX_MIXED_KERNELS(float, float)
+MATRIX_MIXED_KERNELS(double, double)
+MATRIX_MIXED_KERNELS(long double, long_double)
+
+/**
+ * The kernels of each precision.
+ */
+static const struct matrix_mixed_type matrix_mixed_types[] = {
+  [MATRIX_PRECISION_FLOAT] = {sizeof(float), matrix_mixed_convert_float, matrix_mixed_axpy_float, matrix_mixed_accumulate_float, matrix_mixed_dot_float, matrix_mixed_get_float, matrix_mixed_set_float},
+  [MATRIX_PRECISION_DOUBLE] = {sizeof(double), matrix_mixed_convert_double, matrix_mixed_axpy_double, matrix_mixed_accumulate_double, matrix_mixed_dot_double, matrix_mixed_get_double, matrix_mixed_set_double},
+  [MATRIX_PRECISION_LONG_DOUBLE] = {sizeof(long double), matrix_mixed_convert_long_double, matrix_mixed_axpy_long_double, matrix_mixed_accumulate_long_double, matrix_mixed_dot_long_double, matrix_mixed_get_long_double, matrix_mixed_set_long_double},
+};
+
+/**
+ * Get the kernels of a precision.
+ *
+ * @param enum matrix_precision precision
+ *   The precision.
+ *
+ * @return const struct matrix_mixed_type*
+ *   The kernels, NULL for an unknown precision.
+ */
+static const struct matrix_mixed_type *matrix_mixed_type(enum matrix_precision precision) {
+  if (precision < MATRIX_PRECISION_FLOAT || precision > MATRIX_PRECISION_LONG_DOUBLE) {
+    return NULL;
+  }
+  return &matrix_mixed_types[precision];
+}
+
+/**
+ * The data struct definition for values rounded to a precision in parallel.
+ */
+struct matrix_mixed_conversion {
+  const struct matrix_mixed_type *type;
+  const long double *from;
+  char *to;
+  int64_t columns;
+};
+
+/**
+ * Parallel loop body of the rounding of a matrix, the loop runs over rows.
+ *
+ * @param void* context
+ *   The matrix_mixed_conversion object.
+ * @param int64_t start
+ *   The first row.
+ * @param int64_t end
+ *   The row after the last one.
+ */
+static void matrix_mixed_convert_rows(void *context, int64_t start, int64_t end) {
+  struct matrix_mixed_conversion *conversion = (struct matrix_mixed_conversion *)context;
+  size_t first = (size_t)start * conversion->columns;
+  conversion->type->convert((end - start) * conversion->columns, conversion->from + first, conversion->to + first * conversion->type->size);
+}
+
+/**
+ * Round the values of a matrix to a precision, in a new buffer.
+ *
+ * @param const struct matrix_mixed_type* type
+ *   The kernels of the precision.
+ * @param struct matrix* a
+ *   The matrix.
+ *
+ * @return char*
+ *   The rounded values, to be freed, otherwise NULL.
+ */
+static char *matrix_mixed_convert(const struct matrix_mixed_type *type, struct matrix *a) {
+  size_t bytes;
+  if (matrixmath_size_mul((size_t)a->rows * a->columns, type->size, &bytes) != 0) {
+    return NULL;
+  }
+  char *values = malloc(bytes);
+  if (values == NULL) {
+    return NULL;
+  }
+  struct matrix_mixed_conversion conversion = {type, a->data, values, a->columns};
+  int64_t grain = a->columns >= MATRIX_MIXED_PARALLEL_GRAIN ? 1 : MATRIX_MIXED_PARALLEL_GRAIN / a->columns;
+  if (matrixmath_parallel_for(a->rows, grain, matrix_mixed_convert_rows, &conversion) != 0) {
+    matrix_mixed_convert_rows(&conversion, 0, a->rows);
+  }
+  return values;
+}
+
+/**
+ * The data struct definition for a mixed precision product in progress.
+ */
+struct matrix_mixed_gemm {
+  const struct matrix_mixed_type *type;
+  int64_t n;
+  int64_t k;
+  long double alpha;
+  const long double *a;
+  const char *b;
+  long double beta;
+  long double *c;
+};
+
+/**
+ * Parallel loop body of the mixed precision product, the loop runs over rows
+ * of c.
+ *
+ * The products of a block of MATRIX_MIXED_DEPTH rows of b are summed in double
+ * precision, and the block sums in long double precision into c, in the order
+ * of k whatever the split across threads.
+ *
+ * @param void* context
+ *   The matrix_mixed_gemm object.
+ * @param int64_t start
+ *   The first row.
+ * @param int64_t end
+ *   The row after the last one.
+ */
+static void matrix_mixed_gemm_rows(void *context, int64_t start, int64_t end) {
+  struct matrix_mixed_gemm *gemm = (struct matrix_mixed_gemm *)context;
+  const struct matrix_mixed_type *type = gemm->type;
+  double sum[MATRIX_MIXED_WIDTH];
+  long double *row_c;
+  int64_t last_l;
+  int64_t width;
+  // Scale c first, without reading it when beta is 0.
+  for (int64_t i = start; i < end; i++) {
+    row_c = gemm->c + (size_t)i * gemm->n;
+    for (int64_t j = 0; j < gemm->n; j++) {
+      row_c[j] = gemm->beta == 0 ? 0 : gemm->beta * row_c[j];
+    }
+  }
+  for (int64_t j0 = 0; j0 < gemm->n; j0 += MATRIX_MIXED_WIDTH) {
+    width = j0 + MATRIX_MIXED_WIDTH < gemm->n ? MATRIX_MIXED_WIDTH : gemm->n - j0;
+    for (int64_t l0 = 0; l0 < gemm->k; l0 += MATRIX_MIXED_DEPTH) {
+      last_l = l0 + MATRIX_MIXED_DEPTH < gemm->k ? l0 + MATRIX_MIXED_DEPTH : gemm->k;
+      for (int64_t i = start; i < end; i++) {
+        memset(sum, 0, sizeof(double) * width);
+        for (int64_t l = l0; l < last_l; l++) {
+          type->accumulate(width, gemm->a[(size_t)i * gemm->k + l], gemm->b + ((size_t)l * gemm->n + j0) * type->size, sum);
+        }
+        row_c = gemm->c + (size_t)i * gemm->n + j0;
+        for (int64_t j = 0; j < width; j++) {
+          row_c[j] += gemm->alpha * sum[j];
+        }
+      }
+    }
+  }
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_gemm_mixed(enum matrix_precision precision, long double alpha, struct matrix *a, struct matrix *b, long double beta, struct matrix *c) {
+  const struct matrix_mixed_type *type = matrix_mixed_type(precision);
+  if (type == NULL || a == NULL || b == NULL || c == NULL || a->columns != b->rows) {
+    return 1;
+  }
+  if (precision == MATRIX_PRECISION_LONG_DOUBLE) {
+    return matrix_gemm(alpha, a, b, beta, c);
+  }
+  if (c->rows != a->rows || c->columns != b->columns || matrix_detach(c) != 0) {
+    return 1;
+  }
+  // The rows of c are written while a and b are still read.
+  if (c->data == a->data || c->data == b->data) {
+    return 1;
+  }
+  // The values of a are rounded as they are used, b is rounded once.
+  char *values = matrix_mixed_convert(type, b);
+  if (values == NULL) {
+    return 1;
+  }
+  struct matrix_mixed_gemm gemm = {type, b->columns, a->columns, alpha, a->data, values, beta, c->data};
+  int64_t work = b->columns * a->columns;
+  int64_t grain = work >= MATRIX_MIXED_PARALLEL_GRAIN ? 1 : MATRIX_MIXED_PARALLEL_GRAIN / work;
+  int status = matrixmath_parallel_for(a->rows, grain, matrix_mixed_gemm_rows, &gemm);
+  free(values);
+  return status;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct matrix *matrix_mul_mixed(enum matrix_precision precision, struct matrix *a, struct matrix *b) {
+  if (a == NULL || b == NULL || a->columns != b->rows) {
+    return NULL;
+  }
+  struct matrix *result = matrix_create(a->rows, b->columns);
+  if (result == NULL) {
+    return NULL;
+  }
+  if (matrix_gemm_mixed(precision, 1, a, b, 0, result) != 0) {
+    matrix_destroy(result);
+    return NULL;
+  }
+  return result;
+}
+
+/**
+ * The data struct definition for the update of the trailing rows of a
+ * factorization by a panel.
+ */
+struct matrix_lu_update {
+  const struct matrix_mixed_type *type;
+  char *data;
+  int64_t size;
+  int64_t first;
+  int64_t last;
+};
+
+/**
+ * Parallel loop body of the trailing update A22 -= L21 * U12, the loop runs
+ * over the rows below the panel.
+ *
+ * @param void* context
+ *   The matrix_lu_update object.
+ * @param int64_t start
+ *   The first row, from the end of the panel.
+ * @param int64_t end
+ *   The row after the last one, from the end of the panel.
+ */
+static void matrix_lu_update_rows(void *context, int64_t start, int64_t end) {
+  struct matrix_lu_update *update = (struct matrix_lu_update *)context;
+  const struct matrix_mixed_type *type = update->type;
+  size_t stride = (size_t)update->size * type->size;
+  int64_t width;
+  char *row;
+  for (int64_t j0 = update->last; j0 < update->size; j0 += MATRIX_MIXED_WIDTH) {
+    width = j0 + MATRIX_MIXED_WIDTH < update->size ? MATRIX_MIXED_WIDTH : update->size - j0;
+    for (int64_t i = update->last + start; i < update->last + end; i++) {
+      row = update->data + (size_t)i * stride;
+      for (int64_t l = update->first; l < update->last; l++) {
+        type->axpy(width, type->get(row, l), update->data + (size_t)l * stride + j0 * type->size, row + j0 * type->size);
+      }
+    }
+  }
+}
+
+/**
+ * Factorize the square matrix of a factorization in place, by panels.
+ *
+ * @param struct matrix_lu* object
+ *   The factorization, with the values of the matrix.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, 1 when the matrix is singular.
+ */
+static int matrix_lu_factorize(struct matrix_lu *object) {
+  const struct matrix_mixed_type *type = matrix_mixed_type(object->precision);
+  int64_t n = object->size;
+  size_t stride = (size_t)n * type->size;
+  char *data = (char *)object->data;
+  char *swap = malloc(stride);
+  if (swap == NULL) {
+    return 1;
+  }
+  long double value;
+  long double largest;
+  long double pivot;
+  int64_t last;
+  int64_t p;
+  for (int64_t k0 = 0; k0 < n; k0 += MATRIX_LU_BLOCK) {
+    last = k0 + MATRIX_LU_BLOCK < n ? k0 + MATRIX_LU_BLOCK : n;
+    // Factorize the panel, the columns k0 to last of all the rows below k0.
+    for (int64_t k = k0; k < last; k++) {
+      p = k;
+      largest = fabsl(type->get(data, (size_t)k * n + k));
+      for (int64_t i = k + 1; i < n; i++) {
+        value = fabsl(type->get(data, (size_t)i * n + k));
+        if (value > largest) {
+          largest = value;
+          p = i;
+        }
+      }
+      if (largest == 0 || !isfinite(largest)) {
+        free(swap);
+        return 1;
+      }
+      object->pivots[k] = p;
+      // Whole rows are interchanged, the multipliers already computed included.
+      if (p != k) {
+        memcpy(swap, data + (size_t)k * stride, stride);
+        memcpy(data + (size_t)k * stride, data + (size_t)p * stride, stride);
+        memcpy(data + (size_t)p * stride, swap, stride);
+      }
+      pivot = type->get(data, (size_t)k * n + k);
+      for (int64_t i = k + 1; i < n; i++) {
+        value = type->get(data, (size_t)i * n + k) / pivot;
+        type->set(data, (size_t)i * n + k, value);
+        type->axpy(last - k - 1, value, data + (size_t)k * stride + (k + 1) * type->size, data + (size_t)i * stride + (k + 1) * type->size);
+      }
+    }
+    if (last == n) {
+      break;
+    }
+    // Solve U12 = L11^-1 * A12, L11 having a unit diagonal.
+    for (int64_t k = k0; k < last; k++) {
+      for (int64_t i = k + 1; i < last; i++) {
+        type->axpy(n - last, type->get(data, (size_t)i * n + k), data + (size_t)k * stride + last * type->size, data + (size_t)i * stride + last * type->size);
+      }
+    }
+    struct matrix_lu_update update = {type, data, n, k0, last};
+    int64_t work = (n - last) * (last - k0);
+    int64_t grain = work >= MATRIX_MIXED_PARALLEL_GRAIN ? 1 : MATRIX_MIXED_PARALLEL_GRAIN / work;
+    if (matrixmath_parallel_for(n - last, grain, matrix_lu_update_rows, &update) != 0) {
+      matrix_lu_update_rows(&update, 0, n - last);
+    }
+  }
+  free(swap);
+  return 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct matrix_lu *matrix_lu(struct matrix *a, enum matrix_precision precision) {
+  const struct matrix_mixed_type *type = matrix_mixed_type(precision);
+  if (type == NULL || a == NULL || a->rows != a->columns) {
+    return NULL;
+  }
+  size_t bytes;
+  if (matrixmath_array_size(a->rows, sizeof(int64_t), &bytes) != 0) {
+    return NULL;
+  }
+  struct matrix_lu *object = malloc(sizeof(struct matrix_lu));
+  if (object == NULL) {
+    return NULL;
+  }
+  object->size = a->rows;
+  object->precision = precision;
+  object->pivots = malloc(bytes);
+  object->data = matrix_mixed_convert(type, a);
+  if (object->pivots == NULL || object->data == NULL || matrix_lu_factorize(object) != 0) {
+    matrix_lu_destroy(object);
+    return NULL;
+  }
+  return object;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void matrix_lu_destroy(struct matrix_lu *object) {
+  if (object == NULL) {
+    return;
+  }
+  free(object->data);
+  free(object->pivots);
+  free(object);
+}
+
+/**
+ * Solve a system with a factorization, in long double precision.
+ *
+ * @param struct matrix_lu* object
+ *   The factorization.
+ * @param long double* x
+ *   The right-hand side, overwritten with the solution.
+ */
+static void matrix_lu_substitute(struct matrix_lu *object, long double *x) {
+  const struct matrix_mixed_type *type = matrix_mixed_type(object->precision);
+  int64_t n = object->size;
+  const char *data = (const char *)object->data;
+  size_t stride = (size_t)n * type->size;
+  long double value;
+  for (int64_t k = 0; k < n; k++) {
+    if (object->pivots[k] != k) {
+      value = x[k];
+      x[k] = x[object->pivots[k]];
+      x[object->pivots[k]] = value;
+    }
+  }
+  for (int64_t i = 1; i < n; i++) {
+    x[i] -= type->dot(i, data + (size_t)i * stride, x);
+  }
+  for (int64_t i = n - 1; i >= 0; i--) {
+    value = x[i] - type->dot(n - i - 1, data + (size_t)i * stride + (i + 1) * type->size, x + i + 1);
+    x[i] = value / type->get(data, (size_t)i * n + i);
+  }
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_lu_solve(struct matrix_lu *object, struct vector *b) {
+  if (object == NULL || b == NULL || b->capacity != object->size || vector_detach(b) != 0) {
+    return 1;
+  }
+  matrix_lu_substitute(object, b->data);
+  return 0;
+}
+
+/**
+ * The data struct definition for a residual computed in parallel.
+ */
+struct matrix_residual {
+  const long double *a;
+  const long double *x;
+  const long double *b;
+  long double *r;
+  int64_t size;
+};
+
+/**
+ * Parallel loop body of the residual r = b - A * x, the loop runs over rows.
+ *
+ * @param void* context
+ *   The matrix_residual object.
+ * @param int64_t start
+ *   The first row.
+ * @param int64_t end
+ *   The row after the last one.
+ */
+static void matrix_residual_rows(void *context, int64_t start, int64_t end) {
+  struct matrix_residual *residual = (struct matrix_residual *)context;
+  const long double *restrict row;
+  long double sum;
+  for (int64_t i = start; i < end; i++) {
+    row = residual->a + (size_t)i * residual->size;
+    sum = residual->b[i];
+    for (int64_t j = 0; j < residual->size; j++) {
+      sum -= row[j] * residual->x[j];
+    }
+    residual->r[i] = sum;
+  }
+}
+
+/**
+ * Get the largest magnitude of a buffer.
+ *
+ * @param const long double* values
+ *   The values.
+ * @param int64_t count
+ *   The number of values.
+ *
+ * @return long double
+ *   The infinity norm of the values.
+ */
+static long double matrix_norm_max(const long double *values, int64_t count) {
+  long double norm = 0;
+  for (int64_t i = 0; i < count; i++) {
+    norm = fabsl(values[i]) > norm ? fabsl(values[i]) : norm;
+  }
+  return norm;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_solve_mixed(struct matrix *a, struct vector *b, enum matrix_precision precision) {
+  if (a == NULL || b == NULL || a->rows != a->columns || b->capacity != a->rows || matrix_mixed_type(precision) == NULL || vector_detach(b) != 0) {
+    return 1;
+  }
+  int64_t n = a->rows;
+  long double *rhs = malloc(sizeof(long double) * n * 2);
+  if (rhs == NULL) {
+    return 1;
+  }
+  long double *r = rhs + n;
+  long double *x = b->data;
+  memcpy(rhs, x, sizeof(long double) * n);
+  // The largest row sum of a, the scale of the residuals.
+  long double norm_a = 0;
+  long double row_sum;
+  for (int64_t i = 0; i < n; i++) {
+    row_sum = 0;
+    for (int64_t j = 0; j < n; j++) {
+      row_sum += fabsl(a->data[(size_t)i * n + j]);
+    }
+    norm_a = row_sum > norm_a ? row_sum : norm_a;
+  }
+  long double tolerance = sqrtl((long double)n) * LDBL_EPSILON * norm_a;
+  struct matrix_residual residual = {a->data, x, rhs, r, n};
+  int64_t grain = n >= MATRIX_MIXED_PARALLEL_GRAIN ? 1 : MATRIX_MIXED_PARALLEL_GRAIN / n;
+  struct matrix_lu *lu = matrix_lu(a, precision);
+  // A matrix singular once rounded may not be in long double precision.
+  if (lu == NULL && precision != MATRIX_PRECISION_LONG_DOUBLE) {
+    lu = matrix_lu(a, precision = MATRIX_PRECISION_LONG_DOUBLE);
+  }
+  int status = lu == NULL;
+  long double norm_d;
+  long double norm_previous = 0;
+  int64_t iteration = 0;
+  if (lu != NULL) {
+    matrix_lu_substitute(lu, x);
+  }
+  while (lu != NULL) {
+    // The residual in long double precision drives the corrections.
+    if (matrixmath_parallel_for(n, grain, matrix_residual_rows, &residual) != 0) {
+      matrix_residual_rows(&residual, 0, n);
+    }
+    if (matrix_norm_max(r, n) <= tolerance * matrix_norm_max(x, n)) {
+      break;
+    }
+    matrix_lu_substitute(lu, r);
+    norm_d = matrix_norm_max(r, n);
+    for (int64_t i = 0; i < n; i++) {
+      x[i] += r[i];
+    }
+    // The correction no longer changes the solution.
+    if (norm_d <= LDBL_EPSILON * matrix_norm_max(x, n)) {
+      break;
+    }
+    iteration++;
+    if ((iteration > 1 && !(norm_d <= norm_previous / 2)) || iteration == MATRIX_REFINE_ITERATIONS) {
+      // The attainable accuracy is reached with a long double factorization.
+      if (precision == MATRIX_PRECISION_LONG_DOUBLE) {
+        break;
+      }
+      // The matrix is too ill-conditioned for the precision, restart from a
+      // long double factorization.
+      matrix_lu_destroy(lu);
+      lu = matrix_lu(a, precision = MATRIX_PRECISION_LONG_DOUBLE);
+      status = lu == NULL;
+      memcpy(x, rhs, sizeof(long double) * n);
+      if (lu != NULL) {
+        matrix_lu_substitute(lu, x);
+      }
+      iteration = 0;
+      continue;
+    }
+    norm_previous = norm_d;
+  }
+  matrix_lu_destroy(lu);
+  free(rhs);
+  return status;
+}
@@ -0,0 +1,231 @@
+#include <stdlib.h>
+#include "../../include/matrixmath.h"
+
+/**
+ * Get the position of the first stored element of a row.
+ *
+ * A lower triangle stores i + 1 elements in row i, an upper one n - i.
+ *
+ * @param struct packed_matrix* object
+ *   The packed matrix.
+ * @param int64_t row
+ *   The row.
+ *
+ * @return size_t
+ *   The position of the row in the values.
+ */
+static size_t packed_matrix_row_offset(struct packed_matrix *object, int64_t row) {
+  size_t i = row;
+  if (object->triangle == MATRIX_LOWER) {
+    return i * (i + 1) / 2;
+  }
+  return i * object->size - (i * i - i) / 2;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct packed_matrix *packed_matrix_create(const int64_t size, enum matrix_triangle triangle, int symmetric) {
+  size_t count;
+  if (size < 0 || (triangle != MATRIX_LOWER && triangle != MATRIX_UPPER)) {
+    return NULL;
+  }
+  // The number of stored values must not wrap around.
+  if (matrixmath_size_mul((size_t)size, (size_t)size + 1, &count) != 0) {
+    return NULL;
+  }
+  // Allocate the packed matrix memory space.
+  struct packed_matrix *object = malloc(sizeof(struct packed_matrix));
+  if (object == NULL) {
+    return NULL;
+  }
+  // Only n * (n + 1) / 2 values are stored, zero initialized; one more keeps
+  // the allocation valid for an empty matrix.
+  object->data = calloc(count / 2 + 1, sizeof(long double));
+  if (object->data == NULL) {
+    free(object);
+    return NULL;
+  }
+  object->size = size;
+  object->triangle = triangle;
+  object->symmetric = symmetric != 0;
+  return object;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void packed_matrix_destroy(struct packed_matrix *object) {
+  if (object == NULL) {
+    return;
+  }
+  free(object->data);
+  object->data = NULL;
+  object->size = 0;
+  free(object);
+}
+
+/**
+ * {@inheritdoc}
+ */
+long double *packed_matrix_getl(struct packed_matrix *object, int64_t row, int64_t column) {
+  if (object == NULL || row < 0 || column < 0 || row >= object->size || column >= object->size) {
+    return NULL;
+  }
+  int outside = object->triangle == MATRIX_LOWER ? column > row : column < row;
+  if (outside) {
+    // The other triangle is the mirror of the stored one for symmetric matrices.
+    if (!object->symmetric) {
+      return NULL;
+    }
+    int64_t swap = row;
+    row = column;
+    column = swap;
+  }
+  size_t offset = packed_matrix_row_offset(object, row);
+  return object->data + offset + (object->triangle == MATRIX_LOWER ? column : column - row);
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct packed_matrix *packed_matrix_from_matrix(struct matrix *a, enum matrix_triangle triangle, int symmetric) {
+  if (a == NULL || a->rows != a->columns) {
+    return NULL;
+  }
+  struct packed_matrix *object = packed_matrix_create(a->rows, triangle, symmetric);
+  if (object == NULL) {
+    return NULL;
+  }
+  long double *values = object->data;
+  const long double *row;
+  int64_t n = a->rows;
+  for (int64_t i = 0; i < n; i++) {
+    row = a->data + (size_t)i * n;
+    if (triangle == MATRIX_LOWER) {
+      for (int64_t j = 0; j <= i; j++) {
+        *values++ = row[j];
+      }
+    }
+    else {
+      for (int64_t j = i; j < n; j++) {
+        *values++ = row[j];
+      }
+    }
+  }
+  return object;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct matrix *packed_matrix_to_matrix(struct packed_matrix *object) {
+  if (object == NULL) {
+    return NULL;
+  }
+  int64_t n = object->size;
+  struct matrix *result = matrix_create(n, n);
+  if (result == NULL) {
+    return NULL;
+  }
+  const long double *values = object->data;
+  int64_t first;
+  int64_t last;
+  for (int64_t i = 0; i < n; i++) {
+    first = object->triangle == MATRIX_LOWER ? 0 : i;
+    last = object->triangle == MATRIX_LOWER ? i + 1 : n;
+    for (int64_t j = first; j < last; j++) {
+      result->data[(size_t)i * n + j] = *values;
+      if (object->symmetric) {
+        result->data[(size_t)j * n + i] = *values;
+      }
+      values++;
+    }
+  }
+  return result;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int packed_matrix_mul_vector_dest(struct packed_matrix *object, struct vector *x, struct vector *dest) {
+  if (object == NULL || x == NULL || dest == NULL || x->capacity != object->size || dest->capacity != object->size || vector_detach(dest) != 0) {
+    return 1;
+  }
+  if (x->data == dest->data) {
+    return 1;
+  }
+  int64_t n = object->size;
+  const long double *restrict values = object->data;
+  const long double *restrict xd = x->data;
+  long double *restrict yd = dest->data;
+  long double sum;
+  long double xi;
+  int64_t first;
+  int64_t last;
+  for (int64_t i = 0; i < n; i++) {
+    yd[i] = 0;
+  }
+  // Each stored row is used once for its own product and, when symmetric,
+  // once more as the matching column.
+  for (int64_t i = 0; i < n; i++) {
+    first = object->triangle == MATRIX_LOWER ? 0 : i;
+    last = object->triangle == MATRIX_LOWER ? i + 1 : n;
+    sum = 0;
+    xi = xd[i];
+    for (int64_t j = first; j < last; j++) {
+      sum += values[j - first] * xd[j];
+    }
+    if (object->symmetric) {
+      for (int64_t j = first; j < last; j++) {
+        if (j != i) {
+          yd[j] += values[j - first] * xi;
+        }
+      }
+    }
+    yd[i] += sum;
+    values += last - first;
+  }
+  return 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int packed_matrix_solve_vector(struct packed_matrix *object, struct vector *b) {
+  if (object == NULL || b == NULL || b->capacity != object->size || object->symmetric || vector_detach(b) != 0) {
+    return 1;
+  }
+  int64_t n = object->size;
+  long double *x = b->data;
+  const long double *row;
+  long double sum;
+  if (object->triangle == MATRIX_LOWER) {
+    // Forward substitution, row i ends with the diagonal.
+    for (int64_t i = 0; i < n; i++) {
+      row = object->data + packed_matrix_row_offset(object, i);
+      sum = x[i];
+      for (int64_t j = 0; j < i; j++) {
+        sum -= row[j] * x[j];
+      }
+      if (row[i] == 0) {
+        return 1;
+      }
+      x[i] = sum / row[i];
+    }
+    return 0;
+  }
+  // Backward substitution, row i starts with the diagonal.
+  for (int64_t i = n - 1; i >= 0; i--) {
+    row = object->data + packed_matrix_row_offset(object, i);
+    sum = x[i];
+    for (int64_t j = i + 1; j < n; j++) {
+      sum -= row[j - i] * x[j];
+    }
+    if (row[0] == 0) {
+      return 1;
+    }
+    x[i] = sum / row[0];
+  }
+  return 0;
+}
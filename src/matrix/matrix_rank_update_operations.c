@@ -0,0 +1,252 @@
+#include <stdlib.h>
+#include "../../include/matrixmath.h"
+
+/**
+ * The number of elements below which an update is not split across threads.
+ */
+#define MATRIX_RANK_UPDATE_PARALLEL_GRAIN 16384
+
+/**
+ * The number of columns of a row updated at once by the rank-1 updates.
+ *
+ * A tile of y stays in the L1 cache while it is applied to all the rows of
+ * the chunk.
+ */
+#define MATRIX_RANK_UPDATE_COLUMN_TILE 512
+
+/**
+ * The number of rows and columns of the tiles of the SYRK output.
+ */
+#define MATRIX_SYRK_TILE 64
+
+/**
+ * The number of columns of A walked at once by the SYRK tiles.
+ *
+ * Both tile row panels of A, 2 x 64 x 256 long doubles, fit in the L2 cache.
+ */
+#define MATRIX_SYRK_DEPTH 256
+
+/**
+ * The data struct definition for a rank-1 update in progress.
+ */
+struct matrix_rank_one {
+  long double alpha;
+  const long double *x;
+  const long double *y;
+  long double *a;
+  int64_t columns;
+  int accumulate;
+};
+
+/**
+ * Parallel loop body of the rank-1 updates, the loop runs over rows.
+ *
+ * @param void* context
+ *   The matrix_rank_one object.
+ * @param int64_t start
+ *   The first row to update.
+ * @param int64_t end
+ *   The row after the last one to update.
+ */
+static void matrix_rank_one_rows(void *context, int64_t start, int64_t end) {
+  struct matrix_rank_one *update = (struct matrix_rank_one *)context;
+  const long double *restrict y = update->y;
+  long double *restrict row;
+  long double scale;
+  int64_t last;
+  for (int64_t first = 0; first < update->columns; first += MATRIX_RANK_UPDATE_COLUMN_TILE) {
+    last = first + MATRIX_RANK_UPDATE_COLUMN_TILE < update->columns ? first + MATRIX_RANK_UPDATE_COLUMN_TILE : update->columns;
+    for (int64_t i = start; i < end; i++) {
+      row = update->a + (size_t)i * update->columns;
+      scale = update->alpha * update->x[i];
+      if (update->accumulate) {
+        for (int64_t j = first; j < last; j++) {
+          row[j] += scale * y[j];
+        }
+      }
+      else {
+        for (int64_t j = first; j < last; j++) {
+          row[j] = scale * y[j];
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Compute a = alpha * x * y^T, or a += alpha * x * y^T, in parallel.
+ *
+ * @param long double alpha
+ *   The scale factor.
+ * @param struct vector* x
+ *   The column vector, with one element per row of a.
+ * @param struct vector* y
+ *   The row vector, with one element per column of a.
+ * @param struct matrix* a
+ *   The destination matrix.
+ * @param int accumulate
+ *   Whether the product is added to a instead of overwriting it.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+static int matrix_rank_one(long double alpha, struct vector *x, struct vector *y, struct matrix *a, int accumulate) {
+  if (x == NULL || y == NULL || a == NULL || x->capacity != a->rows || y->capacity != a->columns || matrix_detach(a) != 0) {
+    return 1;
+  }
+  // The update reads x and y while writing a, they must not share its values.
+  if (x->data == a->data || y->data == a->data) {
+    return 1;
+  }
+  struct matrix_rank_one update = {alpha, x->data, y->data, a->data, a->columns, accumulate};
+  int64_t grain = a->columns > 0 ? MATRIX_RANK_UPDATE_PARALLEL_GRAIN / a->columns : a->rows;
+  return matrixmath_parallel_for(a->rows, grain > 0 ? grain : 1, matrix_rank_one_rows, &update);
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct matrix *vector_outer_product(struct vector *x, struct vector *y) {
+  if (x == NULL || y == NULL) {
+    return NULL;
+  }
+  // Create the new Matrix to store the result of the operation.
+  struct matrix *result = matrix_create(x->capacity, y->capacity);
+  if (result == NULL) {
+    return NULL;
+  }
+  matrix_rank_one(1, x, y, result, 0);
+  return result;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int vector_outer_product_dest(struct vector *x, struct vector *y, struct matrix *dest) {
+  return matrix_rank_one(1, x, y, dest, 0);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_ger(long double alpha, struct vector *x, struct vector *y, struct matrix *a) {
+  return matrix_rank_one(alpha, x, y, a, 1);
+}
+
+/**
+ * The data struct definition for a SYRK in progress.
+ */
+struct matrix_syrk {
+  long double alpha;
+  long double beta;
+  const long double *a;
+  long double *c;
+  int64_t n;
+  int64_t k;
+  enum matrix_triangle triangle;
+  int64_t tiles;
+};
+
+/**
+ * Compute one tile of the lower triangle of C = alpha * A * A^T + beta * C.
+ *
+ * The element (i, j) is the inner product of the rows i and j of A, both
+ * contiguous; the rows of the two tiles are walked MATRIX_SYRK_DEPTH columns
+ * at a time so they are reused from the cache.
+ *
+ * @param struct matrix_syrk* syrk
+ *   The SYRK object.
+ * @param int64_t ti
+ *   The tile row.
+ * @param int64_t tj
+ *   The tile column, at most ti.
+ */
+static void matrix_syrk_tile(struct matrix_syrk *syrk, int64_t ti, int64_t tj) {
+  int64_t i0 = ti * MATRIX_SYRK_TILE;
+  int64_t i1 = i0 + MATRIX_SYRK_TILE < syrk->n ? i0 + MATRIX_SYRK_TILE : syrk->n;
+  int64_t j0 = tj * MATRIX_SYRK_TILE;
+  int64_t j1 = j0 + MATRIX_SYRK_TILE < syrk->n ? j0 + MATRIX_SYRK_TILE : syrk->n;
+  int64_t k = syrk->k;
+  const long double *restrict x;
+  const long double *restrict y;
+  long double *cij;
+  long double s[4];
+  int64_t last;
+  int64_t l;
+  // Scale the tile first, without reading C when beta is 0.
+  for (int64_t i = i0; i < i1; i++) {
+    for (int64_t j = j0; j < (ti == tj ? i + 1 : j1); j++) {
+      cij = syrk->triangle == MATRIX_LOWER ? syrk->c + (size_t)i * syrk->n + j : syrk->c + (size_t)j * syrk->n + i;
+      *cij = syrk->beta == 0 ? 0 : syrk->beta * (*cij);
+    }
+  }
+  for (int64_t l0 = 0; l0 < k; l0 += MATRIX_SYRK_DEPTH) {
+    last = l0 + MATRIX_SYRK_DEPTH < k ? l0 + MATRIX_SYRK_DEPTH : k;
+    for (int64_t i = i0; i < i1; i++) {
+      x = syrk->a + (size_t)i * k;
+      for (int64_t j = j0; j < (ti == tj ? i + 1 : j1); j++) {
+        y = syrk->a + (size_t)j * k;
+        s[0] = s[1] = s[2] = s[3] = 0;
+        for (l = l0; l + 4 <= last; l += 4) {
+          s[0] += x[l] * y[l];
+          s[1] += x[l + 1] * y[l + 1];
+          s[2] += x[l + 2] * y[l + 2];
+          s[3] += x[l + 3] * y[l + 3];
+        }
+        for (; l < last; l++) {
+          s[0] += x[l] * y[l];
+        }
+        cij = syrk->triangle == MATRIX_LOWER ? syrk->c + (size_t)i * syrk->n + j : syrk->c + (size_t)j * syrk->n + i;
+        *cij += syrk->alpha * ((s[0] + s[1]) + (s[2] + s[3]));
+      }
+    }
+  }
+}
+
+/**
+ * Parallel loop body of the SYRK, the loop runs over pairs of tile rows.
+ *
+ * Tile row p has p + 1 tiles, so the pair (p, tiles - 1 - p) always has the
+ * same amount of work and a static partition of the pairs is balanced.
+ *
+ * @param void* context
+ *   The matrix_syrk object.
+ * @param int64_t start
+ *   The first pair.
+ * @param int64_t end
+ *   The pair after the last one.
+ */
+static void matrix_syrk_pairs(void *context, int64_t start, int64_t end) {
+  struct matrix_syrk *syrk = (struct matrix_syrk *)context;
+  int64_t other;
+  for (int64_t p = start; p < end; p++) {
+    for (int64_t tj = 0; tj <= p; tj++) {
+      matrix_syrk_tile(syrk, p, tj);
+    }
+    other = syrk->tiles - 1 - p;
+    if (other == p) {
+      continue;
+    }
+    for (int64_t tj = 0; tj <= other; tj++) {
+      matrix_syrk_tile(syrk, other, tj);
+    }
+  }
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_syrk(long double alpha, struct matrix *a, long double beta, struct matrix *c, enum matrix_triangle triangle) {
+  if (a == NULL || c == NULL || c->rows != a->rows || c->columns != a->rows || matrix_detach(c) != 0) {
+    return 1;
+  }
+  if (c->data == a->data || (triangle != MATRIX_LOWER && triangle != MATRIX_UPPER)) {
+    return 1;
+  }
+  int64_t tiles = (a->rows + MATRIX_SYRK_TILE - 1) / MATRIX_SYRK_TILE;
+  struct matrix_syrk syrk = {alpha, beta, a->data, c->data, a->rows, a->columns, triangle, tiles};
+  // A tile row pair costs about tiles * 64 * 64 * k multiply-adds.
+  int64_t work = (int64_t)(tiles + 1) * MATRIX_SYRK_TILE * MATRIX_SYRK_TILE * (a->columns > 0 ? a->columns : 1);
+  int64_t grain = work >= MATRIX_RANK_UPDATE_PARALLEL_GRAIN ? 1 : MATRIX_RANK_UPDATE_PARALLEL_GRAIN / work;
+  return matrixmath_parallel_for((tiles + 1) / 2, grain, matrix_syrk_pairs, &syrk);
+}
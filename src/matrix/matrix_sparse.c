@@ -0,0 +1,171 @@
+#include <stdlib.h>
+#include "../../include/matrixmath.h"
+
+/**
+ * The number of stored values below which a sparse product is not split
+ * across threads.
+ */
+#define SPARSE_MATRIX_PARALLEL_GRAIN 16384
+
+/**
+ * {@inheritdoc}
+ */
+struct sparse_matrix *sparse_matrix_create(const int64_t rows, const int64_t columns, const int64_t nonzeros) {
+  size_t values_bytes;
+  size_t indices_bytes;
+  size_t offsets_bytes;
+  if (rows < 0 || columns < 0 || nonzeros < 0 || rows == INT64_MAX || nonzeros == INT64_MAX) {
+    return NULL;
+  }
+  // None of the buffer sizes may wrap around; one more value keeps the
+  // allocations valid for an empty matrix.
+  if (matrixmath_array_size(nonzeros + 1, sizeof(long double), &values_bytes) != 0 || matrixmath_array_size(nonzeros + 1, sizeof(int64_t), &indices_bytes) != 0 || matrixmath_array_size(rows + 1, sizeof(int64_t), &offsets_bytes) != 0) {
+    return NULL;
+  }
+  // Allocate the sparse matrix memory space.
+  struct sparse_matrix *object = malloc(sizeof(struct sparse_matrix));
+  if (object == NULL) {
+    return NULL;
+  }
+  object->values = malloc(values_bytes);
+  object->indices = malloc(indices_bytes);
+  object->offsets = calloc((size_t)rows + 1, sizeof(int64_t));
+  if (object->values == NULL || object->indices == NULL || object->offsets == NULL) {
+    sparse_matrix_destroy(object);
+    return NULL;
+  }
+  object->rows = rows;
+  object->columns = columns;
+  object->nonzeros = nonzeros;
+  return object;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void sparse_matrix_destroy(struct sparse_matrix *object) {
+  if (object == NULL) {
+    return;
+  }
+  free(object->values);
+  free(object->indices);
+  free(object->offsets);
+  object->values = NULL;
+  object->indices = NULL;
+  object->offsets = NULL;
+  free(object);
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct sparse_matrix *sparse_matrix_from_matrix(struct matrix *a) {
+  if (a == NULL) {
+    return NULL;
+  }
+  // Count the values first, the buffers are allocated once.
+  size_t size = (size_t)a->rows * a->columns;
+  int64_t nonzeros = 0;
+  for (size_t i = 0; i < size; i++) {
+    nonzeros += a->data[i] != 0;
+  }
+  struct sparse_matrix *object = sparse_matrix_create(a->rows, a->columns, nonzeros);
+  if (object == NULL) {
+    return NULL;
+  }
+  const long double *row;
+  int64_t position = 0;
+  for (int64_t i = 0; i < a->rows; i++) {
+    row = a->data + (size_t)i * a->columns;
+    for (int64_t j = 0; j < a->columns; j++) {
+      if (row[j] != 0) {
+        object->values[position] = row[j];
+        object->indices[position] = j;
+        position++;
+      }
+    }
+    object->offsets[i + 1] = position;
+  }
+  return object;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct matrix *sparse_matrix_to_matrix(struct sparse_matrix *object) {
+  if (object == NULL) {
+    return NULL;
+  }
+  struct matrix *result = matrix_create(object->rows, object->columns);
+  if (result == NULL) {
+    return NULL;
+  }
+  long double *row;
+  for (int64_t i = 0; i < object->rows; i++) {
+    row = result->data + (size_t)i * object->columns;
+    for (int64_t p = object->offsets[i]; p < object->offsets[i + 1]; p++) {
+      row[object->indices[p]] += object->values[p];
+    }
+  }
+  return result;
+}
+
+/**
+ * The data struct definition for a sparse product in progress.
+ */
+struct sparse_matrix_product {
+  const struct sparse_matrix *a;
+  const long double *x;
+  long double *y;
+};
+
+/**
+ * Parallel loop body of the sparse product, the loop runs over rows.
+ *
+ * @param void* context
+ *   The sparse_matrix_product object.
+ * @param int64_t start
+ *   The first row.
+ * @param int64_t end
+ *   The row after the last one.
+ */
+static void sparse_matrix_product_rows(void *context, int64_t start, int64_t end) {
+  struct sparse_matrix_product *product = (struct sparse_matrix_product *)context;
+  const long double *restrict values = product->a->values;
+  const int64_t *restrict indices = product->a->indices;
+  const int64_t *restrict offsets = product->a->offsets;
+  const long double *restrict x = product->x;
+  long double sum;
+  for (int64_t i = start; i < end; i++) {
+    sum = 0;
+    for (int64_t p = offsets[i]; p < offsets[i + 1]; p++) {
+      sum += values[p] * x[indices[p]];
+    }
+    product->y[i] = sum;
+  }
+}
+
+/**
+ * {@inheritdoc}
+ */
+int sparse_matrix_mul_vector_dest(struct sparse_matrix *object, struct vector *x, struct vector *dest) {
+  if (object == NULL || x == NULL || dest == NULL || x->capacity != object->columns || dest->capacity != object->rows || vector_detach(dest) != 0) {
+    return 1;
+  }
+  // Every row reads scattered elements of x, it cannot be overwritten.
+  if (x->data == dest->data) {
+    return 1;
+  }
+  struct sparse_matrix_product product = {object, x->data, dest->data};
+  // Split the rows by their average number of values.
+  int64_t average = object->rows > 0 ? object->nonzeros / object->rows : 0;
+  int64_t grain = SPARSE_MATRIX_PARALLEL_GRAIN / (average > 0 ? average : 1);
+  return matrixmath_parallel_for(object->rows, grain > 0 ? grain : 1, sparse_matrix_product_rows, &product);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int sparse_operator_apply(void *context, struct vector *x, struct vector *y) {
+  return sparse_matrix_mul_vector_dest((struct sparse_matrix *)context, x, y);
+}
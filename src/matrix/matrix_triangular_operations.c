@@ -0,0 +1,209 @@
+#include <stdlib.h>
+#include "../../include/matrixmath.h"
+
+/**
+ * The number of rows of the diagonal blocks of the blocked algorithms.
+ *
+ * The diagonal blocks are handled by the triangular kernels, everything else
+ * by the matrix product: with n rows, all but n * 64 / 2 of the n^2 / 2
+ * multiply-adds per right-hand side go through matrix_gemm_strided().
+ */
+#define MATRIX_TRIANGULAR_BLOCK 64
+
+/**
+ * The number of right-hand side columns below which a triangular kernel is not
+ * split across threads.
+ */
+#define MATRIX_TRIANGULAR_PARALLEL_GRAIN 64
+
+/**
+ * The data struct definition for a triangular kernel in progress.
+ *
+ * The kernel works on the rows [first, last) of b, with the matching diagonal
+ * block of a; its parallel loop runs over the columns of b.
+ */
+struct matrix_triangular {
+  const long double *a;
+  long double *b;
+  int64_t n;
+  int64_t columns;
+  int64_t first;
+  int64_t last;
+  enum matrix_triangle triangle;
+  int unit;
+};
+
+/**
+ * Parallel loop body of the triangular solve of a diagonal block.
+ *
+ * Forward (lower) or backward (upper) substitution, every row update is a
+ * contiguous loop over the columns of the chunk.
+ *
+ * @param void* context
+ *   The matrix_triangular object.
+ * @param int64_t start
+ *   The first column of b.
+ * @param int64_t end
+ *   The column after the last one.
+ */
+static void matrix_trsm_block(void *context, int64_t start, int64_t end) {
+  struct matrix_triangular *t = (struct matrix_triangular *)context;
+  long double *restrict row;
+  const long double *restrict other;
+  long double val;
+  int64_t i;
+  for (int64_t step = 0; step < t->last - t->first; step++) {
+    i = t->triangle == MATRIX_LOWER ? t->first + step : t->last - 1 - step;
+    row = t->b + (size_t)i * t->columns;
+    // Subtract the rows of the block already solved.
+    for (int64_t l = t->first; l < t->last; l++) {
+      if (t->triangle == MATRIX_LOWER ? l >= i : l <= i) {
+        continue;
+      }
+      val = t->a[(size_t)i * t->n + l];
+      other = t->b + (size_t)l * t->columns;
+      for (int64_t j = start; j < end; j++) {
+        row[j] -= val * other[j];
+      }
+    }
+    if (!t->unit) {
+      val = t->a[(size_t)i * t->n + i];
+      for (int64_t j = start; j < end; j++) {
+        row[j] /= val;
+      }
+    }
+  }
+}
+
+/**
+ * Parallel loop body of the triangular product of a diagonal block, in place.
+ *
+ * The rows are computed in the order that leaves the rows they depend on
+ * untouched: bottom up for a lower triangle, top down for an upper one.
+ *
+ * @param void* context
+ *   The matrix_triangular object.
+ * @param int64_t start
+ *   The first column of b.
+ * @param int64_t end
+ *   The column after the last one.
+ */
+static void matrix_trmm_block(void *context, int64_t start, int64_t end) {
+  struct matrix_triangular *t = (struct matrix_triangular *)context;
+  long double *restrict row;
+  const long double *restrict other;
+  long double val;
+  int64_t i;
+  for (int64_t step = 0; step < t->last - t->first; step++) {
+    i = t->triangle == MATRIX_LOWER ? t->last - 1 - step : t->first + step;
+    row = t->b + (size_t)i * t->columns;
+    if (!t->unit) {
+      val = t->a[(size_t)i * t->n + i];
+      for (int64_t j = start; j < end; j++) {
+        row[j] *= val;
+      }
+    }
+    for (int64_t l = t->first; l < t->last; l++) {
+      if (t->triangle == MATRIX_LOWER ? l >= i : l <= i) {
+        continue;
+      }
+      val = t->a[(size_t)i * t->n + l];
+      other = t->b + (size_t)l * t->columns;
+      for (int64_t j = start; j < end; j++) {
+        row[j] += val * other[j];
+      }
+    }
+  }
+}
+
+/**
+ * Check the operands of a triangular operation.
+ *
+ * @param struct matrix* a
+ *   The triangular matrix.
+ * @param struct matrix* b
+ *   The right-hand sides.
+ * @param enum matrix_triangle triangle
+ *   The triangle of a.
+ *
+ * @return int
+ *   Returns 0 when the operands are valid, otherwise 1.
+ */
+static int matrix_triangular_check(struct matrix *a, struct matrix *b, enum matrix_triangle triangle) {
+  if (a == NULL || b == NULL || a->rows != a->columns || b->rows != a->rows || matrix_detach(b) != 0) {
+    return 1;
+  }
+  if (a->data == b->data || (triangle != MATRIX_LOWER && triangle != MATRIX_UPPER)) {
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_trsm(enum matrix_triangle triangle, int unit, long double alpha, struct matrix *a, struct matrix *b) {
+  if (matrix_triangular_check(a, b, triangle) != 0) {
+    return 1;
+  }
+  int64_t n = a->rows;
+  int64_t columns = b->columns;
+  if (alpha != 1 && matrix_scalar_mul_dest(alpha, b, b) != 0) {
+    return 1;
+  }
+  struct matrix_triangular t = {a->data, b->data, n, columns, 0, 0, triangle, unit};
+  int64_t blocks = (n + MATRIX_TRIANGULAR_BLOCK - 1) / MATRIX_TRIANGULAR_BLOCK;
+  int64_t block;
+  for (int64_t step = 0; step < blocks; step++) {
+    // Lower triangles are solved top down, upper ones bottom up.
+    block = triangle == MATRIX_LOWER ? step : blocks - 1 - step;
+    t.first = block * MATRIX_TRIANGULAR_BLOCK;
+    t.last = t.first + MATRIX_TRIANGULAR_BLOCK < n ? t.first + MATRIX_TRIANGULAR_BLOCK : n;
+    if (matrixmath_parallel_for(columns, MATRIX_TRIANGULAR_PARALLEL_GRAIN, matrix_trsm_block, &t) != 0) {
+      return 1;
+    }
+    // Remove the solved block from the rows still to solve.
+    if (triangle == MATRIX_LOWER && t.last < n && matrix_gemm_strided(n - t.last, columns, t.last - t.first, -1, a->data + (size_t)t.last * n + t.first, n, b->data + (size_t)t.first * columns, columns, 1, b->data + (size_t)t.last * columns, columns) != 0) {
+      return 1;
+    }
+    if (triangle == MATRIX_UPPER && t.first > 0 && matrix_gemm_strided(t.first, columns, t.last - t.first, -1, a->data + t.first, n, b->data + (size_t)t.first * columns, columns, 1, b->data, columns) != 0) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_trmm(enum matrix_triangle triangle, int unit, long double alpha, struct matrix *a, struct matrix *b) {
+  if (matrix_triangular_check(a, b, triangle) != 0) {
+    return 1;
+  }
+  int64_t n = a->rows;
+  int64_t columns = b->columns;
+  struct matrix_triangular t = {a->data, b->data, n, columns, 0, 0, triangle, unit};
+  int64_t blocks = (n + MATRIX_TRIANGULAR_BLOCK - 1) / MATRIX_TRIANGULAR_BLOCK;
+  int64_t block;
+  for (int64_t step = 0; step < blocks; step++) {
+    // A block row only depends on the block rows above it for a lower
+    // triangle, so those are overwritten last; the other way round for an
+    // upper one.
+    block = triangle == MATRIX_LOWER ? blocks - 1 - step : step;
+    t.first = block * MATRIX_TRIANGULAR_BLOCK;
+    t.last = t.first + MATRIX_TRIANGULAR_BLOCK < n ? t.first + MATRIX_TRIANGULAR_BLOCK : n;
+    if (matrixmath_parallel_for(columns, MATRIX_TRIANGULAR_PARALLEL_GRAIN, matrix_trmm_block, &t) != 0) {
+      return 1;
+    }
+    if (triangle == MATRIX_LOWER && t.first > 0 && matrix_gemm_strided(t.last - t.first, columns, t.first, 1, a->data + (size_t)t.first * n, n, b->data, columns, 1, b->data + (size_t)t.first * columns, columns) != 0) {
+      return 1;
+    }
+    if (triangle == MATRIX_UPPER && t.last < n && matrix_gemm_strided(t.last - t.first, columns, n - t.last, 1, a->data + (size_t)t.first * n + t.last, n, b->data + (size_t)t.last * columns, columns, 1, b->data + (size_t)t.first * columns, columns) != 0) {
+      return 1;
+    }
+  }
+  if (alpha != 1 && matrix_scalar_mul_dest(alpha, b, b) != 0) {
+    return 1;
+  }
+  return 0;
+}
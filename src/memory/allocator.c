@@ -0,0 +1,152 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "../../include/matrixmath.h"
+
+/**
+ * The size of a huge page, and the size from which a buffer may use them.
+ */
+#define ALLOCATOR_HUGE_PAGE 2097152
+
+/**
+ * The allocator used by the library when none is given, NULL for the built-in one.
+ */
+static struct matrixmath_allocator *allocator_current = NULL;
+
+/**
+ * The huge page policy used by the library when none is given, -1 until the
+ * MATRIXMATH_HUGE_PAGES environment variable has been read.
+ */
+static int allocator_huge_pages = -1;
+
+/**
+ * {@inheritdoc}
+ */
+void matrixmath_set_allocator(struct matrixmath_allocator *allocator) {
+  __atomic_store_n(&allocator_current, allocator, __ATOMIC_RELEASE);
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct matrixmath_allocator *matrixmath_get_allocator() {
+  return __atomic_load_n(&allocator_current, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void matrixmath_set_huge_pages(enum huge_pages_policy policy) {
+  __atomic_store_n(&allocator_huge_pages, policy == HUGE_PAGES_DEFAULT ? -1 : (int)policy, __ATOMIC_RELAXED);
+}
+
+/**
+ * {@inheritdoc}
+ */
+enum huge_pages_policy matrixmath_get_huge_pages() {
+  int policy = __atomic_load_n(&allocator_huge_pages, __ATOMIC_RELAXED);
+  if (policy < 0) {
+    const char *value = getenv("MATRIXMATH_HUGE_PAGES");
+    policy = HUGE_PAGES_NONE;
+    if (value != NULL && strcmp(value, "transparent") == 0) {
+      policy = HUGE_PAGES_TRANSPARENT;
+    }
+    else if (value != NULL && strcmp(value, "explicit") == 0) {
+      policy = HUGE_PAGES_EXPLICIT;
+    }
+    // Every thread reads the same variable, the race is harmless.
+    __atomic_store_n(&allocator_huge_pages, policy, __ATOMIC_RELAXED);
+  }
+  return (enum huge_pages_policy)policy;
+}
+
+/**
+ * Allocate a buffer with the built-in allocator.
+ *
+ * The values start MATRIXMATH_ALIGNMENT bytes after the start of the
+ * allocation, where the length of the mapping is kept, 0 when the allocation
+ * comes from the heap. Buffers of a huge page and more are aligned on huge
+ * pages when they are enabled, so the values span as few of them as possible.
+ *
+ * @param size_t bytes
+ *   The number of bytes.
+ *
+ * @return void*
+ *   The buffer, otherwise NULL.
+ */
+static void *allocator_builtin(size_t bytes) {
+  size_t length;
+  if (bytes > SIZE_MAX - ALLOCATOR_HUGE_PAGE) {
+    return NULL;
+  }
+  length = bytes + MATRIXMATH_ALIGNMENT;
+  enum huge_pages_policy policy = bytes >= ALLOCATOR_HUGE_PAGE ? matrixmath_get_huge_pages() : HUGE_PAGES_NONE;
+  void *base = NULL;
+  size_t mapped = 0;
+#ifdef MAP_HUGETLB
+  if (policy == HUGE_PAGES_EXPLICIT) {
+    // The pool of huge pages may be empty or too small, the transparent ones
+    // are used then.
+    mapped = (length + ALLOCATOR_HUGE_PAGE - 1) & ~(size_t)(ALLOCATOR_HUGE_PAGE - 1);
+    base = mmap(NULL, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (base == MAP_FAILED) {
+      base = NULL;
+      mapped = 0;
+    }
+  }
+#endif
+  if (base == NULL) {
+    size_t alignment = policy != HUGE_PAGES_NONE ? ALLOCATOR_HUGE_PAGE : MATRIXMATH_ALIGNMENT;
+    if (posix_memalign(&base, alignment, length) != 0) {
+      return NULL;
+    }
+#ifdef MADV_HUGEPAGE
+    // A hint only, the whole huge pages of the buffer are promoted when the
+    // system allows it.
+    if (policy != HUGE_PAGES_NONE) {
+      madvise(base, length & ~(size_t)(ALLOCATOR_HUGE_PAGE - 1), MADV_HUGEPAGE);
+    }
+#endif
+  }
+  *(size_t *)base = mapped;
+  return (char *)base + MATRIXMATH_ALIGNMENT;
+}
+
+/**
+ * {@inheritdoc}
+ */
+long double *matrixmath_allocate_values(size_t bytes, struct matrixmath_allocator **allocator) {
+  struct matrixmath_allocator *current = matrixmath_get_allocator();
+  if (allocator != NULL) {
+    *allocator = current;
+  }
+  if (bytes == 0) {
+    bytes = sizeof(long double);
+  }
+  if (current != NULL) {
+    return current->allocate(current->context, bytes, MATRIXMATH_ALIGNMENT);
+  }
+  return allocator_builtin(bytes);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void matrixmath_release_allocated(void *context, long double *data) {
+  struct matrixmath_allocator *allocator = (struct matrixmath_allocator *)context;
+  if (data == NULL) {
+    return;
+  }
+  if (allocator != NULL) {
+    allocator->release(allocator->context, data);
+    return;
+  }
+  void *base = (char *)data - MATRIXMATH_ALIGNMENT;
+  size_t mapped = *(size_t *)base;
+  if (mapped > 0) {
+    munmap(base, mapped);
+    return;
+  }
+  free(base);
+}
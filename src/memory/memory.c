@@ -0,0 +1,102 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include "../../include/matrixmath.h"
+
+/**
+ * {@inheritdoc}
+ */
+int matrixmath_size_mul(size_t a, size_t b, size_t *result) {
+  if (result == NULL) {
+    return 1;
+  }
+  if (b != 0 && a > SIZE_MAX / b) {
+    return 1;
+  }
+  *result = a * b;
+  return 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrixmath_array_size(int64_t count, size_t element, size_t *bytes) {
+  if (count < 0 || (uint64_t)count > SIZE_MAX) {
+    return 1;
+  }
+  return matrixmath_size_mul((size_t)count, element, bytes);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void matrixmath_release_free(void *context, long double *data) {
+  free(data);
+}
+
+/**
+ * The data struct definition for values shared by several objects.
+ */
+struct matrixmath_shared {
+  long double *data;
+  void (*release)(void *context, long double *data);
+  void *context;
+  int64_t references;
+};
+
+/**
+ * {@inheritdoc}
+ */
+struct matrixmath_shared *matrixmath_shared_get(struct matrixmath_shared **slot, long double *data, void (*release)(void *context, long double *data), void *context) {
+  if (slot == NULL) {
+    return NULL;
+  }
+  struct matrixmath_shared *shared = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+  if (shared != NULL) {
+    return shared;
+  }
+  struct matrixmath_shared *created = malloc(sizeof(struct matrixmath_shared));
+  if (created == NULL) {
+    return NULL;
+  }
+  created->data = data;
+  created->release = release;
+  created->context = context;
+  created->references = 1;
+  // Another thread cloning the same object may have installed one first.
+  if (!__atomic_compare_exchange_n(slot, &shared, created, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+    free(created);
+    return shared;
+  }
+  return created;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void matrixmath_shared_retain(struct matrixmath_shared *shared) {
+  __atomic_fetch_add(&shared->references, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrixmath_shared_unique(struct matrixmath_shared *shared) {
+  return __atomic_load_n(&shared->references, __ATOMIC_ACQUIRE) == 1;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void matrixmath_shared_release(struct matrixmath_shared *shared) {
+  if (shared == NULL) {
+    return;
+  }
+  // The last reference sees every write made through the other ones.
+  if (__atomic_sub_fetch(&shared->references, 1, __ATOMIC_ACQ_REL) != 0) {
+    return;
+  }
+  if (shared->release != NULL) {
+    shared->release(shared->context, shared->data);
+  }
+  free(shared);
+}
@@ -0,0 +1,189 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include "../../include/matrixmath.h"
+
+/**
+ * The minimum number of values initialized per thread, the rows of a matrix
+ * are split like the matrix kernels split them.
+ */
+#define NUMA_PARALLEL_GRAIN 16384
+
+/**
+ * The number of bytes under which a buffer is initialized by the calling
+ * thread: it fits in the caches and the heap recycles it anyway.
+ */
+#define NUMA_MIN_BYTES 1048576
+
+/**
+ * The number of memory nodes the interleaving mask can hold.
+ */
+#define NUMA_MAX_NODES 1024
+
+/**
+ * The allocation policy used by the library when none is given, -1 until the
+ * MATRIXMATH_NUMA environment variable has been read.
+ */
+static int numa_policy = -1;
+
+/**
+ * {@inheritdoc}
+ */
+void matrixmath_set_numa_policy(enum numa_policy policy) {
+  __atomic_store_n(&numa_policy, policy == NUMA_POLICY_DEFAULT ? -1 : (int)policy, __ATOMIC_RELAXED);
+}
+
+/**
+ * {@inheritdoc}
+ */
+enum numa_policy matrixmath_get_numa_policy() {
+  int policy = __atomic_load_n(&numa_policy, __ATOMIC_RELAXED);
+  if (policy < 0) {
+    const char *value = getenv("MATRIXMATH_NUMA");
+    policy = NUMA_POLICY_FIRST_TOUCH;
+    if (value != NULL && strcmp(value, "interleave") == 0) {
+      policy = NUMA_POLICY_INTERLEAVE;
+    }
+    else if (value != NULL && strcmp(value, "none") == 0) {
+      policy = NUMA_POLICY_NONE;
+    }
+    // Every thread reads the same variable, the race is harmless.
+    __atomic_store_n(&numa_policy, policy, __ATOMIC_RELAXED);
+  }
+  return (enum numa_policy)policy;
+}
+
+/**
+ * Spread the pages of a buffer over the memory nodes the process may use.
+ *
+ * Nothing is done on a single node machine, or when the kernel refuses it:
+ * the pages then stay on the node of the thread touching them first.
+ *
+ * @param void* data
+ *   The buffer, not touched yet.
+ * @param size_t bytes
+ *   The size of the buffer.
+ */
+static void numa_interleave(void *data, size_t bytes) {
+#if defined(__linux__) && defined(SYS_mbind) && defined(SYS_get_mempolicy)
+  unsigned long nodes[NUMA_MAX_NODES / (8 * sizeof(unsigned long))] = {0};
+  int count = 0;
+  if (syscall(SYS_get_mempolicy, NULL, nodes, NUMA_MAX_NODES, NULL, MPOL_F_MEMS_ALLOWED) == 0) {
+    for (size_t i = 0; i < sizeof(nodes) / sizeof(nodes[0]); i++) {
+      count += __builtin_popcountl(nodes[i]);
+    }
+  }
+  if (count < 2) {
+    return;
+  }
+  // The policy applies to whole pages, the partial ones at both ends are left
+  // to the first touch.
+  uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+  uintptr_t start = ((uintptr_t)data + page - 1) & ~(page - 1);
+  uintptr_t end = ((uintptr_t)data + bytes) & ~(page - 1);
+  if (end > start) {
+    syscall(SYS_mbind, (void *)start, (unsigned long)(end - start), MPOL_INTERLEAVE, nodes, NUMA_MAX_NODES + 1, 0);
+  }
+#endif
+}
+
+/**
+ * The data struct definition for rows initialized in parallel.
+ */
+struct numa_rows {
+  long double *data;
+  const long double *source;
+  long double value;
+  int64_t columns;
+};
+
+/**
+ * Initialize a range of rows, copied from the source or set to the value.
+ *
+ * @param void* context
+ *   The numa_rows object.
+ * @param int64_t start
+ *   The first row.
+ * @param int64_t end
+ *   The row after the last one.
+ */
+static void numa_rows_run(void *context, int64_t start, int64_t end) {
+  struct numa_rows *rows = (struct numa_rows *)context;
+  size_t first = (size_t)start * rows->columns;
+  size_t count = (size_t)(end - start) * rows->columns;
+  long double *data = rows->data + first;
+  if (rows->source != NULL) {
+    memcpy(data, rows->source + first, sizeof(long double) * count);
+    return;
+  }
+  if (rows->value == 0 && !__builtin_signbit(rows->value)) {
+    memset(data, 0, sizeof(long double) * count);
+    return;
+  }
+  for (size_t i = 0; i < count; i++) {
+    data[i] = rows->value;
+  }
+}
+
+/**
+ * Initialize rows in parallel, split the way the kernels split them.
+ *
+ * @param struct numa_rows* rows
+ *   The rows.
+ * @param int64_t count
+ *   The number of rows.
+ */
+static void numa_rows_initialize(struct numa_rows *rows, int64_t count) {
+  int64_t grain = NUMA_PARALLEL_GRAIN / rows->columns;
+  if (matrixmath_parallel_for(count, grain > 0 ? grain : 1, numa_rows_run, rows) != 0) {
+    numa_rows_run(rows, 0, count);
+  }
+}
+
+/**
+ * {@inheritdoc}
+ */
+long double *matrixmath_allocate(int64_t rows, int64_t columns, const long double *source, struct matrixmath_allocator **allocator) {
+  size_t count;
+  size_t bytes;
+  if (rows <= 0 || columns <= 0 || matrixmath_size_mul((size_t)rows, (size_t)columns, &count) != 0 || matrixmath_size_mul(count, sizeof(long double), &bytes) != 0) {
+    return NULL;
+  }
+  long double *data = matrixmath_allocate_values(bytes, allocator);
+  if (data == NULL) {
+    return NULL;
+  }
+  enum numa_policy policy = matrixmath_get_numa_policy();
+  if (bytes < NUMA_MIN_BYTES || policy == NUMA_POLICY_NONE) {
+    if (source != NULL) {
+      memcpy(data, source, bytes);
+    }
+    else {
+      memset(data, 0, bytes);
+    }
+    return data;
+  }
+  if (policy == NUMA_POLICY_INTERLEAVE) {
+    numa_interleave(data, bytes);
+  }
+  // The thread initializing a row range is the one the kernels give it to.
+  struct numa_rows initialize = {data, source, 0, columns};
+  numa_rows_initialize(&initialize, rows);
+  return data;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void matrixmath_fill(long double *data, int64_t rows, int64_t columns, long double value) {
+  if (data == NULL || rows <= 0 || columns <= 0) {
+    return;
+  }
+  struct numa_rows fill = {data, NULL, value, columns};
+  numa_rows_initialize(&fill, rows);
+}
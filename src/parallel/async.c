@@ -0,0 +1,365 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include "../../include/matrixmath.h"
+
+/**
+ * The states of an operation.
+ */
+enum async_state {
+  ASYNC_PENDING,
+  ASYNC_COMPLETING,
+  ASYNC_DONE,
+};
+
+/**
+ * The data struct definition for an operation and its handle.
+ */
+struct matrixmath_future {
+
+  /**
+   * The operation, returning 0 when it succeeded.
+   *
+   * @var int (*run)(void *context).
+   */
+  int (*run)(void *context);
+
+  /**
+   * The data given to the operation.
+   *
+   * @var void *context.
+   */
+  void *context;
+
+  /**
+   * The completion callback, it can be NULL.
+   *
+   * @var void (*callback)(void *context, int result).
+   */
+  void (*callback)(void *context, int result);
+
+  /**
+   * The data given to the completion callback.
+   *
+   * @var void *callback_context.
+   */
+  void *callback_context;
+
+  /**
+   * The state of the operation.
+   *
+   * @var enum async_state state.
+   */
+  enum async_state state;
+
+  /**
+   * The value returned by the operation, once completing.
+   *
+   * @var int result.
+   */
+  int result;
+
+  /**
+   * The number of owners: the caller handle and the queue until completion.
+   *
+   * @var int references.
+   */
+  int references;
+
+  /**
+   * The next operation of the queue.
+   *
+   * @var struct matrixmath_future *next.
+   */
+  struct matrixmath_future *next;
+};
+
+/**
+ * The data struct definition for a queue of operations run in order.
+ */
+struct matrixmath_queue {
+
+  /**
+   * The operations not started yet, in submission order.
+   *
+   * @var struct matrixmath_future *head.
+   */
+  struct matrixmath_future *head;
+
+  /**
+   * The last operation not started yet.
+   *
+   * @var struct matrixmath_future *tail.
+   */
+  struct matrixmath_future *tail;
+
+  /**
+   * Whether a worker is running the operations of the queue.
+   *
+   * @var int running.
+   */
+  int running;
+
+  /**
+   * Whether an operation failed since the last matrixmath_queue_wait().
+   *
+   * @var int failed.
+   */
+  int failed;
+};
+
+/**
+ * The lock and condition shared by every queue and future; the operations are
+ * coarse so they are never contended for long.
+ */
+static struct {
+  pthread_mutex_t mutex;
+  pthread_cond_t changed;
+} async = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER};
+
+/**
+ * Drop a reference to a future, releasing it with the last one.
+ *
+ * Must be called with the async mutex locked.
+ *
+ * @param struct matrixmath_future* future
+ *   The future.
+ */
+static void async_future_release(struct matrixmath_future *future) {
+  if (--future->references == 0) {
+    free(future);
+  }
+}
+
+/**
+ * Run the operations of a queue one after another on a worker.
+ *
+ * @param void* argument
+ *   The matrixmath_queue object.
+ */
+static void async_queue_drain(void *argument) {
+  struct matrixmath_queue *queue = (struct matrixmath_queue *)argument;
+  struct matrixmath_future *future;
+  void (*callback)(void *context, int result);
+  int result;
+  pthread_mutex_lock(&async.mutex);
+  while (queue->head != NULL) {
+    future = queue->head;
+    queue->head = future->next;
+    if (queue->head == NULL) {
+      queue->tail = NULL;
+    }
+    pthread_mutex_unlock(&async.mutex);
+    result = future->run(future->context);
+    pthread_mutex_lock(&async.mutex);
+    // The callback runs before waiters are released, callbacks registered from
+    // now on run in the registering thread.
+    future->result = result;
+    future->state = ASYNC_COMPLETING;
+    callback = future->callback;
+    queue->failed |= result != 0;
+    if (callback != NULL) {
+      pthread_mutex_unlock(&async.mutex);
+      callback(future->callback_context, result);
+      pthread_mutex_lock(&async.mutex);
+    }
+    future->state = ASYNC_DONE;
+    async_future_release(future);
+    pthread_cond_broadcast(&async.changed);
+  }
+  queue->running = 0;
+  pthread_cond_broadcast(&async.changed);
+  pthread_mutex_unlock(&async.mutex);
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct matrixmath_queue *matrixmath_queue_create() {
+  struct matrixmath_queue *queue = malloc(sizeof(struct matrixmath_queue));
+  if (queue == NULL) {
+    return NULL;
+  }
+  queue->head = NULL;
+  queue->tail = NULL;
+  queue->running = 0;
+  queue->failed = 0;
+  return queue;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void matrixmath_queue_destroy(struct matrixmath_queue *queue) {
+  if (queue == NULL) {
+    return;
+  }
+  matrixmath_queue_wait(queue);
+  free(queue);
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct matrixmath_future *matrixmath_queue_submit(struct matrixmath_queue *queue, int (*run)(void *context), void *context) {
+  if (queue == NULL || run == NULL) {
+    return NULL;
+  }
+  struct matrixmath_future *future = malloc(sizeof(struct matrixmath_future));
+  if (future == NULL) {
+    return NULL;
+  }
+  future->run = run;
+  future->context = context;
+  future->callback = NULL;
+  future->callback_context = NULL;
+  future->state = ASYNC_PENDING;
+  future->result = 0;
+  future->references = 2;
+  future->next = NULL;
+  pthread_mutex_lock(&async.mutex);
+  if (queue->tail == NULL) {
+    queue->head = future;
+  }
+  else {
+    queue->tail->next = future;
+  }
+  queue->tail = future;
+  // A single worker at a time runs the queue, which keeps the order.
+  int start = !queue->running;
+  queue->running = 1;
+  pthread_mutex_unlock(&async.mutex);
+  if (start && matrixmath_parallel_spawn(async_queue_drain, queue) != 0) {
+    // Run it here rather than lose it.
+    async_queue_drain(queue);
+  }
+  return future;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrixmath_queue_wait(struct matrixmath_queue *queue) {
+  if (queue == NULL) {
+    return 1;
+  }
+  pthread_mutex_lock(&async.mutex);
+  while (queue->running) {
+    pthread_cond_wait(&async.changed, &async.mutex);
+  }
+  int failed = queue->failed;
+  queue->failed = 0;
+  pthread_mutex_unlock(&async.mutex);
+  return failed;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrixmath_future_poll(struct matrixmath_future *future) {
+  if (future == NULL) {
+    return 1;
+  }
+  pthread_mutex_lock(&async.mutex);
+  int done = future->state == ASYNC_DONE;
+  pthread_mutex_unlock(&async.mutex);
+  return done;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrixmath_future_wait(struct matrixmath_future *future) {
+  if (future == NULL) {
+    return 1;
+  }
+  pthread_mutex_lock(&async.mutex);
+  while (future->state != ASYNC_DONE) {
+    pthread_cond_wait(&async.changed, &async.mutex);
+  }
+  int result = future->result;
+  pthread_mutex_unlock(&async.mutex);
+  return result;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrixmath_future_then(struct matrixmath_future *future, void (*callback)(void *context, int result), void *context) {
+  if (future == NULL || callback == NULL) {
+    return 1;
+  }
+  pthread_mutex_lock(&async.mutex);
+  if (future->callback != NULL) {
+    pthread_mutex_unlock(&async.mutex);
+    return 1;
+  }
+  future->callback = callback;
+  future->callback_context = context;
+  int completed = future->state != ASYNC_PENDING;
+  int result = future->result;
+  pthread_mutex_unlock(&async.mutex);
+  // Too late for the worker to call it.
+  if (completed) {
+    callback(context, result);
+  }
+  return 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void matrixmath_future_destroy(struct matrixmath_future *future) {
+  if (future == NULL) {
+    return;
+  }
+  pthread_mutex_lock(&async.mutex);
+  async_future_release(future);
+  pthread_mutex_unlock(&async.mutex);
+}
+
+/**
+ * The data struct definition for a queued matrix product.
+ */
+struct async_gemm {
+  long double alpha;
+  struct matrix *a;
+  struct matrix *b;
+  long double beta;
+  struct matrix *c;
+};
+
+/**
+ * Run a queued matrix product and release its arguments.
+ *
+ * @param void* context
+ *   The async_gemm object.
+ *
+ * @return int
+ *   The value returned by matrix_gemm().
+ */
+static int async_gemm_run(void *context) {
+  struct async_gemm *gemm = (struct async_gemm *)context;
+  int result = matrix_gemm(gemm->alpha, gemm->a, gemm->b, gemm->beta, gemm->c);
+  free(gemm);
+  return result;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct matrixmath_future *matrixmath_queue_gemm(struct matrixmath_queue *queue, long double alpha, struct matrix *a, struct matrix *b, long double beta, struct matrix *c) {
+  struct async_gemm *gemm = malloc(sizeof(struct async_gemm));
+  if (gemm == NULL) {
+    return NULL;
+  }
+  gemm->alpha = alpha;
+  gemm->a = a;
+  gemm->b = b;
+  gemm->beta = beta;
+  gemm->c = c;
+  struct matrixmath_future *future = matrixmath_queue_submit(queue, async_gemm_run, gemm);
+  if (future == NULL) {
+    free(gemm);
+  }
+  return future;
+}
@@ -0,0 +1,684 @@
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../include/matrixmath.h"
+
+/**
+ * The initial number of slots of the tile table, a power of two.
+ */
+#define GRAPH_INITIAL_TILES 64
+
+/**
+ * The data struct definition for a task of a graph.
+ */
+struct graph_task {
+
+  /**
+   * The operation, returning 0 when it succeeded.
+   *
+   * @var int (*run)(void *context).
+   */
+  int (*run)(void *context);
+
+  /**
+   * The data given to the operation.
+   *
+   * @var void *context.
+   */
+  void *context;
+
+  /**
+   * Whether the context belongs to the graph, released with free().
+   *
+   * @var int owned.
+   */
+  int owned;
+
+  /**
+   * Whether a predecessor failed, the task is then skipped.
+   *
+   * @var int skipped.
+   */
+  int skipped;
+
+  /**
+   * The tasks waiting for this one.
+   *
+   * @var int64_t *successors.
+   */
+  int64_t *successors;
+
+  /**
+   * The number of successors.
+   *
+   * @var int64_t successor_count.
+   */
+  int64_t successor_count;
+
+  /**
+   * The number of successors the array holds.
+   *
+   * @var int64_t successor_capacity.
+   */
+  int64_t successor_capacity;
+
+  /**
+   * The number of predecessors not done yet.
+   *
+   * @var int64_t waiting.
+   */
+  int64_t waiting;
+
+  /**
+   * The neighbours of the task in the deque holding it, -1 at the ends.
+   *
+   * @var int64_t above.
+   * @var int64_t below.
+   */
+  int64_t above;
+  int64_t below;
+};
+
+/**
+ * The data struct definition for the accesses recorded on a tile.
+ */
+struct graph_tile {
+
+  /**
+   * The tile, NULL for a free slot.
+   *
+   * @var const void *tile.
+   */
+  const void *tile;
+
+  /**
+   * The last task writing the tile, otherwise -1.
+   *
+   * @var int64_t writer.
+   */
+  int64_t writer;
+
+  /**
+   * The tasks reading the tile since the last writer.
+   *
+   * @var int64_t *readers.
+   */
+  int64_t *readers;
+
+  /**
+   * The number of readers.
+   *
+   * @var int64_t reader_count.
+   */
+  int64_t reader_count;
+
+  /**
+   * The number of readers the array holds.
+   *
+   * @var int64_t reader_capacity.
+   */
+  int64_t reader_capacity;
+};
+
+/**
+ * The data struct definition for the ready tasks of a runner.
+ *
+ * The tasks are linked through their above and below members: the runner
+ * takes the newest one from the bottom, the others steal the oldest one from
+ * the top.
+ */
+struct graph_deque {
+  int64_t top;
+  int64_t bottom;
+};
+
+/**
+ * The data struct definition for a task graph.
+ */
+struct matrixmath_graph {
+  int64_t tile;
+  struct graph_task *tasks;
+  int64_t count;
+  int64_t capacity;
+  struct graph_tile *tiles;
+  int64_t tile_count;
+  int64_t tile_capacity;
+  int broken;
+  pthread_mutex_t mutex;
+  pthread_cond_t wake;
+  struct graph_deque *deques;
+  int runners;
+  int64_t remaining;
+  int failed;
+};
+
+/**
+ * Make room for one more item at the end of an array.
+ *
+ * @param void** items
+ *   The array.
+ * @param int64_t* capacity
+ *   The number of items the array holds.
+ * @param int64_t count
+ *   The number of items used.
+ * @param size_t size
+ *   The size of an item.
+ *
+ * @return int
+ *   Returns 0 when the array has room, otherwise 1.
+ */
+static int graph_reserve(void **items, int64_t *capacity, int64_t count, size_t size) {
+  size_t bytes;
+  if (count < *capacity) {
+    return 0;
+  }
+  int64_t grown = *capacity > 0 ? *capacity * 2 : 4;
+  if (matrixmath_array_size(grown, size, &bytes) != 0) {
+    return 1;
+  }
+  void *resized = realloc(*items, bytes);
+  if (resized == NULL) {
+    return 1;
+  }
+  *items = resized;
+  *capacity = grown;
+  return 0;
+}
+
+/**
+ * Get the slot of a tile in the table.
+ *
+ * @param struct graph_tile* tiles
+ *   The table.
+ * @param int64_t capacity
+ *   The number of slots, a power of two.
+ * @param const void* tile
+ *   The tile.
+ *
+ * @return struct graph_tile*
+ *   The slot holding the tile, otherwise the free slot for it.
+ */
+static struct graph_tile *graph_slot(struct graph_tile *tiles, int64_t capacity, const void *tile) {
+  // Fibonacci hashing spreads the aligned addresses of the tiles.
+  uint64_t index = ((uint64_t)(uintptr_t)tile * 0x9e3779b97f4a7c15ULL) >> 32;
+  for (;; index++) {
+    struct graph_tile *slot = tiles + (index & (capacity - 1));
+    if (slot->tile == NULL || slot->tile == tile) {
+      return slot;
+    }
+  }
+}
+
+/**
+ * Get the accesses recorded on a tile, adding it to the table when needed.
+ *
+ * @param struct matrixmath_graph* graph
+ *   The graph.
+ * @param const void* tile
+ *   The tile.
+ *
+ * @return struct graph_tile*
+ *   The accesses, otherwise NULL.
+ */
+static struct graph_tile *graph_tile_get(struct matrixmath_graph *graph, const void *tile) {
+  // Keep the table at most half full.
+  if (2 * (graph->tile_count + 1) > graph->tile_capacity) {
+    int64_t capacity = graph->tile_capacity > 0 ? graph->tile_capacity * 2 : GRAPH_INITIAL_TILES;
+    struct graph_tile *tiles = calloc(capacity, sizeof(struct graph_tile));
+    if (tiles == NULL) {
+      return NULL;
+    }
+    for (int64_t i = 0; i < graph->tile_capacity; i++) {
+      if (graph->tiles[i].tile != NULL) {
+        *graph_slot(tiles, capacity, graph->tiles[i].tile) = graph->tiles[i];
+      }
+    }
+    free(graph->tiles);
+    graph->tiles = tiles;
+    graph->tile_capacity = capacity;
+  }
+  struct graph_tile *slot = graph_slot(graph->tiles, graph->tile_capacity, tile);
+  if (slot->tile == NULL) {
+    slot->tile = tile;
+    slot->writer = -1;
+    slot->readers = NULL;
+    slot->reader_count = 0;
+    slot->reader_capacity = 0;
+    graph->tile_count++;
+  }
+  return slot;
+}
+
+/**
+ * Add an edge between two tasks.
+ *
+ * @param struct matrixmath_graph* graph
+ *   The graph.
+ * @param int64_t from
+ *   The predecessor, ignored when negative.
+ * @param int64_t to
+ *   The successor.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+static int graph_edge(struct matrixmath_graph *graph, int64_t from, int64_t to) {
+  if (from < 0 || from == to) {
+    return 0;
+  }
+  struct graph_task *task = graph->tasks + from;
+  // The edges of a task are added together, a repeated one is the last one.
+  if (task->successor_count > 0 && task->successors[task->successor_count - 1] == to) {
+    return 0;
+  }
+  if (graph_reserve((void **)&task->successors, &task->successor_capacity, task->successor_count, sizeof(int64_t)) != 0) {
+    return 1;
+  }
+  task->successors[task->successor_count++] = to;
+  graph->tasks[to].waiting++;
+  return 0;
+}
+
+/**
+ * Add a task and the edges implied by its tile accesses.
+ *
+ * A read waits for the last writer of the tile; a write waits for the last
+ * writer and every reader since.
+ *
+ * @param struct matrixmath_graph* graph
+ *   The graph.
+ * @param int (*run)(void *context)
+ *   The operation.
+ * @param void* context
+ *   The data given to the operation.
+ * @param int owned
+ *   Whether the graph releases the context, then it does even when the task
+ *   could not be added.
+ * @param const struct matrixmath_tile_access* accesses
+ *   The tile accesses.
+ * @param int count
+ *   The number of accesses.
+ *
+ * @return int64_t
+ *   The task, otherwise -1.
+ */
+static int64_t graph_insert(struct matrixmath_graph *graph, int (*run)(void *context), void *context, int owned, const struct matrixmath_tile_access *accesses, int count) {
+  if (graph_reserve((void **)&graph->tasks, &graph->capacity, graph->count, sizeof(struct graph_task)) != 0) {
+    if (owned) {
+      free(context);
+    }
+    return -1;
+  }
+  // From now on the task is recorded, an owned context is released with it.
+  int64_t id = graph->count++;
+  struct graph_task *task = graph->tasks + id;
+  memset(task, 0, sizeof(struct graph_task));
+  task->run = run;
+  task->context = context;
+  task->owned = owned;
+  struct graph_tile *tile;
+  for (int i = 0; i < count; i++) {
+    tile = graph_tile_get(graph, accesses[i].tile);
+    // A half recorded task would leave the graph inconsistent.
+    if (tile == NULL || graph_edge(graph, tile->writer, id) != 0) {
+      graph->broken = 1;
+      return -1;
+    }
+    if (accesses[i].mode & MATRIXMATH_WRITE) {
+      for (int64_t r = 0; r < tile->reader_count; r++) {
+        if (graph_edge(graph, tile->readers[r], id) != 0) {
+          graph->broken = 1;
+          return -1;
+        }
+      }
+      tile->writer = id;
+      tile->reader_count = 0;
+    }
+    else {
+      if (graph_reserve((void **)&tile->readers, &tile->reader_capacity, tile->reader_count, sizeof(int64_t)) != 0) {
+        graph->broken = 1;
+        return -1;
+      }
+      tile->readers[tile->reader_count++] = id;
+    }
+  }
+  return id;
+}
+
+/**
+ * Forget the tasks and accesses of a graph, keeping its memory.
+ *
+ * @param struct matrixmath_graph* graph
+ *   The graph.
+ */
+static void graph_clear(struct matrixmath_graph *graph) {
+  for (int64_t i = 0; i < graph->count; i++) {
+    free(graph->tasks[i].successors);
+    if (graph->tasks[i].owned) {
+      free(graph->tasks[i].context);
+    }
+  }
+  for (int64_t i = 0; i < graph->tile_capacity; i++) {
+    if (graph->tiles[i].tile != NULL) {
+      free(graph->tiles[i].readers);
+      graph->tiles[i].tile = NULL;
+    }
+  }
+  graph->count = 0;
+  graph->tile_count = 0;
+  graph->broken = 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct matrixmath_graph *matrixmath_graph_create(int64_t tile) {
+  if (tile <= 0) {
+    return NULL;
+  }
+  struct matrixmath_graph *graph = calloc(1, sizeof(struct matrixmath_graph));
+  if (graph == NULL) {
+    return NULL;
+  }
+  graph->tile = tile;
+  pthread_mutex_init(&graph->mutex, NULL);
+  pthread_cond_init(&graph->wake, NULL);
+  return graph;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void matrixmath_graph_destroy(struct matrixmath_graph *graph) {
+  if (graph == NULL) {
+    return;
+  }
+  graph_clear(graph);
+  free(graph->tasks);
+  free(graph->tiles);
+  pthread_mutex_destroy(&graph->mutex);
+  pthread_cond_destroy(&graph->wake);
+  free(graph);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int64_t matrixmath_graph_add(struct matrixmath_graph *graph, int (*run)(void *context), void *context, const struct matrixmath_tile_access *accesses, int count) {
+  if (graph == NULL || run == NULL || count < 0 || (count > 0 && accesses == NULL)) {
+    return -1;
+  }
+  for (int i = 0; i < count; i++) {
+    if (accesses[i].tile == NULL || (accesses[i].mode & MATRIXMATH_READ_WRITE) == 0) {
+      return -1;
+    }
+  }
+  return graph_insert(graph, run, context, 0, accesses, count);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrixmath_graph_depend(struct matrixmath_graph *graph, int64_t task, int64_t predecessor) {
+  // Edges only go forward, which keeps the graph acyclic.
+  if (graph == NULL || predecessor < 0 || task <= predecessor || task >= graph->count) {
+    return 1;
+  }
+  if (graph_edge(graph, predecessor, task) != 0) {
+    graph->broken = 1;
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+long double *matrixmath_graph_tile(struct matrixmath_graph *graph, struct matrix *object, int64_t row, int64_t column) {
+  if (graph == NULL || object == NULL || row < 0 || column < 0 || row >= (object->rows + graph->tile - 1) / graph->tile || column >= (object->columns + graph->tile - 1) / graph->tile) {
+    return NULL;
+  }
+  return object->data + (size_t)row * graph->tile * object->columns + (size_t)column * graph->tile;
+}
+
+/**
+ * The data struct definition for the product of tiles.
+ */
+struct graph_gemm {
+  int64_t m;
+  int64_t n;
+  int64_t k;
+  long double alpha;
+  const long double *a;
+  int64_t lda;
+  const long double *b;
+  int64_t ldb;
+  long double beta;
+  long double *c;
+  int64_t ldc;
+};
+
+/**
+ * Run the product of tiles.
+ *
+ * @param void* context
+ *   The graph_gemm object.
+ *
+ * @return int
+ *   The value returned by matrix_gemm_strided().
+ */
+static int graph_gemm_run(void *context) {
+  struct graph_gemm *gemm = (struct graph_gemm *)context;
+  return matrix_gemm_strided(gemm->m, gemm->n, gemm->k, gemm->alpha, gemm->a, gemm->lda, gemm->b, gemm->ldb, gemm->beta, gemm->c, gemm->ldc);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrixmath_graph_gemm(struct matrixmath_graph *graph, long double alpha, struct matrix *a, struct matrix *b, long double beta, struct matrix *c) {
+  if (graph == NULL || a == NULL || b == NULL || c == NULL || a->columns != b->rows || c->rows != a->rows || c->columns != b->columns) {
+    return 1;
+  }
+  // The tiles of c are written while a and b are still read.
+  if (matrix_detach(c) != 0 || c->data == a->data || c->data == b->data) {
+    return 1;
+  }
+  int64_t size = graph->tile;
+  struct matrixmath_tile_access accesses[3] = {{NULL, MATRIXMATH_READ}, {NULL, MATRIXMATH_READ}, {NULL, MATRIXMATH_READ_WRITE}};
+  struct graph_gemm *gemm;
+  int inserted = 0;
+  // One task per tile of c and step of the inner dimension; the steps of a tile
+  // are chained by their accesses to it.
+  for (int64_t i = 0; i < a->rows; i += size) {
+    for (int64_t j = 0; j < b->columns; j += size) {
+      for (int64_t p = 0; p < a->columns; p += size) {
+        gemm = malloc(sizeof(struct graph_gemm));
+        if (gemm == NULL) {
+          // The tasks already added would compute a partial product.
+          graph->broken |= inserted;
+          return 1;
+        }
+        gemm->m = a->rows - i < size ? a->rows - i : size;
+        gemm->n = b->columns - j < size ? b->columns - j : size;
+        gemm->k = a->columns - p < size ? a->columns - p : size;
+        gemm->alpha = alpha;
+        gemm->a = a->data + (size_t)i * a->columns + p;
+        gemm->lda = a->columns;
+        gemm->b = b->data + (size_t)p * b->columns + j;
+        gemm->ldb = b->columns;
+        gemm->beta = p == 0 ? beta : 1;
+        gemm->c = c->data + (size_t)i * c->columns + j;
+        gemm->ldc = c->columns;
+        accesses[0].tile = gemm->a;
+        accesses[1].tile = gemm->b;
+        accesses[2].tile = gemm->c;
+        // The graph releases the product, even when it fails to add it.
+        if (graph_insert(graph, graph_gemm_run, gemm, 1, accesses, 3) < 0) {
+          graph->broken |= inserted;
+          return 1;
+        }
+        inserted = 1;
+      }
+    }
+  }
+  return 0;
+}
+
+/**
+ * Put a ready task at the bottom of a deque.
+ *
+ * Must be called with the graph mutex locked.
+ *
+ * @param struct matrixmath_graph* graph
+ *   The graph.
+ * @param struct graph_deque* deque
+ *   The deque.
+ * @param int64_t id
+ *   The task.
+ */
+static void graph_push(struct matrixmath_graph *graph, struct graph_deque *deque, int64_t id) {
+  graph->tasks[id].above = deque->bottom;
+  graph->tasks[id].below = -1;
+  if (deque->bottom >= 0) {
+    graph->tasks[deque->bottom].below = id;
+  }
+  else {
+    deque->top = id;
+  }
+  deque->bottom = id;
+}
+
+/**
+ * Take a ready task: the newest one of the runner, otherwise the oldest one of
+ * another runner.
+ *
+ * Must be called with the graph mutex locked.
+ *
+ * @param struct matrixmath_graph* graph
+ *   The graph.
+ * @param int runner
+ *   The runner.
+ *
+ * @return int64_t
+ *   The task, otherwise -1.
+ */
+static int64_t graph_take(struct matrixmath_graph *graph, int runner) {
+  struct graph_deque *deque = graph->deques + runner;
+  int64_t id = deque->bottom;
+  if (id >= 0) {
+    deque->bottom = graph->tasks[id].above;
+    if (deque->bottom >= 0) {
+      graph->tasks[deque->bottom].below = -1;
+    }
+    else {
+      deque->top = -1;
+    }
+    return id;
+  }
+  for (int i = 1; i < graph->runners; i++) {
+    deque = graph->deques + (runner + i) % graph->runners;
+    id = deque->top;
+    if (id >= 0) {
+      deque->top = graph->tasks[id].below;
+      if (deque->top >= 0) {
+        graph->tasks[deque->top].above = -1;
+      }
+      else {
+        deque->bottom = -1;
+      }
+      return id;
+    }
+  }
+  return -1;
+}
+
+/**
+ * Run tasks until the whole graph is done, the loop runs over runners.
+ *
+ * @param void* context
+ *   The matrixmath_graph object.
+ * @param int64_t start
+ *   The runner.
+ * @param int64_t end
+ *   The runner after it.
+ */
+static void graph_runner(void *context, int64_t start, int64_t end) {
+  struct matrixmath_graph *graph = (struct matrixmath_graph *)context;
+  struct graph_task *task;
+  int64_t id;
+  int64_t successor;
+  int result;
+  pthread_mutex_lock(&graph->mutex);
+  while (graph->remaining > 0) {
+    id = graph_take(graph, (int)start);
+    if (id < 0) {
+      pthread_cond_wait(&graph->wake, &graph->mutex);
+      continue;
+    }
+    task = graph->tasks + id;
+    pthread_mutex_unlock(&graph->mutex);
+    result = task->skipped ? 1 : task->run(task->context);
+    pthread_mutex_lock(&graph->mutex);
+    graph->failed |= result != 0;
+    graph->remaining--;
+    // The successors made ready stay with this runner, next to the tiles it
+    // just wrote.
+    for (int64_t s = 0; s < task->successor_count; s++) {
+      successor = task->successors[s];
+      graph->tasks[successor].skipped |= result != 0;
+      if (--graph->tasks[successor].waiting == 0) {
+        graph_push(graph, graph->deques + start, successor);
+        pthread_cond_signal(&graph->wake);
+      }
+    }
+    if (graph->remaining == 0) {
+      pthread_cond_broadcast(&graph->wake);
+    }
+  }
+  pthread_mutex_unlock(&graph->mutex);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrixmath_graph_run(struct matrixmath_graph *graph) {
+  if (graph == NULL) {
+    return 1;
+  }
+  if (graph->broken) {
+    graph_clear(graph);
+    return 1;
+  }
+  if (graph->count == 0) {
+    return 0;
+  }
+  int runners = matrixmath_get_num_threads();
+  runners = runners < graph->count ? runners : (int)graph->count;
+  graph->deques = malloc(runners * sizeof(struct graph_deque));
+  if (graph->deques == NULL) {
+    graph_clear(graph);
+    return 1;
+  }
+  graph->runners = runners;
+  for (int i = 0; i < runners; i++) {
+    graph->deques[i].top = -1;
+    graph->deques[i].bottom = -1;
+  }
+  // The tasks ready from the start are dealt to the runners in turn.
+  int next = 0;
+  for (int64_t i = 0; i < graph->count; i++) {
+    if (graph->tasks[i].waiting == 0) {
+      graph_push(graph, graph->deques + next, i);
+      next = (next + 1) % runners;
+    }
+  }
+  graph->remaining = graph->count;
+  graph->failed = 0;
+  int error = matrixmath_parallel_for(runners, 1, graph_runner, graph);
+  int failed = error || graph->failed;
+  free(graph->deques);
+  graph->deques = NULL;
+  graph_clear(graph);
+  return failed;
+}
@@ -0,0 +1,586 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "../../include/matrixmath.h"
+
+/**
+ * The maximum number of threads used by the library.
+ */
+#define PARALLEL_MAX_THREADS 256
+
+/**
+ * The number of segments of a reproducible reduction.
+ *
+ * It does not depend on the number of threads, which is what makes the
+ * results identical whatever the size of the pool.
+ */
+#define PARALLEL_REPRODUCIBLE_SEGMENTS 64
+
+/**
+ * The maximum number of values computed at once by a parallel reduction.
+ */
+#define PARALLEL_REDUCE_MAX_WIDTH 4
+
+/**
+ * The data struct definition for a task queued on the thread pool.
+ */
+struct parallel_task {
+
+  /**
+   * The function executed by the worker thread.
+   *
+   * @var void (*run)(void *argument).
+   */
+  void (*run)(void *argument);
+
+  /**
+   * The argument given to the run function.
+   *
+   * @var void *argument.
+   */
+  void *argument;
+
+  /**
+   * Counter decremented, under the pool mutex, once the task finished; it can be NULL.
+   *
+   * @var int *pending.
+   */
+  int *pending;
+
+  /**
+   * The next task in the queue.
+   *
+   * @var struct parallel_task *next.
+   */
+  struct parallel_task *next;
+};
+
+/**
+ * The data struct definition for a chunk of a parallel loop.
+ */
+struct parallel_chunk {
+
+  /**
+   * The queued task, it must be the first member.
+   *
+   * @var struct parallel_task task.
+   */
+  struct parallel_task task;
+
+  /**
+   * The loop body.
+   *
+   * @var void (*callback)(void *context, int64_t start, int64_t end).
+   */
+  void (*callback)(void *context, int64_t start, int64_t end);
+
+  /**
+   * The loop body data.
+   *
+   * @var void *context.
+   */
+  void *context;
+
+  /**
+   * The first index of the chunk.
+   *
+   * @var int64_t start.
+   */
+  int64_t start;
+
+  /**
+   * The index after the last one of the chunk.
+   *
+   * @var int64_t end.
+   */
+  int64_t end;
+};
+
+/**
+ * The data struct definition for a function run on a worker without waiting.
+ */
+struct parallel_spawn {
+
+  /**
+   * The queued task, it must be the first member.
+   *
+   * @var struct parallel_task task.
+   */
+  struct parallel_task task;
+
+  /**
+   * The function to run.
+   *
+   * @var void (*run)(void *argument).
+   */
+  void (*run)(void *argument);
+
+  /**
+   * The argument given to the function.
+   *
+   * @var void *argument.
+   */
+  void *argument;
+};
+
+/**
+ * The library thread pool.
+ */
+static struct {
+  pthread_mutex_t mutex;
+  pthread_cond_t available;
+  pthread_cond_t finished;
+  struct parallel_task *head;
+  struct parallel_task *tail;
+  pthread_t threads[PARALLEL_MAX_THREADS];
+  int workers;
+  int size;
+  int shutdown;
+} pool = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER, NULL, NULL, {0}, 0, 0, 0};
+
+/**
+ * The main loop of the worker threads.
+ *
+ * @param void* argument
+ *   Unused.
+ *
+ * @return void*
+ *   Always NULL.
+ */
+static void *parallel_worker(void *argument) {
+  struct parallel_task *task;
+  int *pending;
+  pthread_mutex_lock(&pool.mutex);
+  while (1) {
+    while (pool.head == NULL && !pool.shutdown) {
+      pthread_cond_wait(&pool.available, &pool.mutex);
+    }
+    if (pool.head == NULL) {
+      break;
+    }
+    // Take the first task from the queue.
+    task = pool.head;
+    pool.head = task->next;
+    if (pool.head == NULL) {
+      pool.tail = NULL;
+    }
+    pthread_mutex_unlock(&pool.mutex);
+    // The task can be released by its run function, keep what is needed after it.
+    pending = task->pending;
+    task->run(task->argument);
+    pthread_mutex_lock(&pool.mutex);
+    if (pending != NULL) {
+      (*pending)--;
+      pthread_cond_broadcast(&pool.finished);
+    }
+  }
+  pthread_mutex_unlock(&pool.mutex);
+  return NULL;
+}
+
+/**
+ * Get the default number of threads.
+ *
+ * The MATRIXMATH_NUM_THREADS environment variable takes precedence over the
+ * number of online processors.
+ *
+ * @return int
+ *   The default number of threads.
+ */
+static int parallel_default_size() {
+  const char *value = getenv("MATRIXMATH_NUM_THREADS");
+  long size = value != NULL ? strtol(value, NULL, 10) : 0;
+  if (size <= 0) {
+    size = sysconf(_SC_NPROCESSORS_ONLN);
+  }
+  if (size <= 0) {
+    size = 1;
+  }
+  if (size > PARALLEL_MAX_THREADS) {
+    size = PARALLEL_MAX_THREADS;
+  }
+  return (int)size;
+}
+
+/**
+ * Stop and join the worker threads.
+ *
+ * Must be called with the pool mutex locked.
+ */
+static void parallel_stop() {
+  int workers = pool.workers;
+  pool.shutdown = 1;
+  pthread_cond_broadcast(&pool.available);
+  pthread_mutex_unlock(&pool.mutex);
+  for (int i = 0; i < workers; i++) {
+    pthread_join(pool.threads[i], NULL);
+  }
+  pthread_mutex_lock(&pool.mutex);
+  pool.workers = 0;
+  pool.shutdown = 0;
+}
+
+/**
+ * Start the worker threads for the given pool size.
+ *
+ * Must be called with the pool mutex locked. The calling thread takes part in
+ * the parallel loops, so size - 1 workers are started.
+ *
+ * @param int size
+ *   The number of threads.
+ */
+static void parallel_start(int size) {
+  pool.size = size;
+  for (int i = 0; i < size - 1; i++) {
+    if (pthread_create(&pool.threads[i], NULL, parallel_worker, NULL) != 0) {
+      break;
+    }
+    pool.workers++;
+  }
+  // Keep the size consistent with the workers actually started.
+  pool.size = pool.workers + 1;
+}
+
+/**
+ * Get the thread pool, starting it on first use.
+ *
+ * Must be called with the pool mutex locked.
+ */
+static void parallel_ensure_started() {
+  if (pool.size == 0) {
+    parallel_start(parallel_default_size());
+  }
+}
+
+/**
+ * {@inheritdoc}
+ */
+void matrixmath_set_num_threads(int count) {
+  if (count <= 0) {
+    count = parallel_default_size();
+  }
+  if (count > PARALLEL_MAX_THREADS) {
+    count = PARALLEL_MAX_THREADS;
+  }
+  pthread_mutex_lock(&pool.mutex);
+  if (pool.size != count) {
+    parallel_stop();
+    parallel_start(count);
+  }
+  pthread_mutex_unlock(&pool.mutex);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrixmath_get_num_threads() {
+  pthread_mutex_lock(&pool.mutex);
+  parallel_ensure_started();
+  int size = pool.size;
+  pthread_mutex_unlock(&pool.mutex);
+  return size;
+}
+
+/**
+ * Get the first index of a part of a range split into equal parts.
+ *
+ * The result is count * part / parts, computed without overflowing for any
+ * count that fits in an int64_t.
+ *
+ * @param int64_t count
+ *   The number of indices of the range.
+ * @param int part
+ *   The part, from 0 to parts; parts gives the end of the range.
+ * @param int parts
+ *   The number of parts.
+ *
+ * @return int64_t
+ *   The first index of the part.
+ */
+static int64_t parallel_split(int64_t count, int part, int parts) {
+  return count / parts * part + count % parts * part / parts;
+}
+
+/**
+ * Run one chunk of a parallel loop.
+ *
+ * @param void* argument
+ *   The parallel_chunk object.
+ */
+static void parallel_chunk_run(void *argument) {
+  struct parallel_chunk *chunk = (struct parallel_chunk *)argument;
+  chunk->callback(chunk->context, chunk->start, chunk->end);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrixmath_parallel_chunks(int64_t count, int64_t grain) {
+  if (count <= 0) {
+    return 0;
+  }
+  if (grain <= 0) {
+    grain = 1;
+  }
+  int chunks = matrixmath_get_num_threads();
+  int64_t limit = count / grain + (count % grain != 0);
+  return chunks < limit ? chunks : (int)limit;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrixmath_parallel_for(int64_t count, int64_t grain, void (*callback)(void *context, int64_t start, int64_t end), void *context) {
+  if (callback == NULL || count < 0) {
+    return 1;
+  }
+  int chunks = matrixmath_parallel_chunks(count, grain);
+  if (chunks <= 1) {
+    // Too little work to be worth waking up other threads.
+    if (count > 0) {
+      callback(context, 0, count);
+    }
+    return 0;
+  }
+  // Static partition: chunk i always covers the same range for a given count and
+  // number of chunks, so the kernels touch memory the same way on every call.
+  struct parallel_chunk items[PARALLEL_MAX_THREADS];
+  int pending = chunks - 1;
+  for (int i = 0; i < chunks; i++) {
+    items[i].task.run = parallel_chunk_run;
+    items[i].task.argument = &items[i];
+    items[i].task.pending = &pending;
+    items[i].task.next = NULL;
+    items[i].callback = callback;
+    items[i].context = context;
+    items[i].start = parallel_split(count, i, chunks);
+    items[i].end = parallel_split(count, i + 1, chunks);
+  }
+  // Queue the chunks 1..n for the workers.
+  pthread_mutex_lock(&pool.mutex);
+  for (int i = 1; i < chunks; i++) {
+    if (pool.tail == NULL) {
+      pool.head = &items[i].task;
+    }
+    else {
+      pool.tail->next = &items[i].task;
+    }
+    pool.tail = &items[i].task;
+  }
+  pthread_cond_broadcast(&pool.available);
+  pthread_mutex_unlock(&pool.mutex);
+  // The calling thread runs the first chunk.
+  callback(context, items[0].start, items[0].end);
+  // Run the chunks no worker has taken yet, then wait for the others.
+  struct parallel_task *previous;
+  struct parallel_task *task;
+  pthread_mutex_lock(&pool.mutex);
+  for (int i = 1; i < chunks; i++) {
+    previous = NULL;
+    task = pool.head;
+    while (task != NULL && task != &items[i].task) {
+      previous = task;
+      task = task->next;
+    }
+    if (task == NULL) {
+      continue;
+    }
+    if (previous == NULL) {
+      pool.head = task->next;
+    }
+    else {
+      previous->next = task->next;
+    }
+    if (pool.tail == task) {
+      pool.tail = previous;
+    }
+    pending--;
+    pthread_mutex_unlock(&pool.mutex);
+    callback(context, items[i].start, items[i].end);
+    pthread_mutex_lock(&pool.mutex);
+  }
+  while (pending > 0) {
+    pthread_cond_wait(&pool.finished, &pool.mutex);
+  }
+  pthread_mutex_unlock(&pool.mutex);
+  return 0;
+}
+
+/**
+ * Run a spawned function, releasing its task first.
+ *
+ * @param void* argument
+ *   The parallel_spawn object.
+ */
+static void parallel_spawn_run(void *argument) {
+  struct parallel_spawn *spawn = (struct parallel_spawn *)argument;
+  void (*run)(void *argument) = spawn->run;
+  argument = spawn->argument;
+  free(spawn);
+  run(argument);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrixmath_parallel_spawn(void (*run)(void *argument), void *argument) {
+  if (run == NULL) {
+    return 1;
+  }
+  struct parallel_spawn *spawn = malloc(sizeof(struct parallel_spawn));
+  if (spawn == NULL) {
+    return 1;
+  }
+  spawn->task.run = parallel_spawn_run;
+  spawn->task.argument = spawn;
+  spawn->task.pending = NULL;
+  spawn->task.next = NULL;
+  spawn->run = run;
+  spawn->argument = argument;
+  pthread_mutex_lock(&pool.mutex);
+  parallel_ensure_started();
+  if (pool.workers == 0) {
+    // Nobody else would ever run it.
+    pthread_mutex_unlock(&pool.mutex);
+    parallel_spawn_run(spawn);
+    return 0;
+  }
+  if (pool.tail == NULL) {
+    pool.head = &spawn->task;
+  }
+  else {
+    pool.tail->next = &spawn->task;
+  }
+  pool.tail = &spawn->task;
+  pthread_cond_signal(&pool.available);
+  pthread_mutex_unlock(&pool.mutex);
+  return 0;
+}
+
+/**
+ * The reduction mode used by the library when none is given, -1 until the
+ * MATRIXMATH_REPRODUCIBLE environment variable has been read.
+ */
+static int parallel_reduction_mode = -1;
+
+/**
+ * {@inheritdoc}
+ */
+void matrixmath_set_reduction_mode(enum parallel_reduction_mode mode) {
+  pthread_mutex_lock(&pool.mutex);
+  parallel_reduction_mode = mode == PARALLEL_REDUCTION_DEFAULT ? -1 : (int)mode;
+  pthread_mutex_unlock(&pool.mutex);
+}
+
+/**
+ * {@inheritdoc}
+ */
+enum parallel_reduction_mode matrixmath_get_reduction_mode() {
+  pthread_mutex_lock(&pool.mutex);
+  if (parallel_reduction_mode < 0) {
+    const char *value = getenv("MATRIXMATH_REPRODUCIBLE");
+    parallel_reduction_mode = value != NULL && strtol(value, NULL, 10) > 0 ? PARALLEL_REDUCTION_REPRODUCIBLE : PARALLEL_REDUCTION_FAST;
+  }
+  enum parallel_reduction_mode mode = (enum parallel_reduction_mode)parallel_reduction_mode;
+  pthread_mutex_unlock(&pool.mutex);
+  return mode;
+}
+
+/**
+ * The data struct definition for a parallel reduction in progress.
+ */
+struct parallel_reduction {
+  void (*callback)(void *context, int64_t start, int64_t end, long double *partial);
+  void *context;
+  int64_t count;
+  int segments;
+  int width;
+  long double *partials;
+};
+
+/**
+ * Parallel loop body of a reduction, the loop runs over segments.
+ *
+ * @param void* context
+ *   The parallel_reduction object.
+ * @param int64_t start
+ *   The first segment to reduce.
+ * @param int64_t end
+ *   The segment after the last one to reduce.
+ */
+static void parallel_reduce_segments(void *context, int64_t start, int64_t end) {
+  struct parallel_reduction *reduction = (struct parallel_reduction *)context;
+  long double *partial;
+  for (int64_t i = start; i < end; i++) {
+    partial = reduction->partials + i * reduction->width;
+    for (int w = 0; w < reduction->width; w++) {
+      partial[w] = 0;
+    }
+    reduction->callback(reduction->context, parallel_split(reduction->count, (int)i, reduction->segments), parallel_split(reduction->count, (int)i + 1, reduction->segments), partial);
+  }
+}
+
+/**
+ * Sum the partials of a range of segments along a balanced binary tree.
+ *
+ * @param const long double* partials
+ *   The partial results, width values per segment.
+ * @param int first
+ *   The first segment.
+ * @param int last
+ *   The segment after the last one.
+ * @param int width
+ *   The number of values per segment.
+ * @param long double* result
+ *   The destination of the width sums.
+ */
+static void parallel_reduce_tree(const long double *partials, int first, int last, int width, long double *result) {
+  if (last - first == 1) {
+    for (int w = 0; w < width; w++) {
+      result[w] = partials[first * width + w];
+    }
+    return;
+  }
+  long double right[PARALLEL_REDUCE_MAX_WIDTH];
+  int middle = first + (last - first) / 2;
+  parallel_reduce_tree(partials, first, middle, width, result);
+  parallel_reduce_tree(partials, middle, last, width, right);
+  for (int w = 0; w < width; w++) {
+    result[w] += right[w];
+  }
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrixmath_parallel_reduce(int64_t count, int64_t grain, enum parallel_reduction_mode mode, int width, void (*callback)(void *context, int64_t start, int64_t end, long double *partial), void *context, long double *result) {
+  if (callback == NULL || result == NULL || count < 0 || width <= 0 || width > PARALLEL_REDUCE_MAX_WIDTH) {
+    return 1;
+  }
+  if (mode == PARALLEL_REDUCTION_DEFAULT) {
+    mode = matrixmath_get_reduction_mode();
+  }
+  if (grain <= 0) {
+    grain = 1;
+  }
+  // The reproducible segments only depend on the count and the grain.
+  int64_t limit = count / grain + (count % grain != 0);
+  int segments = mode == PARALLEL_REDUCTION_REPRODUCIBLE ? PARALLEL_REPRODUCIBLE_SEGMENTS : matrixmath_parallel_chunks(count, grain);
+  segments = segments < limit ? segments : (int)limit;
+  if (segments <= 1) {
+    for (int w = 0; w < width; w++) {
+      result[w] = 0;
+    }
+    if (count > 0) {
+      callback(context, 0, count, result);
+    }
+    return 0;
+  }
+  long double partials[PARALLEL_MAX_THREADS * PARALLEL_REDUCE_MAX_WIDTH];
+  struct parallel_reduction reduction = {callback, context, count, segments, width, partials};
+  if (matrixmath_parallel_for(segments, 1, parallel_reduce_segments, &reduction) != 0) {
+    return 1;
+  }
+  parallel_reduce_tree(partials, 0, segments, width, result);
+  return 0;
+}
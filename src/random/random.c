@@ -0,0 +1,340 @@
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include "../../include/matrixmath.h"
+
+/**
+ * The odd constant added to the counter for every draw (2^64 / golden ratio).
+ */
+#define RANDOM_GAMMA 0x9e3779b97f4a7c15ULL
+
+/**
+ * The number of values generated by a parallel loop iteration.
+ */
+#define RANDOM_BLOCK_SIZE 1024
+
+/**
+ * The number of values below which a fill is not split across threads.
+ */
+#define RANDOM_PARALLEL_GRAIN 16384
+
+/**
+ * The seed of the library default generator.
+ */
+#define RANDOM_DEFAULT_SEED 5489
+
+/**
+ * The value of pi with the precision of a long double, M_PI is a double.
+ */
+#define RANDOM_PI 3.14159265358979323846264338327950288L
+
+/**
+ * The generator used when none is given, guarded by its mutex.
+ */
+static struct random_generator random_default = {0, 0, 0};
+static int random_default_seeded = 0;
+static pthread_mutex_t random_default_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Scramble a 64 bits value (SplitMix64 finalizer).
+ *
+ * @param uint64_t z
+ *   The value.
+ *
+ * @return uint64_t
+ *   The scrambled value.
+ */
+static uint64_t random_mix(uint64_t z) {
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+/**
+ * Compute the value of a generator at the given position of its stream.
+ *
+ * The value only depends on the key, the stream and the position, which is what
+ * makes the fills reproducible whatever the way they are split across threads.
+ *
+ * @param const struct random_generator* generator
+ *   The generator.
+ * @param uint64_t counter
+ *   The position in the stream.
+ *
+ * @return uint64_t
+ *   The random value.
+ */
+static uint64_t random_at(const struct random_generator *generator, uint64_t counter) {
+  return random_mix(random_mix(generator->key + (counter + 1) * RANDOM_GAMMA) ^ generator->stream);
+}
+
+/**
+ * Convert a random value to a long double in [0, 1).
+ *
+ * The 64 bits of the value fit in the long double significand, so the
+ * conversion is exact and never rounds up to 1.
+ *
+ * @param uint64_t value
+ *   The random value.
+ *
+ * @return long double
+ *   The uniform value.
+ */
+static long double random_unit(uint64_t value) {
+  return (long double)value * 0x1p-64L;
+}
+
+/**
+ * Compute the pair of standard normal values of a position (Box-Muller).
+ *
+ * @param const struct random_generator* generator
+ *   The generator.
+ * @param uint64_t counter
+ *   The position of the first of the two uniform values used.
+ * @param long double* z0
+ *   The destination of the first normal value.
+ * @param long double* z1
+ *   The destination of the second normal value, it can be NULL.
+ */
+static void random_normal_pair(const struct random_generator *generator, uint64_t counter, long double *z0, long double *z1) {
+  // 1 - u lies in (0, 1], so the logarithm is finite.
+  long double radius = sqrtl(-2 * logl(1 - random_unit(random_at(generator, counter))));
+  long double angle = 2 * RANDOM_PI * random_unit(random_at(generator, counter + 1));
+  *z0 = radius * cosl(angle);
+  if (z1 != NULL) {
+    *z1 = radius * sinl(angle);
+  }
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct random_generator random_generator_seed(uint64_t seed) {
+  struct random_generator generator = {random_mix(seed), random_mix(RANDOM_GAMMA), 0};
+  return generator;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct random_generator random_generator_stream(const struct random_generator *generator, uint64_t stream) {
+  struct random_generator result = {generator->key, random_mix((stream + 1) * RANDOM_GAMMA), 0};
+  return result;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void matrixmath_random_seed(uint64_t seed) {
+  pthread_mutex_lock(&random_default_mutex);
+  random_default = random_generator_seed(seed);
+  random_default_seeded = 1;
+  pthread_mutex_unlock(&random_default_mutex);
+}
+
+/**
+ * Reserve a range of positions of a generator stream.
+ *
+ * The library default generator is used when none is given; its range is
+ * reserved under a mutex, so concurrent fills draw disjoint values.
+ *
+ * @param struct random_generator* generator
+ *   The generator, NULL for the library default generator.
+ * @param uint64_t size
+ *   The number of positions to reserve.
+ * @param struct random_generator* range
+ *   The destination where the generator positioned at the range is stored.
+ */
+static void random_reserve(struct random_generator *generator, uint64_t size, struct random_generator *range) {
+  if (generator != NULL) {
+    *range = *generator;
+    generator->counter += size;
+    return;
+  }
+  pthread_mutex_lock(&random_default_mutex);
+  if (!random_default_seeded) {
+    random_default = random_generator_seed(RANDOM_DEFAULT_SEED);
+    random_default_seeded = 1;
+  }
+  *range = random_default;
+  random_default.counter += size;
+  pthread_mutex_unlock(&random_default_mutex);
+}
+
+/**
+ * {@inheritdoc}
+ */
+uint64_t random_next(struct random_generator *generator) {
+  struct random_generator range;
+  random_reserve(generator, 1, &range);
+  return random_at(&range, range.counter);
+}
+
+/**
+ * {@inheritdoc}
+ */
+long double random_uniform(struct random_generator *generator, long double min, long double max) {
+  return min + random_unit(random_next(generator)) * (max - min);
+}
+
+/**
+ * {@inheritdoc}
+ */
+long double random_gaussian(struct random_generator *generator, long double mean, long double deviation) {
+  struct random_generator range;
+  long double z;
+  random_reserve(generator, 2, &range);
+  random_normal_pair(&range, range.counter, &z, NULL);
+  return mean + deviation * z;
+}
+
+/**
+ * The data struct definition for a fill in progress.
+ */
+struct random_fill {
+  struct random_generator generator;
+  long double *data;
+  size_t size;
+  long double a;
+  long double b;
+};
+
+/**
+ * Parallel loop body of the uniform fill, the loop runs over blocks.
+ *
+ * @param void* context
+ *   The random_fill object, a and b being the bounds of the range.
+ * @param int64_t start
+ *   The first block to fill.
+ * @param int64_t end
+ *   The block after the last one to fill.
+ */
+static void random_fill_uniform_blocks(void *context, int64_t start, int64_t end) {
+  struct random_fill *fill = (struct random_fill *)context;
+  size_t first = (size_t)start * RANDOM_BLOCK_SIZE;
+  size_t last = (size_t)end * RANDOM_BLOCK_SIZE < fill->size ? (size_t)end * RANDOM_BLOCK_SIZE : fill->size;
+  long double *restrict data = fill->data;
+  long double scale = fill->b - fill->a;
+  for (size_t i = first; i < last; i++) {
+    data[i] = fill->a + random_unit(random_at(&fill->generator, fill->generator.counter + i)) * scale;
+  }
+}
+
+/**
+ * Parallel loop body of the gaussian fill, the loop runs over blocks.
+ *
+ * Element i uses the positions 2 * (i / 2) and 2 * (i / 2) + 1, both elements
+ * of a pair come from the same Box-Muller transform.
+ *
+ * @param void* context
+ *   The random_fill object, a and b being the mean and the standard deviation.
+ * @param int64_t start
+ *   The first block to fill.
+ * @param int64_t end
+ *   The block after the last one to fill.
+ */
+static void random_fill_gaussian_blocks(void *context, int64_t start, int64_t end) {
+  struct random_fill *fill = (struct random_fill *)context;
+  size_t first = (size_t)start * RANDOM_BLOCK_SIZE;
+  size_t last = (size_t)end * RANDOM_BLOCK_SIZE < fill->size ? (size_t)end * RANDOM_BLOCK_SIZE : fill->size;
+  long double *restrict data = fill->data;
+  long double z0;
+  long double z1;
+  // The block size is even, so pairs never straddle two blocks.
+  for (size_t i = first; i < last; i += 2) {
+    random_normal_pair(&fill->generator, fill->generator.counter + i, &z0, &z1);
+    data[i] = fill->a + fill->b * z0;
+    if (i + 1 < last) {
+      data[i + 1] = fill->a + fill->b * z1;
+    }
+  }
+}
+
+/**
+ * Fill a buffer block by block through the thread pool.
+ *
+ * @param struct random_generator* generator
+ *   The generator, NULL for the library default generator.
+ * @param long double* data
+ *   The buffer.
+ * @param size_t size
+ *   The number of values.
+ * @param uint64_t positions
+ *   The number of stream positions consumed.
+ * @param long double a
+ *   The first parameter of the distribution.
+ * @param long double b
+ *   The second parameter of the distribution.
+ * @param void (*callback)(void *context, int64_t start, int64_t end)
+ *   The loop body.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+static int random_fill_buffer(struct random_generator *generator, long double *data, size_t size, uint64_t positions, long double a, long double b, void (*callback)(void *context, int64_t start, int64_t end)) {
+  if (data == NULL && size > 0) {
+    return 1;
+  }
+  size_t blocks = (size + RANDOM_BLOCK_SIZE - 1) / RANDOM_BLOCK_SIZE;
+  if (blocks > INT_MAX) {
+    return 1;
+  }
+  struct random_fill fill = {{0, 0, 0}, data, size, a, b};
+  random_reserve(generator, positions, &fill.generator);
+  return matrixmath_parallel_for((int64_t)blocks, RANDOM_PARALLEL_GRAIN / RANDOM_BLOCK_SIZE, callback, &fill);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int random_fill_uniform(struct random_generator *generator, long double *data, size_t size, long double min, long double max) {
+  return random_fill_buffer(generator, data, size, size, min, max, random_fill_uniform_blocks);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int random_fill_gaussian(struct random_generator *generator, long double *data, size_t size, long double mean, long double deviation) {
+  return random_fill_buffer(generator, data, size, size + (size & 1), mean, deviation, random_fill_gaussian_blocks);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int vector_fill_uniform(struct vector *object, struct random_generator *generator, long double min, long double max) {
+  if (object == NULL || vector_detach(object) != 0) {
+    return 1;
+  }
+  return random_fill_uniform(generator, object->data, object->capacity, min, max);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int vector_fill_gaussian(struct vector *object, struct random_generator *generator, long double mean, long double deviation) {
+  if (object == NULL || vector_detach(object) != 0) {
+    return 1;
+  }
+  return random_fill_gaussian(generator, object->data, object->capacity, mean, deviation);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_fill_uniform(struct matrix *object, struct random_generator *generator, long double min, long double max) {
+  if (object == NULL || matrix_detach(object) != 0) {
+    return 1;
+  }
+  return random_fill_uniform(generator, object->data, (size_t)object->rows * object->columns, min, max);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_fill_gaussian(struct matrix *object, struct random_generator *generator, long double mean, long double deviation) {
+  if (object == NULL || matrix_detach(object) != 0) {
+    return 1;
+  }
+  return random_fill_gaussian(generator, object->data, (size_t)object->rows * object->columns, mean, deviation);
+}
@@ -0,0 +1,588 @@
+#include <math.h>
+#include "../../include/matrixmath.h"
+
+/**
+ * The number of elements summed with plain accumulators at the leaves of the
+ * pairwise summation tree.
+ *
+ * The rounding error of the pairwise sum grows with log2(n / block) instead of
+ * n, at the cost of nothing but the recursion on large arrays.
+ */
+#define REDUCTION_PAIRWISE_BLOCK 128
+
+/**
+ * The number of elements a parallel chunk is made of, in whole blocks.
+ */
+#define REDUCTION_BLOCK_SIZE 1024
+
+/**
+ * The number of elements below which a reduction is not split across threads.
+ */
+#define REDUCTION_PARALLEL_GRAIN 32768
+
+/**
+ * The number of columns reduced together by the column reductions.
+ */
+#define REDUCTION_COLUMN_TILE 256
+
+/**
+ * The maximum number of partial results of a parallel reduction.
+ */
+#define REDUCTION_MAX_CHUNKS 256
+
+/**
+ * The partial result of a reduction.
+ */
+struct reduction_value {
+
+  /**
+   * The sum, or the extreme value, of the elements.
+   *
+   * @var long double value.
+   */
+  long double value;
+
+  /**
+   * The index of the extreme value, if any.
+   *
+   * @var size_t index.
+   */
+  size_t index;
+};
+
+/**
+ * Define the pairwise summation of a transformation of the elements.
+ *
+ * The leaves use four independent accumulators so consecutive additions do
+ * not wait for each other.
+ */
+#define REDUCTION_PAIRWISE(NAME, EXPR) \
+  static long double NAME(const long double *restrict x, size_t n) { \
+    if (n > REDUCTION_PAIRWISE_BLOCK) { \
+      size_t half = (n / 2 + REDUCTION_PAIRWISE_BLOCK - 1) / REDUCTION_PAIRWISE_BLOCK * REDUCTION_PAIRWISE_BLOCK; \
+      return NAME(x, half) + NAME(x + half, n - half); \
+    } \
+    long double s0 = 0, s1 = 0, s2 = 0, s3 = 0, v; \
+    size_t i = 0; \
+    for (; i + 4 <= n; i += 4) { \
+      v = x[i]; \
+      s0 += EXPR; \
+      v = x[i + 1]; \
+      s1 += EXPR; \
+      v = x[i + 2]; \
+      s2 += EXPR; \
+      v = x[i + 3]; \
+      s3 += EXPR; \
+    } \
+    for (; i < n; i++) { \
+      v = x[i]; \
+      s0 += EXPR; \
+    } \
+    return (s0 + s1) + (s2 + s3); \
+  }
+
+REDUCTION_PAIRWISE(reduction_sum, v)
+REDUCTION_PAIRWISE(reduction_sum_abs, fabsl(v))
+REDUCTION_PAIRWISE(reduction_sum_squares, v * v)
+
+/**
+ * Reduce a contiguous range of elements.
+ *
+ * The mean and the L2 norm are returned as the sum and the sum of squares,
+ * reduction_finalize() completes them.
+ *
+ * @param const long double* x
+ *   The elements.
+ * @param size_t n
+ *   The number of elements, at least 1.
+ * @param enum reduction_operation operation
+ *   The reduction.
+ *
+ * @return struct reduction_value
+ *   The partial result, its index is relative to x.
+ */
+static struct reduction_value reduction_range(const long double *restrict x, size_t n, enum reduction_operation operation) {
+  struct reduction_value result = {0, 0};
+  long double best;
+  switch (operation) {
+    case REDUCTION_SUM:
+    case REDUCTION_MEAN:
+      result.value = reduction_sum(x, n);
+      break;
+
+    case REDUCTION_NORM_L1:
+      result.value = reduction_sum_abs(x, n);
+      break;
+
+    case REDUCTION_NORM_L2:
+      result.value = reduction_sum_squares(x, n);
+      break;
+
+    case REDUCTION_MIN:
+    case REDUCTION_ARGMIN:
+      best = x[0];
+      for (size_t i = 1; i < n; i++) {
+        if (x[i] < best) {
+          best = x[i];
+          result.index = i;
+        }
+      }
+      result.value = best;
+      break;
+
+    case REDUCTION_MAX:
+    case REDUCTION_ARGMAX:
+      best = x[0];
+      for (size_t i = 1; i < n; i++) {
+        if (x[i] > best) {
+          best = x[i];
+          result.index = i;
+        }
+      }
+      result.value = best;
+      break;
+
+    case REDUCTION_NORM_INF:
+      best = 0;
+      for (size_t i = 0; i < n; i++) {
+        best = fabsl(x[i]) > best ? fabsl(x[i]) : best;
+      }
+      result.value = best;
+      break;
+  }
+  return result;
+}
+
+/**
+ * Merge the partial result of the elements following the ones of another.
+ *
+ * On ties the first index wins, as in a sequential scan.
+ *
+ * @param struct reduction_value* a
+ *   The partial result updated with b.
+ * @param struct reduction_value b
+ *   The partial result of the following elements.
+ * @param enum reduction_operation operation
+ *   The reduction.
+ */
+static void reduction_merge(struct reduction_value *a, struct reduction_value b, enum reduction_operation operation) {
+  switch (operation) {
+    case REDUCTION_MIN:
+    case REDUCTION_ARGMIN:
+      if (b.value < a->value) {
+        *a = b;
+      }
+      break;
+
+    case REDUCTION_MAX:
+    case REDUCTION_ARGMAX:
+    case REDUCTION_NORM_INF:
+      if (b.value > a->value) {
+        *a = b;
+      }
+      break;
+
+    default:
+      a->value += b.value;
+      break;
+  }
+}
+
+/**
+ * Turn the partial result of n elements into the value of the reduction.
+ *
+ * @param struct reduction_value result
+ *   The partial result.
+ * @param size_t n
+ *   The number of elements reduced.
+ * @param enum reduction_operation operation
+ *   The reduction.
+ *
+ * @return long double
+ *   The value of the reduction.
+ */
+static long double reduction_finalize(struct reduction_value result, size_t n, enum reduction_operation operation) {
+  switch (operation) {
+    case REDUCTION_MEAN:
+      return result.value / n;
+
+    case REDUCTION_NORM_L2:
+      return sqrtl(result.value);
+
+    case REDUCTION_ARGMIN:
+    case REDUCTION_ARGMAX:
+      return (long double)result.index;
+
+    default:
+      return result.value;
+  }
+}
+
+/**
+ * Get the value of a reduction over no element.
+ *
+ * @param enum reduction_operation operation
+ *   The reduction.
+ *
+ * @return long double
+ *   0 for the sums and the norms, -1 for the indexes, otherwise NAN.
+ */
+static long double reduction_empty(enum reduction_operation operation) {
+  switch (operation) {
+    case REDUCTION_SUM:
+    case REDUCTION_NORM_L1:
+    case REDUCTION_NORM_L2:
+    case REDUCTION_NORM_INF:
+      return 0;
+
+    case REDUCTION_ARGMIN:
+    case REDUCTION_ARGMAX:
+      return -1;
+
+    default:
+      return NAN;
+  }
+}
+
+/**
+ * The data struct definition for a parallel reduction in progress.
+ */
+struct reduction_task {
+  const long double *data;
+  size_t size;
+  enum reduction_operation operation;
+  int chunks;
+  struct reduction_value partials[REDUCTION_MAX_CHUNKS];
+};
+
+/**
+ * Parallel loop body of the reduction of a buffer, the loop runs over chunks.
+ *
+ * @param void* context
+ *   The reduction_task object.
+ * @param int64_t start
+ *   The first chunk to reduce.
+ * @param int64_t end
+ *   The chunk after the last one to reduce.
+ */
+static void reduction_chunks(void *context, int64_t start, int64_t end) {
+  struct reduction_task *task = (struct reduction_task *)context;
+  size_t blocks = (task->size + REDUCTION_BLOCK_SIZE - 1) / REDUCTION_BLOCK_SIZE;
+  size_t first;
+  size_t last;
+  for (int64_t c = start; c < end; c++) {
+    // Whole blocks per chunk, the last block being the only partial one.
+    first = blocks * c / task->chunks * REDUCTION_BLOCK_SIZE;
+    last = blocks * (c + 1) / task->chunks * REDUCTION_BLOCK_SIZE;
+    last = last < task->size ? last : task->size;
+    task->partials[c] = reduction_range(task->data + first, last - first, task->operation);
+    task->partials[c].index += first;
+  }
+}
+
+/**
+ * The data struct definition for a parallel sum in progress.
+ */
+struct reduction_sums {
+  const long double *data;
+  size_t size;
+  enum reduction_operation operation;
+};
+
+/**
+ * Parallel reduction body of the sums, the segments are made of blocks.
+ *
+ * @param void* context
+ *   The reduction_sums object.
+ * @param int64_t start
+ *   The first block of the segment.
+ * @param int64_t end
+ *   The block after the last one of the segment.
+ * @param long double* partial
+ *   The destination of the sum of the segment.
+ */
+static void reduction_sum_blocks(void *context, int64_t start, int64_t end, long double *partial) {
+  struct reduction_sums *sums = (struct reduction_sums *)context;
+  size_t first = (size_t)start * REDUCTION_BLOCK_SIZE;
+  size_t last = (size_t)end * REDUCTION_BLOCK_SIZE < sums->size ? (size_t)end * REDUCTION_BLOCK_SIZE : sums->size;
+  partial[0] = reduction_range(sums->data + first, last - first, sums->operation).value;
+}
+
+/**
+ * Reduce a contiguous buffer, in parallel.
+ *
+ * @param const long double* data
+ *   The elements.
+ * @param size_t size
+ *   The number of elements.
+ * @param enum reduction_operation operation
+ *   The reduction.
+ * @param enum parallel_reduction_mode mode
+ *   The way the partial sums are combined.
+ *
+ * @return long double
+ *   The value of the reduction.
+ */
+static long double reduction_buffer(const long double *data, size_t size, enum reduction_operation operation, enum parallel_reduction_mode mode) {
+  if (size == 0) {
+    return reduction_empty(operation);
+  }
+  size_t blocks = (size + REDUCTION_BLOCK_SIZE - 1) / REDUCTION_BLOCK_SIZE;
+  struct reduction_value result = {0, 0};
+  if (operation == REDUCTION_SUM || operation == REDUCTION_MEAN || operation == REDUCTION_NORM_L1 || operation == REDUCTION_NORM_L2) {
+    // Sums are split into whole blocks, their combination depends on the mode.
+    struct reduction_sums sums = {data, size, operation};
+    matrixmath_parallel_reduce((int64_t)blocks, REDUCTION_PARALLEL_GRAIN / REDUCTION_BLOCK_SIZE, mode, 1, reduction_sum_blocks, &sums, &result.value);
+    return reduction_finalize(result, size, operation);
+  }
+  int chunks = matrixmath_parallel_chunks((int64_t)blocks, REDUCTION_PARALLEL_GRAIN / REDUCTION_BLOCK_SIZE);
+  if (chunks <= 1) {
+    return reduction_finalize(reduction_range(data, size, operation), size, operation);
+  }
+  struct reduction_task task;
+  task.data = data;
+  task.size = size;
+  task.operation = operation;
+  task.chunks = chunks < REDUCTION_MAX_CHUNKS ? chunks : REDUCTION_MAX_CHUNKS;
+  matrixmath_parallel_for(task.chunks, 1, reduction_chunks, &task);
+  // The partials are merged in order, so ties keep the first index whatever
+  // the number of chunks.
+  result = task.partials[0];
+  for (int64_t c = 1; c < task.chunks; c++) {
+    reduction_merge(&result, task.partials[c], operation);
+  }
+  return reduction_finalize(result, size, operation);
+}
+
+/**
+ * {@inheritdoc}
+ */
+long double vector_reduce_mode(struct vector *a, enum reduction_operation operation, enum parallel_reduction_mode mode) {
+  if (a == NULL) {
+    return NAN;
+  }
+  return reduction_buffer(a->data, a->capacity, operation, mode);
+}
+
+/**
+ * {@inheritdoc}
+ */
+long double vector_reduce(struct vector *a, enum reduction_operation operation) {
+  return vector_reduce_mode(a, operation, PARALLEL_REDUCTION_DEFAULT);
+}
+
+/**
+ * {@inheritdoc}
+ */
+long double matrix_reduce_mode(struct matrix *a, enum reduction_operation operation, enum parallel_reduction_mode mode) {
+  if (a == NULL) {
+    return NAN;
+  }
+  return reduction_buffer(a->data, (size_t)a->rows * a->columns, operation, mode);
+}
+
+/**
+ * {@inheritdoc}
+ */
+long double matrix_reduce(struct matrix *a, enum reduction_operation operation) {
+  return matrix_reduce_mode(a, operation, PARALLEL_REDUCTION_DEFAULT);
+}
+
+/**
+ * The data struct definition for a row or column reduction in progress.
+ */
+struct reduction_lines {
+  struct matrix *a;
+  enum reduction_operation operation;
+  long double *dest;
+};
+
+/**
+ * Parallel loop body of the row reductions.
+ *
+ * @param void* context
+ *   The reduction_lines object.
+ * @param int64_t start
+ *   The first row to reduce.
+ * @param int64_t end
+ *   The row after the last one to reduce.
+ */
+static void reduction_rows(void *context, int64_t start, int64_t end) {
+  struct reduction_lines *lines = (struct reduction_lines *)context;
+  int64_t columns = lines->a->columns;
+  for (int64_t i = start; i < end; i++) {
+    lines->dest[i] = reduction_finalize(reduction_range(lines->a->data + (size_t)i * columns, columns, lines->operation), columns, lines->operation);
+  }
+}
+
+/**
+ * Parallel loop body of the column reductions, the loop runs over tiles.
+ *
+ * The rows of a tile are walked contiguously and each column keeps its own
+ * accumulator; the sums are compensated (Neumaier) since a strided pairwise
+ * tree would not be cache friendly.
+ *
+ * @param void* context
+ *   The reduction_lines object.
+ * @param int64_t start
+ *   The first tile to reduce.
+ * @param int64_t end
+ *   The tile after the last one to reduce.
+ */
+static void reduction_columns(void *context, int64_t start, int64_t end) {
+  struct reduction_lines *lines = (struct reduction_lines *)context;
+  struct matrix *a = lines->a;
+  enum reduction_operation operation = lines->operation;
+  long double sum[REDUCTION_COLUMN_TILE];
+  long double compensation[REDUCTION_COLUMN_TILE];
+  struct reduction_value best[REDUCTION_COLUMN_TILE];
+  struct reduction_value candidate;
+  const long double *row;
+  long double v;
+  long double t;
+  int64_t first;
+  int64_t width;
+  for (int64_t tile = start; tile < end; tile++) {
+    first = tile * REDUCTION_COLUMN_TILE;
+    width = a->columns - first < REDUCTION_COLUMN_TILE ? a->columns - first : REDUCTION_COLUMN_TILE;
+    for (int64_t j = 0; j < width; j++) {
+      sum[j] = 0;
+      compensation[j] = 0;
+      best[j].value = operation == REDUCTION_NORM_INF ? 0 : a->data[first + j];
+      best[j].index = 0;
+    }
+    for (int64_t i = 0; i < a->rows; i++) {
+      row = a->data + (size_t)i * a->columns + first;
+      switch (operation) {
+        case REDUCTION_SUM:
+        case REDUCTION_MEAN:
+        case REDUCTION_NORM_L1:
+        case REDUCTION_NORM_L2:
+          for (int64_t j = 0; j < width; j++) {
+            v = operation == REDUCTION_NORM_L1 ? fabsl(row[j]) : operation == REDUCTION_NORM_L2 ? row[j] * row[j] : row[j];
+            t = sum[j] + v;
+            compensation[j] += fabsl(sum[j]) >= fabsl(v) ? (sum[j] - t) + v : (v - t) + sum[j];
+            sum[j] = t;
+          }
+          break;
+
+        default:
+          for (int64_t j = 0; j < width; j++) {
+            candidate.value = operation == REDUCTION_NORM_INF ? fabsl(row[j]) : row[j];
+            candidate.index = i;
+            reduction_merge(&best[j], candidate, operation);
+          }
+          break;
+      }
+    }
+    for (int64_t j = 0; j < width; j++) {
+      if (operation == REDUCTION_SUM || operation == REDUCTION_MEAN || operation == REDUCTION_NORM_L1 || operation == REDUCTION_NORM_L2) {
+        best[j].value = sum[j] + compensation[j];
+      }
+      lines->dest[first + j] = reduction_finalize(best[j], a->rows, operation);
+    }
+  }
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_reduce_rows(struct matrix *a, enum reduction_operation operation, struct vector *dest) {
+  if (a == NULL || dest == NULL || dest->capacity != a->rows || vector_detach(dest) != 0) {
+    return 1;
+  }
+  if (a->columns == 0) {
+    vector_fill(dest, reduction_empty(operation));
+    return 0;
+  }
+  struct reduction_lines lines = {a, operation, dest->data};
+  int64_t grain = REDUCTION_PARALLEL_GRAIN / a->columns;
+  return matrixmath_parallel_for(a->rows, grain > 0 ? grain : 1, reduction_rows, &lines);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_reduce_columns(struct matrix *a, enum reduction_operation operation, struct vector *dest) {
+  if (a == NULL || dest == NULL || dest->capacity != a->columns || vector_detach(dest) != 0) {
+    return 1;
+  }
+  if (a->rows == 0) {
+    vector_fill(dest, reduction_empty(operation));
+    return 0;
+  }
+  struct reduction_lines lines = {a, operation, dest->data};
+  int64_t tiles = (a->columns + REDUCTION_COLUMN_TILE - 1) / REDUCTION_COLUMN_TILE;
+  int64_t work = (int64_t)a->rows * REDUCTION_COLUMN_TILE;
+  int64_t grain = work >= REDUCTION_PARALLEL_GRAIN ? 1 : REDUCTION_PARALLEL_GRAIN / work;
+  return matrixmath_parallel_for(tiles, grain, reduction_columns, &lines);
+}
+
+/**
+ * {@inheritdoc}
+ */
+long double vector_sum(struct vector *a) {
+  return vector_reduce(a, REDUCTION_SUM);
+}
+
+/**
+ * {@inheritdoc}
+ */
+long double vector_mean(struct vector *a) {
+  return vector_reduce(a, REDUCTION_MEAN);
+}
+
+/**
+ * {@inheritdoc}
+ */
+long double vector_min(struct vector *a) {
+  return vector_reduce(a, REDUCTION_MIN);
+}
+
+/**
+ * {@inheritdoc}
+ */
+long double vector_max(struct vector *a) {
+  return vector_reduce(a, REDUCTION_MAX);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int64_t vector_argmin(struct vector *a) {
+  if (a == NULL) {
+    return -1;
+  }
+  return (int64_t)vector_reduce(a, REDUCTION_ARGMIN);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int64_t vector_argmax(struct vector *a) {
+  if (a == NULL) {
+    return -1;
+  }
+  return (int64_t)vector_reduce(a, REDUCTION_ARGMAX);
+}
+
+/**
+ * {@inheritdoc}
+ */
+long double vector_norm_l1(struct vector *a) {
+  return vector_reduce(a, REDUCTION_NORM_L1);
+}
+
+/**
+ * {@inheritdoc}
+ */
+long double vector_norm_l2(struct vector *a) {
+  return vector_reduce(a, REDUCTION_NORM_L2);
+}
+
+/**
+ * {@inheritdoc}
+ */
+long double vector_norm_inf(struct vector *a) {
+  return vector_reduce(a, REDUCTION_NORM_INF);
+}
@@ -0,0 +1,523 @@
+#include <math.h>
+#include <stdlib.h>
+#include "../../include/matrixmath.h"
+
+/**
+ * The number of scratch vectors needed by CG and BiCGSTAB.
+ */
+#define KRYLOV_SCRATCH_VECTORS 8
+
+/**
+ * The default maximum number of iterations.
+ */
+#define KRYLOV_DEFAULT_MAX_ITERATIONS 1000
+
+/**
+ * The default relative residual tolerance.
+ */
+#define KRYLOV_DEFAULT_TOLERANCE 1e-10L
+
+/**
+ * Gram-Schmidt is repeated when the norm of the orthogonalized vector drops
+ * below this fraction of its original norm.
+ */
+#define KRYLOV_REORTHOGONALIZATION_THRESHOLD 0.7L
+
+/**
+ * {@inheritdoc}
+ */
+struct krylov_solver *krylov_solver_create(const int64_t size, const int restart) {
+  if (size <= 0 || restart <= 0) {
+    return NULL;
+  }
+  // Allocate solver memory space.
+  struct krylov_solver *object = malloc(sizeof(struct krylov_solver));
+  if (object == NULL) {
+    return NULL;
+  }
+  // Init solver object properties.
+  object->size = size;
+  object->restart = restart;
+  object->max_iterations = KRYLOV_DEFAULT_MAX_ITERATIONS;
+  object->tolerance = KRYLOV_DEFAULT_TOLERANCE;
+  object->iterations = 0;
+  object->residual = 0;
+  object->hessenberg = NULL;
+  object->givens = NULL;
+  object->rhs = NULL;
+  object->projections = NULL;
+  // GMRES keeps restart + 1 basis vectors plus two scratch vectors.
+  object->work_size = restart + 3;
+  if (object->work_size < KRYLOV_SCRATCH_VECTORS) {
+    object->work_size = KRYLOV_SCRATCH_VECTORS;
+  }
+  object->work = vector_create_multiple(object->work_size);
+  if (object->work == NULL) {
+    krylov_solver_destroy(object);
+    return NULL;
+  }
+  for (int64_t i = 0; i < object->work_size; i++) {
+    object->work[i] = NULL;
+  }
+  for (int64_t i = 0; i < object->work_size; i++) {
+    object->work[i] = vector_create_zeros(size);
+    if (object->work[i] == NULL) {
+      krylov_solver_destroy(object);
+      return NULL;
+    }
+  }
+  // Allocate the GMRES least squares problem.
+  object->hessenberg = malloc(sizeof(long double) * (restart + 1) * restart);
+  object->givens = malloc(sizeof(long double) * 2 * restart);
+  object->rhs = malloc(sizeof(long double) * (restart + 1));
+  object->projections = malloc(sizeof(long double) * (restart + 1));
+  if (object->hessenberg == NULL || object->givens == NULL || object->rhs == NULL || object->projections == NULL) {
+    krylov_solver_destroy(object);
+    return NULL;
+  }
+  // Return the solver object.
+  return object;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void krylov_solver_destroy(struct krylov_solver *object) {
+  if (object == NULL) {
+    return;
+  }
+  if (object->work != NULL) {
+    vector_destroy_multiple(object->work, object->work_size);
+    object->work = NULL;
+  }
+  free(object->hessenberg);
+  free(object->givens);
+  free(object->rhs);
+  free(object->projections);
+  free(object);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int matrix_operator_apply(void *context, struct vector *x, struct vector *y) {
+  return matrix_mul_vector_dest((struct matrix *)context, x, y);
+}
+
+/**
+ * Check the arguments given to a solver.
+ *
+ * @param struct krylov_solver* solver
+ *   The solver object.
+ * @param struct linear_operator* op
+ *   The linear operator.
+ * @param struct vector* b
+ *   The right hand side vector.
+ * @param struct vector* x
+ *   The initial guess vector.
+ *
+ * @return int
+ *   Returns 0 when the arguments are valid, otherwise 1.
+ */
+static int krylov_check(struct krylov_solver *solver, struct linear_operator *op, struct vector *b, struct vector *x) {
+  if (solver == NULL || op == NULL || op->apply == NULL || b == NULL || x == NULL) {
+    return 1;
+  }
+  if (b->capacity != solver->size || x->capacity != solver->size || vector_detach(x) != 0) {
+    return 1;
+  }
+  solver->iterations = 0;
+  solver->residual = 0;
+  return 0;
+}
+
+/**
+ * Compute the residual r = b - A * x and its squared norm.
+ *
+ * @param struct linear_operator* op
+ *   The linear operator.
+ * @param struct vector* b
+ *   The right hand side vector.
+ * @param struct vector* x
+ *   The current solution.
+ * @param struct vector* r
+ *   The destination vector for the residual.
+ * @param long double* norm2
+ *   The destination for the squared norm of the residual.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+static int krylov_residual(struct linear_operator *op, struct vector *b, struct vector *x, struct vector *r, long double *norm2) {
+  if (op->apply(op->context, x, r) != 0) {
+    return 1;
+  }
+  long double *rd = r->data;
+  long double *bd = b->data;
+  *norm2 = 0;
+  for (int64_t i = 0; i < r->capacity; i++) {
+    rd[i] = bd[i] - rd[i];
+    *norm2 += rd[i] * rd[i];
+  }
+  return 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int krylov_cg(struct krylov_solver *solver, struct linear_operator *op, struct preconditioner *pc, struct vector *b, struct vector *x) {
+  if (krylov_check(solver, op, b, x) != 0) {
+    return 1;
+  }
+  int64_t n = solver->size;
+  struct vector *r = solver->work[0];
+  struct vector *u = solver->work[1];
+  struct vector *w = solver->work[2];
+  struct vector *p = solver->work[3];
+  struct vector *s = solver->work[4];
+  // A zero right hand side has the trivial solution.
+  long double bnorm;
+  vector_dot_norms(b, b, NULL, &bnorm, NULL);
+  if (bnorm == 0) {
+    vector_fill(x, 0);
+    return 0;
+  }
+  long double rr;
+  if (krylov_residual(op, b, x, r, &rr) != 0) {
+    return 1;
+  }
+  solver->residual = sqrtl(rr) / bnorm;
+  if (solver->residual <= solver->tolerance) {
+    return 0;
+  }
+  // u = M^-1 * r, w = A * u.
+  if (preconditioner_apply(pc, r, u) != 0 || op->apply(op->context, u, w) != 0) {
+    return 1;
+  }
+  long double *rd = r->data;
+  long double *ud = u->data;
+  long double *wd = w->data;
+  long double *pd = p->data;
+  long double *sd = s->data;
+  long double *xd = x->data;
+  long double gamma = 0;
+  long double delta = 0;
+  for (int64_t i = 0; i < n; i++) {
+    gamma += rd[i] * ud[i];
+    delta += wd[i] * ud[i];
+  }
+  if (delta == 0) {
+    return 1;
+  }
+  long double alpha = gamma / delta;
+  long double beta = 0;
+  long double gamma_next;
+  long double denominator;
+  vector_fill(p, 0);
+  vector_fill(s, 0);
+  while (solver->iterations < solver->max_iterations) {
+    // Single pass: update the search directions, the solution and the residual.
+    rr = 0;
+    for (int64_t i = 0; i < n; i++) {
+      pd[i] = ud[i] + beta * pd[i];
+      sd[i] = wd[i] + beta * sd[i];
+      xd[i] += alpha * pd[i];
+      rd[i] -= alpha * sd[i];
+      rr += rd[i] * rd[i];
+    }
+    solver->iterations++;
+    solver->residual = sqrtl(rr) / bnorm;
+    if (solver->residual <= solver->tolerance) {
+      return 0;
+    }
+    if (preconditioner_apply(pc, r, u) != 0 || op->apply(op->context, u, w) != 0) {
+      return 1;
+    }
+    // Single pass: both inner products of the iteration.
+    gamma_next = 0;
+    delta = 0;
+    for (int64_t i = 0; i < n; i++) {
+      gamma_next += rd[i] * ud[i];
+      delta += wd[i] * ud[i];
+    }
+    beta = gamma_next / gamma;
+    denominator = delta - beta * gamma_next / alpha;
+    if (gamma_next == 0 || denominator == 0) {
+      return 1;
+    }
+    alpha = gamma_next / denominator;
+    gamma = gamma_next;
+  }
+  return 1;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int krylov_bicgstab(struct krylov_solver *solver, struct linear_operator *op, struct preconditioner *pc, struct vector *b, struct vector *x) {
+  if (krylov_check(solver, op, b, x) != 0) {
+    return 1;
+  }
+  int64_t n = solver->size;
+  struct vector *r = solver->work[0];
+  struct vector *shadow = solver->work[1];
+  struct vector *p = solver->work[2];
+  struct vector *v = solver->work[3];
+  struct vector *y = solver->work[4];
+  struct vector *s = solver->work[5];
+  struct vector *z = solver->work[6];
+  struct vector *t = solver->work[7];
+  // A zero right hand side has the trivial solution.
+  long double bnorm;
+  vector_dot_norms(b, b, NULL, &bnorm, NULL);
+  if (bnorm == 0) {
+    vector_fill(x, 0);
+    return 0;
+  }
+  long double rr;
+  if (krylov_residual(op, b, x, r, &rr) != 0) {
+    return 1;
+  }
+  solver->residual = sqrtl(rr) / bnorm;
+  if (solver->residual <= solver->tolerance) {
+    return 0;
+  }
+  vector_copy(r, shadow);
+  vector_fill(p, 0);
+  vector_fill(v, 0);
+  long double rho = rr;
+  long double rho_previous = 1;
+  long double alpha = 1;
+  long double omega = 1;
+  long double beta;
+  long double dot;
+  long double ts;
+  long double tt;
+  long double ss;
+  long double *rd = r->data;
+  long double *hd = shadow->data;
+  long double *pd = p->data;
+  long double *vd = v->data;
+  long double *yd = y->data;
+  long double *sd = s->data;
+  long double *zd = z->data;
+  long double *td = t->data;
+  long double *xd = x->data;
+  while (solver->iterations < solver->max_iterations) {
+    // p = r + beta * (p - omega * v).
+    beta = (rho / rho_previous) * (alpha / omega);
+    for (int64_t i = 0; i < n; i++) {
+      pd[i] = rd[i] + beta * (pd[i] - omega * vd[i]);
+    }
+    // y = M^-1 * p, v = A * y.
+    if (preconditioner_apply(pc, p, y) != 0 || op->apply(op->context, y, v) != 0) {
+      return 1;
+    }
+    vector_dot_norms(shadow, v, &dot, NULL, NULL);
+    if (dot == 0) {
+      return 1;
+    }
+    alpha = rho / dot;
+    // Single pass: s = r - alpha * v and its norm.
+    ss = 0;
+    for (int64_t i = 0; i < n; i++) {
+      sd[i] = rd[i] - alpha * vd[i];
+      ss += sd[i] * sd[i];
+    }
+    solver->iterations++;
+    if (sqrtl(ss) / bnorm <= solver->tolerance) {
+      vector_axpy(alpha, y, x);
+      solver->residual = sqrtl(ss) / bnorm;
+      return 0;
+    }
+    // z = M^-1 * s, t = A * z.
+    if (preconditioner_apply(pc, s, z) != 0 || op->apply(op->context, z, t) != 0) {
+      return 1;
+    }
+    // Single pass: both inner products needed by omega.
+    vector_dot_norms(t, s, &ts, &tt, NULL);
+    tt = tt * tt;
+    if (tt == 0) {
+      return 1;
+    }
+    omega = ts / tt;
+    // Single pass: update the solution, the residual and the next inner products.
+    rho_previous = rho;
+    rho = 0;
+    rr = 0;
+    for (int64_t i = 0; i < n; i++) {
+      xd[i] += alpha * yd[i] + omega * zd[i];
+      rd[i] = sd[i] - omega * td[i];
+      rho += hd[i] * rd[i];
+      rr += rd[i] * rd[i];
+    }
+    solver->residual = sqrtl(rr) / bnorm;
+    if (solver->residual <= solver->tolerance) {
+      return 0;
+    }
+    if (rho == 0 || omega == 0) {
+      return 1;
+    }
+  }
+  return 1;
+}
+
+/**
+ * Orthogonalize the last basis vector against the previous ones.
+ *
+ * Classical Gram-Schmidt: one pass computes all the projections at once and a
+ * second pass removes them while computing the remaining norm.
+ *
+ * @param struct vector** basis
+ *   The basis vectors, the one at position count is orthogonalized.
+ * @param int count
+ *   The number of orthonormal vectors already in the basis.
+ * @param long double* projections
+ *   The destination for the projections over each basis vector.
+ * @param long double* before
+ *   The destination for the norm of the vector before the orthogonalization.
+ *
+ * @return long double
+ *   The norm of the vector after the orthogonalization.
+ */
+static long double krylov_gram_schmidt(struct vector **basis, int count, long double *projections, long double *before) {
+  long double *w = basis[count]->data;
+  int64_t n = basis[count]->capacity;
+  long double norm2 = 0;
+  for (int64_t j = 0; j < count; j++) {
+    projections[j] = 0;
+  }
+  for (int64_t i = 0; i < n; i++) {
+    norm2 += w[i] * w[i];
+    for (int64_t j = 0; j < count; j++) {
+      projections[j] += w[i] * basis[j]->data[i];
+    }
+  }
+  *before = sqrtl(norm2);
+  norm2 = 0;
+  for (int64_t i = 0; i < n; i++) {
+    for (int64_t j = 0; j < count; j++) {
+      w[i] -= projections[j] * basis[j]->data[i];
+    }
+    norm2 += w[i] * w[i];
+  }
+  return sqrtl(norm2);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int krylov_gmres(struct krylov_solver *solver, struct linear_operator *op, struct preconditioner *pc, struct vector *b, struct vector *x) {
+  if (krylov_check(solver, op, b, x) != 0) {
+    return 1;
+  }
+  int64_t n = solver->size;
+  int m = solver->restart;
+  int ld = m + 1;
+  struct vector **basis = solver->work;
+  struct vector *z = solver->work[m + 1];
+  struct vector *u = solver->work[m + 2];
+  long double *h = solver->hessenberg;
+  long double *g = solver->rhs;
+  long double *rotations = solver->givens;
+  long double *projections = solver->projections;
+  // A zero right hand side has the trivial solution.
+  long double bnorm;
+  vector_dot_norms(b, b, NULL, &bnorm, NULL);
+  if (bnorm == 0) {
+    vector_fill(x, 0);
+    return 0;
+  }
+  long double rr;
+  long double beta;
+  long double norm;
+  long double before;
+  long double denominator;
+  long double temp;
+  long double sum;
+  long double *column;
+  int k;
+  while (1) {
+    // Restart from the true residual: v0 = r / ||r||.
+    if (krylov_residual(op, b, x, basis[0], &rr) != 0) {
+      return 1;
+    }
+    beta = sqrtl(rr);
+    solver->residual = beta / bnorm;
+    if (solver->residual <= solver->tolerance) {
+      return 0;
+    }
+    if (solver->iterations >= solver->max_iterations) {
+      return 1;
+    }
+    vector_scale_inplace(1 / beta, basis[0]);
+    g[0] = beta;
+    for (int64_t i = 1; i <= m; i++) {
+      g[i] = 0;
+    }
+    // Arnoldi process.
+    k = 0;
+    while (k < m && solver->iterations < solver->max_iterations) {
+      // w = A * M^-1 * v_k, built in place of the next basis vector.
+      if (preconditioner_apply(pc, basis[k], z) != 0 || op->apply(op->context, z, basis[k + 1]) != 0) {
+        return 1;
+      }
+      column = h + k * ld;
+      norm = krylov_gram_schmidt(basis, k + 1, column, &before);
+      // Repeat once when cancellation made the result lose orthogonality.
+      if (norm < KRYLOV_REORTHOGONALIZATION_THRESHOLD * before) {
+        norm = krylov_gram_schmidt(basis, k + 1, projections, &before);
+        for (int64_t j = 0; j <= k; j++) {
+          column[j] += projections[j];
+        }
+      }
+      column[k + 1] = norm;
+      if (norm != 0) {
+        vector_scale_inplace(1 / norm, basis[k + 1]);
+      }
+      // Apply the previous Givens rotations to the new column.
+      for (int64_t i = 0; i < k; i++) {
+        temp = rotations[2 * i] * column[i] + rotations[2 * i + 1] * column[i + 1];
+        column[i + 1] = -rotations[2 * i + 1] * column[i] + rotations[2 * i] * column[i + 1];
+        column[i] = temp;
+      }
+      // Compute the rotation that eliminates the subdiagonal element.
+      denominator = hypotl(column[k], column[k + 1]);
+      if (denominator == 0) {
+        return 1;
+      }
+      rotations[2 * k] = column[k] / denominator;
+      rotations[2 * k + 1] = column[k + 1] / denominator;
+      column[k] = denominator;
+      column[k + 1] = 0;
+      g[k + 1] = -rotations[2 * k + 1] * g[k];
+      g[k] = rotations[2 * k] * g[k];
+      k++;
+      solver->iterations++;
+      solver->residual = fabsl(g[k]) / bnorm;
+      if (solver->residual <= solver->tolerance || norm == 0) {
+        break;
+      }
+    }
+    // Solve the upper triangular least squares system in place.
+    for (int64_t i = k - 1; i >= 0; i--) {
+      sum = g[i];
+      for (int64_t j = i + 1; j < k; j++) {
+        sum -= h[i + j * ld] * g[j];
+      }
+      g[i] = sum / h[i + i * ld];
+    }
+    // Single pass: u = V * y, then x += M^-1 * u.
+    for (int64_t i = 0; i < n; i++) {
+      sum = 0;
+      for (int64_t j = 0; j < k; j++) {
+        sum += g[j] * basis[j]->data[i];
+      }
+      u->data[i] = sum;
+    }
+    if (preconditioner_apply(pc, u, z) != 0) {
+      return 1;
+    }
+    vector_add_inplace(x, z);
+  }
+}
@@ -0,0 +1,359 @@
+#include <stdlib.h>
+#include "../../include/matrixmath.h"
+
+/**
+ * Apply the Jacobi preconditioner: z = D^-1 * r.
+ *
+ * @param void* context
+ *   The vector with the inverse of the matrix diagonal.
+ * @param struct vector* r
+ *   The vector to precondition.
+ * @param struct vector* z
+ *   The destination vector where the results of the operation will be stored.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+static int preconditioner_jacobi_apply(void *context, struct vector *r, struct vector *z) {
+  struct vector *diagonal = (struct vector *)context;
+  if (r->capacity != diagonal->capacity || z->capacity != diagonal->capacity) {
+    return 1;
+  }
+  long double *d = diagonal->data;
+  long double *rd = r->data;
+  long double *zd = z->data;
+  for (int64_t i = 0; i < diagonal->capacity; i++) {
+    zd[i] = d[i] * rd[i];
+  }
+  return 0;
+}
+
+/**
+ * Free the Jacobi preconditioner context.
+ *
+ * @param void* context
+ *   The vector with the inverse of the matrix diagonal.
+ */
+static void preconditioner_jacobi_destroy(void *context) {
+  vector_destroy((struct vector *)context);
+}
+
+/**
+ * Create a Jacobi preconditioner from the inverse of a diagonal.
+ *
+ * @param struct vector* diagonal
+ *   The diagonal of the matrix, replaced by its inverse. It is owned by the
+ *   preconditioner, or freed on failure.
+ *
+ * @return struct preconditioner*
+ *   The pointer to the preconditioner instance, otherwise NULL.
+ */
+static struct preconditioner *preconditioner_jacobi_wrap(struct vector *diagonal) {
+  // Store the inverse of the diagonal so applying it is a multiplication.
+  long double *d = diagonal->data;
+  for (int64_t i = 0; i < diagonal->capacity; i++) {
+    if (d[i] == 0) {
+      vector_destroy(diagonal);
+      return NULL;
+    }
+    d[i] = 1 / d[i];
+  }
+  // Allocate the preconditioner memory space.
+  struct preconditioner *object = malloc(sizeof(struct preconditioner));
+  if (object == NULL) {
+    vector_destroy(diagonal);
+    return NULL;
+  }
+  object->apply = preconditioner_jacobi_apply;
+  object->destroy = preconditioner_jacobi_destroy;
+  object->context = diagonal;
+  return object;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct preconditioner *preconditioner_jacobi_create(struct matrix *a) {
+  // Only square matrices have a usable diagonal.
+  if (a == NULL || a->rows != a->columns) {
+    return NULL;
+  }
+  struct vector *diagonal = vector_create(a->rows);
+  if (diagonal == NULL) {
+    return NULL;
+  }
+  for (int64_t i = 0; i < a->rows; i++) {
+    diagonal->data[i] = a->data[(size_t)i * a->columns + i];
+  }
+  return preconditioner_jacobi_wrap(diagonal);
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct preconditioner *preconditioner_jacobi_create_sparse(struct sparse_matrix *a) {
+  // Only square matrices have a usable diagonal.
+  if (a == NULL || a->rows != a->columns) {
+    return NULL;
+  }
+  struct vector *diagonal = vector_create_zeros(a->rows);
+  if (diagonal == NULL) {
+    return NULL;
+  }
+  // Repeated values of a position add up, as in the product.
+  for (int64_t i = 0; i < a->rows; i++) {
+    for (int64_t p = a->offsets[i]; p < a->offsets[i + 1]; p++) {
+      if (a->indices[p] == i) {
+        diagonal->data[i] += a->values[p];
+      }
+    }
+  }
+  return preconditioner_jacobi_wrap(diagonal);
+}
+
+/**
+ * The data struct definition for the ILU(0) factors.
+ */
+struct preconditioner_ilu0 {
+  struct sparse_matrix *factors;
+  int64_t *diagonal;
+};
+
+/**
+ * Apply the ILU(0) preconditioner: z = U^-1 * L^-1 * r.
+ *
+ * @param void* context
+ *   The preconditioner_ilu0 object, the L (unit diagonal, not stored) and U
+ *   factors share the sparsity pattern of the matrix.
+ * @param struct vector* r
+ *   The vector to precondition.
+ * @param struct vector* z
+ *   The destination vector where the results of the operation will be stored.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+static int preconditioner_ilu0_apply(void *context, struct vector *r, struct vector *z) {
+  struct preconditioner_ilu0 *ilu0 = (struct preconditioner_ilu0 *)context;
+  const struct sparse_matrix *factors = ilu0->factors;
+  int64_t n = factors->rows;
+  if (r->capacity != n || z->capacity != n) {
+    return 1;
+  }
+  const long double *values = factors->values;
+  const int64_t *indices = factors->indices;
+  const int64_t *offsets = factors->offsets;
+  const int64_t *diagonal = ilu0->diagonal;
+  long double *rd = r->data;
+  long double *zd = z->data;
+  long double sum;
+  // Forward substitution with the unit lower triangular factor: L * y = r.
+  for (int64_t i = 0; i < n; i++) {
+    sum = rd[i];
+    for (int64_t p = offsets[i]; p < diagonal[i]; p++) {
+      sum -= values[p] * zd[indices[p]];
+    }
+    zd[i] = sum;
+  }
+  // Backward substitution with the upper triangular factor: U * z = y.
+  for (int64_t i = n - 1; i >= 0; i--) {
+    sum = zd[i];
+    for (int64_t p = diagonal[i] + 1; p < offsets[i + 1]; p++) {
+      sum -= values[p] * zd[indices[p]];
+    }
+    zd[i] = sum / values[diagonal[i]];
+  }
+  return 0;
+}
+
+/**
+ * Free the ILU(0) preconditioner context.
+ *
+ * @param void* context
+ *   The preconditioner_ilu0 object.
+ */
+static void preconditioner_ilu0_destroy(void *context) {
+  struct preconditioner_ilu0 *ilu0 = (struct preconditioner_ilu0 *)context;
+  if (ilu0 == NULL) {
+    return;
+  }
+  sparse_matrix_destroy(ilu0->factors);
+  free(ilu0->diagonal);
+  free(ilu0);
+}
+
+/**
+ * Factorize a square sparse matrix in place and wrap it in a preconditioner.
+ *
+ * @param struct sparse_matrix* factors
+ *   The matrix, columns sorted and unique within every row. It is owned by the
+ *   preconditioner, or freed on failure.
+ *
+ * @return struct preconditioner*
+ *   The pointer to the preconditioner instance, otherwise NULL.
+ */
+static struct preconditioner *preconditioner_ilu0_factorize(struct sparse_matrix *factors) {
+  int64_t n = factors->rows;
+  struct preconditioner_ilu0 *ilu0 = malloc(sizeof(struct preconditioner_ilu0));
+  if (ilu0 == NULL) {
+    sparse_matrix_destroy(factors);
+    return NULL;
+  }
+  ilu0->factors = factors;
+  ilu0->diagonal = malloc(((size_t)n + 1) * sizeof(int64_t));
+  // The position of every column of the current row, -1 outside the pattern.
+  int64_t *position = malloc(((size_t)n + 1) * sizeof(int64_t));
+  if (ilu0->diagonal == NULL || position == NULL) {
+    free(position);
+    preconditioner_ilu0_destroy(ilu0);
+    return NULL;
+  }
+  for (int64_t j = 0; j < n; j++) {
+    position[j] = -1;
+  }
+  long double *values = factors->values;
+  const int64_t *indices = factors->indices;
+  const int64_t *offsets = factors->offsets;
+  int64_t *diagonal = ilu0->diagonal;
+  int64_t k;
+  int64_t j;
+  long double lower;
+  int status = 0;
+  // IKJ variant of Gaussian elimination restricted to the pattern, the updates
+  // of row i only visit the upper part of the rows it depends on.
+  for (int64_t i = 0; i < n && status == 0; i++) {
+    for (int64_t p = offsets[i]; p < offsets[i + 1]; p++) {
+      position[indices[p]] = p;
+    }
+    diagonal[i] = position[i];
+    if (diagonal[i] < 0) {
+      status = 1;
+    }
+    for (int64_t p = offsets[i]; p < offsets[i + 1] && status == 0 && indices[p] < i; p++) {
+      k = indices[p];
+      lower = values[p] / values[diagonal[k]];
+      values[p] = lower;
+      for (int64_t q = diagonal[k] + 1; q < offsets[k + 1]; q++) {
+        j = position[indices[q]];
+        if (j >= 0) {
+          values[j] -= lower * values[q];
+        }
+      }
+    }
+    if (status == 0 && values[diagonal[i]] == 0) {
+      status = 1;
+    }
+    for (int64_t p = offsets[i]; p < offsets[i + 1]; p++) {
+      position[indices[p]] = -1;
+    }
+  }
+  free(position);
+  if (status != 0) {
+    preconditioner_ilu0_destroy(ilu0);
+    return NULL;
+  }
+  // Allocate the preconditioner memory space.
+  struct preconditioner *object = malloc(sizeof(struct preconditioner));
+  if (object == NULL) {
+    preconditioner_ilu0_destroy(ilu0);
+    return NULL;
+  }
+  object->apply = preconditioner_ilu0_apply;
+  object->destroy = preconditioner_ilu0_destroy;
+  object->context = ilu0;
+  return object;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct preconditioner *preconditioner_ilu0_create(struct matrix *a) {
+  // The factorization is only defined for square matrices.
+  if (a == NULL || a->rows != a->columns) {
+    return NULL;
+  }
+  // The conversion keeps the nonzero pattern with sorted columns.
+  struct sparse_matrix *factors = sparse_matrix_from_matrix(a);
+  if (factors == NULL) {
+    return NULL;
+  }
+  return preconditioner_ilu0_factorize(factors);
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct preconditioner *preconditioner_ilu0_create_sparse(struct sparse_matrix *a) {
+  // The factorization is only defined for square matrices.
+  if (a == NULL || a->rows != a->columns) {
+    return NULL;
+  }
+  struct sparse_matrix *factors = sparse_matrix_create(a->rows, a->columns, a->nonzeros);
+  if (factors == NULL) {
+    return NULL;
+  }
+  // Copy the rows with sorted columns, repeated columns add up.
+  long double value;
+  int64_t column;
+  int64_t first;
+  int64_t q;
+  int64_t position = 0;
+  for (int64_t i = 0; i < a->rows; i++) {
+    first = position;
+    for (int64_t p = a->offsets[i]; p < a->offsets[i + 1]; p++) {
+      column = a->indices[p];
+      value = a->values[p];
+      if (column < 0 || column >= a->columns) {
+        sparse_matrix_destroy(factors);
+        return NULL;
+      }
+      // Rows are usually sorted already, the insertion stops at once then.
+      for (q = position; q > first && factors->indices[q - 1] > column; q--) {
+        factors->indices[q] = factors->indices[q - 1];
+        factors->values[q] = factors->values[q - 1];
+      }
+      if (q > first && factors->indices[q - 1] == column) {
+        factors->values[q - 1] += value;
+        for (; q < position; q++) {
+          factors->indices[q] = factors->indices[q + 1];
+          factors->values[q] = factors->values[q + 1];
+        }
+        continue;
+      }
+      factors->indices[q] = column;
+      factors->values[q] = value;
+      position++;
+    }
+    factors->offsets[i + 1] = position;
+  }
+  factors->nonzeros = position;
+  return preconditioner_ilu0_factorize(factors);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void preconditioner_destroy(struct preconditioner *object) {
+  if (object == NULL) {
+    return;
+  }
+  if (object->destroy != NULL) {
+    object->destroy(object->context);
+  }
+  object->context = NULL;
+  free(object);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int preconditioner_apply(struct preconditioner *object, struct vector *r, struct vector *z) {
+  // Without preconditioner the operation is the identity.
+  if (object == NULL) {
+    return vector_copy(r, z);
+  }
+  if (vector_detach(z) != 0) {
+    return 1;
+  }
+  return object->apply(object->context, r, z);
+}
@@ -1,13 +1,14 @@
 #include <stdlib.h>
+#include <string.h>
 #include "../../include/matrixmath.h"
-#include "vector_item.h"
 
 /**
  * {@inheritdoc}
  */
-struct vector *vector_create(const int capacity) {
-  if (capacity <= 0) {
-    // Vector with no capacity not allowed.
+struct vector *vector_create(const int64_t capacity) {
+  size_t bytes;
+  if (capacity <= 0 || matrixmath_array_size(capacity, sizeof(long double), &bytes) != 0) {
+    // Vector with no capacity, or too large to be addressed, not allowed.
     return NULL;
   }
   // Allocate vector memory space.
@@ -18,17 +19,19 @@ struct vector *vector_create(const int capacity) {
   }
   // Init vector object properties.
   object->capacity = capacity;
-  // Try to set the requested vector capacity.
-  size_t items_size = sizeof(struct _vector_item *) * object->capacity;
-  object->items = malloc(items_size);
-  if (object->items == NULL) {
+  object->allocated = capacity;
+  object->release = matrixmath_release_allocated;
+  object->release_context = NULL;
+  object->shared = NULL;
+  // Try to set the requested vector capacity, zero initialized by the threads
+  // computing the values.
+  struct matrixmath_allocator *allocator;
+  object->data = matrixmath_allocate(capacity, 1, NULL, &allocator);
+  if (object->data == NULL) {
     vector_destroy(object);
     return NULL;
   }
-  // NULL initialize the vector items.
-  for (int i = 0; i < object->capacity; i++) {
-    object->items[i] = NULL;
-  }
+  object->release_context = allocator;
   // Return the vector object.
   return object;
 }
@@ -36,7 +39,7 @@ struct vector *vector_create(const int capacity) {
 /**
  * {@inheritdoc}
  */
-struct vector *vector_create_zeros(const int capacity) {
+struct vector *vector_create_zeros(const int64_t capacity) {
   // Reuse the generalized function to create a vector with a specific default value.
   return vector_create_with_value(capacity, 0);
 }
@@ -44,7 +47,7 @@ struct vector *vector_create_zeros(const int capacity) {
 /**
  * {@inheritdoc}
  */
-struct vector *vector_create_with_value(const int capacity, long double default_value) {
+struct vector *vector_create_with_value(const int64_t capacity, long double default_value) {
   // Create a new vector object instance.
   struct vector *object = vector_create(capacity);
   if (object == NULL) {
@@ -59,7 +62,7 @@ struct vector *vector_create_with_value(const int capacity, long double default_
 /**
  * {@inheritdoc}
  */
-struct vector *vector_create_random(const int capacity, const long double min, const long double max) {
+struct vector *vector_create_random(const int64_t capacity, const long double min, const long double max) {
   // Create a new vector object instance.
   struct vector *object = vector_create(capacity);
   if (object == NULL) {
@@ -74,13 +77,41 @@ struct vector *vector_create_random(const int capacity, const long double min, c
 /**
  * {@inheritdoc}
  */
-struct vector **vector_create_multiple(int size) {
+struct vector *vector_wrap(long double *data, const int64_t capacity, void (*release)(void *context, long double *data), void *context) {
+  size_t bytes;
+  if (data == NULL || capacity <= 0 || matrixmath_array_size(capacity, sizeof(long double), &bytes) != 0) {
+    return NULL;
+  }
+  // The kernels address the values as long double, the buffer must allow it.
+  if ((uintptr_t)data % _Alignof(long double) != 0) {
+    return NULL;
+  }
+  struct vector *object = malloc(sizeof(struct vector));
+  if (object == NULL) {
+    return NULL;
+  }
+  object->data = data;
+  object->capacity = capacity;
+  object->allocated = capacity;
+  object->release = release;
+  object->release_context = context;
+  object->shared = NULL;
+  return object;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct vector **vector_create_multiple(int64_t size) {
   // Ensure size is valid.
   if (size <= 0) {
     return NULL;
   }
   // Try to set the requested the items memory.
-  size_t items_size = sizeof(struct vector *) * size;
+  size_t items_size;
+  if (matrixmath_array_size(size, sizeof(struct vector *), &items_size) != 0) {
+    return NULL;
+  }
   struct vector **items = malloc(items_size);
   return items;
 }
@@ -92,17 +123,15 @@ void vector_destroy(struct vector *object) {
   if (object == NULL) {
     return;
   }
-  // Free the object items.
-  if (object->items != NULL) {
-    for (int i = 0; i < object->capacity; i++) {
-      if (object->items[i] != NULL) {
-        vector_item_destroy(object->items[i]);
-        object->items[i] = NULL;
-      }
-    }
-    free(object->items);
-    object->items = NULL;
+  // Release the object values, unless they are borrowed; shared values are
+  // released by the last object using them.
+  if (object->shared != NULL) {
+    matrixmath_shared_release(object->shared);
+  }
+  else if (object->release != NULL && object->data != NULL) {
+    object->release(object->release_context, object->data);
   }
+  object->data = NULL;
   object->capacity = 0;
   // Free the object.
   free(object);
@@ -113,15 +142,15 @@ void vector_destroy(struct vector *object) {
  *
  * @param struct vector **items
  *   The list of vectors to destroy.
- * @param int size
+ * @param int64_t size
  *   The number of vectors to destroy.
  */
-void vector_destroy_multiple(struct vector **items, int size) {
+void vector_destroy_multiple(struct vector **items, int64_t size) {
   // Check for NULL or invalid size.
   if (items == NULL || size <= 0) {
     return;
   }
-  for (size_t i = 0; i < size; i++) {
+  for (int64_t i = 0; i < size; i++) {
     vector_destroy(items[i]);
   }
   free(items);
@@ -130,48 +159,45 @@ void vector_destroy_multiple(struct vector **items, int size) {
 /**
  * {@inheritdoc}
  */
-long double *vector_setl(struct vector *object, int index, long double value) {
+long double *vector_setl(struct vector *object, int64_t index, long double value) {
   // Check for valid index.
   if (object == NULL || index < 0 || index >= object->capacity) {
     // Index out of bounds.
     return NULL;
   }
-  // Create void pointer with the value.
-  size_t size = sizeof(long double);
-  long double *item_value = malloc(size);
-  if (item_value == NULL) {
+  if (vector_detach(object) != 0) {
     return NULL;
   }
-  *item_value = value;
-  // Create item.
-  void *item = vector_item_set(index, item_value);
-  if (item == NULL) {
-    free(item_value);
-    return NULL;
-  }
-  object->items[index] = item;
+  // Store the value in place.
+  object->data[index] = value;
   // Return the pointer to the value stored.
-  return item_value;
+  return object->data + index;
 }
 
 /**
  * {@inheritdoc}
  */
-long double *vector_getl(struct vector *object, int index) {
+long double *vector_getl(struct vector *object, int64_t index) {
   // Check for valid index
   if (object == NULL || index < 0 || index >= object->capacity) {
     // Index out of bounds.
     return NULL;
   }
-  void *item = object->items[index];
-  if (item == NULL) {
+  // The pointer can be written through, the values cannot stay shared.
+  if (vector_detach(object) != 0) {
     return NULL;
   }
-  void *value = vector_item_get(item);
-  if (value == NULL) {
+  return object->data + index;
+}
+
+/**
+ * {@inheritdoc}
+ */
+long double *vector_data(struct vector *object) {
+  if (object == NULL || vector_detach(object) != 0) {
     return NULL;
   }
-  return (long double *)value;
+  return object->data;
 }
 
 /**
@@ -182,36 +208,165 @@ struct vector *vector_concatenate(struct vector *a, struct vector *b) {
   if (a == NULL || b == NULL) {
     return NULL;
   }
-  int capacity = a->capacity + b->capacity;
+  int64_t capacity = a->capacity + b->capacity;
   // Create the new vector to store the result of the operation.
   struct vector *result = vector_create(capacity);
   if (result == NULL) {
     return NULL;
   }
-  // Copy values from vector a.
-  long double *val;
-  for (size_t i = 0; i < a->capacity; i++) {
-    val = vector_getl(a, i);
-    if (val == NULL) {
-      vector_destroy(result);
-      return NULL;
-    }
-    vector_setl(result, i, *val);
-  }
-  // Copy values from vector b.
-  size_t start = a->capacity;
-  for (size_t j = 0; j < b->capacity; j++) {
-    val = vector_getl(b, j);
-    if (val == NULL) {
-      vector_destroy(result);
-      return NULL;
-    }
-    vector_setl(result, (start + j), *val);
-  }
+  // Copy values from vector a, followed by the values from vector b.
+  memcpy(result->data, a->data, sizeof(long double) * a->capacity);
+  memcpy(result->data + a->capacity, b->data, sizeof(long double) * b->capacity);
   // Return the result of the operation.
   return result;
 }
 
+/**
+ * Move the values of a vector to a new buffer of the given size.
+ *
+ * Buffers adopted from malloc() are resized with realloc(); the others are
+ * copied to a new buffer from the library allocator, and the old one is
+ * released or left to its owner.
+ *
+ * @param struct vector* object
+ *   The vector object.
+ * @param int64_t allocated
+ *   The number of elements of the new buffer, at least the capacity.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+static int vector_reallocate(struct vector *object, int64_t allocated) {
+  size_t bytes;
+  // Keep a valid buffer for empty vectors.
+  if (allocated < 1) {
+    allocated = 1;
+  }
+  if (matrixmath_array_size(allocated, sizeof(long double), &bytes) != 0) {
+    return 1;
+  }
+  long double *data;
+  if (object->shared == NULL && object->release == matrixmath_release_free) {
+    data = realloc(object->data, bytes);
+    if (data == NULL) {
+      return 1;
+    }
+    object->data = data;
+    object->allocated = allocated;
+    return 0;
+  }
+  struct matrixmath_allocator *allocator;
+  data = matrixmath_allocate_values(bytes, &allocator);
+  if (data == NULL) {
+    return 1;
+  }
+  memcpy(data, object->data, sizeof(long double) * object->capacity);
+  if (object->shared != NULL) {
+    matrixmath_shared_release(object->shared);
+  }
+  else if (object->release != NULL) {
+    object->release(object->release_context, object->data);
+  }
+  object->data = data;
+  object->allocated = allocated;
+  object->release = matrixmath_release_allocated;
+  object->release_context = allocator;
+  object->shared = NULL;
+  return 0;
+}
+
+/**
+ * Make room for a number of elements, growing the buffer geometrically.
+ *
+ * @param struct vector* object
+ *   The vector object.
+ * @param int64_t count
+ *   The number of elements the buffer must hold.
+ *
+ * @return int
+ *   Returns 0 when the operation succeeded, otherwise 1.
+ */
+static int vector_grow(struct vector *object, int64_t count) {
+  // Shared values are copied first, to a buffer that may be smaller.
+  if (vector_detach(object) != 0) {
+    return 1;
+  }
+  if (count <= object->allocated) {
+    return 0;
+  }
+  // Doubling keeps the total copy cost linear in the final size.
+  int64_t allocated = object->allocated < INT64_MAX / 2 ? object->allocated * 2 : INT64_MAX;
+  return vector_reallocate(object, allocated > count ? allocated : count);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int vector_reserve(struct vector *object, int64_t count) {
+  if (object == NULL || count < 0) {
+    return 1;
+  }
+  if (count <= object->allocated) {
+    return 0;
+  }
+  return vector_reallocate(object, count);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int vector_resize(struct vector *object, int64_t capacity) {
+  if (object == NULL || capacity < 0 || vector_grow(object, capacity) != 0) {
+    return 1;
+  }
+  if (capacity > object->capacity) {
+    memset(object->data + object->capacity, 0, sizeof(long double) * (capacity - object->capacity));
+  }
+  object->capacity = capacity;
+  return 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int vector_push(struct vector *object, long double value) {
+  if (object == NULL || object->capacity == INT64_MAX || vector_grow(object, object->capacity + 1) != 0) {
+    return 1;
+  }
+  object->data[object->capacity++] = value;
+  return 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int vector_append(struct vector *a, struct vector *b) {
+  if (a == NULL || b == NULL || b->capacity > INT64_MAX - a->capacity) {
+    return 1;
+  }
+  int64_t count = b->capacity;
+  if (vector_grow(a, a->capacity + count) != 0) {
+    return 1;
+  }
+  // Read b after growing a, its values moved if it is a itself.
+  memcpy(a->data + a->capacity, b->data, sizeof(long double) * count);
+  a->capacity += count;
+  return 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int vector_shrink_to_fit(struct vector *object) {
+  if (object == NULL || vector_detach(object) != 0) {
+    return 1;
+  }
+  if (object->allocated <= object->capacity || object->allocated == 1) {
+    return 0;
+  }
+  return vector_reallocate(object, object->capacity);
+}
+
 /**
  * {@inheritdoc}
  */
@@ -220,38 +375,63 @@ struct vector *vector_clone(struct vector *a) {
   if (a == NULL) {
     return NULL;
   }
-  // Create the new vector to store the result of the operation.
-  struct vector *result = vector_create(a->capacity);
-  if (result == NULL) {
+  // Share the values, they are copied by the first write to either vector.
+  struct matrixmath_shared *shared = matrixmath_shared_get(&a->shared, a->data, a->release, a->release_context);
+  if (shared == NULL) {
     return NULL;
   }
-  // Copy values from vector a.
-  long double *val;
-  for (size_t i = 0; i < a->capacity; i++) {
-    val = vector_getl(a, i);
-    if (val != NULL) {
-      vector_setl(result, i, (*val));
-    }
+  struct vector *result = malloc(sizeof(struct vector));
+  if (result == NULL) {
+    return NULL;
   }
+  matrixmath_shared_retain(shared);
+  result->data = a->data;
+  result->capacity = a->capacity;
+  result->allocated = a->allocated;
+  result->release = NULL;
+  result->release_context = NULL;
+  result->shared = shared;
   // Return the result of the operation.
   return result;
 }
 
+/**
+ * {@inheritdoc}
+ */
+int vector_detach(struct vector *object) {
+  if (object == NULL) {
+    return 1;
+  }
+  if (object->shared == NULL || matrixmath_shared_unique(object->shared)) {
+    return 0;
+  }
+  // An empty vector still gets a valid buffer.
+  struct matrixmath_allocator *allocator;
+  long double *data = object->capacity > 0 ? matrixmath_allocate(object->capacity, 1, object->data, &allocator) : matrixmath_allocate_values(sizeof(long double), &allocator);
+  if (data == NULL) {
+    return 1;
+  }
+  // Drop the reference only once the values are copied.
+  matrixmath_shared_release(object->shared);
+  object->data = data;
+  object->allocated = object->capacity;
+  object->release = matrixmath_release_allocated;
+  object->release_context = allocator;
+  object->shared = NULL;
+  return 0;
+}
+
 /**
  * {@inheritdoc}
  */
 int vector_walk(struct vector *a, long double (*callback)(long double)) {
   // Check for NULL pointers.
-  if (a == NULL || callback == NULL) {
+  if (a == NULL || callback == NULL || vector_detach(a) != 0) {
     return 0;
   }
-  long double *val;
-  for (size_t i = 0; i < a->capacity; i++) {
-    val = vector_getl(a, i);
-    if (val == NULL) {
-      return 0;
-    }
-    vector_setl(a, i, callback(*val));
+  long double *data = a->data;
+  for (int64_t i = 0; i < a->capacity; i++) {
+    data[i] = callback(data[i]);
   }
   return 1;
 }
@@ -261,41 +441,10 @@ int vector_walk(struct vector *a, long double (*callback)(long double)) {
  */
 void vector_fill(struct vector *object, const long double value) {
   // Check for NULL vector object.
-  if (object == NULL) {
+  if (object == NULL || vector_detach(object) != 0) {
     return;
   }
-  for (size_t i = 0; i < object->capacity; i++) {
-    vector_setl(object, i, value);
-  }
-}
-
-/**
- * Generate a random long double value between a specified range.
- *
- * This function generates a random floating-point value between the provided
- * `min` and `max` values using a uniform distribution. It uses the `rand()`
- * function to generate a random integer and scales it to the desired range by
- * normalizing the result to a floating-point number between 0 and 1, then scaling
- * it to fit within the specified bounds.
- *
- * Note: The function relies on the standard `rand()` function, which provides
- * limited precision and should be seeded with `srand()` before use in the program.
- * For applications that require higher precision or different distributions,
- * consider using other random number generators.
- *
- * @param long double min
- *   The minimum possible value in the generated range.
- * @param long double max
- *   The maximum possible value in the generated range.
- *
- * @return
- *   A random long double between `min` and `max`.
- */
-static long double random_long_double(long double min, long double max) {
-  // Random number between 0 and 1.
-  long double scale = rand() / (long double)RAND_MAX;
-  // Scale it to the desired range.
-  return min + scale * (max - min);
+  matrixmath_fill(object->data, object->capacity, 1, value);
 }
 
 /**
@@ -303,13 +452,11 @@ static long double random_long_double(long double min, long double max) {
  */
 void vector_fill_random(struct vector *object, const long double min, const long double max) {
   // Handle NULL vector object.
-  if (object == NULL) {
+  if (object == NULL || vector_detach(object) != 0) {
     return;
   }
-  // Assign a random value to each element in the vector.
-  for (size_t i = 0; i < object->capacity; i++) {
-    vector_setl(object, i, random_long_double(min, max));
-  }
+  // Draw the values from the library default generator.
+  random_fill_uniform(NULL, object->data, object->capacity, min, max);
 }
 
 /**
@@ -321,15 +468,12 @@ int vector_copy(struct vector *src, struct vector *dest) {
     return 1;
   }
   // Ensure destination capacity is sufficient.
-  if (dest->capacity < src->capacity) {
+  if (dest->capacity < src->capacity || vector_detach(dest) != 0) {
     return 1;
   }
-  long double *val;
-  for (size_t i = 0; i < src->capacity; i++) {
-    val = vector_getl(src, i);
-    if (val != NULL) {
-      vector_setl(dest, i, *val);
-    }
+  // Copying a vector into itself is a no-op.
+  if (src != dest) {
+    memcpy(dest->data, src->data, sizeof(long double) * src->capacity);
   }
   return 0;
 }
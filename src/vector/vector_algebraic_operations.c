@@ -15,19 +15,7 @@ struct vector *vector_add(struct vector *a, struct vector *b) {
     return NULL;
   }
   // Sum the values.
-  long double *val1;
-  long double *val2;
-  long double sum = 0;
-  for (int i = 0; i < a->capacity; i++) {
-    val1 = vector_getl(a, i);
-    val2 = vector_getl(b, i);
-    if (val1 == NULL || val2 == NULL) {
-      free(result);
-      return NULL;
-    }
-    sum = *val1 + *val2;
-    vector_setl(result, i, sum);
-  }
+  vector_add_dest(a, b, result);
   // Return the result of the operation.
   return result;
 }
@@ -40,22 +28,17 @@ int vector_add_dest(struct vector *a, struct vector *b, struct vector *dest) {
   if (a->capacity != b->capacity) {
     return 1;
   }
-  // Check if the destination vector matches the expected size.
-  if (dest->capacity != a->capacity) {
+  // Check if the destination vector matches the expected size, and that its
+  // values are its own.
+  if (dest->capacity != a->capacity || vector_detach(dest) != 0) {
     return 1;
   }
   // Sum the values.
-  long double *val1;
-  long double *val2;
-  long double sum = 0;
-  for (int i = 0; i < a->capacity; i++) {
-    val1 = vector_getl(a, i);
-    val2 = vector_getl(b, i);
-    if (val1 == NULL || val2 == NULL) {
-      return 1;
-    }
-    sum = *val1 + *val2;
-    vector_setl(dest, i, sum);
+  long double *val1 = a->data;
+  long double *val2 = b->data;
+  long double *sum = dest->data;
+  for (int64_t i = 0; i < a->capacity; i++) {
+    sum[i] = val1[i] + val2[i];
   }
   // Return the result of the operation.
   return 0;
@@ -74,20 +57,8 @@ struct vector *vector_sub(struct vector *a, struct vector *b) {
   if (result == NULL) {
     return NULL;
   }
-  // Sum the values.
-  long double *val1;
-  long double *val2;
-  long double sub = 0;
-  for (int i = 0; i < a->capacity; i++) {
-    val1 = vector_getl(a, i);
-    val2 = vector_getl(b, i);
-    if (val1 == NULL || val2 == NULL) {
-      free(result);
-      return NULL;
-    }
-    sub = *val1 - *val2;
-    vector_setl(result, i, sub);
-  }
+  // Subtract the values.
+  vector_sub_dest(a, b, result);
   // Return the result of the operation.
   return result;
 }
@@ -100,22 +71,17 @@ int vector_sub_dest(struct vector *a, struct vector *b, struct vector *dest) {
   if (a->capacity != b->capacity) {
     return 1;
   }
-  // Check if the destination vector matches the expected size.
-  if (dest->capacity != a->capacity) {
+  // Check if the destination vector matches the expected size, and that its
+  // values are its own.
+  if (dest->capacity != a->capacity || vector_detach(dest) != 0) {
     return 1;
   }
-  // Sum the values.
-  long double *val1;
-  long double *val2;
-  long double sub = 0;
-  for (int i = 0; i < a->capacity; i++) {
-    val1 = vector_getl(a, i);
-    val2 = vector_getl(b, i);
-    if (val1 == NULL || val2 == NULL) {
-      return 1;
-    }
-    sub = *val1 - *val2;
-    vector_setl(dest, i, sub);
+  // Subtract the values.
+  long double *val1 = a->data;
+  long double *val2 = b->data;
+  long double *sub = dest->data;
+  for (int64_t i = 0; i < a->capacity; i++) {
+    sub[i] = val1[i] - val2[i];
   }
   // Return the result of the operation.
   return 0;
@@ -136,18 +102,7 @@ long double *vector_dot_product(struct vector *a, struct vector *b) {
     return NULL;
   }
   // Multiply values.
-  long double *val1;
-  long double *val2;
-  *result = 0;
-  for (int i = 0; i < a->capacity; i++) {
-    val1 = vector_getl(a, i);
-    val2 = vector_getl(b, i);
-    if (val1 == NULL || val2 == NULL) {
-      free(result);
-      return NULL;
-    }
-    *result = *result + (*val1) * (*val2);
-  }
+  vector_dot_norms(a, b, result, NULL, NULL);
   // Return the result of the operation.
   return result;
 }
@@ -166,18 +121,11 @@ struct vector *vector_hadamard_product(struct vector *a, struct vector *b) {
     return NULL;
   }
   // Multiply values.
-  long double *val1;
-  long double *val2;
-  long double mul;
-  for (int i = 0; i < a->capacity; i++) {
-    val1 = vector_getl(a, i);
-    val2 = vector_getl(b, i);
-    if (val1 == NULL || val2 == NULL) {
-      free(result);
-      return NULL;
-    }
-    mul = (*val1) * (*val2);
-    vector_setl(result, i, mul);
+  long double *val1 = a->data;
+  long double *val2 = b->data;
+  long double *mul = result->data;
+  for (int64_t i = 0; i < a->capacity; i++) {
+    mul[i] = val1[i] * val2[i];
   }
   // Return the result of the operation.
   return result;
@@ -193,16 +141,7 @@ struct vector *vector_scalar_mul(long double scalar, struct vector *a) {
     return NULL;
   }
   // Mul the values.
-  long double *val;
-  long double mul;
-  for (int i = 0; i < a->capacity; i++) {
-    val = vector_getl(a, i);
-    if (val == NULL) {
-      return NULL;
-    }
-    mul = scalar * (*val);
-    vector_setl(result, i, mul);
-  }
+  vector_scalar_mul_dest(scalar, a, result);
   // Return the result of the operation.
   return result;
 }
@@ -211,16 +150,16 @@ struct vector *vector_scalar_mul(long double scalar, struct vector *a) {
  * {@inheritdoc}
  */
 int vector_scalar_mul_dest(long double scalar, struct vector *a, struct vector *dest) {
+  // Check if the destination vector matches the expected size, and that its
+  // values are its own.
+  if (dest->capacity != a->capacity || vector_detach(dest) != 0) {
+    return 1;
+  }
   // Mul the values.
-  long double *val;
-  long double mul;
-  for (int i = 0; i < a->capacity; i++) {
-    val = vector_getl(a, i);
-    if (val == NULL) {
-      return 1;
-    }
-    mul = scalar * (*val);
-    vector_setl(dest, i, mul);
+  long double *val = a->data;
+  long double *mul = dest->data;
+  for (int64_t i = 0; i < a->capacity; i++) {
+    mul[i] = scalar * val[i];
   }
   // Return the result of the operation.
   return 0;
@@ -235,17 +174,11 @@ struct vector *vector_scalar_sub(long double scalar, struct vector *a) {
   if (result == NULL) {
     return NULL;
   }
-  // Sum the values.
-  long double *val;
-  long double sub;
-  for (int i = 0; i < a->capacity; i++) {
-    val = vector_getl(a, i);
-    if (val == NULL) {
-      free(result);
-      return NULL;
-    }
-    sub = scalar - (*val);
-    vector_setl(result, i, sub);
+  // Subtract the values.
+  long double *val = a->data;
+  long double *sub = result->data;
+  for (int64_t i = 0; i < a->capacity; i++) {
+    sub[i] = scalar - val[i];
   }
   // Return the result of the operation.
   return result;
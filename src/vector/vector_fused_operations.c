@@ -0,0 +1,237 @@
+#include <math.h>
+#include <stdlib.h>
+#include "../../include/matrixmath.h"
+
+/**
+ * The number of elements below which a reduction is not split across threads.
+ */
+#define VECTOR_FUSED_PARALLEL_GRAIN 32768
+
+/**
+ * Compute y = y + alpha * x over two buffers that do not overlap.
+ *
+ * @param int64_t n
+ *   The number of elements.
+ * @param long double alpha
+ *   The scale factor of x.
+ * @param const long double* x
+ *   The values to add.
+ * @param long double* y
+ *   The values to update.
+ */
+static void vector_axpy_kernel(int64_t n, long double alpha, const long double *restrict x, long double *restrict y) {
+  for (int64_t i = 0; i < n; i++) {
+    y[i] += alpha * x[i];
+  }
+}
+
+/**
+ * Compute y = alpha * x + beta * y over two buffers that do not overlap.
+ *
+ * @param int64_t n
+ *   The number of elements.
+ * @param long double alpha
+ *   The scale factor of x.
+ * @param const long double* x
+ *   The values to add.
+ * @param long double beta
+ *   The scale factor of y.
+ * @param long double* y
+ *   The values to update.
+ */
+static void vector_axpby_kernel(int64_t n, long double alpha, const long double *restrict x, long double beta, long double *restrict y) {
+  for (int64_t i = 0; i < n; i++) {
+    y[i] = alpha * x[i] + beta * y[i];
+  }
+}
+
+/**
+ * {@inheritdoc}
+ */
+int vector_axpy(long double alpha, struct vector *x, struct vector *y) {
+  if (x == NULL || y == NULL || x->capacity != y->capacity || vector_detach(y) != 0) {
+    return 1;
+  }
+  // Adding a vector to itself is a scaling.
+  if (x == y) {
+    return vector_scale_inplace(1 + alpha, y);
+  }
+  vector_axpy_kernel(y->capacity, alpha, x->data, y->data);
+  return 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int vector_axpby(long double alpha, struct vector *x, long double beta, struct vector *y) {
+  if (x == NULL || y == NULL || x->capacity != y->capacity || vector_detach(y) != 0) {
+    return 1;
+  }
+  // Combining a vector with itself is a scaling.
+  if (x == y) {
+    return vector_scale_inplace(alpha + beta, y);
+  }
+  // As in BLAS, y is not read when beta is zero.
+  if (beta == 0) {
+    return vector_scalar_mul_dest(alpha, x, y);
+  }
+  vector_axpby_kernel(y->capacity, alpha, x->data, beta, y->data);
+  return 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int vector_scale_inplace(long double alpha, struct vector *x) {
+  if (x == NULL || vector_detach(x) != 0) {
+    return 1;
+  }
+  long double *data = x->data;
+  for (int64_t i = 0; i < x->capacity; i++) {
+    data[i] *= alpha;
+  }
+  return 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int vector_add_inplace(struct vector *a, struct vector *b) {
+  if (a == NULL || b == NULL || a->capacity != b->capacity || vector_detach(a) != 0) {
+    return 1;
+  }
+  // Adding a vector to itself is a scaling.
+  if (a == b) {
+    return vector_scale_inplace(2, a);
+  }
+  vector_axpy_kernel(a->capacity, 1, b->data, a->data);
+  return 0;
+}
+
+/**
+ * Compute the inner product of two buffers.
+ *
+ * Long double arithmetic has no SIMD lanes, four independent partial sums hide
+ * the latency of the additions instead.
+ *
+ * @param int64_t n
+ *   The number of elements.
+ * @param const long double* x
+ *   The first buffer.
+ * @param const long double* y
+ *   The second buffer.
+ *
+ * @return long double
+ *   The inner product.
+ */
+static long double vector_dot_kernel(int64_t n, const long double *restrict x, const long double *restrict y) {
+  long double xy[4] = {0, 0, 0, 0};
+  int64_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    for (int64_t l = 0; l < 4; l++) {
+      xy[l] += x[i + l] * y[i + l];
+    }
+  }
+  for (; i < n; i++) {
+    xy[0] += x[i] * y[i];
+  }
+  return (xy[0] + xy[1]) + (xy[2] + xy[3]);
+}
+
+/**
+ * Compute the inner products x.y, x.x and y.y of two buffers in a single pass.
+ *
+ * @param int64_t n
+ *   The number of elements.
+ * @param const long double* x
+ *   The first buffer.
+ * @param const long double* y
+ *   The second buffer.
+ * @param long double* result
+ *   The destination of the three inner products.
+ */
+static void vector_dot_norms_kernel(int64_t n, const long double *restrict x, const long double *restrict y, long double *result) {
+  long double xy[4] = {0, 0, 0, 0};
+  long double xx[4] = {0, 0, 0, 0};
+  long double yy[4] = {0, 0, 0, 0};
+  int64_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    for (int64_t l = 0; l < 4; l++) {
+      xy[l] += x[i + l] * y[i + l];
+      xx[l] += x[i + l] * x[i + l];
+      yy[l] += y[i + l] * y[i + l];
+    }
+  }
+  for (; i < n; i++) {
+    xy[0] += x[i] * y[i];
+    xx[0] += x[i] * x[i];
+    yy[0] += y[i] * y[i];
+  }
+  result[0] = (xy[0] + xy[1]) + (xy[2] + xy[3]);
+  result[1] = (xx[0] + xx[1]) + (xx[2] + xx[3]);
+  result[2] = (yy[0] + yy[1]) + (yy[2] + yy[3]);
+}
+
+/**
+ * The data struct definition for a dot product in progress.
+ */
+struct vector_dot_task {
+  const long double *x;
+  const long double *y;
+  int norms;
+};
+
+/**
+ * Parallel reduction body of the dot product and the norms.
+ *
+ * @param void* context
+ *   The vector_dot_task object.
+ * @param int64_t start
+ *   The first element of the segment.
+ * @param int64_t end
+ *   The element after the last one of the segment.
+ * @param long double* partial
+ *   The destination of the inner products of the segment.
+ */
+static void vector_dot_norms_range(void *context, int64_t start, int64_t end, long double *partial) {
+  struct vector_dot_task *task = (struct vector_dot_task *)context;
+  if (task->norms) {
+    vector_dot_norms_kernel(end - start, task->x + start, task->y + start, partial);
+  }
+  else {
+    partial[0] = vector_dot_kernel(end - start, task->x + start, task->y + start);
+  }
+}
+
+/**
+ * {@inheritdoc}
+ */
+int vector_dot_norms_mode(struct vector *a, struct vector *b, enum parallel_reduction_mode mode, long double *dot, long double *norm_a, long double *norm_b) {
+  if (a == NULL || b == NULL || a->capacity != b->capacity) {
+    return 1;
+  }
+  // Skip the norms work when only the inner product is requested.
+  struct vector_dot_task task = {a->data, b->data, norm_a != NULL || norm_b != NULL};
+  long double result[3];
+  if (matrixmath_parallel_reduce(a->capacity, VECTOR_FUSED_PARALLEL_GRAIN, mode, task.norms ? 3 : 1, vector_dot_norms_range, &task, result) != 0) {
+    return 1;
+  }
+  // Store the requested outputs.
+  if (dot != NULL) {
+    *dot = result[0];
+  }
+  if (norm_a != NULL) {
+    *norm_a = sqrtl(result[1]);
+  }
+  if (norm_b != NULL) {
+    *norm_b = sqrtl(result[2]);
+  }
+  return 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int vector_dot_norms(struct vector *a, struct vector *b, long double *dot, long double *norm_a, long double *norm_b) {
+  return vector_dot_norms_mode(a, b, PARALLEL_REDUCTION_DEFAULT, dot, norm_a, norm_b);
+}
@@ -1,14 +0,0 @@
-#ifndef VECTOR_ITEM_PRINT_H
-#define VECTOR_ITEM_PRINT_H
-
-#include "vector_item.h"
-
-/**
- * Prints a vector item object.
- *
- * @param struct vector_item* object
- *   The vector object to be print.
- */
-void vector_item_print(struct vector_item *object);
-
-#endif
@@ -1,5 +1,6 @@
 #include "vector_tests.h"
 #include "matrix_tests.h"
+#include "solver_tests.h"
 
 /**
  * Main controller function.
@@ -15,6 +16,7 @@
 int main(int argc, char const *argv[]) {
   vector_tests();
   matrix_tests();
+  solver_tests();
   // Return success response.
   return 0;
 }
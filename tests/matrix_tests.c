@@ -4,6 +4,66 @@
 #include "../include/matrixmath.h"
 #include "matrix_tests.h"
 
+/**
+ * Completion callback counting the succeeded operations.
+ *
+ * @param void* context
+ *   The counter.
+ * @param int result
+ *   The value returned by the operation.
+ */
+void count_completion(void *context, int result) {
+  *(int *)context += result == 0;
+}
+
+/**
+ * Allocator callback counting the live buffers.
+ *
+ * @param void* context
+ *   The counter.
+ * @param size_t bytes
+ *   The number of bytes.
+ * @param size_t alignment
+ *   The alignment of the buffer.
+ *
+ * @return void*
+ *   The buffer, otherwise NULL.
+ */
+void *counted_allocate(void *context, size_t bytes, size_t alignment) {
+  void *data;
+  if (posix_memalign(&data, alignment, bytes) != 0) {
+    return NULL;
+  }
+  (*(int *)context)++;
+  return data;
+}
+
+/**
+ * Release callback counting the live buffers.
+ *
+ * @param void* context
+ *   The counter.
+ * @param void* data
+ *   The buffer.
+ */
+void counted_release(void *context, void *data) {
+  (*(int *)context)--;
+  free(data);
+}
+
+/**
+ * Member callback printing the names of the arrays of an archive.
+ *
+ * @param void* context
+ *   Unused.
+ * @param const char* name
+ *   The name of the array.
+ */
+void print_npz_member(void *context, const char *name) {
+  (void)context;
+  printf("member: [%s]\n", name);
+}
+
 /**
  * Main controller function.
  *
@@ -85,6 +145,14 @@ int matrix_tests() {
   vector_println(vector_n);
   struct vector *vector_o = matrix_mul_vector(matrix_n, vector_n);
   vector_println(vector_o);
+  // The product cannot overwrite the vector it reads.
+  long double array_square[2][2] = {{1, 2}, {3, 4}};
+  struct matrix *matrix_square_2 = matrix_from_array(&array_square[0][0], 2, 2);
+  struct vector *vector_ones = vector_create_with_value(2, 1);
+  printf("in place: [%d]\n", matrix_mul_vector_dest(matrix_square_2, vector_ones, vector_ones));
+  vector_println(vector_ones);
+  matrix_destroy(matrix_square_2);
+  vector_destroy(vector_ones);
 
   // Test Matix and Vector Nested Operations.
   printf("------------ Matrix and Vector Nested Operations. ------------\n");
@@ -111,10 +179,286 @@ int matrix_tests() {
   matrix_print(matrix_l);
   matrix_print(matrix_m);
 
+  // Test Matrix lazy expressions.
+  printf("------------ Matrix lazy expressions: (A - B) + 2 * C. ------------\n");
+  struct matrix *matrix_s = matrix_create(rows, columns);
+  struct expression expression_a = expression_matrix(matrix_a);
+  struct expression expression_b = expression_matrix(matrix_b);
+  struct expression expression_c = expression_matrix(matrix_c);
+  struct expression expression_ab = expression_sub(&expression_a, &expression_b);
+  struct expression expression_2c = expression_scale(2, &expression_c);
+  struct expression expression_sum = expression_add(&expression_ab, &expression_2c);
+  expression_eval_matrix(&expression_sum, matrix_s);
+  matrix_print(matrix_s);
+
+  // Test Matrix batched multiplication.
+  printf("------------ Matrix batched multiplication. ------------\n");
+  long double array_t[2][2][2] = {
+      {{1, 2}, {3, 4}},
+      {{0, 1}, {1, 0}}};
+  long double array_u[2][2] = {
+      {5, 6},
+      {7, 8}};
+  long double array_v[2][2][2];
+  matrix_mul_strided_batched(2, 2, 2, &array_t[0][0][0], 4, &array_u[0][0], 0, &array_v[0][0][0], 4, 2);
+  struct matrix *matrix_t = matrix_from_array(&array_v[0][0][0], 2, 2);
+  struct matrix *matrix_u = matrix_from_array(&array_v[1][0][0], 2, 2);
+  matrix_print(matrix_t);
+  matrix_print(matrix_u);
+  struct matrix *batch_a[2] = {matrix_a, matrix_e};
+  struct matrix *batch_b[2] = {matrix_b, matrix_f};
+  struct matrix *batch_c[2] = {matrix_create(3, 3), matrix_create(2, 3)};
+  matrix_mul_batched(batch_a, batch_b, batch_c, 2);
+  matrix_print(batch_c[0]);
+  matrix_print(batch_c[1]);
+  // A destination read or written by another product of the batch is rejected.
+  struct matrix *chain_c = matrix_create(2, 2);
+  struct matrix *chain_a[2] = {matrix_t, matrix_u};
+  struct matrix *chain_b[2] = {matrix_t, matrix_t};
+  struct matrix *chain_chained[2] = {matrix_u, chain_c};
+  struct matrix *chain_shared[2] = {chain_c, chain_c};
+  printf("Chained: [%d], shared destination: [%d]\n", matrix_mul_batched(chain_a, chain_b, chain_chained, 2), matrix_mul_batched(chain_a, chain_b, chain_shared, 2));
+  matrix_destroy(chain_c);
+
+  // Test Matrix reductions.
+  printf("------------ Matrix reductions. ------------\n");
+  struct vector *vector_w = vector_create(matrix_i->rows);
+  struct vector *vector_x = vector_create(matrix_i->columns);
+  printf("Sum: [%Lf], argmin: [%Lf], Frobenius norm: [%Lf]\n", matrix_reduce(matrix_i, REDUCTION_SUM), matrix_reduce(matrix_i, REDUCTION_ARGMIN), matrix_reduce(matrix_i, REDUCTION_NORM_L2));
+  matrix_reduce_rows(matrix_i, REDUCTION_MAX, vector_w);
+  matrix_reduce_columns(matrix_i, REDUCTION_MEAN, vector_x);
+  vector_println(vector_w);
+  vector_println(vector_x);
+
+  // Test Matrix elementwise functions.
+  printf("------------ Matrix elementwise functions. ------------\n");
+  struct matrix *matrix_y = matrix_create(matrix_i->rows, matrix_i->columns);
+  matrix_map(matrix_i, ELEMENTWISE_RELU, 0, 0, matrix_y);
+  matrix_print(matrix_y);
+  matrix_map(matrix_y, ELEMENTWISE_POW, 0.5, 0, matrix_y);
+  matrix_print(matrix_y);
+
+  // Test Matrix broadcasting.
+  printf("------------ Matrix broadcasting. ------------\n");
+  struct matrix *matrix_z = matrix_broadcast_row(matrix_i, vector_a, BROADCAST_SUB);
+  matrix_print(matrix_z);
+  matrix_broadcast_column_inplace(matrix_z, vector_w, BROADCAST_MUL);
+  matrix_print(matrix_z);
+
+  // Test Matrix rank updates.
+  printf("------------ Matrix rank updates: outer product, GER and SYRK. ------------\n");
+  struct matrix *matrix_o = vector_outer_product(vector_w, vector_a);
+  matrix_print(matrix_o);
+  matrix_ger(-1, vector_w, vector_a, matrix_o);
+  matrix_print(matrix_o);
+  struct matrix *matrix_v = matrix_create(matrix_i->rows, matrix_i->rows);
+  matrix_syrk(1, matrix_i, 0, matrix_v, MATRIX_LOWER);
+  matrix_print(matrix_v);
+
+  // Test Matrix triangular operations.
+  printf("------------ Matrix triangular operations: GEMM, TRMM, TRSM and packed storage. ------------\n");
+  long double array_l[3][3] = {
+      {2, 0, 0},
+      {1, 4, 0},
+      {3, 2, 5}};
+  struct matrix *matrix_lower = matrix_from_array(&array_l[0][0], 3, 3);
+  struct matrix *matrix_rhs = matrix_create(3, 2);
+  matrix_fill(matrix_rhs, 1);
+  matrix_gemm(2, matrix_lower, matrix_lower, 0, batch_c[0]);
+  matrix_print(batch_c[0]);
+  matrix_trmm(MATRIX_LOWER, 0, 1, matrix_lower, matrix_rhs);
+  matrix_print(matrix_rhs);
+  matrix_trsm(MATRIX_LOWER, 0, 1, matrix_lower, matrix_rhs);
+  matrix_print(matrix_rhs);
+  // Products with no row or no column are empty, not invalid.
+  printf("Empty GEMM: [%d] [%d], non-square TRSM: [%d]\n", matrix_gemm_strided(2, 0, 3, 1, matrix_lower->data, 3, matrix_rhs->data, 0, 0, batch_c[0]->data, 0), matrix_gemm_strided(0, 2, 3, 1, NULL, 3, NULL, 2, 0, NULL, 2), matrix_trsm(MATRIX_LOWER, 0, 1, matrix_rhs, matrix_rhs));
+  struct packed_matrix *packed_lower = packed_matrix_from_matrix(matrix_lower, MATRIX_LOWER, 0);
+  struct vector *vector_y = vector_create(3);
+  struct vector *vector_z = vector_create(3);
+  vector_fill(vector_y, 1);
+  packed_matrix_mul_vector_dest(packed_lower, vector_y, vector_z);
+  vector_println(vector_z);
+  packed_matrix_solve_vector(packed_lower, vector_z);
+  vector_println(vector_z);
+
+  // Test Matrix wrap, the borrowed array and the matrix share their values.
+  printf("------------ Matrix wrap. ------------\n");
+  struct matrix *matrix_borrowed = matrix_wrap(&array_l[0][0], 3, 3, NULL, NULL);
+  matrix_scalar_mul_dest(2, matrix_borrowed, matrix_borrowed);
+  printf("%.13Lf %.13Lf\n", array_l[2][0], matrix_data(matrix_borrowed)[8]);
+  long double *buffer = malloc(sizeof(long double) * 6);
+  struct matrix *matrix_adopted = matrix_wrap(buffer, 2, 3, matrixmath_release_free, NULL);
+  matrix_fill(matrix_adopted, 1.5);
+  matrix_print(matrix_adopted);
+
+  // Test Matrix clone, the values are copied by the first write.
+  printf("------------ Matrix clone. ------------\n");
+  struct matrix *matrix_clone_a = matrix_clone(matrix_adopted);
+  struct matrix *matrix_clone_b = matrix_clone(matrix_clone_a);
+  printf("shared: [%d]\n", matrix_clone_a->data == matrix_adopted->data && matrix_clone_b->data == matrix_adopted->data);
+  matrix_setl(matrix_clone_a, 0, 0, 7);
+  matrix_scalar_mul_dest(2, matrix_adopted, matrix_clone_b);
+  matrix_print(matrix_adopted);
+  matrix_print(matrix_clone_a);
+  matrix_print(matrix_clone_b);
+  struct matrix *matrix_clone_c = matrix_clone(matrix_clone_a);
+  *matrix_getl(matrix_clone_c, 0, 1) = 9;
+  printf("getl detached: [%d], [%Lf] [%Lf]\n", matrix_clone_c->data != matrix_clone_a->data, *matrix_getl(matrix_clone_a, 0, 1), *matrix_getl(matrix_clone_c, 0, 1));
+  matrix_destroy(matrix_clone_c);
+
+  // Test Matrix Market and CSV streams, written and read back.
+  printf("------------ Matrix Market and CSV streams. ------------\n");
+  FILE *stream = tmpfile();
+  matrix_market_write(stream, matrix_lower);
+  rewind(stream);
+  struct matrix *matrix_read = matrix_market_read(stream);
+  matrix_print(matrix_read);
+  fclose(stream);
+  stream = tmpfile();
+  struct matrix *matrix_random = matrix_create_random(4, 3, -1, 1);
+  matrix_csv_write(stream, matrix_random, ',');
+  rewind(stream);
+  struct matrix *matrix_csv = matrix_csv_read(stream, ',', 0);
+  int equal = matrix_csv != NULL && matrix_csv->rows == 4 && matrix_csv->columns == 3;
+  for (int i = 0; equal && i < 12; i++) {
+    equal = matrix_csv->data[i] == matrix_random->data[i];
+  }
+  printf("equal: [%d]\n", equal);
+  fclose(stream);
+  stream = tmpfile();
+  fputs("%%MatrixMarket matrix coordinate real symmetric\n% comment\n3 3 4\n1 1 4.0\n2 1 -1\n2 2 4\n3 3 2.5e0\n", stream);
+  rewind(stream);
+  struct sparse_matrix *sparse = matrix_market_read_sparse(stream);
+  fclose(stream);
+  vector_fill(vector_y, 1);
+  sparse_matrix_mul_vector_dest(sparse, vector_y, vector_z);
+  vector_println(vector_z);
+
+  // Test NumPy files, saved and loaded back.
+  printf("------------ NumPy files. ------------\n");
+  matrix_save_npy("matrix_tests.npy", matrix_lower, MATRIX_NPY_LONGDOUBLE, 0);
+  struct matrix *matrix_npy = matrix_load_npy("matrix_tests.npy");
+  matrix_print(matrix_npy);
+  matrix_save_npy("matrix_tests.npy", matrix_random, MATRIX_NPY_FLOAT64, 1);
+  struct matrix *matrix_npy_f64 = matrix_load_npy("matrix_tests.npy");
+  equal = matrix_npy_f64 != NULL && matrix_npy_f64->rows == 4 && matrix_npy_f64->columns == 3;
+  for (int i = 0; equal && i < 12; i++) {
+    equal = matrix_npy_f64->data[i] == (double)matrix_random->data[i];
+  }
+  printf("equal: [%d]\n", equal);
+  remove("matrix_tests.npy");
+  // The fixture holds a stored 2x3 matrix and a deflated 64 values vector.
+  printf("members: [%d]\n", matrix_npz_members("tests/fixtures/arrays.npz", print_npz_member, NULL));
+  struct matrix *matrix_npz = matrix_load_npz("tests/fixtures/arrays.npz", "matrix");
+  matrix_print(matrix_npz);
+  struct vector *vector_npz = vector_load_npz("tests/fixtures/arrays.npz", "vector.npy");
+  equal = vector_npz != NULL && vector_npz->capacity == 64;
+  for (int i = 0; equal && i < 64; i++) {
+    equal = vector_npz->data[i] == i * 0.5L;
+  }
+  printf("deflated: [%d], missing: [%d]\n", equal, matrix_load_npz("tests/fixtures/arrays.npz", "other") == NULL);
+  matrix_destroy(matrix_npz);
+  vector_destroy(vector_npz);
+
+  // Test printing to a buffer, summarized and with a custom precision.
+  printf("------------ Matrix print to buffers. ------------\n");
+  struct matrix *matrix_summary = matrix_create(6, 6);
+  matrix_fill(matrix_summary, 0.5);
+  char text[256];
+  int64_t length = matrix_sprint(text, sizeof(text), matrix_summary, 2, 2);
+  printf("%s%lld\n", text, (long long)length);
+  matrix_fprint(stdout, matrix_lower, 4, 0);
+
+  // Test the asynchronous operation queue, the products run in order.
+  printf("------------ Async operation queue. ------------\n");
+  struct matrixmath_queue *queue = matrixmath_queue_create();
+  struct matrix *matrix_async = matrix_create(3, 3);
+  int completed = 0;
+  struct matrixmath_future *future_first = matrixmath_queue_gemm(queue, 1, matrix_lower, matrix_lower, 0, matrix_async);
+  struct matrixmath_future *future_second = matrixmath_queue_gemm(queue, 1, matrix_lower, matrix_lower, 1, matrix_async);
+  matrixmath_future_then(future_first, count_completion, &completed);
+  matrixmath_future_then(future_second, count_completion, &completed);
+  printf("result: [%d]\n", matrixmath_future_wait(future_second));
+  printf("done: [%d], completed: [%d]\n", matrixmath_future_poll(future_first), completed);
+  matrix_print(matrix_async);
+  matrixmath_future_destroy(future_first);
+  matrixmath_future_destroy(future_second);
+  matrixmath_queue_destroy(queue);
+
+  // Test the task graph, chained tiled products overlap tile by tile.
+  printf("------------ Task graph. ------------\n");
+  struct matrixmath_graph *graph = matrixmath_graph_create(2);
+  struct matrix *matrix_square = matrix_create(3, 3);
+  struct matrix *matrix_cube = matrix_create(3, 3);
+  matrixmath_graph_gemm(graph, 1, matrix_lower, matrix_lower, 0, matrix_square);
+  matrixmath_graph_gemm(graph, 1, matrix_square, matrix_lower, 0, matrix_cube);
+  printf("result: [%d]\n", matrixmath_graph_run(graph));
+  matrix_print(matrix_cube);
+  matrixmath_graph_destroy(graph);
+
+  // Test page placement, large matrices are initialized by the threads.
+  printf("------------ Page placement. ------------\n");
+  matrixmath_set_numa_policy(NUMA_POLICY_INTERLEAVE);
+  struct matrix *matrix_placed = matrix_create(1024, 1024);
+  matrix_fill(matrix_placed, 2.5);
+  struct matrix *matrix_placed_copy = matrix_clone(matrix_placed);
+  matrix_detach(matrix_placed_copy);
+  matrix_placed_copy->data[0] = 1;
+  matrixmath_set_numa_policy(NUMA_POLICY_DEFAULT);
+  printf("policy: [%d], values: [%.1Lf, %.1Lf, %.1Lf]\n", matrixmath_get_numa_policy(), matrix_placed->data[0], matrix_placed_copy->data[0], matrix_placed_copy->data[1024 * 1024 - 1]);
+
+  // Test the allocators, the buffers go back to the allocator they come from.
+  printf("------------ Allocators. ------------\n");
+  int allocated = 0;
+  struct matrixmath_allocator allocator = {counted_allocate, counted_release, &allocated};
+  matrixmath_set_allocator(&allocator);
+  struct matrix *matrix_allocated = matrix_create(2, 2);
+  matrixmath_set_allocator(NULL);
+  matrixmath_set_huge_pages(HUGE_PAGES_TRANSPARENT);
+  struct matrix *matrix_huge = matrix_create(512, 512);
+  matrixmath_set_huge_pages(HUGE_PAGES_DEFAULT);
+  printf("live: [%d], aligned: [%d]\n", allocated, (int)((uintptr_t)matrix_huge->data % MATRIXMATH_ALIGNMENT));
+  matrix_destroy(matrix_allocated);
+  matrix_destroy(matrix_huge);
+  printf("live: [%d]\n", allocated);
+
+  // Test mixed precision, float factors refined to the long double accuracy.
+  printf("------------ Mixed precision. ------------\n");
+  long double array_mixed[3][3] = {
+      {4, 1, 2},
+      {1, 5, 1},
+      {2, 1, 3}};
+  struct matrix *matrix_mixed = matrix_from_array(&array_mixed[0][0], 3, 3);
+  struct matrix *matrix_mixed_product = matrix_mul_mixed(MATRIX_PRECISION_FLOAT, matrix_mixed, matrix_lower);
+  matrix_print(matrix_mixed_product);
+  struct vector *vector_mixed = vector_create(3);
+  vector_fill(vector_mixed, 1);
+  printf("status: [%d]\n", matrix_solve_mixed(matrix_mixed, vector_mixed, MATRIX_PRECISION_FLOAT));
+  vector_println(vector_mixed);
+
+  // Test fixed size matrices.
+  printf("------------ Fixed size matrices. ------------\n");
+  struct mat3 mat3_a = {{{2, 0, 1}, {1, 3, 2}, {1, 1, 2}}};
+  struct mat3 mat3_inv;
+  mat3_inverse(mat3_a, &mat3_inv);
+  printf("det = %.13Lf\n", mat3_determinant(mat3_a));
+  struct matrix *matrix_w = mat3_to_matrix(mat3_mul(mat3_a, mat3_inv));
+  matrix_print(matrix_w);
+  struct mat4 mat4_a = {{{4, 0, 0, 1}, {0, 3, 0, 0}, {0, 0, 2, 0}, {1, 0, 0, 1}}};
+  struct mat4 mat4_inv;
+  mat4_inverse(mat4_a, &mat4_inv);
+  printf("det = %.13Lf\n", mat4_determinant(mat4_a));
+  struct matrix *matrix_x = mat4_to_matrix(mat4_mul(mat4_inv, mat4_a));
+  matrix_print(matrix_x);
+  struct vec3 vec3_x = {{1, 0, 0}};
+  struct vec3 vec3_y = {{0, 1, 0}};
+  struct vec3 vec3_z = mat3_mul_vec(mat3_identity(), vec3_cross(vec3_x, vec3_y));
+  printf("cross = %.13Lf %.13Lf %.13Lf, dot = %.13Lf\n", vec3_z.v[0], vec3_z.v[1], vec3_z.v[2], vec3_dot(vec3_x, vec3_y));
+
   // Test Matrix Create Random.
   printf("------------ Matrix Create Random. ------------\n");
   // Seed the random number generator with the current time.
-  srandom(time(NULL));
+  matrixmath_random_seed(time(NULL));
   struct matrix *matrix_p = matrix_create_random(rows, columns, 0.1, 1.0);
   struct matrix *matrix_q = matrix_create_random(rows, columns, 0.1, 1.0);
   struct matrix *matrix_r = matrix_create_random(rows, columns, 0.1, 1.0);
@@ -146,6 +490,43 @@ int matrix_tests() {
   matrix_destroy(matrix_p);
   matrix_destroy(matrix_q);
   matrix_destroy(matrix_r);
+  matrix_destroy(matrix_s);
+  matrix_destroy(matrix_t);
+  matrix_destroy(matrix_u);
+  matrix_destroy(batch_c[0]);
+  matrix_destroy(batch_c[1]);
+  matrix_destroy(matrix_w);
+  matrix_destroy(matrix_x);
+  vector_destroy(vector_w);
+  vector_destroy(vector_x);
+  matrix_destroy(matrix_y);
+  matrix_destroy(matrix_z);
+  matrix_destroy(matrix_o);
+  matrix_destroy(matrix_v);
+  matrix_destroy(matrix_lower);
+  matrix_destroy(matrix_rhs);
+  packed_matrix_destroy(packed_lower);
+  vector_destroy(vector_y);
+  vector_destroy(vector_z);
+  matrix_destroy(matrix_borrowed);
+  matrix_destroy(matrix_adopted);
+  matrix_destroy(matrix_clone_a);
+  matrix_destroy(matrix_clone_b);
+  matrix_destroy(matrix_read);
+  matrix_destroy(matrix_csv);
+  matrix_destroy(matrix_random);
+  matrix_destroy(matrix_npy);
+  matrix_destroy(matrix_npy_f64);
+  matrix_destroy(matrix_summary);
+  matrix_destroy(matrix_async);
+  matrix_destroy(matrix_square);
+  matrix_destroy(matrix_cube);
+  matrix_destroy(matrix_placed);
+  matrix_destroy(matrix_placed_copy);
+  matrix_destroy(matrix_mixed);
+  matrix_destroy(matrix_mixed_product);
+  vector_destroy(vector_mixed);
+  sparse_matrix_destroy(sparse);
 
   // Return success response.
   return 0;
@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../include/matrixmath.h"
+#include "solver_tests.h"
+
+/**
+ * Create the 1D Poisson matrix: 2 on the diagonal and -1 next to it.
+ *
+ * @param int size
+ *   The number of rows and columns.
+ * @param long double shift
+ *   The value added to the diagonal, a nonzero shift breaks the symmetry.
+ *
+ * @return struct matrix*
+ *   The pointer to the matrix instance, otherwise NULL.
+ */
+struct matrix *poisson_matrix(int size, long double shift) {
+  struct matrix *object = matrix_create(size, size);
+  matrix_fill(object, 0);
+  for (int i = 0; i < size; i++) {
+    matrix_setl(object, i, i, 2);
+    if (i > 0) {
+      matrix_setl(object, i, i - 1, -1 - shift);
+    }
+    if (i < size - 1) {
+      matrix_setl(object, i, i + 1, -1);
+    }
+  }
+  return object;
+}
+
+/**
+ * Print the outcome of a solve.
+ *
+ * @param const char* name
+ *   The name of the method.
+ * @param int status
+ *   The status returned by the solver.
+ * @param struct krylov_solver* solver
+ *   The solver object.
+ * @param struct vector* x
+ *   The solution vector.
+ */
+void print_solve(const char *name, int status, struct krylov_solver *solver, struct vector *x) {
+  printf("%s: status [%d], iterations [%d], residual [%Le]\n", name, status, solver->iterations, solver->residual);
+  vector_println(x);
+}
+
+/**
+ * Main controller function.
+ *
+ * @return int
+ *   The constant that represent the exit status.
+ */
+int solver_tests() {
+  int size = 8;
+  struct matrix *spd = poisson_matrix(size, 0);
+  struct matrix *nonsymmetric = poisson_matrix(size, 0.5);
+  struct vector *b = vector_create_with_value(size, 1);
+  struct vector *x = vector_create_zeros(size);
+  struct krylov_solver *solver = krylov_solver_create(size, 4);
+  struct linear_operator op = {matrix_operator_apply, spd};
+  struct preconditioner *jacobi = preconditioner_jacobi_create(spd);
+  struct preconditioner *ilu0 = preconditioner_ilu0_create(nonsymmetric);
+  int status;
+
+  printf("------------ Conjugate Gradient. ------------\n");
+  status = krylov_cg(solver, &op, NULL, b, x);
+  print_solve("CG", status, solver, x);
+  vector_fill(x, 0);
+  status = krylov_cg(solver, &op, jacobi, b, x);
+  print_solve("CG + Jacobi", status, solver, x);
+
+  printf("------------ BiCGSTAB. ------------\n");
+  op.context = nonsymmetric;
+  vector_fill(x, 0);
+  status = krylov_bicgstab(solver, &op, NULL, b, x);
+  print_solve("BiCGSTAB", status, solver, x);
+  vector_fill(x, 0);
+  status = krylov_bicgstab(solver, &op, ilu0, b, x);
+  print_solve("BiCGSTAB + ILU(0)", status, solver, x);
+
+  printf("------------ Restarted GMRES. ------------\n");
+  vector_fill(x, 0);
+  status = krylov_gmres(solver, &op, NULL, b, x);
+  print_solve("GMRES(4)", status, solver, x);
+  vector_fill(x, 0);
+  status = krylov_gmres(solver, &op, ilu0, b, x);
+  print_solve("GMRES(4) + ILU(0)", status, solver, x);
+
+  printf("------------ Sparse preconditioners. ------------\n");
+  struct sparse_matrix *sparse_spd = sparse_matrix_from_matrix(spd);
+  struct sparse_matrix *sparse_nonsymmetric = sparse_matrix_from_matrix(nonsymmetric);
+  struct preconditioner *sparse_jacobi = preconditioner_jacobi_create_sparse(sparse_spd);
+  struct preconditioner *sparse_ilu0 = preconditioner_ilu0_create_sparse(sparse_nonsymmetric);
+  op.apply = sparse_operator_apply;
+  op.context = sparse_spd;
+  vector_fill(x, 0);
+  status = krylov_cg(solver, &op, sparse_jacobi, b, x);
+  print_solve("CG + sparse Jacobi", status, solver, x);
+  op.context = sparse_nonsymmetric;
+  vector_fill(x, 0);
+  status = krylov_bicgstab(solver, &op, sparse_ilu0, b, x);
+  print_solve("BiCGSTAB + sparse ILU(0)", status, solver, x);
+
+  printf("------------ Banded solvers. ------------\n");
+  struct banded_matrix *tridiagonal = banded_matrix_from_matrix(spd, 1, 1);
+  struct banded_matrix *banded = banded_matrix_from_matrix(nonsymmetric, 1, 1);
+  vector_fill(x, 1);
+  status = banded_matrix_solve_tridiagonal(tridiagonal, x);
+  printf("Thomas: status [%d]\n", status);
+  vector_println(x);
+  vector_fill(x, 1);
+  status = banded_matrix_solve(banded, x);
+  printf("Banded LU: status [%d]\n", status);
+  vector_println(x);
+  op.apply = banded_operator_apply;
+  op.context = banded;
+  vector_fill(x, 0);
+  status = krylov_gmres(solver, &op, NULL, b, x);
+  print_solve("GMRES(4) on the banded operator", status, solver, x);
+
+  // Clear the used memory.
+  preconditioner_destroy(jacobi);
+  preconditioner_destroy(ilu0);
+  preconditioner_destroy(sparse_jacobi);
+  preconditioner_destroy(sparse_ilu0);
+  sparse_matrix_destroy(sparse_spd);
+  sparse_matrix_destroy(sparse_nonsymmetric);
+  krylov_solver_destroy(solver);
+  matrix_destroy(spd);
+  matrix_destroy(nonsymmetric);
+  banded_matrix_destroy(tridiagonal);
+  banded_matrix_destroy(banded);
+  vector_destroy(b);
+  vector_destroy(x);
+  // Return success response.
+  return 0;
+}
@@ -0,0 +1,12 @@
+#ifndef SOLVER_TESTS_H
+#define SOLVER_TESTS_H
+
+/**
+ * Iterative solvers tests function.
+ *
+ * @return int
+ *   The constant that represent the exit status.
+ */
+int solver_tests();
+
+#endif
@@ -42,6 +42,34 @@ long double cube(long double x) {
   return (x * x * x);
 }
 
+/**
+ * Release callback function, counting the releases instead of freeing.
+ *
+ * @param void* context
+ *   The release counter.
+ * @param long double* data
+ *   The released values.
+ */
+void count_release(void *context, long double *data) {
+  (*(int *)context)++;
+}
+
+/**
+ * Halve callback function, applied to a chunk of values.
+ *
+ * @param void* context
+ *   Unused.
+ * @param long double* values
+ *   The values of the chunk.
+ * @param int count
+ *   The number of values of the chunk.
+ */
+void halve_batch(void *context, long double *values, int count) {
+  for (int i = 0; i < count; i++) {
+    values[i] /= 2;
+  }
+}
+
 /**
  * Main controller function.
  *
@@ -116,6 +144,17 @@ int vector_tests() {
   vector_println(result5);
   vector_walk(result5, &cube);
   vector_println(result5);
+  vector_walk_batch(result5, &halve_batch, NULL);
+  vector_println(result5);
+
+  printf("------------ Vector elementwise functions. ------------\n");
+  struct vector *result9 = vector_create(capacity);
+  vector_map(result5, ELEMENTWISE_LOG, 0, 0, result9);
+  vector_println(result9);
+  vector_map(result9, ELEMENTWISE_SIGMOID, 0, 0, result9);
+  vector_println(result9);
+  vector_map(result5, ELEMENTWISE_CLAMP, 1, 10, result9);
+  vector_println(result9);
 
   printf("------------ Vector Hadamard product. ------------\n");
   vector_println(a);
@@ -127,11 +166,103 @@ int vector_tests() {
   vector_println(a);
   struct vector *result7 = vector_clone(a);
   vector_println(result7);
+  // The clone shares the values of a until it is written.
+  vector_setl(result7, 0, 100);
+  vector_println(a);
+  vector_println(result7);
+  // So is a clone written through vector_getl().
+  struct vector *result7_clone = vector_clone(result7);
+  *vector_getl(result7_clone, 1) = 200;
+  vector_println(result7);
+  vector_println(result7_clone);
+  vector_destroy(result7_clone);
+
+  printf("------------ Vector fused operations. ------------\n");
+  struct vector *result8 = vector_clone(a);
+  vector_axpy(2, b, result8);
+  vector_println(result8);
+  vector_axpby(0.5, a, -1, result8);
+  vector_println(result8);
+  vector_scale_inplace(3, result8);
+  vector_println(result8);
+  vector_add_inplace(result8, b);
+  vector_println(result8);
+  long double dot, norm_a, norm_b;
+  vector_dot_norms(a, b, &dot, &norm_a, &norm_b);
+  printf("Dot product: [%Lf], norm a: [%Lf], norm b: [%Lf]\n", dot, norm_a, norm_b);
+
+  // Test Vector reductions.
+  printf("------------ Vector reductions. ------------\n");
+  printf("Sum: [%Lf], mean: [%Lf], min: [%Lf], max: [%Lf], argmax: [%lld]\n", vector_sum(a), vector_mean(a), vector_min(a), vector_max(a), (long long)vector_argmax(a));
+  printf("Norm L1: [%Lf], L2: [%Lf], Linf: [%Lf]\n", vector_norm_l1(a), vector_norm_l2(a), vector_norm_inf(a));
+  vector_dot_norms_mode(a, b, PARALLEL_REDUCTION_REPRODUCIBLE, &dot, NULL, NULL);
+  printf("Reproducible dot product: [%Lf], sum: [%Lf]\n", dot, vector_reduce_mode(a, REDUCTION_SUM, PARALLEL_REDUCTION_REPRODUCIBLE));
+
+  // The reproducible results must not depend on the number of threads, the
+  // sizes make every one of the 64 segments span several blocks.
+  printf("------------ Reproducibility across threads. ------------\n");
+  int thread_counts[3] = {1, 3, 8};
+  long double sums[3], dots[3], norms[3];
+  int same = 1;
+  struct vector *long_a = vector_create_random(64 * 32768 + 4099, -1, 1);
+  struct vector *long_b = vector_create_random(64 * 32768 + 4099, -1, 1);
+  struct matrix *gemm_a = matrix_create_random(200, 150, -1, 1);
+  struct matrix *gemm_b = matrix_create_random(150, 180, -1, 1);
+  struct matrix *gemm_c[3];
+  for (int t = 0; t < 3; t++) {
+    matrixmath_set_num_threads(thread_counts[t]);
+    sums[t] = vector_reduce_mode(long_a, REDUCTION_SUM, PARALLEL_REDUCTION_REPRODUCIBLE);
+    vector_dot_norms_mode(long_a, long_b, PARALLEL_REDUCTION_REPRODUCIBLE, &dots[t], &norms[t], NULL);
+    gemm_c[t] = matrix_create(200, 180);
+    matrix_gemm(1, gemm_a, gemm_b, 0, gemm_c[t]);
+  }
+  matrixmath_set_num_threads(0);
+  for (int t = 1; t < 3; t++) {
+    same &= sums[t] == sums[0] && dots[t] == dots[0] && norms[t] == norms[0];
+    for (int i = 0; i < 200 * 180; i++) {
+      same &= gemm_c[t]->data[i] == gemm_c[0]->data[i];
+    }
+  }
+  printf("Sum, dot product, norm and GEMM identical with 1, 3 and 8 threads: [%d]\n", same);
+  for (int t = 0; t < 3; t++) {
+    matrix_destroy(gemm_c[t]);
+  }
+  matrix_destroy(gemm_a);
+  matrix_destroy(gemm_b);
+  vector_destroy(long_a);
+  vector_destroy(long_b);
+
+  // Test Vector wrap, with a borrowed buffer and a custom release callback.
+  printf("------------ Vector wrap. ------------\n");
+  long double values[4] = {1, 2, 3, 4};
+  int released = 0;
+  struct vector *vector_borrowed = vector_wrap(values, 4, NULL, NULL);
+  struct vector *vector_owned = vector_wrap(values, 4, count_release, &released);
+  vector_scalar_mul_dest(2, vector_borrowed, vector_borrowed);
+  vector_println(vector_owned);
+  printf("Last: [%Lf], shared: [%d]\n", values[3], vector_data(vector_borrowed) == vector_data(vector_owned));
+  vector_destroy(vector_borrowed);
+  vector_destroy(vector_owned);
+  printf("Released: [%d]\n", released);
+
+  // Test growable vectors, built one value at a time.
+  printf("------------ Vector push, append and resize. ------------\n");
+  struct vector *vector_g = vector_create(1);
+  for (int i = 1; i < 6; i++) {
+    vector_push(vector_g, i);
+  }
+  vector_append(vector_g, vector_g);
+  vector_println(vector_g);
+  vector_resize(vector_g, 3);
+  vector_shrink_to_fit(vector_g);
+  vector_resize(vector_g, 5);
+  printf("Capacity: [%lld], allocated: [%lld]\n", (long long)vector_g->capacity, (long long)vector_g->allocated);
+  vector_println(vector_g);
 
   // Test Vector Create Random.
   printf("------------ Vector Create Random. ------------\n");
   // Seed the random number generator with the current time.
-  srandom(time(NULL));
+  matrixmath_random_seed(time(NULL));
   struct vector *vector_p = vector_create_random(capacity, 0.1, 1.0);
   struct vector *vector_q = vector_create_random(capacity, 0.1, 1.0);
   struct vector *vector_r = vector_create_random(capacity, 0.1, 1.0);
@@ -140,6 +271,18 @@ int vector_tests() {
   vector_println(vector_q);
   vector_println(vector_r);
 
+  // Test Vector random streams, the same seed and stream give the same values.
+  printf("------------ Vector Random Gaussian. ------------\n");
+  struct random_generator generator = random_generator_seed(42);
+  struct random_generator stream_a = random_generator_stream(&generator, 1);
+  struct random_generator stream_b = random_generator_stream(&generator, 1);
+  struct vector *vector_s = vector_create(capacity);
+  struct vector *vector_t = vector_create(capacity);
+  vector_fill_gaussian(vector_s, &stream_a, 0, 1);
+  vector_fill_gaussian(vector_t, &stream_b, 0, 1);
+  vector_println(vector_s);
+  vector_println(vector_t);
+
   // Clear the used memory.
   vector_destroy(a);
   vector_destroy(b);
@@ -150,6 +293,14 @@ int vector_tests() {
   vector_destroy(result5);
   vector_destroy(result6);
   vector_destroy(result7);
+  vector_destroy(result8);
+  vector_destroy(result9);
+  vector_destroy(vector_p);
+  vector_destroy(vector_q);
+  vector_destroy(vector_r);
+  vector_destroy(vector_s);
+  vector_destroy(vector_t);
+  vector_destroy(vector_g);
   // Return success response.
   return 0;
 }